@@ -57,11 +57,29 @@ public:
   virtual SysCallIntResult recvmmsg(os_fd_t sockfd, struct mmsghdr* msgvec, unsigned int vlen,
                                     int flags, struct timespec* timeout) PURE;
 
+  /**
+   * @see sendmmsg (man 2 sendmmsg)
+   */
+  virtual SysCallIntResult sendmmsg(os_fd_t sockfd, struct mmsghdr* msgvec, unsigned int vlen,
+                                    int flags) PURE;
+
   /**
    * return true if the OS supports recvmmsg() and sendmmsg().
    */
   virtual bool supportsMmsg() const PURE;
 
+  /**
+   * return true if the OS supports UDP generic segmentation offload, i.e. sending a message which
+   * the kernel splits into multiple datagrams of the size given by a UDP_SEGMENT control message.
+   */
+  virtual bool supportsUdpGso() const PURE;
+
+  /**
+   * return true if the OS supports UDP generic receive offload, i.e. the UDP_GRO socket option
+   * which lets the kernel coalesce multiple received datagrams into a single message.
+   */
+  virtual bool supportsUdpGro() const PURE;
+
   /**
    * Release all resources allocated for fd.
    * @return zero on success, -1 returned otherwise.
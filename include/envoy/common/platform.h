@@ -162,6 +162,7 @@ struct msghdr {
 
 #if defined(__linux__)
 #include <linux/netfilter_ipv4.h>
+#include <netinet/udp.h>
 #endif
 
 #define PACKED_STRUCT(definition, ...) definition, ##__VA_ARGS__ __attribute__((packed))
@@ -195,8 +196,19 @@ using os_fd_t = int;
 // this please bring up in Envoy's slack channel #envoy-udp-quic-dev.
 #if defined(__linux__)
 #define ENVOY_MMSG_MORE 1
+// UDP generic segmentation offload (Linux 4.18) and generic receive offload (Linux 5.0). Older C
+// library headers may lack the socket options; whether the running kernel supports them is probed
+// at runtime.
+#define ENVOY_UDP_GSO_GRO 1
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
 #else
 #define ENVOY_MMSG_MORE 0
+#define ENVOY_UDP_GSO_GRO 0
 #define MSG_WAITFORONE 0x10000 // recvmmsg(): block until 1+ packets avail.
 // Posix structure for describing messages sent by 'sendmmsg` and received by
 // 'recvmmsg'
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -163,6 +164,17 @@ public:
    */
   virtual Event::TimerPtr createTimer(TimerCb cb) PURE;
 
+  /**
+   * Allocates a coarse timer, which is armed, re-armed and disarmed in O(1) rather than in the
+   * O(log n) of createTimer(), and fires up to one granularity after its deadline. The coarse
+   * timers of a given granularity share a timer wheel, itself driven by a single timer, so this
+   * suits large numbers of frequently re-armed timeouts such as idle timeouts. @see Timer for docs
+   * on how to use the timer.
+   * @param cb supplies the callback to invoke when the timer fires.
+   * @param granularity supplies the granularity of the timer, which must be greater than zero.
+   */
+  virtual Event::TimerPtr createCoarseTimer(TimerCb cb, std::chrono::milliseconds granularity) PURE;
+
   /**
    * Submits an item for deferred delete. @see DeferredDeletable.
    */
@@ -45,6 +45,17 @@ public:
    */
   virtual Api::IoCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Write several buffers to the file, in order. Where the platform supports it, this takes a
+   * single system call. The file must be explicitly opened before writing.
+   *
+   * @param buffers supplies the buffers to write.
+   * @param num_buffers supplies the number of buffers.
+   * @return ssize_t total number of bytes written, or -1 for failure
+   */
+  virtual Api::IoCallSizeResult writev(const absl::string_view* buffers,
+                                       uint64_t num_buffers) PURE;
+
   /**
    * Close the file.
    *
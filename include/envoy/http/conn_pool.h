@@ -96,6 +96,13 @@ public:
    */
   virtual bool hasActiveConnections() const PURE;
 
+  /**
+   * Establish connections ahead of demand, up to the minimum number of warm connections and the
+   * prefetch ratio of the host's cluster. This is a no-op for a pool which is being drained.
+   * @return true if a connection was created.
+   */
+  virtual bool maybePrefetch() PURE;
+
   /**
    * Create a new stream on the pool.
    * @param response_decoder supplies the decoder events to fire when the response is
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -17,6 +18,7 @@
 
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Http {
@@ -637,6 +639,130 @@ public:
 
 using HeaderMapPtr = std::unique_ptr<HeaderMap>;
 
+/**
+ * Registry of the O(1) headers of each typed header map. All of the built in inline headers above
+ * are registered, and extensions may register additional headers that they access on hot paths.
+ * Registration must happen during static initialization, typically via
+ * RegisterCustomInlineHeader, because the registry for a header map type is finalized the first
+ * time a header map of that type is used. Registering the same header more than once, including a
+ * built in header, yields handles to the same slot.
+ */
+class CustomInlineHeaderRegistry {
+public:
+  enum class Type { RequestHeaders, RequestTrailers, ResponseHeaders, ResponseTrailers };
+  using RegistrationMap = std::map<LowerCaseString, size_t>;
+
+  /**
+   * Reference to a registered header. The type parameter prevents handles registered for one
+   * header map type from being used with another.
+   */
+  template <Type type> class Handle {
+  public:
+    size_t index() const { return index_; }
+    const LowerCaseString& key() const { return *key_; }
+
+  private:
+    explicit Handle(const RegistrationMap::value_type& entry)
+        : index_(entry.second), key_(&entry.first) {}
+
+    size_t index_;
+    const LowerCaseString* key_;
+
+    friend class CustomInlineHeaderRegistry;
+  };
+
+  /**
+   * Register a header for O(1) access.
+   * @param header supplies the header to register.
+   * @return the handle used to access the header.
+   */
+  template <Type type> static Handle<type> registerInlineHeader(const LowerCaseString& header) {
+    RELEASE_ASSERT(!mutableFinalized<type>(),
+                   "inline headers must be registered before any header map is used");
+    RegistrationMap& headers = mutableRegistrationMap<type>();
+    const size_t index = headers.size();
+    return Handle<type>(*headers.emplace(header, index).first);
+  }
+
+  /**
+   * Prevent further registration. This is called by the header map implementation before it
+   * builds its lookup table.
+   */
+  template <Type type> static void finalize() { mutableFinalized<type>() = true; }
+
+  /**
+   * @return all registered headers and their slot indexes.
+   */
+  template <Type type> static const RegistrationMap& headers() {
+    return mutableRegistrationMap<type>();
+  }
+
+  /**
+   * @return the handle for a registered header, or absl::nullopt if the header is not registered.
+   */
+  template <Type type>
+  static absl::optional<Handle<type>> getInlineHeader(const LowerCaseString& header) {
+    const RegistrationMap& headers = mutableRegistrationMap<type>();
+    const auto it = headers.find(header);
+    if (it == headers.end()) {
+      return absl::nullopt;
+    }
+    return Handle<type>(*it);
+  }
+
+private:
+  template <Type type> static RegistrationMap& mutableRegistrationMap() {
+    MUTABLE_CONSTRUCT_ON_FIRST_USE(RegistrationMap);
+  }
+  template <Type type> static bool& mutableFinalized() {
+    MUTABLE_CONSTRUCT_ON_FIRST_USE(bool, false);
+  }
+};
+
+/**
+ * Registers a custom inline header at static initialization time, e.g.:
+ *
+ * RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::RequestHeaders>
+ *     authorization_handle(Http::Headers::get().Authorization);
+ */
+template <CustomInlineHeaderRegistry::Type type> class RegisterCustomInlineHeader {
+public:
+  explicit RegisterCustomInlineHeader(const LowerCaseString& header)
+      : handle_(CustomInlineHeaderRegistry::registerInlineHeader<type>(header)) {}
+
+  typename CustomInlineHeaderRegistry::Handle<type> handle() const { return handle_; }
+
+private:
+  const typename CustomInlineHeaderRegistry::Handle<type> handle_;
+};
+
+/**
+ * O(1) access to registered headers. These functions behave like the per header functions
+ * defined by DEFINE_INLINE_HEADER.
+ */
+template <CustomInlineHeaderRegistry::Type type> class CustomInlineHeaderBase {
+public:
+  static constexpr CustomInlineHeaderRegistry::Type header_map_type = type;
+  using Handle = CustomInlineHeaderRegistry::Handle<type>;
+
+  virtual ~CustomInlineHeaderBase() = default;
+
+  virtual const HeaderEntry* getInline(Handle handle) const PURE;
+  virtual void appendInline(Handle handle, absl::string_view data,
+                            absl::string_view delimiter) PURE;
+  virtual void setReferenceInline(Handle handle, absl::string_view value) PURE;
+  virtual void setInline(Handle handle, absl::string_view value) PURE;
+  virtual void setInline(Handle handle, uint64_t value) PURE;
+  virtual size_t removeInline(Handle handle) PURE;
+  absl::string_view getInlineValue(Handle handle) const {
+    const HeaderEntry* entry = getInline(handle);
+    if (entry != nullptr) {
+      return entry->value().getStringView();
+    }
+    return "";
+  }
+};
+
 /**
  * Typed derived classes for all header map types.
  */
@@ -648,14 +774,18 @@ public:
 };
 
 // Request headers.
-class RequestHeaderMap : public RequestOrResponseHeaderMap {
+class RequestHeaderMap
+    : public RequestOrResponseHeaderMap,
+      public CustomInlineHeaderBase<CustomInlineHeaderRegistry::Type::RequestHeaders> {
 public:
   INLINE_REQ_HEADERS(DEFINE_INLINE_HEADER)
 };
 using RequestHeaderMapPtr = std::unique_ptr<RequestHeaderMap>;
 
 // Request trailers.
-class RequestTrailerMap : public virtual HeaderMap {};
+class RequestTrailerMap
+    : public virtual HeaderMap,
+      public CustomInlineHeaderBase<CustomInlineHeaderRegistry::Type::RequestTrailers> {};
 using RequestTrailerMapPtr = std::unique_ptr<RequestTrailerMap>;
 
 // Base class for both response headers and trailers.
@@ -665,14 +795,20 @@ public:
 };
 
 // Response headers.
-class ResponseHeaderMap : public RequestOrResponseHeaderMap, public ResponseHeaderOrTrailerMap {
+class ResponseHeaderMap
+    : public RequestOrResponseHeaderMap,
+      public ResponseHeaderOrTrailerMap,
+      public CustomInlineHeaderBase<CustomInlineHeaderRegistry::Type::ResponseHeaders> {
 public:
   INLINE_RESP_HEADERS(DEFINE_INLINE_HEADER)
 };
 using ResponseHeaderMapPtr = std::unique_ptr<ResponseHeaderMap>;
 
 // Response trailers.
-class ResponseTrailerMap : public virtual HeaderMap, public ResponseHeaderOrTrailerMap {};
+class ResponseTrailerMap
+    : public virtual HeaderMap,
+      public ResponseHeaderOrTrailerMap,
+      public CustomInlineHeaderBase<CustomInlineHeaderRegistry::Type::ResponseTrailers> {};
 using ResponseTrailerMapPtr = std::unique_ptr<ResponseTrailerMap>;
 
 /**
@@ -82,6 +82,33 @@ public:
                                           int flags, const Address::Ip* self_ip,
                                           const Address::Instance& peer_address) PURE;
 
+  /**
+   * A message to be sent by sendmmsg().
+   */
+  struct SendMsgPacket {
+    // The payload of the message.
+    const Buffer::RawSlice* slices_;
+    uint64_t num_slice_;
+    // The source address whose port should be ignored. Nullptr if the kernel should select the
+    // source address.
+    const Address::Ip* self_ip_;
+    const Address::Instance* peer_address_;
+    // If non-zero, the kernel splits the payload into datagrams of this size with UDP GSO. The last
+    // datagram may be shorter. Must be zero unless supportsUdpGso() returns true.
+    uint64_t gso_size_;
+  };
+
+  /**
+   * If the platform supports, send multiple messages with a single system call.
+   * @param packets points to the messages to send.
+   * @param num_packets indicates the number of messages |packets| contains.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance if the first message
+   * could not be sent, or err_ = nullptr and rc_ = the number of messages sent from the front of
+   * |packets| for success.
+   */
+  virtual Api::IoCallUint64Result sendmmsg(const SendMsgPacket* packets,
+                                           uint64_t num_packets) PURE;
+
   struct RecvMsgPerPacketInfo {
     // The destination address from transport header.
     Address::InstanceConstSharedPtr local_address_;
@@ -89,6 +116,9 @@ public:
     Address::InstanceConstSharedPtr peer_address_;
     // The payload length of this packet.
     unsigned int msg_len_{0};
+    // If non-zero, the payload holds multiple datagrams of this size coalesced by UDP GRO. The last
+    // datagram may be shorter.
+    uint64_t gso_size_{0};
   };
 
   /**
@@ -144,6 +174,12 @@ public:
    * return true if the platform supports recvmmsg() and sendmmsg().
    */
   virtual bool supportsMmsg() const PURE;
+
+  /**
+   * return true if the platform supports segmenting a message into multiple UDP datagrams in
+   * sendmmsg().
+   */
+  virtual bool supportsUdpGso() const PURE;
 };
 
 using IoHandlePtr = std::unique_ptr<IoHandle>;
@@ -294,6 +294,20 @@ public:
    * sender.
    */
   virtual Api::IoCallUint64Result send(const UdpSendData& data) PURE;
+
+  /**
+   * Send a batch of datagrams through the underlying udp socket, with as few system calls as the
+   * platform allows (sendmmsg(), and UDP GSO for runs of equally sized datagrams to the same
+   * peer).
+   *
+   * @param data supplies the datagrams to send.
+   * @param num_data supplies the number of datagrams in data.
+   * @return the result of the underlying send api. rc_ is the number of datagrams sent, in order
+   * from the front of data, and the buffers of those datagrams are drained. If not all datagrams
+   * were sent, err_ is the error which stopped the batch and the remaining datagrams can be
+   * retried by the sender.
+   */
+  virtual Api::IoCallUint64Result sendBatch(const UdpSendData* data, uint64_t num_data) PURE;
 };
 
 using UdpListenerPtr = std::unique_ptr<UdpListener>;
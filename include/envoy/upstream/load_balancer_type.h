@@ -105,6 +105,18 @@ public:
    * elements in a list value defined in endpoint metadata.
    */
   virtual bool listAsAny() const PURE;
+
+  /*
+   * @return bool whether subsets are computed on demand from a bitmap index of the host metadata
+   * instead of being created up front for every combination of metadata values.
+   */
+  virtual bool bitmapIndex() const PURE;
+
+  /*
+   * @return uint32_t the maximum number of subsets kept for recently requested metadata when
+   * the bitmap index is used.
+   */
+  virtual uint32_t bitmapIndexMaxCachedSubsets() const PURE;
 };
 
 } // namespace Upstream
@@ -558,6 +558,7 @@ public:
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_cx_overflow)                                                                    \
   COUNTER(upstream_cx_pool_overflow)                                                               \
+  COUNTER(upstream_cx_prefetch)                                                                    \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
@@ -781,6 +782,12 @@ public:
   virtual const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>&
   lbRingHashConfig() const PURE;
 
+  /**
+   * @return configuration for Maglev load balancing, only used if type is set to maglev_lb.
+   */
+  virtual const absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig>&
+  lbMaglevConfig() const PURE;
+
   /**
    * @return const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& the configuration
    *         for the Original Destination load balancing policy, only used if type is set to
@@ -804,6 +811,19 @@ public:
    */
   virtual uint64_t maxRequestsPerConnection() const PURE;
 
+  /**
+   * @return float the ratio of stream capacity that the HTTP connection pools keep to their pending
+   *         and active streams, by establishing connections ahead of demand. 1.0 indicates that
+   *         connections are only established for streams which cannot be served otherwise.
+   */
+  virtual float perUpstreamPrefetchRatio() const PURE;
+
+  /**
+   * @return uint32_t the minimum number of connections that the HTTP connection pools keep to
+   *         their host. 0 indicates no minimum.
+   */
+  virtual uint32_t minWarmConnections() const PURE;
+
   /**
    * @return uint32_t the maximum number of response headers. The default value is 100. Results in a
    * reset if the number of headers exceeds this value.
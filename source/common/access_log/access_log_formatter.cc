@@ -1,7 +1,9 @@
 #include "common/access_log/access_log_formatter.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
+#include <map>
 #include <regex>
 #include <string>
 #include <vector>
@@ -12,6 +14,7 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
+#include "common/common/json_escape_string.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/grpc/common.h"
@@ -49,6 +52,99 @@ const std::regex& getStartTimeNewlinePattern() {
 }
 const std::regex& getNewlinePattern() { CONSTRUCT_ON_FIRST_USE(std::regex, "\n"); }
 
+// Escapes the part of output starting at start, in place.
+void escapeJsonTail(std::string& output, size_t start) {
+  const auto first = std::find_if(output.begin() + start, output.end(), JsonEscaper::needsEscape);
+  if (first == output.end()) {
+    return;
+  }
+  const size_t escape_start = first - output.begin();
+  const std::string tail = output.substr(escape_start);
+  output.resize(escape_start);
+  JsonEscaper::appendEscaped(tail, output);
+}
+
+void appendJsonString(absl::string_view value, std::string& output) {
+  output.push_back('"');
+  JsonEscaper::appendEscaped(value, output);
+  output.push_back('"');
+}
+
+void appendUInt64(uint64_t value, std::string& output) {
+  const fmt::format_int formatted(value);
+  output.append(formatted.data(), formatted.size());
+}
+
+// Appends the JSON serialization of value, as MessageUtil::getJsonStringFromMessage() would,
+// except that NaN and infinities are written as null rather than as strings.
+void appendJsonValue(const ProtobufWkt::Value& value, std::string& output) {
+  switch (value.kind_case()) {
+  case ProtobufWkt::Value::kNumberValue:
+    JsonEscaper::appendNumber(value.number_value(), output);
+    break;
+  case ProtobufWkt::Value::kStringValue:
+    appendJsonString(value.string_value(), output);
+    break;
+  case ProtobufWkt::Value::kBoolValue:
+    output.append(value.bool_value() ? "true" : "false");
+    break;
+  case ProtobufWkt::Value::kStructValue: {
+    output.push_back('{');
+    bool first = true;
+    for (const auto& field : value.struct_value().fields()) {
+      if (!first) {
+        output.push_back(',');
+      }
+      first = false;
+      appendJsonString(field.first, output);
+      output.push_back(':');
+      appendJsonValue(field.second, output);
+    }
+    output.push_back('}');
+    break;
+  }
+  case ProtobufWkt::Value::kListValue: {
+    output.push_back('[');
+    bool first = true;
+    for (const auto& element : value.list_value().values()) {
+      if (!first) {
+        output.push_back(',');
+      }
+      first = false;
+      appendJsonValue(element, output);
+    }
+    output.push_back(']');
+    break;
+  }
+  default:
+    output.append("null");
+  }
+}
+
+void appendString(absl::string_view value, FormatProgram::Encoding encoding, std::string& output) {
+  switch (encoding) {
+  case FormatProgram::Encoding::Text:
+    output.append(value.data(), value.size());
+    break;
+  case FormatProgram::Encoding::JsonString:
+    JsonEscaper::appendEscaped(value, output);
+    break;
+  case FormatProgram::Encoding::JsonValue:
+    appendJsonString(value, output);
+    break;
+  }
+}
+
+void appendHeader(const HeaderFormatter& formatter, const Http::HeaderMap& headers,
+                  FormatProgram::Encoding encoding, std::string& output) {
+  const absl::optional<absl::string_view> value = formatter.value(headers);
+  if (!value) {
+    output.append(encoding == FormatProgram::Encoding::JsonValue ? "null" : UnspecifiedValueString);
+    return;
+  }
+  appendString(value.value(), encoding, output);
+}
+
 } // namespace
 
 const std::string AccessLogFormatUtils::DEFAULT_FORMAT =
@@ -89,8 +185,104 @@ const std::string AccessLogFormatUtils::getHostname() {
   return hostname;
 }
 
+void FormatProgram::addLiteral(absl::string_view literal) {
+  if (literal.empty()) {
+    return;
+  }
+  if (instructions_.empty() || instructions_.back().opcode_ != Opcode::Literal) {
+    Instruction instruction{Opcode::Literal, Encoding::Text};
+    instruction.literal_offset_ = literals_.size();
+    instructions_.push_back(instruction);
+  }
+  // Literals are appended to the pool in program order, so the last literal ends the pool and can
+  // be extended.
+  instructions_.back().literal_size_ += literal.size();
+  literals_.append(literal.data(), literal.size());
+}
+
+void FormatProgram::addProvider(FormatterProviderPtr&& provider, Encoding encoding) {
+  if (const auto* plain = dynamic_cast<const PlainStringFormatter*>(provider.get())) {
+    std::string literal;
+    appendString(plain->value(), encoding, literal);
+    addLiteral(literal);
+    return;
+  }
+
+  Instruction instruction{Opcode::Provider, encoding};
+  if (const auto* header = dynamic_cast<const RequestHeaderFormatter*>(provider.get())) {
+    instruction.opcode_ = Opcode::RequestHeader;
+    instruction.header_ = header;
+  } else if (const auto* header = dynamic_cast<const ResponseHeaderFormatter*>(provider.get())) {
+    instruction.opcode_ = Opcode::ResponseHeader;
+    instruction.header_ = header;
+  } else if (const auto* header = dynamic_cast<const ResponseTrailerFormatter*>(provider.get())) {
+    instruction.opcode_ = Opcode::ResponseTrailer;
+    instruction.header_ = header;
+  } else if (dynamic_cast<const LocalReplyBodyFormatter*>(provider.get()) != nullptr) {
+    instruction.opcode_ = Opcode::LocalReplyBody;
+  } else if (const auto* field = dynamic_cast<const StreamInfoFormatter*>(provider.get())) {
+    instruction.opcode_ = Opcode::StreamInfoField;
+    instruction.field_extractor_ = &field->fieldExtractor();
+  }
+  instruction.provider_ = provider.get();
+  instructions_.push_back(instruction);
+  providers_.push_back(std::move(provider));
+}
+
+void FormatProgram::format(const Http::RequestHeaderMap& request_headers,
+                           const Http::ResponseHeaderMap& response_headers,
+                           const Http::ResponseTrailerMap& response_trailers,
+                           const StreamInfo::StreamInfo& stream_info,
+                           absl::string_view local_reply_body, std::string& output) const {
+  for (const Instruction& instruction : instructions_) {
+    switch (instruction.opcode_) {
+    case Opcode::Literal:
+      output.append(literals_, instruction.literal_offset_, instruction.literal_size_);
+      break;
+    case Opcode::RequestHeader:
+      appendHeader(*instruction.header_, request_headers, instruction.encoding_, output);
+      break;
+    case Opcode::ResponseHeader:
+      appendHeader(*instruction.header_, response_headers, instruction.encoding_, output);
+      break;
+    case Opcode::ResponseTrailer:
+      appendHeader(*instruction.header_, response_trailers, instruction.encoding_, output);
+      break;
+    case Opcode::LocalReplyBody:
+      appendString(local_reply_body, instruction.encoding_, output);
+      break;
+    case Opcode::StreamInfoField:
+      if (instruction.encoding_ == Encoding::JsonValue) {
+        instruction.field_extractor_->extractJsonTo(stream_info, output);
+      } else {
+        const size_t start = output.size();
+        instruction.field_extractor_->extractTo(stream_info, output);
+        if (instruction.encoding_ == Encoding::JsonString) {
+          escapeJsonTail(output, start);
+        }
+      }
+      break;
+    case Opcode::Provider:
+      if (instruction.encoding_ == Encoding::JsonValue) {
+        appendJsonValue(instruction.provider_->formatValue(request_headers, response_headers,
+                                                           response_trailers, stream_info,
+                                                           local_reply_body),
+                        output);
+      } else {
+        appendString(instruction.provider_->format(request_headers, response_headers,
+                                                   response_trailers, stream_info,
+                                                   local_reply_body),
+                     instruction.encoding_, output);
+      }
+      break;
+    }
+  }
+}
+
 FormatterImpl::FormatterImpl(const std::string& format) {
-  providers_ = AccessLogFormatParser::parse(format);
+  for (FormatterProviderPtr& provider : AccessLogFormatParser::parse(format)) {
+    program_.addProvider(std::move(provider), FormatProgram::Encoding::Text);
+  }
 }
 
 std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
@@ -100,21 +292,37 @@ std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                   absl::string_view local_reply_body) const {
   std::string log_line;
   log_line.reserve(256);
-
-  for (const FormatterProviderPtr& provider : providers_) {
-    log_line += provider->format(request_headers, response_headers, response_trailers, stream_info,
-                                 local_reply_body);
-  }
-
+  program_.format(request_headers, response_headers, response_trailers, stream_info,
+                  local_reply_body, log_line);
   return log_line;
 }
 
 JsonFormatterImpl::JsonFormatterImpl(
-    const absl::flat_hash_map<std::string, std::string>& format_mapping, bool preserve_types)
-    : preserve_types_(preserve_types) {
-  for (const auto& pair : format_mapping) {
-    json_output_format_.emplace(pair.first, AccessLogFormatParser::parse(pair.second));
+    const absl::flat_hash_map<std::string, std::string>& format_mapping, bool preserve_types) {
+  const std::map<std::string, std::string> sorted_mapping(format_mapping.begin(),
+                                                          format_mapping.end());
+  program_.addLiteral("{");
+  bool first = true;
+  for (const auto& pair : sorted_mapping) {
+    std::string key = first ? "" : ",";
+    first = false;
+    appendJsonString(pair.first, key);
+    key.push_back(':');
+    program_.addLiteral(key);
+
+    std::vector<FormatterProviderPtr> providers = AccessLogFormatParser::parse(pair.second);
+    if (preserve_types && providers.size() == 1) {
+      program_.addProvider(std::move(providers.front()), FormatProgram::Encoding::JsonValue);
+      continue;
+    }
+    // Multiple providers forces string output.
+    program_.addLiteral("\"");
+    for (FormatterProviderPtr& provider : providers) {
+      program_.addProvider(std::move(provider), FormatProgram::Encoding::JsonString);
+    }
+    program_.addLiteral("\"");
   }
+  program_.addLiteral("}\n");
 }
 
 std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_headers,
@@ -122,44 +330,11 @@ std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_head
                                       const Http::ResponseTrailerMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info,
                                       absl::string_view local_reply_body) const {
-  const auto output_struct =
-      toStruct(request_headers, response_headers, response_trailers, stream_info, local_reply_body);
-
-  const std::string log_line = MessageUtil::getJsonStringFromMessage(output_struct, false, true);
-  return absl::StrCat(log_line, "\n");
-}
-
-ProtobufWkt::Struct JsonFormatterImpl::toStruct(const Http::RequestHeaderMap& request_headers,
-                                                const Http::ResponseHeaderMap& response_headers,
-                                                const Http::ResponseTrailerMap& response_trailers,
-                                                const StreamInfo::StreamInfo& stream_info,
-                                                absl::string_view local_reply_body) const {
-  ProtobufWkt::Struct output;
-  auto* fields = output.mutable_fields();
-  for (const auto& pair : json_output_format_) {
-    const auto& providers = pair.second;
-    ASSERT(!providers.empty());
-
-    if (providers.size() == 1) {
-      const auto& provider = providers.front();
-      const auto val =
-          preserve_types_ ? provider->formatValue(request_headers, response_headers,
-                                                  response_trailers, stream_info, local_reply_body)
-                          : ValueUtil::stringValue(
-                                provider->format(request_headers, response_headers,
-                                                 response_trailers, stream_info, local_reply_body));
-      (*fields)[pair.first] = val;
-    } else {
-      // Multiple providers forces string output.
-      std::string str;
-      for (const auto& provider : providers) {
-        str += provider->format(request_headers, response_headers, response_trailers, stream_info,
-                                local_reply_body);
-      }
-      (*fields)[pair.first] = ValueUtil::stringValue(str);
-    }
-  }
-  return output;
+  std::string log_line;
+  log_line.reserve(256);
+  program_.format(request_headers, response_headers, response_trailers, stream_info,
+                  local_reply_body, log_line);
+  return log_line;
 }
 
 void AccessLogFormatParser::parseCommandHeader(const std::string& token, const size_t start,
@@ -363,6 +538,10 @@ public:
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::stringValue(field_extractor_(stream_info));
   }
+  void extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                     std::string& output) const override {
+    appendJsonString(field_extractor_(stream_info), output);
+  }
 
 private:
   FieldExtractor field_extractor_;
@@ -392,6 +571,19 @@ public:
 
     return ValueUtil::stringValue(str.value());
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const auto str = field_extractor_(stream_info);
+    output.append(str ? str.value() : UnspecifiedValueString);
+  }
+  void extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                     std::string& output) const override {
+    const auto str = field_extractor_(stream_info);
+    if (!str) {
+      output.append("null");
+      return;
+    }
+    appendJsonString(str.value(), output);
+  }
 
 private:
   FieldExtractor field_extractor_;
@@ -422,6 +614,23 @@ public:
 
     return ValueUtil::numberValue(millis.value());
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const auto millis = extractMillis(stream_info);
+    if (!millis) {
+      output.append(UnspecifiedValueString);
+      return;
+    }
+    appendUInt64(millis.value(), output);
+  }
+  void extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                     std::string& output) const override {
+    const auto millis = extractMillis(stream_info);
+    if (!millis) {
+      output.append("null");
+      return;
+    }
+    appendUInt64(millis.value(), output);
+  }
 
 private:
   absl::optional<uint32_t> extractMillis(const StreamInfo::StreamInfo& stream_info) const {
@@ -449,6 +658,13 @@ public:
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::numberValue(field_extractor_(stream_info));
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    appendUInt64(field_extractor_(stream_info), output);
+  }
+  void extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                     std::string& output) const override {
+    appendUInt64(field_extractor_(stream_info), output);
+  }
 
 private:
   FieldExtractor field_extractor_;
@@ -496,8 +712,38 @@ public:
 
     return ValueUtil::stringValue(toString(*address));
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
+    if (!address) {
+      output.append(UnspecifiedValueString);
+      return;
+    }
+    appendAddress(*address, output);
+  }
+  void extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                     std::string& output) const override {
+    Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
+    if (!address) {
+      output.append("null");
+      return;
+    }
+    output.push_back('"');
+    const size_t start = output.size();
+    appendAddress(*address, output);
+    escapeJsonTail(output, start);
+    output.push_back('"');
+  }
 
 private:
+  void appendAddress(const Network::Address::Instance& address, std::string& output) const {
+    if (extraction_type_ == StreamInfoFormatter::StreamInfoAddressFieldExtractionType::WithPort) {
+      // Avoids copying the cached address string.
+      output.append(address.asString());
+      return;
+    }
+    output.append(toString(address));
+  }
+
   std::string toString(const Network::Address::Instance& address) const {
     switch (extraction_type_) {
     case StreamInfoFormatter::StreamInfoAddressFieldExtractionType::WithoutPort:
@@ -551,6 +797,16 @@ private:
   FieldExtractor field_extractor_;
 };
 
+void StreamInfoFormatter::FieldExtractor::extractTo(const StreamInfo::StreamInfo& stream_info,
+                                                    std::string& output) const {
+  output.append(extract(stream_info));
+}
+
+void StreamInfoFormatter::FieldExtractor::extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                                                        std::string& output) const {
+  appendJsonValue(extractValue(stream_info), output);
+}
+
 StreamInfoFormatter::StreamInfoFormatter(const std::string& field_name) {
   if (field_name == "REQUEST_DURATION") {
     field_extractor_ = std::make_unique<StreamInfoDurationFieldExtractor>(
@@ -831,26 +1087,35 @@ const Http::HeaderEntry* HeaderFormatter::findHeader(const Http::HeaderMap& head
   return header;
 }
 
-std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
+absl::optional<absl::string_view> HeaderFormatter::value(const Http::HeaderMap& headers) const {
   const Http::HeaderEntry* header = findHeader(headers);
   if (!header) {
-    return UnspecifiedValueString;
+    return absl::nullopt;
   }
 
-  std::string val = std::string(header->value().getStringView());
-  truncate(val, max_length_);
+  absl::string_view val = header->value().getStringView();
+  if (max_length_) {
+    val = val.substr(0, max_length_.value());
+  }
   return val;
 }
 
+std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
+  const absl::optional<absl::string_view> val = value(headers);
+  if (!val) {
+    return UnspecifiedValueString;
+  }
+
+  return std::string(val.value());
+}
+
 ProtobufWkt::Value HeaderFormatter::formatValue(const Http::HeaderMap& headers) const {
-  const Http::HeaderEntry* header = findHeader(headers);
-  if (!header) {
+  const absl::optional<absl::string_view> val = value(headers);
+  if (!val) {
     return unspecifiedValue();
   }
 
-  std::string val = std::string(header->value().getStringView());
-  truncate(val, max_length_);
-  return ValueUtil::stringValue(val);
+  return ValueUtil::stringValue(std::string(val.value()));
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -85,46 +85,6 @@ private:
   static const std::string DEFAULT_FORMAT;
 };
 
-/**
- * Composite formatter implementation.
- */
-class FormatterImpl : public Formatter {
-public:
-  FormatterImpl(const std::string& format);
-
-  // Formatter::format
-  std::string format(const Http::RequestHeaderMap& request_headers,
-                     const Http::ResponseHeaderMap& response_headers,
-                     const Http::ResponseTrailerMap& response_trailers,
-                     const StreamInfo::StreamInfo& stream_info,
-                     absl::string_view local_reply_body) const override;
-
-private:
-  std::vector<FormatterProviderPtr> providers_;
-};
-
-class JsonFormatterImpl : public Formatter {
-public:
-  JsonFormatterImpl(const absl::flat_hash_map<std::string, std::string>& format_mapping,
-                    bool preserve_types);
-
-  // Formatter::format
-  std::string format(const Http::RequestHeaderMap& request_headers,
-                     const Http::ResponseHeaderMap& response_headers,
-                     const Http::ResponseTrailerMap& response_trailers,
-                     const StreamInfo::StreamInfo& stream_info,
-                     absl::string_view local_reply_body) const override;
-
-private:
-  const bool preserve_types_;
-  std::map<const std::string, const std::vector<FormatterProviderPtr>> json_output_format_;
-
-  ProtobufWkt::Struct toStruct(const Http::RequestHeaderMap& request_headers,
-                               const Http::ResponseHeaderMap& response_headers,
-                               const Http::ResponseTrailerMap& response_trailers,
-                               const StreamInfo::StreamInfo& stream_info,
-                               absl::string_view local_reply_body) const;
-};
 
 /**
  * FormatterProvider for string literals. It ignores headers and stream info and returns string by
@@ -142,6 +102,8 @@ public:
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
 
+  const std::string& value() const { return str_.string_value(); }
+
 private:
   ProtobufWkt::Value str_;
 };
@@ -167,6 +129,12 @@ public:
   HeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                   absl::optional<size_t> max_length);
 
+  /**
+   * @return the value of the main or else the alternative header, truncated to the max length,
+   *         or absl::nullopt if neither header is present.
+   */
+  absl::optional<absl::string_view> value(const Http::HeaderMap& headers) const;
+
 protected:
   std::string format(const Http::HeaderMap& headers) const;
   ProtobufWkt::Value formatValue(const Http::HeaderMap& headers) const;
@@ -182,7 +150,7 @@ private:
 /**
  * FormatterProvider for request headers.
  */
-class RequestHeaderFormatter : public FormatterProvider, HeaderFormatter {
+class RequestHeaderFormatter : public FormatterProvider, public HeaderFormatter {
 public:
   RequestHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                          absl::optional<size_t> max_length);
@@ -199,7 +167,7 @@ public:
 /**
  * FormatterProvider for response headers.
  */
-class ResponseHeaderFormatter : public FormatterProvider, HeaderFormatter {
+class ResponseHeaderFormatter : public FormatterProvider, public HeaderFormatter {
 public:
   ResponseHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                           absl::optional<size_t> max_length);
@@ -216,7 +184,7 @@ public:
 /**
  * FormatterProvider for response trailers.
  */
-class ResponseTrailerFormatter : public FormatterProvider, HeaderFormatter {
+class ResponseTrailerFormatter : public FormatterProvider, public HeaderFormatter {
 public:
   ResponseTrailerFormatter(const std::string& main_header, const std::string& alternative_header,
                            absl::optional<size_t> max_length);
@@ -268,11 +236,24 @@ public:
 
     virtual std::string extract(const StreamInfo::StreamInfo&) const PURE;
     virtual ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo&) const PURE;
+
+    /**
+     * Appends the value returned by extract() to output.
+     */
+    virtual void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const;
+
+    /**
+     * Appends the JSON serialization of the value returned by extractValue() to output.
+     */
+    virtual void extractJsonTo(const StreamInfo::StreamInfo& stream_info,
+                               std::string& output) const;
   };
   using FieldExtractorPtr = std::unique_ptr<FieldExtractor>;
 
   enum class StreamInfoAddressFieldExtractionType { WithPort, WithoutPort, JustPort };
 
+  const FieldExtractor& fieldExtractor() const { return *field_extractor_; }
+
 private:
   FieldExtractorPtr field_extractor_;
 };
@@ -357,5 +338,108 @@ private:
   const Envoy::DateFormatter date_formatter_;
 };
 
+/**
+ * A parsed format compiled into a flat list of instructions which append their output to a caller
+ * supplied buffer. Adjacent literals are merged, and literals are encoded when the program is
+ * built. Headers, stream info fields and the local reply body are appended in place without
+ * intermediate strings; other commands fall back to their FormatterProvider.
+ */
+class FormatProgram {
+public:
+  enum class Encoding {
+    // Values are appended as returned by FormatterProvider::format().
+    Text,
+    // Values are appended as returned by FormatterProvider::format(), escaped to be placed inside
+    // a JSON string.
+    JsonString,
+    // Values are appended as the JSON serialization of FormatterProvider::formatValue().
+    JsonValue,
+  };
+
+  /**
+   * Adds a literal which is appended to the output as is.
+   */
+  void addLiteral(absl::string_view literal);
+
+  /**
+   * Adds a provider whose value is appended to the output with the given encoding.
+   */
+  void addProvider(FormatterProviderPtr&& provider, Encoding encoding);
+
+  /**
+   * Runs the program, appending its output to output.
+   */
+  void format(const Http::RequestHeaderMap& request_headers,
+              const Http::ResponseHeaderMap& response_headers,
+              const Http::ResponseTrailerMap& response_trailers,
+              const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+              std::string& output) const;
+
+private:
+  enum class Opcode : uint8_t {
+    Literal,
+    RequestHeader,
+    ResponseHeader,
+    ResponseTrailer,
+    LocalReplyBody,
+    StreamInfoField,
+    Provider,
+  };
+
+  struct Instruction {
+    Opcode opcode_;
+    Encoding encoding_;
+    // The position of a literal in literals_.
+    uint32_t literal_offset_{};
+    uint32_t literal_size_{};
+    const HeaderFormatter* header_{};
+    const StreamInfoFormatter::FieldExtractor* field_extractor_{};
+    const FormatterProvider* provider_{};
+  };
+
+  std::vector<Instruction> instructions_;
+  std::string literals_;
+  // Providers referenced by instructions.
+  std::vector<FormatterProviderPtr> providers_;
+};
+
+/**
+ * Composite formatter implementation.
+ */
+class FormatterImpl : public Formatter {
+public:
+  FormatterImpl(const std::string& format);
+
+  // Formatter::format
+  std::string format(const Http::RequestHeaderMap& request_headers,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const Http::ResponseTrailerMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info,
+                     absl::string_view local_reply_body) const override;
+
+private:
+  FormatProgram program_;
+};
+
+/**
+ * Formatter which outputs a JSON object per line. The object is written directly by a single
+ * FormatProgram, with keys in lexicographic order.
+ */
+class JsonFormatterImpl : public Formatter {
+public:
+  JsonFormatterImpl(const absl::flat_hash_map<std::string, std::string>& format_mapping,
+                    bool preserve_types);
+
+  // Formatter::format
+  std::string format(const Http::RequestHeaderMap& request_headers,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const Http::ResponseTrailerMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info,
+                     absl::string_view local_reply_body) const override;
+
+private:
+  FormatProgram program_;
+};
+
 } // namespace AccessLog
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/access_log/access_log_manager_impl.h"
 
+#include <algorithm>
 #include <string>
 
 #include "common/common/assert.h"
@@ -7,9 +8,23 @@
 #include "common/common/lock_guard.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/strip.h"
 
 namespace Envoy {
 namespace AccessLog {
+namespace {
+
+// Turns a file path into a stat name segment, e.g. /var/log/access.log into var_log_access_log.
+std::string fileStatPrefix(absl::string_view path) {
+  return absl::StrCat(
+      "filesystem.file.",
+      absl::StrReplaceAll(absl::StripPrefix(path, "/"), {{"/", "_"}, {".", "_"}, {":", "_"}}),
+      ".");
+}
+
+} // namespace
 
 AccessLogManagerImpl::~AccessLogManagerImpl() {
   for (auto& access_log : access_logs_) {
@@ -41,24 +56,114 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
     return access_log->second;
   }
 
+  if (flusher_ == nullptr) {
+    flusher_ = std::make_shared<AccessLogFlusher>(dispatcher_, api_.threadFactory(),
+                                                  file_flush_interval_msec_, file_stats_);
+  }
   access_logs_[*file_name] = std::make_shared<AccessLogFileImpl>(
-      api_.fileSystem().createFile(*file_name), dispatcher_, lock_, file_stats_,
-      file_flush_interval_msec_, api_.threadFactory());
+      api_.fileSystem().createFile(*file_name), flusher_, lock_, file_stats_, stats_store_,
+      api_.timeSource());
   return access_logs_[*file_name];
 }
 
-AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
-                                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
-                                     std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
-    : file_(std::move(file)), file_lock_(lock),
+AccessLogFlusher::AccessLogFlusher(Event::Dispatcher& dispatcher,
+                                   Thread::ThreadFactory& thread_factory,
+                                   std::chrono::milliseconds flush_interval_msec,
+                                   AccessLogFileStats& stats)
+    : thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        {
+          Thread::LockGuard lock(lock_);
+          flush_all_ = true;
+          flush_event_.notifyOne();
+        }
         flush_timer_->enableTimer(flush_interval_msec_);
-      })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      })) {}
+
+AccessLogFlusher::~AccessLogFlusher() {
+  {
+    Thread::LockGuard lock(lock_);
+    ASSERT(files_.empty());
+    flush_thread_exit_ = true;
+    flush_event_.notifyOne();
+  }
+
+  if (flush_thread_ != nullptr) {
+    flush_thread_->join();
+  }
+}
+
+void AccessLogFlusher::addFile(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  files_.push_back(&file);
+}
+
+void AccessLogFlusher::removeFile(AccessLogFileImpl& file) {
+  Thread::LockGuard pass_lock(pass_lock_);
+  Thread::LockGuard lock(lock_);
+  files_.erase(std::remove(files_.begin(), files_.end(), &file), files_.end());
+  flush_requests_.erase(std::remove(flush_requests_.begin(), flush_requests_.end(), &file),
+                        flush_requests_.end());
+}
+
+void AccessLogFlusher::start() {
+  Thread::LockGuard lock(lock_);
+  if (started_) {
+    return;
+  }
+  started_ = true;
+  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); });
+  flush_timer_->enableTimer(flush_interval_msec_);
+}
+
+void AccessLogFlusher::requestFlush(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  flush_requests_.push_back(&file);
+  flush_event_.notifyOne();
+}
+
+void AccessLogFlusher::flushThreadFunc() {
+  std::vector<AccessLogFileImpl*> files;
+  while (true) {
+    {
+      Thread::LockGuard lock(lock_);
+      // flush_event_ can be woken up either by a file with a large enough flush buffer, or by the
+      // timer, in which case all files are flushed.
+      while (flush_requests_.empty() && !flush_all_ && !flush_thread_exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        flush_event_.wait(lock_);
+      }
+      if (flush_thread_exit_) {
+        return;
+      }
+    }
+
+    // pass_lock_ must be acquired before lock_, so the set of files to flush is only taken once it
+    // is held. Files cannot be removed until the pass completes.
+    Thread::LockGuard pass_lock(pass_lock_);
+    {
+      Thread::LockGuard lock(lock_);
+      files = flush_all_ ? files_ : flush_requests_;
+      flush_all_ = false;
+      flush_requests_.clear();
+    }
+    for (AccessLogFileImpl* file : files) {
+      file->flushFromFlusher();
+    }
+  }
+}
+
+AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, AccessLogFlusherSharedPtr flusher,
+                                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
+                                     Stats::Scope& stats_scope, TimeSource& time_source)
+    : file_(std::move(file)), flusher_(std::move(flusher)), file_lock_(lock), stats_(stats),
+      queue_stats_{ACCESS_LOG_FILE_QUEUE_STATS(
+          POOL_COUNTER_PREFIX(stats_scope, fileStatPrefix(file_->path())),
+          POOL_GAUGE_PREFIX(stats_scope, fileStatPrefix(file_->path())))},
+      time_source_(time_source) {
   open();
+  flusher_->addFile(*this);
 }
 
 Filesystem::FlagSet AccessLogFileImpl::defaultFlags() {
@@ -80,15 +185,7 @@ void AccessLogFileImpl::open() {
 void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  flusher_->removeFile(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
@@ -103,7 +200,15 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 }
 
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
+  const uint64_t length = buffer.length();
+  if (length == 0) {
+    return;
+  }
   Buffer::RawSliceVector slices = buffer.getRawSlices();
+  absl::FixedArray<absl::string_view> data(slices.size());
+  for (size_t i = 0; i < slices.size(); i++) {
+    data[i] = absl::string_view(static_cast<char*>(slices[i].mem_), slices[i].len_);
+  }
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different AccessLogFileImpl pointing to the same underlying file. This can happen either via
@@ -115,62 +220,54 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (const Buffer::RawSlice& slice : slices) {
-      absl::string_view data(static_cast<char*>(slice.mem_), slice.len_);
-      const Api::IoCallSizeResult result = file_->write(data);
-      if (result.ok() && result.rc_ == static_cast<ssize_t>(slice.len_)) {
-        stats_.write_completed_.inc();
-      } else {
-        // Probably disk full.
-        stats_.write_failed_.inc();
-      }
+    const Api::IoCallSizeResult result = file_->writev(data.begin(), data.size());
+    if (result.ok() && result.rc_ == static_cast<ssize_t>(length)) {
+      stats_.write_completed_.inc();
+    } else {
+      // Probably disk full.
+      stats_.write_failed_.inc();
     }
   }
 
-  stats_.write_total_buffered_.sub(buffer.length());
-  buffer.drain(buffer.length());
+  stats_.write_total_buffered_.sub(length);
+  queue_stats_.pending_bytes_.sub(length);
+  buffer.drain(length);
 }
 
-void AccessLogFileImpl::flushThreadFunc() {
-
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
-    {
-      Thread::LockGuard write_lock(write_lock_);
+void AccessLogFileImpl::flushFromFlusher() {
+  std::unique_lock<Thread::BasicLockable> flush_lock;
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
-
-      if (flush_thread_exit_) {
-        return;
-      }
-
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
+  {
+    Thread::LockGuard write_lock(write_lock_);
+    flush_requested_ = false;
+    if (flush_buffer_.length() == 0 && !reopen_file_) {
+      return;
     }
 
-    // if we failed to open file before, then simply ignore
-    if (file_->isOpen()) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          const Api::IoCallBoolResult result = file_->close();
-          ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
-                                         result.err_->getErrorDetails()));
-          open();
-        }
+    flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
+    about_to_write_buffer_.move(flush_buffer_);
+    ASSERT(flush_buffer_.length() == 0);
+  }
 
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
+  // if we failed to open file before, then simply ignore
+  if (file_->isOpen()) {
+    const MonotonicTime start = time_source_.monotonicTime();
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        const Api::IoCallBoolResult result = file_->close();
+        ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                       result.err_->getErrorDetails()));
+        open();
       }
+
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
+    queue_stats_.flush_time_us_.add(
+        std::chrono::duration_cast<std::chrono::microseconds>(time_source_.monotonicTime() - start)
+            .count());
   }
 }
 
@@ -181,7 +278,7 @@ void AccessLogFileImpl::flush() {
     Thread::LockGuard write_lock(write_lock_);
 
     // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
+    // possible that the flush thread has already moved data from
     // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
     // but has not yet completed doWrite(). This would allow flush() to
     // return before the pending data has actually been written to disk.
@@ -201,22 +298,20 @@ void AccessLogFileImpl::flush() {
 void AccessLogFileImpl::write(absl::string_view data) {
   Thread::LockGuard lock(write_lock_);
 
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
-  }
-
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
+  queue_stats_.pending_bytes_.add(data.length());
   flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  // The first write to a file is flushed right away, rather than after the flush interval.
+  if (!written_ || (flush_buffer_.length() > MIN_FLUSH_SIZE && !flush_requested_)) {
+    if (!written_) {
+      written_ = true;
+      flusher_->start();
+    }
+    flush_requested_ = true;
+    flusher_->requestFlush(*this);
   }
 }
 
-void AccessLogFileImpl::createFlushStructures() {
-  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); });
-  flush_timer_->enableTimer(flush_interval_msec_);
-}
-
 } // namespace AccessLog
 } // namespace Envoy
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/filesystem/filesystem.h"
+#include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stats/store.h"
 
@@ -28,17 +32,32 @@ struct AccessLogFileStats {
   ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
 };
 
+/**
+ * Stats kept for each access log file, under filesystem.file.<sanitized path>. These are updated
+ * from the flush thread, which has no thread local storage, so histograms can't be used here.
+ */
+#define ACCESS_LOG_FILE_QUEUE_STATS(COUNTER, GAUGE)                                                \
+  COUNTER(flush_time_us)                                                                           \
+  GAUGE(pending_bytes, Accumulate)
+
+struct AccessLogFileQueueStats {
+  ACCESS_LOG_FILE_QUEUE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 namespace AccessLog {
 
+class AccessLogFlusher;
+using AccessLogFlusherSharedPtr = std::shared_ptr<AccessLogFlusher>;
+
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
   AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
                        Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
       : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{
-                         ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
-                                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
+        lock_(lock), stats_store_(stats_store),
+        file_stats_{ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
+                                          POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
   ~AccessLogManagerImpl() override;
 
   // AccessLog::AccessLogManager
@@ -50,23 +69,79 @@ private:
   Api::Api& api_;
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
+  Stats::Store& stats_store_;
   AccessLogFileStats file_stats_;
+  // Created along with the first file.
+  AccessLogFlusherSharedPtr flusher_;
   std::unordered_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
+class AccessLogFileImpl;
+
+/**
+ * Flushes all access log files of a manager from a single thread, so that the number of threads
+ * doesn't grow with the number of files. Files are flushed when their buffer grows past a
+ * threshold, and all files are flushed when the flush interval elapses. The thread and the timer
+ * are started by the first write to any file.
+ */
+class AccessLogFlusher {
+public:
+  AccessLogFlusher(Event::Dispatcher& dispatcher, Thread::ThreadFactory& thread_factory,
+                   std::chrono::milliseconds flush_interval_msec, AccessLogFileStats& stats);
+  ~AccessLogFlusher();
+
+  void addFile(AccessLogFileImpl& file);
+
+  /**
+   * Unregisters a file. Once this returns the flush thread no longer accesses the file.
+   */
+  void removeFile(AccessLogFileImpl& file);
+
+  /**
+   * Starts the flush thread and the flush timer if they are not running yet.
+   */
+  void start();
+
+  /**
+   * Asks the flush thread to flush a file without waiting for the flush interval.
+   */
+  void requestFlush(AccessLogFileImpl& file);
+
+private:
+  void flushThreadFunc();
+
+  Thread::ThreadFactory& thread_factory_;
+  const std::chrono::milliseconds flush_interval_msec_;
+  AccessLogFileStats& stats_;
+  Event::TimerPtr flush_timer_;
+  Thread::ThreadPtr flush_thread_;
+
+  // These locks are always acquired in the following order if multiple locks are held:
+  //    1) pass_lock_
+  //    2) AccessLogFileImpl::write_lock_
+  //    3) lock_
+  Thread::MutexBasicLockable pass_lock_; // Held by the flush thread while flushing files, so that
+                                         // files are not destroyed while being flushed.
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar flush_event_;
+  std::vector<AccessLogFileImpl*> files_ ABSL_GUARDED_BY(lock_);
+  std::vector<AccessLogFileImpl*> flush_requests_ ABSL_GUARDED_BY(lock_);
+  bool flush_all_ ABSL_GUARDED_BY(lock_){};
+  bool started_ ABSL_GUARDED_BY(lock_){};
+  bool flush_thread_exit_ ABSL_GUARDED_BY(lock_){};
+};
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Data is buffered and written to disk by the AccessLogFlusher's thread, which is shared by all
+ * files of a manager. Each flush writes all the buffered data with a single writev().
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
-  AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
+  AccessLogFileImpl(Filesystem::FilePtr&& file, AccessLogFlusherSharedPtr flusher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
-                    std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    Stats::Scope& stats_scope, TimeSource& time_source);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
@@ -80,11 +155,15 @@ public:
   void reopen() override;
   void flush() override;
 
+  /**
+   * Writes out the buffered data, reopening the file first if requested. Called by the flush
+   * thread.
+   */
+  void flushFromFlusher();
+
 private:
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
   void open();
-  void createFlushStructures();
 
   // return default flags set which used by open
   static Filesystem::FlagSet defaultFlags();
@@ -93,6 +172,7 @@ private:
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
 
   Filesystem::FilePtr file_;
+  const AccessLogFlusherSharedPtr flusher_;
 
   // These locks are always acquired in the following order if multiple locks are held:
   //    1) write_lock_
@@ -111,10 +191,10 @@ private:
       write_lock_; // The lock is used when filling the flush buffer. It allows
                    // multiple threads to write to the same file at relatively
                    // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
   std::atomic<bool> reopen_file_{};
+  bool written_ ABSL_GUARDED_BY(write_lock_){};         // Whether write() has been called.
+  bool flush_requested_ ABSL_GUARDED_BY(write_lock_){}; // Whether a flush has been requested
+                                                        // from the flusher and not yet done.
   Buffer::OwnedImpl
       flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
                                                   // gets filled and then flushed either when max
@@ -127,12 +207,9 @@ private:
                                             // the lock is released so that flush_buffer_ can
                                             // continue to fill. This buffer is then used for the
                                             // final write to disk.
-  Event::TimerPtr flush_timer_;
-  Thread::ThreadFactory& thread_factory_;
-  const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
-                                                        // matter if it reached the MIN_FLUSH_SIZE
-                                                        // or not.
   AccessLogFileStats& stats_;
+  AccessLogFileQueueStats queue_stats_;
+  TimeSource& time_source_;
 };
 
 } // namespace AccessLog
@@ -65,6 +65,20 @@ SysCallIntResult OsSysCallsImpl::recvmmsg(os_fd_t sockfd, struct mmsghdr* msgvec
 #endif
 }
 
+SysCallIntResult OsSysCallsImpl::sendmmsg(os_fd_t sockfd, struct mmsghdr* msgvec, unsigned int vlen,
+                                          int flags) {
+#if ENVOY_MMSG_MORE
+  const int rc = ::sendmmsg(sockfd, msgvec, vlen, flags);
+  return {rc, rc != -1 ? 0 : errno};
+#else
+  UNREFERENCED_PARAMETER(sockfd);
+  UNREFERENCED_PARAMETER(msgvec);
+  UNREFERENCED_PARAMETER(vlen);
+  UNREFERENCED_PARAMETER(flags);
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+#endif
+}
+
 bool OsSysCallsImpl::supportsMmsg() const {
 #if ENVOY_MMSG_MORE
   return true;
@@ -73,6 +87,44 @@ bool OsSysCallsImpl::supportsMmsg() const {
 #endif
 }
 
+#if ENVOY_UDP_GSO_GRO
+namespace {
+
+// The socket options are defined by the C library headers, but only the kernel knows whether it
+// implements them, so probe once on a throwaway socket.
+bool probeUdpSocketOption(int optname) {
+  const int fd = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd == -1) {
+    return false;
+  }
+  int value = 0;
+  socklen_t value_len = sizeof(value);
+  const bool supported = ::getsockopt(fd, IPPROTO_UDP, optname, &value, &value_len) == 0;
+  ::close(fd);
+  return supported;
+}
+
+} // namespace
+#endif
+
+bool OsSysCallsImpl::supportsUdpGso() const {
+#if ENVOY_UDP_GSO_GRO
+  static const bool is_supported = probeUdpSocketOption(UDP_SEGMENT);
+  return is_supported;
+#else
+  return false;
+#endif
+}
+
+bool OsSysCallsImpl::supportsUdpGro() const {
+#if ENVOY_UDP_GSO_GRO
+  static const bool is_supported = probeUdpSocketOption(UDP_GRO);
+  return is_supported;
+#else
+  return false;
+#endif
+}
+
 SysCallIntResult OsSysCallsImpl::ftruncate(int fd, off_t length) {
   const int rc = ::ftruncate(fd, length);
   return {rc, rc != -1 ? 0 : errno};
@@ -0,0 +1,84 @@
+#include "common/common/arena.h"
+
+#include <algorithm>
+#include <new>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+namespace {
+
+constexpr size_t MaxAlignment = alignof(std::max_align_t);
+
+// Rounded up so that the memory following a slab header is maximally aligned.
+constexpr size_t SlabHeaderSize = (sizeof(void*) + MaxAlignment - 1) & ~(MaxAlignment - 1);
+
+// ArenaObject allocations are prefixed with a header recording whether they are heap allocated.
+constexpr size_t ObjectHeaderSize = MaxAlignment;
+
+} // namespace
+
+Arena::Arena(void* initial_buffer, size_t initial_size, size_t slab_size)
+    : current_(static_cast<char*>(initial_buffer)),
+      end_(static_cast<char*>(initial_buffer) + (initial_buffer != nullptr ? initial_size : 0)),
+      next_slab_size_(std::max<size_t>(slab_size, 64)) {
+  ASSERT(reinterpret_cast<uintptr_t>(initial_buffer) % MaxAlignment == 0);
+}
+
+Arena::~Arena() {
+  while (slab_list_ != nullptr) {
+    Slab* next = slab_list_->next_;
+    ::operator delete(slab_list_);
+    slab_list_ = next;
+  }
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+  ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= MaxAlignment);
+  bytes_allocated_ += size;
+  uintptr_t aligned = (reinterpret_cast<uintptr_t>(current_) + alignment - 1) & ~(alignment - 1);
+  if (current_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+    newSlab(size);
+    aligned = reinterpret_cast<uintptr_t>(current_);
+  }
+  current_ = reinterpret_cast<char*>(aligned + size);
+  return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::newSlab(size_t min_size) {
+  const size_t size = std::max(next_slab_size_, min_size);
+  Slab* slab = static_cast<Slab*>(::operator new(SlabHeaderSize + size));
+  slab->next_ = slab_list_;
+  slab_list_ = slab;
+  slabs_++;
+  next_slab_size_ = size * 2;
+  current_ = reinterpret_cast<char*>(slab) + SlabHeaderSize;
+  end_ = current_ + size;
+}
+
+void* ArenaObject::operator new(size_t size, Arena* arena) {
+  char* header;
+  if (arena != nullptr) {
+    header = static_cast<char*>(arena->allocate(ObjectHeaderSize + size));
+    *header = 0;
+  } else {
+    header = static_cast<char*>(::operator new(ObjectHeaderSize + size));
+    *header = 1;
+  }
+  return header + ObjectHeaderSize;
+}
+
+void ArenaObject::operator delete(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  char* header = static_cast<char*>(ptr) - ObjectHeaderSize;
+  if (*header == 1) {
+    ::operator delete(header);
+  }
+}
+
+void ArenaObject::operator delete(void* ptr, Arena*) { operator delete(ptr); }
+
+} // namespace Envoy
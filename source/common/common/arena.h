@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * A monotonic allocator for objects which share a lifetime, e.g. the internals of a single HTTP
+ * stream. Memory is bump allocated from an optional initial buffer and then from heap slabs which
+ * double in size. Memory is never reused: deallocation is a no-op and everything is released in
+ * bulk when the arena is destroyed, so objects placed in the arena must be destroyed before it.
+ * This class is not thread safe.
+ */
+class Arena : NonCopyable {
+public:
+  /**
+   * @param initial_buffer supplies memory to allocate from before any slab is allocated. It must
+   *        be aligned to alignof(std::max_align_t) and outlive the arena. May be nullptr.
+   * @param initial_size supplies the size of initial_buffer.
+   * @param slab_size supplies the minimum size of the first heap slab.
+   */
+  Arena(void* initial_buffer, size_t initial_size, size_t slab_size);
+  ~Arena();
+
+  /**
+   * Allocate memory which remains valid until the arena is destroyed.
+   * @param size supplies the number of bytes to allocate.
+   * @param alignment supplies the required alignment, which must be a power of two no greater
+   *        than alignof(std::max_align_t).
+   */
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @return the number of heap slabs allocated so far.
+   */
+  uint32_t slabs() const { return slabs_; }
+
+  /**
+   * @return the number of bytes handed out by allocate(), excluding alignment padding.
+   */
+  uint64_t bytesAllocated() const { return bytes_allocated_; }
+
+private:
+  struct Slab {
+    Slab* next_;
+  };
+
+  void newSlab(size_t min_size);
+
+  char* current_;
+  char* end_;
+  Slab* slab_list_{};
+  size_t next_slab_size_;
+  uint32_t slabs_{};
+  uint64_t bytes_allocated_{};
+};
+
+/**
+ * An Arena whose initial buffer is stored inline, so that an arena which fits its allocations in
+ * InlineSize bytes costs a single allocation of its own.
+ */
+template <size_t InlineSize> class InlineArena : public Arena {
+public:
+  InlineArena() : Arena(buffer_, InlineSize, InlineSize) {}
+
+private:
+  alignas(std::max_align_t) char buffer_[InlineSize];
+};
+
+/**
+ * STL allocator which allocates from an Arena, or from the heap if it has no arena.
+ */
+template <class T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena = nullptr) : arena_(arena) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ != nullptr) {
+      return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (arena_ == nullptr) {
+      std::allocator<T>().deallocate(ptr, n);
+    }
+  }
+
+  Arena* arena() const { return arena_; }
+
+  template <class U> bool operator==(const ArenaAllocator<U>& rhs) const {
+    return arena_ == rhs.arena();
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U>& rhs) const {
+    return arena_ != rhs.arena();
+  }
+
+private:
+  Arena* arena_;
+};
+
+/**
+ * Base class for objects which may be placed in an Arena with `new (arena) T(...)`, or on the heap
+ * if arena is nullptr. In both cases the object is destroyed with `delete`, which only releases
+ * heap memory, so these objects can be owned by a std::unique_ptr<T> wherever they live. Plain
+ * `new T(...)` does not compile, so that the choice is always explicit.
+ */
+class ArenaObject {
+public:
+  static void* operator new(size_t size, Arena* arena);
+  static void operator delete(void* ptr);
+  // Only called if the constructor of an object placed with new (arena) throws.
+  static void operator delete(void* ptr, Arena* arena);
+};
+
+} // namespace Envoy
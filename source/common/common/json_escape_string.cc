@@ -0,0 +1,60 @@
+#include "common/common/json_escape_string.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "common/common/fmt.h"
+
+namespace Envoy {
+
+void JsonEscaper::appendEscaped(absl::string_view value, std::string& output) {
+  size_t start = 0;
+  for (size_t i = 0; i < value.size(); ++i) {
+    const char c = value[i];
+    if (!needsEscape(c)) {
+      continue;
+    }
+    output.append(value.data() + start, i - start);
+    start = i + 1;
+    switch (c) {
+    case '"':
+      output.append("\\\"");
+      break;
+    case '\\':
+      output.append("\\\\");
+      break;
+    case '\b':
+      output.append("\\b");
+      break;
+    case '\f':
+      output.append("\\f");
+      break;
+    case '\n':
+      output.append("\\n");
+      break;
+    case '\r':
+      output.append("\\r");
+      break;
+    case '\t':
+      output.append("\\t");
+      break;
+    default:
+      fmt::format_to(std::back_inserter(output), "\\u{:04x}", static_cast<unsigned char>(c));
+    }
+  }
+  output.append(value.data() + start, value.size() - start);
+}
+
+void JsonEscaper::appendNumber(double value, std::string& output) {
+  if (!std::isfinite(value)) {
+    output.append("null");
+  } else if (std::trunc(value) == value && std::abs(value) < 9007199254740992.0) {
+    // Integral values which a double represents exactly.
+    const fmt::format_int formatted(static_cast<int64_t>(value));
+    output.append(formatted.data(), formatted.size());
+  } else {
+    fmt::format_to(std::back_inserter(output), "{}", value);
+  }
+}
+
+} // namespace Envoy
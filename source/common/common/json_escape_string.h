@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+
+/**
+ * Helpers for writing JSON directly into a string, without building a document first.
+ */
+class JsonEscaper final {
+public:
+  /**
+   * @param c supplies a character of a string.
+   * @return bool whether c must be escaped within a JSON string.
+   */
+  static bool needsEscape(char c) {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+  }
+
+  /**
+   * Appends a string escaped to be placed inside a quoted JSON string.
+   * @param value supplies the string to escape.
+   * @param output supplies the string to append to.
+   */
+  static void appendEscaped(absl::string_view value, std::string& output);
+
+  /**
+   * Appends a number as a JSON number. Integral values are written without a fraction, and other
+   * values using the shortest representation which round-trips. NaN and infinities, which JSON
+   * can't represent, are written as null.
+   * @param value supplies the number.
+   * @param output supplies the string to append to.
+   */
+  static void appendNumber(double value, std::string& output);
+};
+
+} // namespace Envoy
@@ -8,11 +8,11 @@
 namespace Envoy {
 /**
  * Mixin class that allows an object contained in a unique pointer to be easily linked and unlinked
- * from lists.
+ * from lists. Allocator supplies the allocator of the list.
  */
-template <class T> class LinkedObject {
+template <class T, class Allocator = std::allocator<std::unique_ptr<T>>> class LinkedObject {
 public:
-  using ListType = std::list<std::unique_ptr<T>>;
+  using ListType = std::list<std::unique_ptr<T>, Allocator>;
 
   /**
    * @return the list iterator for the object.
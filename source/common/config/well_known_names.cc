@@ -22,6 +22,10 @@ TagNameValues::TagNameValues() {
   // - Stand-ins for a variable segment of the name (including inside capture groups) will be
   // enclosed in <>.
   // - Typical * notation will be used to denote an arbitrary set of characters.
+  //
+  // Extractions which only depend on whole '.' separated tokens of the name are expressed as token
+  // patterns rather than regexes, which are matched much faster (see TagExtractorTokensImpl). For
+  // each of them the equivalent regex is noted too.
 
   // *_rq(_<response_code>)
   addRegex(RESPONSE_CODE, "_rq(_(\\d{3}))$", "_rq_");
@@ -77,7 +81,8 @@ TagNameValues::TagNameValues() {
   addRegex(SSL_CIPHER_SUITE, R"(^cluster(?=\.).*?\.ssl\.ciphers(\.(.*?))$)", ".ssl.ciphers.");
 
   // cluster.[<route_target_cluster>.]grpc.(<grpc_service>.)*
-  addRegex(GRPC_BRIDGE_SERVICE, R"(^cluster(?=\.).*?\.grpc\.((.*?)\.))", ".grpc.");
+  // Regex: ^cluster(?=\.).*?\.grpc\.((.*?)\.)
+  addTokenized(GRPC_BRIDGE_SERVICE, "cluster.**.grpc.$.*.**");
 
   // tcp.(<stat_prefix>.)<base_stat>
   addRegex(TCP_PREFIX, R"(^tcp\.((.*?)\.)\w+?$)");
@@ -89,23 +94,28 @@ TagNameValues::TagNameValues() {
   addRegex(RATELIMIT_PREFIX, R"(^ratelimit\.((.*?)\.)\w+?$)");
 
   // cluster.(<cluster_name>.)*
-  addRegex(CLUSTER_NAME, "^cluster\\.((.*?)\\.)");
+  // Regex: ^cluster\.((.*?)\.)
+  addTokenized(CLUSTER_NAME, "cluster.$.*.**");
 
   // listener.[<address>.]http.(<stat_prefix>.)*
-  addRegex(HTTP_CONN_MANAGER_PREFIX, R"(^listener(?=\.).*?\.http\.((.*?)\.))", ".http.");
+  // Regex: ^listener(?=\.).*?\.http\.((.*?)\.)
+  addTokenized(HTTP_CONN_MANAGER_PREFIX, "listener.**.http.$.*.**");
 
   // http.(<stat_prefix>.)*
-  addRegex(HTTP_CONN_MANAGER_PREFIX, "^http\\.((.*?)\\.)");
+  // Regex: ^http\.((.*?)\.)
+  addTokenized(HTTP_CONN_MANAGER_PREFIX, "http.$.*.**");
 
   // listener.(<address>.)*
   addRegex(LISTENER_ADDRESS,
            R"(^listener\.(((?:[_.[:digit:]]*|[_\[\]aAbBcCdDeEfF[:digit:]]*))\.))");
 
   // vhost.(<virtual host name>.)*
-  addRegex(VIRTUAL_HOST, "^vhost\\.((.*?)\\.)");
+  // Regex: ^vhost\.((.*?)\.)
+  addTokenized(VIRTUAL_HOST, "vhost.$.*.**");
 
   // mongo.(<stat_prefix>.)*
-  addRegex(MONGO_PREFIX, "^mongo\\.((.*?)\\.)");
+  // Regex: ^mongo\.((.*?)\.)
+  addTokenized(MONGO_PREFIX, "mongo.$.*.**");
 
   // http.[<stat_prefix>.]rds.(<route_config_name>.)<base_stat>
   addRegex(RDS_ROUTE_CONFIG, R"(^http(?=\.).*?\.rds\.((.*?)\.)\w+?$)", ".rds.");
@@ -119,5 +129,9 @@ void TagNameValues::addRegex(const std::string& name, const std::string& regex,
   descriptor_vec_.emplace_back(Descriptor(name, regex, substr));
 }
 
+void TagNameValues::addTokenized(const std::string& name, const std::string& tokens) {
+  descriptor_vec_.emplace_back(Descriptor(name, tokens, "", PatternType::Tokens));
+}
+
 } // namespace Config
 } // namespace Envoy
@@ -57,17 +57,28 @@ public:
   TagNameValues();
 
   /**
-   * Represents a tag extraction. This structure may be extended to
-   * allow for an faster pattern-matching engine to be used as an
-   * alternative to regexes, on an individual tag basis. Some of the
-   * tags, such as "_rq_(\\d)xx$", will probably stay as regexes.
+   * The pattern-matching engine of a tag extraction.
+   */
+  enum class PatternType {
+    // regex_ is a std::regex.
+    Regex,
+    // regex_ is a pattern of '.' separated tokens, matched without regexes. See
+    // Stats::TagExtractorTokensImpl for the syntax.
+    Tokens,
+  };
+
+  /**
+   * Represents a tag extraction. Tags whose extraction only depends on whole '.' separated tokens
+   * of the stat name use the faster token engine. Others, such as "_rq_(\\d)xx$", stay as regexes.
    */
   struct Descriptor {
-    Descriptor(const std::string& name, const std::string& regex, const std::string& substr = "")
-        : name_(name), regex_(regex), substr_(substr) {}
+    Descriptor(const std::string& name, const std::string& regex, const std::string& substr = "",
+               PatternType type = PatternType::Regex)
+        : name_(name), regex_(regex), substr_(substr), type_(type) {}
     const std::string name_;
     const std::string regex_;
     const std::string substr_;
+    const PatternType type_;
   };
 
   // Cluster name tag
@@ -129,6 +140,7 @@ public:
 
 private:
   void addRegex(const std::string& name, const std::string& regex, const std::string& substr = "");
+  void addTokenized(const std::string& name, const std::string& tokens);
 
   // Collection of tag descriptors.
   std::vector<Descriptor> descriptor_vec_;
@@ -11,7 +11,6 @@
 #include "envoy/network/listener.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/libevent_scheduler.h"
@@ -159,6 +158,15 @@ TimerPtr DispatcherImpl::createTimer(TimerCb cb) {
   return createTimerInternal(cb);
 }
 
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb, std::chrono::milliseconds granularity) {
+  ASSERT(isThreadSafe());
+  std::unique_ptr<TimerWheel>& wheel = timer_wheels_[granularity];
+  if (wheel == nullptr) {
+    wheel = std::make_unique<TimerWheel>(*this, granularity);
+  }
+  return wheel->createTimer(cb);
+}
+
 TimerPtr DispatcherImpl::createTimerInternal(TimerCb cb) {
   return scheduler_->createTimer(cb, *this);
 }
@@ -180,14 +188,8 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
-
-  if (do_post) {
+  // Only the first post after the post callbacks started running enables the timer.
+  if (post_callbacks_.push(std::move(callback))) {
     post_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 }
@@ -214,21 +216,16 @@ void DispatcherImpl::updateApproximateMonotonicTimeInternal() {
 }
 
 void DispatcherImpl::runPostCallbacks() {
+  // Callbacks posted from now on enable the timer again, in case they are not popped below.
+  post_callbacks_.acknowledgeWakeup();
   while (true) {
     // It is important that this declaration is inside the body of the loop so that the callback is
-    // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
-    // for each iteration, the previous iteration's callback is destructed when callback is
-    // re-assigned, which happens while holding the lock. This can lead to a deadlock (via
-    // recursive mutex acquisition) if destroying the callback runs a destructor, which through some
+    // destructed before the next one is popped. The overflow list of the queue is popped while
+    // holding its lock, and destroying the callback may run a destructor which through some
     // callstack calls post() on this dispatcher.
     std::function<void()> callback;
-    {
-      Thread::LockGuard lock(post_lock_);
-      if (post_callbacks_.empty()) {
-        return;
-      }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
+    if (!post_callbacks_.pop(callback)) {
+      return;
     }
     callback();
   }
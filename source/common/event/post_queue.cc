@@ -0,0 +1,90 @@
+#include "common/event/post_queue.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Event {
+
+PostQueue::PostQueue(uint32_t capacity) : mask_(capacity - 1), cells_(new Cell[capacity]) {
+  ASSERT(capacity > 0 && (capacity & mask_) == 0);
+  for (uint64_t i = 0; i < capacity; ++i) {
+    cells_[i].sequence_.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool PostQueue::push(std::function<void()> callback) {
+  if (overflowing_.load(std::memory_order_acquire) || !tryPushRing(callback)) {
+    Thread::LockGuard lock(overflow_lock_);
+    overflowing_.store(true, std::memory_order_release);
+    overflow_.push_back(std::move(callback));
+    overflow_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // The exchange orders the push before the consumer's acknowledgeWakeup(), if that reads true.
+  return !wakeup_pending_.exchange(true);
+}
+
+bool PostQueue::pop(std::function<void()>& callback) {
+  if (tryPopRing(callback)) {
+    return true;
+  }
+  if (!overflowing_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  Thread::LockGuard lock(overflow_lock_);
+  // The ring may have been filled since it was found empty, and its callbacks precede those of the
+  // overflow list. If the next one is still being filled, its producer wakes up the consumer.
+  if (push_position_.load(std::memory_order_acquire) != pop_position_) {
+    return tryPopRing(callback);
+  }
+  if (overflow_.empty()) {
+    overflowing_.store(false, std::memory_order_release);
+    return false;
+  }
+  callback = std::move(overflow_.front());
+  overflow_.pop_front();
+  return true;
+}
+
+bool PostQueue::tryPushRing(std::function<void()>& callback) {
+  uint64_t position = push_position_.load(std::memory_order_relaxed);
+  while (true) {
+    Cell& cell = cells_[position & mask_];
+    const uint64_t sequence = cell.sequence_.load(std::memory_order_acquire);
+    const int64_t difference = static_cast<int64_t>(sequence - position);
+    if (difference == 0) {
+      // The cell is free for this position; claim the position.
+      if (push_position_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+        cell.callback_ = std::move(callback);
+        cell.sequence_.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (difference < 0) {
+      // The cell still holds the callback pushed one lap earlier: the ring is full.
+      return false;
+    } else {
+      // Another producer claimed the position.
+      position = push_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool PostQueue::tryPopRing(std::function<void()>& callback) {
+  Cell& cell = cells_[pop_position_ & mask_];
+  if (cell.sequence_.load(std::memory_order_acquire) != pop_position_ + 1) {
+    // The ring is empty, or the producer of the next position has not filled its cell yet. That
+    // producer's push() wakes up the consumer again.
+    return false;
+  }
+  callback = std::move(cell.callback_);
+  // Destroy anything left of the moved callback before the cell is reused.
+  cell.callback_ = nullptr;
+  cell.sequence_.store(pop_position_ + mask_ + 1, std::memory_order_release);
+  ++pop_position_;
+  return true;
+}
+
+} // namespace Event
+} // namespace Envoy
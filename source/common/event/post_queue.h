@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * The queue of callbacks posted to a dispatcher by any thread and run by the dispatcher's thread.
+ * Callbacks are moved into the preallocated cells of a bounded ring with a single compare and swap
+ * (Vyukov's bounded queue), so that a post neither allocates a list node nor acquires a lock. Only
+ * when the ring is full are callbacks appended to a mutex guarded overflow list, until the consumer
+ * has drained it. Callbacks pushed by one thread are popped in the order in which they were pushed.
+ *
+ * push() reports whether the consumer needs to be woken up, which is only the case for the first
+ * push after the consumer called acknowledgeWakeup(), so that a burst of posts wakes up the
+ * dispatcher once.
+ */
+class PostQueue : NonCopyable {
+public:
+  static constexpr uint32_t DefaultCapacity = 1024;
+
+  /**
+   * @param capacity supplies the number of cells of the ring, which must be a power of two.
+   */
+  explicit PostQueue(uint32_t capacity = DefaultCapacity);
+
+  /**
+   * Pushes a callback. May be called by any thread.
+   * @return true if the consumer must be woken up to pop the callback.
+   */
+  bool push(std::function<void()> callback);
+
+  /**
+   * Acknowledges a wake up, before popping the callbacks. Callbacks pushed after this call wake up
+   * the consumer again. Must only be called by the consumer.
+   */
+  void acknowledgeWakeup() { wakeup_pending_.exchange(false); }
+
+  /**
+   * Pops the next callback. Must only be called by the consumer.
+   * @return true if a callback was popped into callback, false if the queue is empty.
+   */
+  bool pop(std::function<void()>& callback);
+
+  /**
+   * @return the number of callbacks which were pushed into the overflow list as the ring was full.
+   */
+  uint64_t overflowCount() const { return overflow_count_.load(std::memory_order_relaxed); }
+
+private:
+  struct Cell {
+    // The position of the push which may fill this cell, or that position plus one once the cell
+    // is filled and until it is popped.
+    std::atomic<uint64_t> sequence_;
+    std::function<void()> callback_;
+  };
+
+  bool tryPushRing(std::function<void()>& callback);
+  bool tryPopRing(std::function<void()>& callback);
+
+  const uint64_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+  // Producers and the consumer update their positions on separate cache lines.
+  alignas(64) std::atomic<uint64_t> push_position_{0};
+  alignas(64) uint64_t pop_position_{0};
+  std::atomic<bool> wakeup_pending_{false};
+  // Set while the overflow list may hold callbacks, so that they are not overtaken by callbacks
+  // pushed into the ring by the same thread.
+  std::atomic<bool> overflowing_{false};
+  std::atomic<uint64_t> overflow_count_{0};
+  Thread::MutexBasicLockable overflow_lock_;
+  std::list<std::function<void()>> overflow_ ABSL_GUARDED_BY(overflow_lock_);
+};
+
+} // namespace Event
+} // namespace Envoy
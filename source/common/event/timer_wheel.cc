@@ -0,0 +1,230 @@
+#include "common/event/timer_wheel.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/scope_tracker.h"
+
+namespace Envoy {
+namespace Event {
+
+class TimerWheel::WheelTimer : public Timer, public Node {
+public:
+  WheelTimer(TimerWheel& wheel, const TimerCb& cb) : wheel_(wheel), cb_(cb) { ASSERT(cb_); }
+  ~WheelTimer() override { disableTimer(); }
+
+  // Timer
+  void disableTimer() override {
+    if (!linked()) {
+      return;
+    }
+    unlink();
+    wheel_.onUnlinked(*this);
+  }
+  void enableTimer(const std::chrono::milliseconds& ms,
+                   const ScopeTrackedObject* object = nullptr) override {
+    wheel_.enable(*this, ms, object);
+  }
+  void enableHRTimer(const std::chrono::microseconds& us,
+                     const ScopeTrackedObject* object = nullptr) override {
+    wheel_.enable(*this, us, object);
+  }
+  bool enabled() override { return linked(); }
+
+  void fire() {
+    if (object_ == nullptr) {
+      cb_();
+      return;
+    }
+    ScopeTrackerScopeState scope(object_, wheel_.dispatcher_);
+    object_ = nullptr;
+    cb_();
+  }
+
+  TimerWheel& wheel_;
+  const TimerCb cb_;
+  const ScopeTrackedObject* object_{};
+  // The tick the timer expires in.
+  uint64_t expiry_{};
+  bool first_level_{};
+};
+
+void TimerWheel::Node::unlink() {
+  prev_->next_ = next_;
+  next_->prev_ = prev_;
+  prev_ = next_ = this;
+}
+
+void TimerWheel::Node::linkBefore(Node& sentinel) {
+  ASSERT(!linked());
+  prev_ = sentinel.prev_;
+  next_ = &sentinel;
+  prev_->next_ = this;
+  sentinel.prev_ = this;
+}
+
+void TimerWheel::Node::moveTo(Node& to) {
+  ASSERT(!to.linked());
+  if (!linked()) {
+    return;
+  }
+  to.next_ = next_;
+  to.prev_ = prev_;
+  next_->prev_ = &to;
+  prev_->next_ = &to;
+  prev_ = next_ = this;
+}
+
+TimerWheel::TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds granularity)
+    : dispatcher_(dispatcher), granularity_(granularity),
+      start_(dispatcher.timeSource().monotonicTime()),
+      tick_timer_(dispatcher.createTimer([this]() -> void { onTick(); })) {
+  ASSERT(granularity_.count() > 0);
+}
+
+TimerWheel::~TimerWheel() { ASSERT(size_ == 0); }
+
+TimerPtr TimerWheel::createTimer(const TimerCb& cb) {
+  return std::make_unique<WheelTimer>(*this, cb);
+}
+
+void TimerWheel::enable(WheelTimer& timer, MonotonicTime::duration duration,
+                        const ScopeTrackedObject* object) {
+  timer.disableTimer();
+  if (size_ == 0) {
+    // Nothing is armed, so the wheel was not advanced while idle.
+    current_tick_ = std::max(current_tick_, currentTimeTick());
+  }
+
+  // Round the deadline up so that the timer never fires early.
+  const auto deadline = dispatcher_.timeSource().monotonicTime() - start_ + duration;
+  const uint64_t expiry = (deadline + granularity_ - MonotonicTime::duration(1)) / granularity_;
+  timer.expiry_ = std::max(expiry, current_tick_ + 1);
+  timer.object_ = object;
+  insert(timer);
+
+  if (advancing_) {
+    // onTick() schedules the next tick once the wheel has caught up.
+    return;
+  }
+  if (!tick_timer_->enabled()) {
+    scheduleTick(nextTick());
+  } else if (timer.first_level_ && timer.expiry_ < scheduled_tick_) {
+    scheduleTick(timer.expiry_);
+  }
+}
+
+void TimerWheel::insert(WheelTimer& timer) {
+  ++size_;
+  const uint64_t delta = timer.expiry_ - current_tick_;
+  if (delta <= FirstLevelMask) {
+    timer.first_level_ = true;
+    ++first_level_size_;
+    timer.linkBefore(first_level_[timer.expiry_ & FirstLevelMask]);
+    return;
+  }
+
+  timer.first_level_ = false;
+  // Timers beyond the span of the wheel are parked in the furthest slot and re-inserted from there.
+  const uint64_t expiry = current_tick_ + std::min(delta, (uint64_t(1) << MaxTickBits) - 1);
+  uint32_t level = 1;
+  while (level < UpperLevels && (expiry - current_tick_) >> levelShift(level + 1) != 0) {
+    ++level;
+  }
+  timer.linkBefore(upper_levels_[level - 1][(expiry >> levelShift(level)) & LevelMask]);
+}
+
+void TimerWheel::onUnlinked(WheelTimer& timer) {
+  ASSERT(size_ > 0);
+  --size_;
+  if (timer.first_level_) {
+    --first_level_size_;
+  }
+}
+
+void TimerWheel::cascade(Node& slot) {
+  Node pending;
+  slot.moveTo(pending);
+  while (pending.linked()) {
+    WheelTimer& timer = static_cast<WheelTimer&>(*pending.next_);
+    timer.unlink();
+    onUnlinked(timer);
+    insert(timer);
+  }
+}
+
+void TimerWheel::expire(Node& slot) {
+  // Timers armed or disarmed by callbacks are unaffected by the rest of the slot being processed.
+  Node pending;
+  slot.moveTo(pending);
+  while (pending.linked()) {
+    WheelTimer& timer = static_cast<WheelTimer&>(*pending.next_);
+    timer.unlink();
+    onUnlinked(timer);
+    if (timer.expiry_ > current_tick_) {
+      insert(timer);
+      continue;
+    }
+    timer.fire();
+  }
+}
+
+void TimerWheel::advance(uint64_t tick) {
+  while (current_tick_ < tick) {
+    if (first_level_size_ == 0) {
+      // Nothing can fire before the next cascade, so skip straight to it.
+      current_tick_ = std::min(tick, current_tick_ | FirstLevelMask);
+      if (current_tick_ == tick) {
+        break;
+      }
+    }
+    const uint64_t now = ++current_tick_;
+    // Cascade from the top so that timers moving down more than one level are picked up by the
+    // lower levels' cascades in the same tick.
+    for (uint32_t level = UpperLevels; level > 0; --level) {
+      if ((now & ((uint64_t(1) << levelShift(level)) - 1)) == 0) {
+        cascade(upper_levels_[level - 1][(now >> levelShift(level)) & LevelMask]);
+      }
+    }
+    expire(first_level_[now & FirstLevelMask]);
+  }
+}
+
+void TimerWheel::onTick() {
+  advancing_ = true;
+  advance(currentTimeTick());
+  advancing_ = false;
+  if (size_ > 0) {
+    scheduleTick(nextTick());
+  } else {
+    tick_timer_->disableTimer();
+  }
+}
+
+uint64_t TimerWheel::currentTimeTick() const {
+  return (dispatcher_.timeSource().monotonicTime() - start_) / granularity_;
+}
+
+uint64_t TimerWheel::nextTick() const {
+  // Upper level slots are only cascaded on multiples of the first level's span.
+  const uint64_t cascade_tick = (current_tick_ | FirstLevelMask) + 1;
+  if (first_level_size_ > 0) {
+    for (uint64_t tick = current_tick_ + 1; tick < cascade_tick; ++tick) {
+      if (first_level_[tick & FirstLevelMask].linked()) {
+        return tick;
+      }
+    }
+  }
+  return cascade_tick;
+}
+
+void TimerWheel::scheduleTick(uint64_t tick) {
+  scheduled_tick_ = tick;
+  const auto delay = start_ + granularity_ * static_cast<int64_t>(tick) -
+                     dispatcher_.timeSource().monotonicTime();
+  tick_timer_->enableTimer(
+      std::max(std::chrono::ceil<std::chrono::milliseconds>(delay), std::chrono::milliseconds(0)));
+}
+
+} // namespace Event
+} // namespace Envoy
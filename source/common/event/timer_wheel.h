@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * A hashed hierarchical timer wheel (Varghese and Lauck, "Hashed and Hierarchical Timing Wheels").
+ * Timers created by the wheel are armed, re-armed and disarmed in O(1), and are all driven by a
+ * single dispatcher timer which advances the wheel in ticks of the configured granularity. A timer
+ * fires in the first tick at or after its deadline, so up to one granularity late. This suits large
+ * numbers of coarse, frequently re-armed timeouts; timers needing precise deadlines should use
+ * Dispatcher::createTimer().
+ *
+ * The wheel must only be used from the thread of its dispatcher and must outlive its timers.
+ */
+class TimerWheel : NonCopyable {
+public:
+  TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds granularity);
+  ~TimerWheel();
+
+  /**
+   * Creates a timer driven by this wheel.
+   */
+  TimerPtr createTimer(const TimerCb& cb);
+
+  /**
+   * @return the number of armed timers.
+   */
+  uint64_t size() const { return size_; }
+
+  std::chrono::milliseconds granularity() const { return granularity_; }
+
+private:
+  class WheelTimer;
+
+  // Links of an intrusive circular doubly linked list. Each slot is the sentinel of a list.
+  struct Node {
+    Node() = default;
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+    bool linked() const { return next_ != this; }
+    void unlink();
+    void linkBefore(Node& sentinel);
+    // Moves all the nodes of this list to the empty list whose sentinel is to.
+    void moveTo(Node& to);
+
+    Node* prev_{this};
+    Node* next_{this};
+  };
+
+  // The first level has 2^8 slots of one tick and each of the others 2^6 slots of 2^6 times the
+  // span of a slot in the level below, so the wheel spans 2^26 ticks. Timers further away are
+  // placed in the last slot they can reach and moved on when it is cascaded.
+  static constexpr uint32_t FirstLevelBits = 8;
+  static constexpr uint32_t LevelBits = 6;
+  static constexpr uint32_t UpperLevels = 3;
+  static constexpr uint32_t MaxTickBits = FirstLevelBits + UpperLevels * LevelBits;
+  static constexpr uint64_t FirstLevelMask = (1 << FirstLevelBits) - 1;
+  static constexpr uint64_t LevelMask = (1 << LevelBits) - 1;
+
+  static constexpr uint32_t levelShift(uint32_t level) {
+    return FirstLevelBits + (level - 1) * LevelBits;
+  }
+
+  void enable(WheelTimer& timer, MonotonicTime::duration duration,
+              const ScopeTrackedObject* object);
+  void insert(WheelTimer& timer);
+  void onUnlinked(WheelTimer& timer);
+  void cascade(Node& slot);
+  void expire(Node& slot);
+  void advance(uint64_t tick);
+  void onTick();
+  uint64_t currentTimeTick() const;
+  uint64_t nextTick() const;
+  void scheduleTick(uint64_t tick);
+
+  Dispatcher& dispatcher_;
+  const std::chrono::milliseconds granularity_;
+  const MonotonicTime start_;
+  const TimerPtr tick_timer_;
+  std::array<Node, 1 << FirstLevelBits> first_level_;
+  std::array<std::array<Node, 1 << LevelBits>, UpperLevels> upper_levels_;
+  // The last tick processed.
+  uint64_t current_tick_{};
+  // The tick tick_timer_ is armed for, if enabled.
+  uint64_t scheduled_tick_{};
+  uint64_t size_{};
+  // Timers on the first level, which are the only ones that can expire before the next cascade.
+  uint64_t first_level_size_{};
+  bool advancing_{};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -23,6 +23,12 @@ Api::IoCallSizeResult FileSharedImpl::write(absl::string_view buffer) {
   return rc != -1 ? resultSuccess<ssize_t>(rc) : resultFailure<ssize_t>(rc, errno);
 };
 
+Api::IoCallSizeResult FileSharedImpl::writev(const absl::string_view* buffers,
+                                             uint64_t num_buffers) {
+  const ssize_t rc = writevFile(buffers, num_buffers);
+  return rc != -1 ? resultSuccess<ssize_t>(rc) : resultFailure<ssize_t>(rc, errno);
+}
+
 Api::IoCallBoolResult FileSharedImpl::close() {
   ASSERT(isOpen());
 
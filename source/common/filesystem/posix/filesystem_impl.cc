@@ -1,8 +1,11 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -16,6 +19,7 @@
 #include "common/common/logger.h"
 #include "common/filesystem/filesystem_impl.h"
 
+#include "absl/container/fixed_array.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 
@@ -38,6 +42,31 @@ ssize_t FileImplPosix::writeFile(absl::string_view buffer) {
   return ::write(fd_, buffer.data(), buffer.size());
 }
 
+ssize_t FileImplPosix::writevFile(const absl::string_view* buffers, uint64_t num_buffers) {
+  ssize_t written = 0;
+  while (num_buffers > 0) {
+    const uint64_t num_iov = std::min<uint64_t>(num_buffers, IOV_MAX);
+    absl::FixedArray<iovec> iov(num_iov);
+    uint64_t size = 0;
+    for (uint64_t i = 0; i < num_iov; i++) {
+      iov[i].iov_base = const_cast<char*>(buffers[i].data());
+      iov[i].iov_len = buffers[i].size();
+      size += buffers[i].size();
+    }
+    const ssize_t rc = ::writev(fd_, iov.begin(), num_iov);
+    if (rc == -1) {
+      return written > 0 ? written : -1;
+    }
+    written += rc;
+    if (static_cast<uint64_t>(rc) < size) {
+      break;
+    }
+    buffers += num_iov;
+    num_buffers -= num_iov;
+  }
+  return written;
+}
+
 FileImplPosix::FlagsAndMode FileImplPosix::translateFlag(FlagSet in) {
   int out = 0;
   mode_t mode = 0;
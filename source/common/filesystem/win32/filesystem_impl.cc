@@ -34,6 +34,21 @@ ssize_t FileImplWin32::writeFile(absl::string_view buffer) {
   return ::_write(fd_, buffer.data(), buffer.size());
 }
 
+ssize_t FileImplWin32::writevFile(const absl::string_view* buffers, uint64_t num_buffers) {
+  ssize_t written = 0;
+  for (uint64_t i = 0; i < num_buffers; i++) {
+    const ssize_t rc = writeFile(buffers[i]);
+    if (rc == -1) {
+      return written > 0 ? written : -1;
+    }
+    written += rc;
+    if (static_cast<size_t>(rc) < buffers[i].size()) {
+      break;
+    }
+  }
+  return written;
+}
+
 FileImplWin32::FlagsAndMode FileImplWin32::translateFlag(FlagSet in) {
   int out = 0;
   int pmode = 0;
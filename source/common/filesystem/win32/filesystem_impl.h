@@ -23,6 +23,7 @@ protected:
   FlagsAndMode translateFlag(FlagSet in);
   void openFile(FlagSet in) override;
   ssize_t writeFile(absl::string_view buffer) override;
+  ssize_t writevFile(const absl::string_view* buffers, uint64_t num_buffers) override;
   bool closeFile() override;
 
 private:
@@ -441,6 +441,11 @@ public:
    * @return LocalReply configuration which supplies mapping for local reply generated by Envoy.
    */
   virtual const LocalReply::LocalReply& localReply() const PURE;
+
+  /**
+   * @return whether stream internals should be allocated from a per stream arena.
+   */
+  virtual bool perStreamArena() const PURE;
 };
 } // namespace Http
 } // namespace Envoy
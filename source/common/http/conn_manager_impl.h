@@ -30,6 +30,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/buffer/watermark_buffer.h"
+#include "common/common/arena.h"
 #include "common/common/dump_state_utils.h"
 #include "common/common/linked_object.h"
 #include "common/grpc/common.h"
@@ -108,10 +109,14 @@ public:
 private:
   struct ActiveStream;
 
+  // Sized to fit the filter wrappers and list nodes of a typical filter chain without growing.
+  using StreamArena = InlineArena<2048>;
+
   /**
-   * Base class wrapper for both stream encoder and decoder filters.
+   * Base class wrapper for both stream encoder and decoder filters. Wrappers are placed in the
+   * stream's arena when it has one.
    */
-  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks {
+  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks, public ArenaObject {
     ActiveStreamFilterBase(ActiveStream& parent, bool dual_filter)
         : parent_(parent), iteration_state_(IterationState::Continue),
           iterate_from_current_filter_(false), headers_continued_(false),
@@ -222,7 +227,9 @@ private:
    */
   struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
                                      public StreamDecoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamDecoderFilter> {
+                                     LinkedObject<ActiveStreamDecoderFilter,
+                                                  ArenaAllocator<std::unique_ptr<
+                                                      ActiveStreamDecoderFilter>>> {
     ActiveStreamDecoderFilter(ActiveStream& parent, StreamDecoderFilterSharedPtr filter,
                               bool dual_filter)
         : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
@@ -336,13 +343,16 @@ private:
   };
 
   using ActiveStreamDecoderFilterPtr = std::unique_ptr<ActiveStreamDecoderFilter>;
+  using ActiveStreamDecoderFilterList = ActiveStreamDecoderFilter::ListType;
 
   /**
    * Wrapper for a stream encoder filter.
    */
   struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
                                      public StreamEncoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamEncoderFilter> {
+                                     LinkedObject<ActiveStreamEncoderFilter,
+                                                  ArenaAllocator<std::unique_ptr<
+                                                      ActiveStreamEncoderFilter>>> {
     ActiveStreamEncoderFilter(ActiveStream& parent, StreamEncoderFilterSharedPtr filter,
                               bool dual_filter)
         : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
@@ -412,12 +422,13 @@ private:
   };
 
   using ActiveStreamEncoderFilterPtr = std::unique_ptr<ActiveStreamEncoderFilter>;
+  using ActiveStreamEncoderFilterList = ActiveStreamEncoderFilter::ListType;
 
   // Used to abstract making of RouteConfig update request.
   // RdsRouteConfigUpdateRequester is used when an RdsRouteConfigProvider is configured,
   // NullRouteConfigUpdateRequester is used in all other cases (specifically when
   // ScopedRdsConfigProvider/InlineScopedRoutesConfigProvider is configured)
-  class RouteConfigUpdateRequester {
+  class RouteConfigUpdateRequester : public ArenaObject {
   public:
     virtual ~RouteConfigUpdateRequester() = default;
     virtual void requestRouteConfigUpdate(const std::string, Event::Dispatcher&,
@@ -464,11 +475,11 @@ private:
     void addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr filter, bool dual_filter);
     void chargeStats(const ResponseHeaderMap& headers);
     // Returns the encoder filter to start iteration with.
-    std::list<ActiveStreamEncoderFilterPtr>::iterator
+    ActiveStreamEncoderFilterList::iterator
     commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream,
                        FilterIterationStartState filter_iteration_start_state);
     // Returns the decoder filter to start iteration with.
-    std::list<ActiveStreamDecoderFilterPtr>::iterator
+    ActiveStreamDecoderFilterList::iterator
     commonDecodePrefix(ActiveStreamDecoderFilter* filter,
                        FilterIterationStartState filter_iteration_start_state);
     const Network::Connection* connection();
@@ -478,7 +489,7 @@ private:
     // Helper function for the case where we have a header only request, but a filter adds a body
     // to it.
     void maybeContinueDecoding(
-        const std::list<ActiveStreamDecoderFilterPtr>::iterator& maybe_continue_data_entry);
+        const ActiveStreamDecoderFilterList::iterator& maybe_continue_data_entry);
     void decodeHeaders(ActiveStreamDecoderFilter* filter, RequestHeaderMap& headers,
                        bool end_stream);
     // Sends data through decoding filter chains. filter_iteration_start_state indicates which
@@ -501,7 +512,7 @@ private:
     // filters before calling encodeHeadersInternal which does final header munging and passes the
     // headers to the encoder.
     void maybeContinueEncoding(
-        const std::list<ActiveStreamEncoderFilterPtr>::iterator& maybe_continue_data_entry);
+        const ActiveStreamEncoderFilterList::iterator& maybe_continue_data_entry);
     void encodeHeaders(ActiveStreamEncoderFilter* filter, ResponseHeaderMap& headers,
                        bool end_stream);
     // Sends data through encoding filter chains. filter_iteration_start_state indicates which
@@ -704,6 +715,10 @@ private:
     }
 
     ConnectionManagerImpl& connection_manager_;
+    // Backs the filter wrappers, the lists holding them and other internals which live exactly as
+    // long as the stream, if per_stream_arena is enabled. It is declared before its users so that
+    // it is destroyed after them.
+    std::unique_ptr<StreamArena> arena_;
     Router::ConfigConstSharedPtr snapped_route_config_;
     Router::ScopedConfigConstSharedPtr snapped_scoped_routes_config_;
     Tracing::SpanPtr active_span_;
@@ -716,9 +731,10 @@ private:
     RequestHeaderMapPtr request_headers_;
     Buffer::WatermarkBufferPtr buffered_request_data_;
     RequestTrailerMapPtr request_trailers_;
-    std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
-    std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
-    std::list<AccessLog::InstanceSharedPtr> access_log_handlers_;
+    ActiveStreamDecoderFilterList decoder_filters_;
+    ActiveStreamEncoderFilterList encoder_filters_;
+    std::list<AccessLog::InstanceSharedPtr, ArenaAllocator<AccessLog::InstanceSharedPtr>>
+        access_log_handlers_;
     Stats::TimespanPtr request_response_timespan_;
     // Per-stream idle timeout.
     Event::TimerPtr stream_idle_timer_;
@@ -775,6 +791,11 @@ private:
 
   enum class DrainState { NotDraining, Draining, Closing };
 
+  // Granularity of the coarse timers used for the idle, request and stream duration timeouts.
+  // The stream idle timer is re-armed on every frame, and the other timers are created for every
+  // stream, so these timeouts use the dispatcher's timer wheels and may fire up to this late.
+  static constexpr std::chrono::milliseconds TimeoutGranularity{10};
+
   ConnectionManagerConfig& config_;
   ConnectionManagerStats& stats_; // We store a reference here to avoid an extra stats() call on the
                                   // config in the hot path.
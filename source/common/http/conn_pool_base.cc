@@ -18,6 +18,7 @@ ConnPoolImplBase::~ConnPoolImplBase() {
 }
 
 void ConnPoolImplBase::destructAllConnections() {
+  destroying_ = true;
   for (auto* list : {&ready_clients_, &busy_clients_}) {
     while (!list->empty()) {
       list->front()->close();
@@ -28,30 +29,70 @@ void ConnPoolImplBase::destructAllConnections() {
   dispatcher_.clearDeferredDeleteList();
 }
 
-void ConnPoolImplBase::tryCreateNewConnection() {
-  if (pending_requests_.size() <= connecting_request_capacity_) {
-    // There are already enough CONNECTING connections for the number
-    // of queued requests.
-    return;
+bool ConnPoolImplBase::shouldCreateNewConnection() const {
+  if (pending_requests_.size() > connecting_request_capacity_) {
+    // There are not enough CONNECTING connections for the number of queued requests.
+    return true;
+  }
+
+  // Connections are only created ahead of demand for a healthy host, not while the pool is being
+  // drained or destroyed, and not after a failed connect until a connection is established.
+  if (destroying_ || !drained_callbacks_.empty() || connect_failed_ ||
+      host_->health() != Upstream::Host::Health::Healthy) {
+    return false;
+  }
+
+  // DRAINING connections count towards the floor, as they are closed once their requests complete.
+  if (ready_clients_.size() + busy_clients_.size() < host_->cluster().minWarmConnections()) {
+    return true;
   }
 
+  // Keep enough CONNECTING and connected capacity for the pending and active requests scaled by
+  // the prefetch ratio, so that a burst of requests does not wait for new connections.
+  const float prefetch_ratio = host_->cluster().perUpstreamPrefetchRatio();
+  return prefetch_ratio > 1.0 &&
+         (pending_requests_.size() + num_active_requests_) * prefetch_ratio >
+             connecting_request_capacity_ + active_request_capacity_;
+}
+
+bool ConnPoolImplBase::tryCreateNewConnection() {
+  // Whether the pending requests need the connection, as opposed to it being created ahead of
+  // demand.
+  const bool needed = pending_requests_.size() > connecting_request_capacity_;
   const bool can_create_connection =
       host_->cluster().resourceManager(priority_).connections().canCreate();
-  if (!can_create_connection) {
+  if (!can_create_connection && needed) {
     host_->cluster().stats().upstream_cx_overflow_.inc();
   }
   // If we are at the connection circuit-breaker limit due to other upstreams having
   // too many open connections, and this upstream has no connections, always create one, to
   // prevent pending requests being queued to this upstream with no way to be processed.
-  if (can_create_connection || (ready_clients_.empty() && busy_clients_.empty())) {
-    ENVOY_LOG(debug, "creating a new connection");
+  if (can_create_connection || (needed && ready_clients_.empty() && busy_clients_.empty())) {
+    if (needed) {
+      ENVOY_LOG(debug, "creating a new connection");
+    } else {
+      ENVOY_LOG(debug, "creating a new connection ahead of demand");
+      host_->cluster().stats().upstream_cx_prefetch_.inc();
+    }
     ActiveClientPtr client = instantiateActiveClient();
     ASSERT(client->state_ == ActiveClient::State::CONNECTING);
     ASSERT(std::numeric_limits<uint64_t>::max() - connecting_request_capacity_ >=
            client->effectiveConcurrentRequestLimit());
     connecting_request_capacity_ += client->effectiveConcurrentRequestLimit();
     client->moveIntoList(std::move(client), owningList(client->state_));
+    return true;
   }
+  return false;
+}
+
+bool ConnPoolImplBase::tryCreateNewConnections() {
+  // Every connection created adds to the CONNECTING capacity and to the number of connections, so
+  // this stops once there are enough connections or the circuit breaker is reached.
+  bool created = false;
+  while (shouldCreateNewConnection() && tryCreateNewConnection()) {
+    created = true;
+  }
+  return created;
 }
 
 void ConnPoolImplBase::attachRequestToClient(ActiveClient& client,
@@ -68,7 +109,9 @@ void ConnPoolImplBase::attachRequestToClient(ActiveClient& client,
     ENVOY_CONN_LOG(debug, "creating stream", *client.codec_client_);
     RequestEncoder& new_encoder = client.newStreamEncoder(response_decoder);
 
+    const uint64_t capacity = client.effectiveConcurrentRequestLimit();
     client.remaining_requests_--;
+    active_request_capacity_ -= capacity - client.effectiveConcurrentRequestLimit();
     if (client.remaining_requests_ == 0) {
       ENVOY_CONN_LOG(debug, "maximum requests per connection, DRAINING", *client.codec_client_);
       host_->cluster().stats().upstream_cx_max_requests_.inc();
@@ -117,6 +160,8 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStream(ResponseDecoder& respon
     ActiveClient& client = *ready_clients_.front();
     ENVOY_CONN_LOG(debug, "using existing connection", *client.codec_client_);
     attachRequestToClient(client, response_decoder, callbacks);
+    // Replenish the spare capacity this request used, if prefetching.
+    tryCreateNewConnections();
     return nullptr;
   }
 
@@ -125,7 +170,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStream(ResponseDecoder& respon
 
     // This must come after newPendingRequest() because this function uses the
     // length of pending_requests_ to determine if a new connection is needed.
-    tryCreateNewConnection();
+    tryCreateNewConnections();
 
     return pending;
   } else {
@@ -152,6 +197,13 @@ bool ConnPoolImplBase::hasActiveConnections() const {
   return (!pending_requests_.empty() || (num_active_requests_ > 0));
 }
 
+bool ConnPoolImplBase::maybePrefetch() {
+  // The caller asks again on events such as host set updates, which gives a host that failed to
+  // connect another chance without reconnecting in a loop.
+  connect_failed_ = false;
+  return tryCreateNewConnections();
+}
+
 std::list<ConnPoolImplBase::ActiveClientPtr>&
 ConnPoolImplBase::owningList(ActiveClient::State state) {
   switch (state) {
@@ -173,6 +225,12 @@ void ConnPoolImplBase::transitionActiveClientState(ActiveClient& client,
                                                    ActiveClient::State new_state) {
   auto& old_list = owningList(client.state_);
   auto& new_list = owningList(new_state);
+  if (hasActiveCapacity(client.state_) && !hasActiveCapacity(new_state)) {
+    ASSERT(active_request_capacity_ >= client.effectiveConcurrentRequestLimit());
+    active_request_capacity_ -= client.effectiveConcurrentRequestLimit();
+  } else if (!hasActiveCapacity(client.state_) && hasActiveCapacity(new_state)) {
+    active_request_capacity_ += client.effectiveConcurrentRequestLimit();
+  }
   client.state_ = new_state;
 
   // old_list and new_list can be equal when transitioning from BUSY to DRAINING.
@@ -273,6 +331,7 @@ void ConnPoolImplBase::onConnectionEvent(ConnPoolImplBase::ActiveClient& client,
     if (client.state_ == ActiveClient::State::CONNECTING) {
       host_->cluster().stats().upstream_cx_connect_fail_.inc();
       host_->stats().cx_connect_fail_.inc();
+      connect_failed_ = true;
 
       ConnectionPool::PoolFailureReason reason;
       if (client.timed_out_) {
@@ -304,18 +363,22 @@ void ConnPoolImplBase::onConnectionEvent(ConnPoolImplBase::ActiveClient& client,
       checkForDrained();
     }
 
+    if (hasActiveCapacity(client.state_)) {
+      ASSERT(active_request_capacity_ >= client.effectiveConcurrentRequestLimit());
+      active_request_capacity_ -= client.effectiveConcurrentRequestLimit();
+    }
     client.state_ = ActiveClient::State::CLOSED;
 
-    // If we have pending requests and we just lost a connection we should make a new one.
-    if (!pending_requests_.empty()) {
-      tryCreateNewConnection();
-    }
+    // If we have pending requests, or are keeping connections ahead of demand, and we just lost a
+    // connection we should make a new one.
+    tryCreateNewConnections();
   } else if (event == Network::ConnectionEvent::Connected) {
     client.conn_connect_ms_->complete();
     client.conn_connect_ms_.reset();
 
     ASSERT(client.state_ == ActiveClient::State::CONNECTING);
     transitionActiveClientState(client, ActiveClient::State::READY);
+    connect_failed_ = false;
 
     onUpstreamReady();
     checkForDrained();
@@ -22,6 +22,7 @@ public:
                                          ConnectionPool::Callbacks& callbacks) override;
   void addDrainedCallback(DrainedCb cb) override;
   bool hasActiveConnections() const override;
+  bool maybePrefetch() override;
   void drainConnections() override;
   Upstream::HostDescriptionConstSharedPtr host() const override { return host_; };
 
@@ -145,9 +146,23 @@ protected:
   void attachRequestToClient(ActiveClient& client, ResponseDecoder& response_decoder,
                              ConnectionPool::Callbacks& callbacks);
 
+  // Returns whether a connection should be created, either because the pending requests cannot be
+  // served by the connecting connections, or to keep the warm connection floor and the prefetch
+  // ratio of the cluster.
+  bool shouldCreateNewConnection() const;
+
   // Creates a new connection if allowed by resourceManager, or if created to avoid
-  // starving this pool.
-  void tryCreateNewConnection();
+  // starving this pool. Returns whether a connection was created.
+  bool tryCreateNewConnection();
+
+  // Creates connections for as long as shouldCreateNewConnection() and resourceManager allow.
+  // Returns whether any connection was created.
+  bool tryCreateNewConnections();
+
+  // Whether the capacity of a client in the given state is counted in active_request_capacity_.
+  static bool hasActiveCapacity(ActiveClient::State state) {
+    return state == ActiveClient::State::READY || state == ActiveClient::State::BUSY;
+  }
 
 public:
   const Upstream::HostConstSharedPtr host_;
@@ -179,6 +194,18 @@ protected:
   // The number of requests that can be immediately dispatched
   // if all CONNECTING connections become connected.
   uint64_t connecting_request_capacity_{0};
+
+  // The number of requests that READY and BUSY connections can serve, including the requests
+  // attached to them.
+  uint64_t active_request_capacity_{0};
+
+  // Whether the last connection to finish connecting failed. While set, connections are only
+  // created for pending requests, so that a host which refuses connections isn't reconnected to in
+  // a loop to keep the warm connection floor or the prefetch ratio.
+  bool connect_failed_{false};
+
+  // Set when destroying the pool, so that closed connections are not replaced ahead of demand.
+  bool destroying_{false};
 };
 } // namespace Http
 } // namespace Envoy
@@ -192,30 +192,41 @@ void HeaderMapImpl::HeaderEntryImpl::value(const HeaderEntry& header) {
   value(header.value().getStringView());
 }
 
-#define INLINE_HEADER_STATIC_MAP_ENTRY(name)                                                       \
-  add(Headers::get().name.get().c_str(), [](HeaderMapType& h) -> StaticLookupResponse {            \
-    return {&h.inline_headers_.name##_, &Headers::get().name};                                     \
-  });
+template <class T> void HeaderMapImpl::StaticLookupTable<T>::finalizeTable() {
+  CustomInlineHeaderRegistry::finalize<T::header_map_type>();
+  const auto& headers = CustomInlineHeaderRegistry::headers<T::header_map_type>();
+  RELEASE_ASSERT(headers.size() <= T::InlineHeadersCapacity,
+                 "too many custom inline headers registered");
+  for (const auto& header : headers) {
+    addEntry(header.first.get(), header.second, header.first);
+  }
+}
+
+template <class T>
+void HeaderMapImpl::StaticLookupTable<T>::addEntry(absl::string_view key, size_t index,
+                                                   const LowerCaseString& canonical_key) {
+  entries_.push_back({index, &canonical_key});
+  add(key, &entries_.back());
+}
 
 template <> HeaderMapImpl::StaticLookupTable<RequestHeaderMapImpl>::StaticLookupTable() {
-  INLINE_REQ_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
-  INLINE_REQ_RESP_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
+  finalizeTable();
 
   // Special case where we map a legacy host header to :authority.
-  add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapType& h) -> StaticLookupResponse {
-    return {&h.inline_headers_.Host_, &Headers::get().Host};
-  });
+  addEntry(Headers::get().HostLegacy.get(), handles_.Host.index(), handles_.Host.key());
+}
+
+template <> HeaderMapImpl::StaticLookupTable<RequestTrailerMapImpl>::StaticLookupTable() {
+  finalizeTable();
 }
 
 template <> HeaderMapImpl::StaticLookupTable<ResponseHeaderMapImpl>::StaticLookupTable() {
-  INLINE_RESP_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
-  INLINE_REQ_RESP_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
-  INLINE_RESP_HEADERS_TRAILERS(INLINE_HEADER_STATIC_MAP_ENTRY)
+  finalizeTable();
 }
 
-template <>
-HeaderMapImpl::StaticLookupTable<ResponseTrailerMapImpl>::StaticLookupTable(){
-    INLINE_RESP_HEADERS_TRAILERS(INLINE_HEADER_STATIC_MAP_ENTRY)}
+template <> HeaderMapImpl::StaticLookupTable<ResponseTrailerMapImpl>::StaticLookupTable() {
+  finalizeTable();
+}
 
 uint64_t HeaderMapImpl::appendToHeader(HeaderString& header, absl::string_view data,
                                        absl::string_view delimiter) {
@@ -11,6 +11,7 @@
 #include "common/common/non_copyable.h"
 #include "common/common/utility.h"
 #include "common/http/headers.h"
+#include "common/singleton/const_singleton.h"
 
 namespace Envoy {
 namespace Http {
@@ -21,30 +22,24 @@ namespace Http {
  */
 #define DEFINE_INLINE_HEADER_FUNCS(name)                                                           \
 public:                                                                                            \
-  const HeaderEntry* name() const override { return inline_headers_.name##_; }                     \
+  const HeaderEntry* name() const override { return getInlineEntry(headerHandles().name); }        \
   void append##name(absl::string_view data, absl::string_view delimiter) override {                \
-    HeaderEntry& entry = maybeCreateInline(&inline_headers_.name##_, Headers::get().name);         \
-    addSize(HeaderMapImpl::appendToHeader(entry.value(), data, delimiter));                        \
+    appendInlineEntry(headerHandles().name, data, delimiter);                                      \
   }                                                                                                \
   void setReference##name(absl::string_view value) override {                                      \
-    HeaderEntry& entry = maybeCreateInline(&inline_headers_.name##_, Headers::get().name);         \
-    updateSize(entry.value().size(), value.size());                                                \
-    entry.value().setReference(value);                                                             \
+    setReferenceInlineEntry(headerHandles().name, value);                                          \
   }                                                                                                \
   void set##name(absl::string_view value) override {                                               \
-    HeaderEntry& entry = maybeCreateInline(&inline_headers_.name##_, Headers::get().name);         \
-    updateSize(entry.value().size(), value.size());                                                \
-    entry.value().setCopy(value);                                                                  \
+    setInlineEntry(headerHandles().name, value);                                                   \
   }                                                                                                \
-  void set##name(uint64_t value) override {                                                        \
-    HeaderEntry& entry = maybeCreateInline(&inline_headers_.name##_, Headers::get().name);         \
-    subtractSize(inline_headers_.name##_->value().size());                                         \
-    entry.value().setInteger(value);                                                               \
-    addSize(inline_headers_.name##_->value().size());                                              \
-  }                                                                                                \
-  size_t remove##name() override { return removeInline(&inline_headers_.name##_); }
+  void set##name(uint64_t value) override { setInlineEntry(headerHandles().name, value); }         \
+  size_t remove##name() override { return removeInlineEntry(headerHandles().name); }
+
+#define DEFINE_INLINE_HEADER_HANDLE(name)                                                          \
+  const Handle name{                                                                               \
+      CustomInlineHeaderRegistry::registerInlineHeader<header_map_type>(Headers::get().name)};
 
-#define DEFINE_INLINE_HEADER_STRUCT(name) HeaderEntryImpl* name##_;
+#define COUNT_INLINE_HEADER(name) +1
 
 /**
  * Implementation of Http::HeaderMap. This is heavily optimized for performance. Roughly, when
@@ -120,23 +115,36 @@ protected:
     const LowerCaseString* key_;
   };
 
+  struct StaticLookupEntry {
+    size_t index_;
+    const LowerCaseString* key_;
+  };
+
   /**
-   * Base class for a static lookup table that converts a string key into an O(1) header.
+   * Base class for a static lookup table that converts a string key into an O(1) header. Building
+   * the table registers the built in inline headers of T and finalizes the registry for T, so
+   * every header registered via CustomInlineHeaderRegistry is found here.
    */
-  template <class T>
-  struct StaticLookupTable : public TrieLookupTable<StaticLookupResponse (*)(T&)> {
-    using HeaderMapType = T;
-
+  template <class T> struct StaticLookupTable : public TrieLookupTable<const StaticLookupEntry*> {
     StaticLookupTable();
 
     static absl::optional<StaticLookupResponse> lookup(T& header_map, absl::string_view key) {
-      auto entry = ConstSingleton<StaticLookupTable>::get().find(key);
+      const StaticLookupEntry* entry = ConstSingleton<StaticLookupTable>::get().find(key);
       if (entry != nullptr) {
-        return entry(header_map);
+        return StaticLookupResponse{&header_map.inline_headers_[entry->index_], entry->key_};
       } else {
         return absl::nullopt;
       }
     }
+
+    void finalizeTable();
+    void addEntry(absl::string_view key, size_t index, const LowerCaseString& canonical_key);
+
+    // Handles of the built in inline headers. These are registered before the registry is
+    // finalized in the constructor.
+    const typename T::HeaderHandleValues handles_{};
+    // A list so that entry addresses, which are stored in the trie, are stable.
+    std::list<StaticLookupEntry> entries_;
   };
 
   /**
@@ -232,94 +240,147 @@ protected:
   uint64_t cached_byte_size_ = 0;
 };
 
+/**
+ * Base class for the typed header maps below. Inline headers, both built in and registered via
+ * CustomInlineHeaderRegistry, are stored in a single array indexed by the registered slot. Up to
+ * MaxCustomInlineHeaders headers may be registered in addition to the built in ones.
+ */
+template <class Interface, size_t BuiltinInlineHeaders>
+class TypedHeaderMapImpl : public HeaderMapImpl, public Interface {
+public:
+  using Handle = typename Interface::Handle;
+
+  static constexpr size_t MaxCustomInlineHeaders = 16;
+  static constexpr size_t InlineHeadersCapacity = BuiltinInlineHeaders + MaxCustomInlineHeaders;
+
+  // Http::CustomInlineHeaderBase
+  const HeaderEntry* getInline(Handle handle) const override { return getInlineEntry(handle); }
+  void appendInline(Handle handle, absl::string_view data, absl::string_view delimiter) override {
+    appendInlineEntry(handle, data, delimiter);
+  }
+  void setReferenceInline(Handle handle, absl::string_view value) override {
+    setReferenceInlineEntry(handle, value);
+  }
+  void setInline(Handle handle, absl::string_view value) override { setInlineEntry(handle, value); }
+  void setInline(Handle handle, uint64_t value) override { setInlineEntry(handle, value); }
+  size_t removeInline(Handle handle) override { return removeInlineEntry(handle); }
+
+protected:
+  // Non-virtual implementations shared by the custom and built in inline header accessors.
+  const HeaderEntry* getInlineEntry(Handle handle) const { return inline_headers_[handle.index()]; }
+  void appendInlineEntry(Handle handle, absl::string_view data, absl::string_view delimiter) {
+    HeaderEntry& entry = maybeCreateInline(&inline_headers_[handle.index()], handle.key());
+    addSize(HeaderMapImpl::appendToHeader(entry.value(), data, delimiter));
+  }
+  void setReferenceInlineEntry(Handle handle, absl::string_view value) {
+    HeaderEntry& entry = maybeCreateInline(&inline_headers_[handle.index()], handle.key());
+    updateSize(entry.value().size(), value.size());
+    entry.value().setReference(value);
+  }
+  void setInlineEntry(Handle handle, absl::string_view value) {
+    HeaderEntry& entry = maybeCreateInline(&inline_headers_[handle.index()], handle.key());
+    updateSize(entry.value().size(), value.size());
+    entry.value().setCopy(value);
+  }
+  void setInlineEntry(Handle handle, uint64_t value) {
+    HeaderEntry& entry = maybeCreateInline(&inline_headers_[handle.index()], handle.key());
+    subtractSize(entry.value().size());
+    entry.value().setInteger(value);
+    addSize(entry.value().size());
+  }
+  size_t removeInlineEntry(Handle handle) {
+    return HeaderMapImpl::removeInline(&inline_headers_[handle.index()]);
+  }
+
+  void clearInline() override { inline_headers_.fill(nullptr); }
+
+  std::array<HeaderEntryImpl*, InlineHeadersCapacity> inline_headers_{};
+
+  friend class HeaderMapImpl;
+};
+
+// The number of built in O(1) headers of each typed header map.
+constexpr size_t BuiltinRequestHeaders =
+    0 INLINE_REQ_HEADERS(COUNT_INLINE_HEADER) INLINE_REQ_RESP_HEADERS(COUNT_INLINE_HEADER);
+constexpr size_t BuiltinRequestTrailers = 0;
+constexpr size_t BuiltinResponseHeaders = 0 INLINE_RESP_HEADERS(COUNT_INLINE_HEADER)
+    INLINE_REQ_RESP_HEADERS(COUNT_INLINE_HEADER) INLINE_RESP_HEADERS_TRAILERS(COUNT_INLINE_HEADER);
+constexpr size_t BuiltinResponseTrailers = 0 INLINE_RESP_HEADERS_TRAILERS(COUNT_INLINE_HEADER);
+
 /**
  * Typed derived classes for all header map types.
  */
-class RequestHeaderMapImpl : public HeaderMapImpl, public RequestHeaderMap {
+class RequestHeaderMapImpl : public TypedHeaderMapImpl<RequestHeaderMap, BuiltinRequestHeaders> {
 public:
   INLINE_REQ_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
   INLINE_REQ_RESP_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
 
 protected:
-  // Explicit inline headers for the request header map.
-  // TODO(mattklein123): This is mostly copied between all of the concrete header map types.
-  // In a future change we can either get rid of O(1) headers completely, or it should be possible
-  // to statically register all O(1) headers and move to a single dynamically sized class where we
-  // we reference the O(1) headers in the table by an offset.
-  struct AllInlineHeaders {
-    AllInlineHeaders() { clear(); }
-    void clear() { memset(this, 0, sizeof(*this)); }
-
-    INLINE_REQ_HEADERS(DEFINE_INLINE_HEADER_STRUCT)
-    INLINE_REQ_RESP_HEADERS(DEFINE_INLINE_HEADER_STRUCT)
+  struct HeaderHandleValues {
+    INLINE_REQ_HEADERS(DEFINE_INLINE_HEADER_HANDLE)
+    INLINE_REQ_RESP_HEADERS(DEFINE_INLINE_HEADER_HANDLE)
   };
 
+  static const HeaderHandleValues& headerHandles() {
+    return ConstSingleton<StaticLookupTable<RequestHeaderMapImpl>>::get().handles_;
+  }
   absl::optional<StaticLookupResponse> staticLookup(absl::string_view key) override {
     return StaticLookupTable<RequestHeaderMapImpl>::lookup(*this, key);
   }
-  void clearInline() override { inline_headers_.clear(); }
-
-  AllInlineHeaders inline_headers_;
 
   friend class HeaderMapImpl;
 };
 
-class RequestTrailerMapImpl : public HeaderMapImpl, public RequestTrailerMap {};
+class RequestTrailerMapImpl : public TypedHeaderMapImpl<RequestTrailerMap, BuiltinRequestTrailers> {
+protected:
+  struct HeaderHandleValues {};
 
-class ResponseHeaderMapImpl : public HeaderMapImpl, public ResponseHeaderMap {
+  absl::optional<StaticLookupResponse> staticLookup(absl::string_view key) override {
+    return StaticLookupTable<RequestTrailerMapImpl>::lookup(*this, key);
+  }
+
+  friend class HeaderMapImpl;
+};
+
+class ResponseHeaderMapImpl : public TypedHeaderMapImpl<ResponseHeaderMap, BuiltinResponseHeaders> {
 public:
   INLINE_RESP_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
   INLINE_REQ_RESP_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
   INLINE_RESP_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_FUNCS)
 
 protected:
-  // Explicit inline headers for the response header map.
-  // TODO(mattklein123): This is mostly copied between all of the concrete header map types.
-  // In a future change we can either get rid of O(1) headers completely, or it should be possible
-  // to statically register all O(1) headers and move to a single dynamically sized class where we
-  // we reference the O(1) headers in the table by an offset.
-  struct AllInlineHeaders {
-    AllInlineHeaders() { clear(); }
-    void clear() { memset(this, 0, sizeof(*this)); }
-
-    INLINE_RESP_HEADERS(DEFINE_INLINE_HEADER_STRUCT)
-    INLINE_REQ_RESP_HEADERS(DEFINE_INLINE_HEADER_STRUCT)
-    INLINE_RESP_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_STRUCT)
+  struct HeaderHandleValues {
+    INLINE_RESP_HEADERS(DEFINE_INLINE_HEADER_HANDLE)
+    INLINE_REQ_RESP_HEADERS(DEFINE_INLINE_HEADER_HANDLE)
+    INLINE_RESP_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_HANDLE)
   };
 
+  static const HeaderHandleValues& headerHandles() {
+    return ConstSingleton<StaticLookupTable<ResponseHeaderMapImpl>>::get().handles_;
+  }
   absl::optional<StaticLookupResponse> staticLookup(absl::string_view key) override {
     return StaticLookupTable<ResponseHeaderMapImpl>::lookup(*this, key);
   }
-  void clearInline() override { inline_headers_.clear(); }
-
-  AllInlineHeaders inline_headers_;
 
   friend class HeaderMapImpl;
 };
 
-class ResponseTrailerMapImpl : public HeaderMapImpl, public ResponseTrailerMap {
+class ResponseTrailerMapImpl
+    : public TypedHeaderMapImpl<ResponseTrailerMap, BuiltinResponseTrailers> {
 public:
   INLINE_RESP_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_FUNCS)
 
 protected:
-  // Explicit inline headers for the response trailer map.
-  // TODO(mattklein123): This is mostly copied between all of the concrete header map types.
-  // In a future change we can either get rid of O(1) headers completely, or it should be possible
-  // to statically register all O(1) headers and move to a single dynamically sized class where we
-  // reference the O(1) headers in the table by an offset.
-  struct AllInlineHeaders {
-    AllInlineHeaders() { clear(); }
-    void clear() { memset(this, 0, sizeof(*this)); }
-
-    INLINE_RESP_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_STRUCT)
+  struct HeaderHandleValues {
+    INLINE_RESP_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_HANDLE)
   };
 
+  static const HeaderHandleValues& headerHandles() {
+    return ConstSingleton<StaticLookupTable<ResponseTrailerMapImpl>>::get().handles_;
+  }
   absl::optional<StaticLookupResponse> staticLookup(absl::string_view key) override {
     return StaticLookupTable<ResponseTrailerMapImpl>::lookup(*this, key);
   }
-  void clearInline() override { inline_headers_.clear(); }
-
-  AllInlineHeaders inline_headers_;
 
   friend class HeaderMapImpl;
 };
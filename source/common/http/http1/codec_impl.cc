@@ -15,6 +15,7 @@
 #include "common/http/header_utility.h"
 #include "common/http/headers.h"
 #include "common/http/http1/header_formatter.h"
+#include "common/http/http1/header_scanner.h"
 #include "common/http/utility.h"
 #include "common/runtime/runtime_features.h"
 
@@ -595,7 +596,7 @@ void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
   absl::string_view header_value{data, length};
 
   if (strict_header_validation_) {
-    if (!Http::HeaderUtility::headerValueIsValid(header_value)) {
+    if (!HeaderScanner::valueIsValid(header_value)) {
       ENVOY_CONN_LOG(debug, "invalid header value: {}", connection_, header_value);
       error_code_ = Http::Code::BadRequest;
       sendProtocolError(Http1ResponseCodeDetails::get().InvalidCharacters);
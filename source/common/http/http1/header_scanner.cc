@@ -0,0 +1,59 @@
+#include "common/http/http1/header_scanner.h"
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+bool validValueChar(uint8_t c) { return c == '\t' || (c >= 0x20 && c != 0x7f); }
+
+} // namespace
+
+bool HeaderScanner::valueIsValidScalar(absl::string_view value) {
+  for (const char c : value) {
+    if (!validValueChar(static_cast<uint8_t>(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#if defined(__SSE2__)
+
+bool HeaderScanner::valueIsValid(absl::string_view value) {
+  const char* data = value.data();
+  const size_t size = value.size();
+  const __m128i max_control = _mm_set1_epi8(0x1f);
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= size; i += sizeof(__m128i)) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    // Unsigned chunk <= 0x1f, since SSE2 only has signed byte comparisons.
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk);
+    const __m128i invalid =
+        _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(chunk, tab), control),
+                     _mm_cmpeq_epi8(chunk, del));
+    if (_mm_movemask_epi8(invalid) != 0) {
+      return false;
+    }
+  }
+  return valueIsValidScalar(value.substr(i));
+}
+
+#else
+
+bool HeaderScanner::valueIsValid(absl::string_view value) { return valueIsValidScalar(value); }
+
+#endif
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Header value scanning routines used by the HTTP/1 codec. They scan the parser's buffer in place.
+ * On x86-64 the input is processed 16 bytes at a time with SSE2 instructions, which are part of the
+ * baseline instruction set; other architectures use the scalar implementation. Results are
+ * identical to Http::HeaderUtility::headerValueIsValid().
+ */
+class HeaderScanner {
+public:
+  /**
+   * Check that a header value contains only characters permitted by RFC 7230: HTAB, SP, visible
+   * ASCII and obs-text. This is equivalent to nghttp2_check_header_value().
+   * @param value supplies the header value to check.
+   * @return true if all characters are valid.
+   */
+  static bool valueIsValid(absl::string_view value);
+
+  /**
+   * Scalar implementation, exposed for tests.
+   */
+  static bool valueIsValidScalar(absl::string_view value);
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
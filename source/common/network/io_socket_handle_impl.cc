@@ -1,5 +1,7 @@
 #include "common/network/io_socket_handle_impl.h"
 
+#include <algorithm>
+
 #include "envoy/buffer/buffer.h"
 
 #include "common/api/os_sys_calls_impl.h"
@@ -64,52 +66,35 @@ Api::IoCallUint64Result IoSocketHandleImpl::writev(const Buffer::RawSlice* slice
       Api::OsSysCallsSingleton::get().writev(fd_, iov.begin(), num_slices_to_write));
 }
 
-Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slices,
-                                                    uint64_t num_slice, int flags,
-                                                    const Address::Ip* self_ip,
-                                                    const Address::Instance& peer_address) {
-  const auto* address_base = dynamic_cast<const Address::InstanceBase*>(&peer_address);
-  sockaddr* sock_addr = const_cast<sockaddr*>(address_base->sockAddr());
+namespace {
 
-  absl::FixedArray<iovec> iov(num_slice);
-  uint64_t num_slices_to_write = 0;
-  for (uint64_t i = 0; i < num_slice; i++) {
-    if (slices[i].mem_ != nullptr && slices[i].len_ != 0) {
-      iov[num_slices_to_write].iov_base = slices[i].mem_;
-      iov[num_slices_to_write].iov_len = slices[i].len_;
-      num_slices_to_write++;
-    }
-  }
-  if (num_slices_to_write == 0) {
-    return Api::ioCallUint64ResultNoError();
-  }
+// The control message space needed to set the source address, which may be IPv4 or IPv6, and the
+// UDP GSO segment size of an outgoing message.
+size_t sendMsgControlSpace() {
+  const size_t space_v6 = CMSG_SPACE(sizeof(in6_pktinfo));
+  // FreeBSD only needs in_addr size, but allocates more to unify code in two platforms.
+  const size_t space_v4 = CMSG_SPACE(sizeof(in_pktinfo));
+  return std::max(space_v4, space_v6) + CMSG_SPACE(sizeof(uint16_t));
+}
 
-  msghdr message;
-  message.msg_name = reinterpret_cast<void*>(sock_addr);
-  message.msg_namelen = address_base->sockAddrLen();
-  message.msg_iov = iov.begin();
-  message.msg_iovlen = num_slices_to_write;
-  message.msg_flags = 0;
-  auto& os_syscalls = Api::OsSysCallsSingleton::get();
-  if (self_ip == nullptr) {
+// Points the control messages of |message| at |cbuf| and fills in the source address if |self_ip|
+// is not null and the UDP GSO segment size if |gso_size| is not zero. |cbuf| must hold
+// sendMsgControlSpace() zeroed bytes.
+void setSendMsgControl(msghdr& message, char* cbuf, const Address::Ip* self_ip,
+                       uint64_t gso_size) {
+  if (self_ip == nullptr && gso_size == 0) {
     message.msg_control = nullptr;
     message.msg_controllen = 0;
-    const Api::SysCallSizeResult result = os_syscalls.sendmsg(fd_, &message, flags);
-    return sysCallResultToIoCallResult(result);
-  } else {
-    const size_t space_v6 = CMSG_SPACE(sizeof(in6_pktinfo));
-    // FreeBSD only needs in_addr size, but allocates more to unify code in two platforms.
-    const size_t space_v4 = CMSG_SPACE(sizeof(in_pktinfo));
-    const size_t cmsg_space = (space_v4 < space_v6) ? space_v6 : space_v4;
-    // kSpaceForIp should be big enough to hold both IPv4 and IPv6 packet info.
-    absl::FixedArray<char> cbuf(cmsg_space);
-    memset(cbuf.begin(), 0, cmsg_space);
-
-    message.msg_control = cbuf.begin();
-    message.msg_controllen = cmsg_space * sizeof(char);
-    cmsghdr* const cmsg = CMSG_FIRSTHDR(&message);
-    RELEASE_ASSERT(cmsg != nullptr, fmt::format("cbuf with size {} is not enough, cmsghdr size {}",
-                                                sizeof(cbuf), sizeof(cmsghdr)));
+    return;
+  }
+
+  message.msg_control = cbuf;
+  message.msg_controllen = sendMsgControlSpace();
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  RELEASE_ASSERT(cmsg != nullptr, fmt::format("cbuf with size {} is not enough, cmsghdr size {}",
+                                              message.msg_controllen, sizeof(cmsghdr)));
+  size_t controllen = 0;
+  if (self_ip != nullptr) {
     if (self_ip->version() == Address::IpVersion::v4) {
       cmsg->cmsg_level = IPPROTO_IP;
 #ifndef IP_SENDSRCADDR
@@ -122,10 +107,12 @@ Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slic
 #else
       pktinfo->ipi_spec_dst.s_addr = self_ip->ipv4()->address();
 #endif
+      controllen += CMSG_SPACE(sizeof(in_pktinfo));
 #else
       cmsg->cmsg_type = IP_SENDSRCADDR;
       cmsg->cmsg_len = CMSG_LEN(sizeof(in_addr));
       *(reinterpret_cast<struct in_addr*>(CMSG_DATA(cmsg))).s_addr = self_ip->ipv4()->address();
+      controllen += CMSG_SPACE(sizeof(in_addr));
 #endif
     } else if (self_ip->version() == Address::IpVersion::v6) {
       cmsg->cmsg_len = CMSG_LEN(sizeof(in6_pktinfo));
@@ -134,10 +121,111 @@ Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slic
       auto pktinfo = reinterpret_cast<in6_pktinfo*>(CMSG_DATA(cmsg));
       pktinfo->ipi6_ifindex = 0;
       *(reinterpret_cast<absl::uint128*>(pktinfo->ipi6_addr.s6_addr)) = self_ip->ipv6()->address();
+      controllen += CMSG_SPACE(sizeof(in6_pktinfo));
     }
-    const Api::SysCallSizeResult result = os_syscalls.sendmsg(fd_, &message, flags);
-    return sysCallResultToIoCallResult(result);
+    cmsg = CMSG_NXTHDR(&message, cmsg);
+  }
+#if ENVOY_UDP_GSO_GRO
+  if (gso_size != 0) {
+    ASSERT(cmsg != nullptr);
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    *reinterpret_cast<uint16_t*>(CMSG_DATA(cmsg)) = static_cast<uint16_t>(gso_size);
+    controllen += CMSG_SPACE(sizeof(uint16_t));
+  }
+#else
+  ASSERT(gso_size == 0);
+#endif
+  message.msg_controllen = controllen;
+}
+
+} // namespace
+
+Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slices,
+                                                    uint64_t num_slice, int flags,
+                                                    const Address::Ip* self_ip,
+                                                    const Address::Instance& peer_address) {
+  const auto* address_base = dynamic_cast<const Address::InstanceBase*>(&peer_address);
+  sockaddr* sock_addr = const_cast<sockaddr*>(address_base->sockAddr());
+
+  absl::FixedArray<iovec> iov(num_slice);
+  uint64_t num_slices_to_write = 0;
+  for (uint64_t i = 0; i < num_slice; i++) {
+    if (slices[i].mem_ != nullptr && slices[i].len_ != 0) {
+      iov[num_slices_to_write].iov_base = slices[i].mem_;
+      iov[num_slices_to_write].iov_len = slices[i].len_;
+      num_slices_to_write++;
+    }
+  }
+  if (num_slices_to_write == 0) {
+    return Api::ioCallUint64ResultNoError();
+  }
+
+  msghdr message;
+  message.msg_name = reinterpret_cast<void*>(sock_addr);
+  message.msg_namelen = address_base->sockAddrLen();
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = num_slices_to_write;
+  message.msg_flags = 0;
+  absl::FixedArray<char> cbuf(self_ip == nullptr ? 0 : sendMsgControlSpace(), 0);
+  setSendMsgControl(message, cbuf.data(), self_ip, 0);
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().sendmsg(fd_, &message, flags);
+  return sysCallResultToIoCallResult(result);
+}
+
+Api::IoCallUint64Result IoSocketHandleImpl::sendmmsg(const SendMsgPacket* packets,
+                                                     uint64_t num_packets) {
+  if (num_packets == 0) {
+    return Api::ioCallUint64ResultNoError();
+  }
+
+  uint64_t total_slices = 0;
+  for (uint64_t i = 0; i < num_packets; ++i) {
+    total_slices += packets[i].num_slice_;
   }
+  absl::FixedArray<mmsghdr> mmsg_hdr(num_packets);
+  absl::FixedArray<iovec> iov(total_slices);
+  const size_t cmsg_space = sendMsgControlSpace();
+  absl::FixedArray<char> cbufs(num_packets * cmsg_space, 0);
+  bool has_gso = false;
+  uint64_t next_iov = 0;
+  for (uint64_t i = 0; i < num_packets; ++i) {
+    const SendMsgPacket& packet = packets[i];
+    const auto* address_base = dynamic_cast<const Address::InstanceBase*>(packet.peer_address_);
+
+    iovec* packet_iov = iov.data() + next_iov;
+    uint64_t num_slices_to_write = 0;
+    for (uint64_t j = 0; j < packet.num_slice_; ++j) {
+      if (packet.slices_[j].mem_ != nullptr && packet.slices_[j].len_ != 0) {
+        packet_iov[num_slices_to_write].iov_base = packet.slices_[j].mem_;
+        packet_iov[num_slices_to_write].iov_len = packet.slices_[j].len_;
+        num_slices_to_write++;
+      }
+    }
+    next_iov += num_slices_to_write;
+
+    mmsg_hdr[i].msg_len = 0;
+    msghdr& message = mmsg_hdr[i].msg_hdr;
+    message.msg_name = const_cast<sockaddr*>(address_base->sockAddr());
+    message.msg_namelen = address_base->sockAddrLen();
+    message.msg_iov = packet_iov;
+    message.msg_iovlen = num_slices_to_write;
+    message.msg_flags = 0;
+    setSendMsgControl(message, &cbufs[i * cmsg_space], packet.self_ip_, packet.gso_size_);
+    has_gso |= packet.gso_size_ != 0;
+  }
+
+  const Api::SysCallIntResult result =
+      Api::OsSysCallsSingleton::get().sendmmsg(fd_, mmsg_hdr.data(), num_packets, 0);
+  if (result.rc_ < 0 && (result.errno_ == EINVAL || result.errno_ == EIO) && has_gso) {
+    // The kernel rejects segmentation it can not offload, e.g. if the segment size exceeds the path
+    // MTU or the device lacks checksum offload. The caller can retry without UDP GSO.
+    return Api::IoCallUint64Result(
+        0, Api::IoErrorPtr(new IoSocketError(result.errno_), IoSocketError::deleteIoError));
+  }
+  return sysCallResultToIoCallResult(result);
 }
 
 Address::InstanceConstSharedPtr getAddressFromSockAddrOrDie(const sockaddr_storage& ss,
@@ -204,6 +292,18 @@ absl::optional<uint32_t> maybeGetPacketsDroppedFromHeader(
   return absl::nullopt;
 }
 
+absl::optional<uint64_t> maybeGetGsoSizeFromHeader(
+#if ENVOY_UDP_GSO_GRO
+    const cmsghdr& cmsg) {
+  if (cmsg.cmsg_level == IPPROTO_UDP && cmsg.cmsg_type == UDP_GRO) {
+    return *reinterpret_cast<const int*>(CMSG_DATA(&cmsg));
+  }
+#else
+    const cmsghdr&) {
+#endif
+  return absl::nullopt;
+}
+
 Api::IoCallUint64Result IoSocketHandleImpl::recvmsg(Buffer::RawSlice* slices,
                                                     const uint64_t num_slice, uint32_t self_port,
                                                     RecvMsgOutput& output) {
@@ -257,6 +357,11 @@ Api::IoCallUint64Result IoSocketHandleImpl::recvmsg(Buffer::RawSlice* slices,
           continue;
         }
       }
+      absl::optional<uint64_t> maybe_gso_size = maybeGetGsoSizeFromHeader(*cmsg);
+      if (maybe_gso_size) {
+        output.msg_[0].gso_size_ = *maybe_gso_size;
+        continue;
+      }
       if (output.dropped_packets_ != nullptr) {
         absl::optional<uint32_t> maybe_dropped = maybeGetPacketsDroppedFromHeader(*cmsg);
         if (maybe_dropped) {
@@ -336,11 +441,18 @@ Api::IoCallUint64Result IoSocketHandleImpl::recvmmsg(RawSliceArrays& slices, uin
     if (hdr.msg_controllen > 0) {
       struct cmsghdr* cmsg;
       for (cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
-        Address::InstanceConstSharedPtr addr = maybeGetDstAddressFromHeader(*cmsg, self_port, fd_);
-        if (addr != nullptr) {
-          // This is a IP packet info message.
-          output.msg_[i].local_address_ = std::move(addr);
-          break;
+        if (output.msg_[i].local_address_ == nullptr) {
+          Address::InstanceConstSharedPtr addr =
+              maybeGetDstAddressFromHeader(*cmsg, self_port, fd_);
+          if (addr != nullptr) {
+            // This is a IP packet info message.
+            output.msg_[i].local_address_ = std::move(addr);
+            continue;
+          }
+        }
+        absl::optional<uint64_t> maybe_gso_size = maybeGetGsoSizeFromHeader(*cmsg);
+        if (maybe_gso_size) {
+          output.msg_[i].gso_size_ = *maybe_gso_size;
         }
       }
     }
@@ -365,5 +477,9 @@ bool IoSocketHandleImpl::supportsMmsg() const {
   return Api::OsSysCallsSingleton::get().supportsMmsg();
 }
 
+bool IoSocketHandleImpl::supportsUdpGso() const {
+  return Api::OsSysCallsSingleton::get().supportsUdpGso();
+}
+
 } // namespace Network
 } // namespace Envoy
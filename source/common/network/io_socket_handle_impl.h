@@ -37,6 +37,8 @@ public:
                                   const Address::Ip* self_ip,
                                   const Address::Instance& peer_address) override;
 
+  Api::IoCallUint64Result sendmmsg(const SendMsgPacket* packets, uint64_t num_packets) override;
+
   Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                   uint32_t self_port, RecvMsgOutput& output) override;
 
@@ -45,6 +47,8 @@ public:
 
   bool supportsMmsg() const override;
 
+  bool supportsUdpGso() const override;
+
 private:
   // Converts a SysCallSizeResult to IoCallUint64Result.
   template <typename T>
@@ -66,11 +70,11 @@ private:
 
   os_fd_t fd_;
 
-  // The minimum cmsg buffer size to filled in destination address and packets dropped when
-  // receiving a packet. It is possible for a received packet to contain both IPv4 and IPv6
-  // addresses.
+  // The minimum cmsg buffer size to filled in destination address, packets dropped and the UDP GRO
+  // segment size when receiving a packet. It is possible for a received packet to contain both
+  // IPv4 and IPv6 addresses.
   const size_t cmsg_space_{CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(struct in_pktinfo)) +
-                           CMSG_SPACE(sizeof(struct in6_pktinfo))};
+                           CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))};
 };
 
 } // namespace Network
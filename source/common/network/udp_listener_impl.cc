@@ -116,5 +116,16 @@ Api::IoCallUint64Result UdpListenerImpl::send(const UdpSendData& send_data) {
   return send_result;
 }
 
+Api::IoCallUint64Result UdpListenerImpl::sendBatch(const UdpSendData* data, uint64_t num_data) {
+  ENVOY_UDP_LOG(trace, "send batch of {} datagrams", num_data);
+  Api::IoCallUint64Result send_result =
+      Utility::writePacketsToSocket(socket_->ioHandle(), data, num_data);
+
+  for (uint64_t i = 0; i < send_result.rc_; ++i) {
+    data[i].buffer_.drain(data[i].buffer_.length());
+  }
+  return send_result;
+}
+
 } // namespace Network
 } // namespace Envoy
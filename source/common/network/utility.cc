@@ -530,7 +530,140 @@ Api::IoCallUint64Result Utility::writeToSocket(IoHandle& handle, Buffer::RawSlic
   return send_result;
 }
 
-void passPayloadToProcessor(uint64_t bytes_read, Buffer::RawSlice& slice,
+Api::IoCallUint64Result Utility::writePacketsToSocket(IoHandle& handle,
+                                                      const UdpSendData* packets,
+                                                      uint64_t num_packets) {
+  if (num_packets == 1 || (num_packets > 1 && !handle.supportsMmsg())) {
+    for (uint64_t i = 0; i < num_packets; ++i) {
+      Api::IoCallUint64Result result = writeToSocket(handle, packets[i].buffer_,
+                                                     packets[i].local_ip_, packets[i].peer_address_);
+      if (!result.ok()) {
+        return Api::IoCallUint64Result(i, std::move(result.err_));
+      }
+    }
+    return Api::IoCallUint64Result(num_packets,
+                                   Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError));
+  }
+
+  // Build one message per run of datagrams which can share a UDP GSO message. first_packet[i] is
+  // the index of the first datagram in message i, the last entry is one past the last datagram.
+  const bool use_gso = handle.supportsUdpGso();
+  std::vector<Buffer::RawSliceVector> slices(num_packets);
+  std::vector<IoHandle::SendMsgPacket> messages;
+  std::vector<uint64_t> first_packet;
+  messages.reserve(num_packets);
+  first_packet.reserve(num_packets + 1);
+  std::vector<Buffer::RawSlice> gso_slices;
+  if (use_gso) {
+    // Reserve upfront so that messages can point into gso_slices while it is filled.
+    uint64_t total_slices = 0;
+    for (uint64_t i = 0; i < num_packets; ++i) {
+      slices[i] = packets[i].buffer_.getRawSlices();
+      total_slices += slices[i].size();
+    }
+    gso_slices.reserve(total_slices);
+  }
+  const auto same_local_ip = [](const Address::Ip* lhs, const Address::Ip* rhs) {
+    return lhs == rhs ||
+           (lhs != nullptr && rhs != nullptr && lhs->addressAsString() == rhs->addressAsString());
+  };
+  uint64_t i = 0;
+  while (i < num_packets) {
+    const UdpSendData& packet = packets[i];
+    const uint64_t segment_size = packet.buffer_.length();
+    uint64_t run_end = i + 1;
+    if (use_gso && segment_size > 0) {
+      uint64_t payload_size = segment_size;
+      while (run_end < num_packets && run_end - i < MAX_UDP_GSO_SEGMENTS) {
+        const UdpSendData& next = packets[run_end];
+        const uint64_t next_size = next.buffer_.length();
+        if (next_size == 0 || next_size > segment_size ||
+            payload_size + next_size > MAX_UDP_GSO_PAYLOAD_SIZE ||
+            next.peer_address_ != packet.peer_address_ ||
+            !same_local_ip(next.local_ip_, packet.local_ip_)) {
+          break;
+        }
+        payload_size += next_size;
+        ++run_end;
+        if (next_size < segment_size) {
+          // Only the last datagram of a run may be shorter than the segment size.
+          break;
+        }
+      }
+    }
+
+    first_packet.push_back(i);
+    if (run_end - i > 1) {
+      const uint64_t first_slice = gso_slices.size();
+      for (uint64_t j = i; j < run_end; ++j) {
+        gso_slices.insert(gso_slices.end(), slices[j].begin(), slices[j].end());
+      }
+      messages.push_back({&gso_slices[first_slice], gso_slices.size() - first_slice,
+                          packet.local_ip_, &packet.peer_address_, segment_size});
+    } else {
+      if (!use_gso) {
+        slices[i] = packet.buffer_.getRawSlices();
+      }
+      messages.push_back(
+          {slices[i].data(), slices[i].size(), packet.local_ip_, &packet.peer_address_, 0});
+    }
+    i = run_end;
+  }
+  first_packet.push_back(num_packets);
+
+  uint64_t next_message = 0;
+  while (next_message < messages.size()) {
+    const uint64_t batch_size =
+        std::min<uint64_t>(messages.size() - next_message, MAX_UDP_PACKETS_PER_SENDMMSG);
+    Api::IoCallUint64Result result = handle.sendmmsg(&messages[next_message], batch_size);
+    if (!result.ok() && result.err_->getErrorCode() == Api::IoError::IoErrorCode::Interrupt) {
+      continue;
+    }
+    if (!result.ok()) {
+      if (messages[next_message].gso_size_ == 0 ||
+          result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        ENVOY_LOG_MISC(debug, "sendmmsg failed with error code {}: {}",
+                       static_cast<int>(result.err_->getErrorCode()),
+                       result.err_->getErrorDetails());
+        return Api::IoCallUint64Result(first_packet[next_message], std::move(result.err_));
+      }
+      // The kernel could not segment the message, send its datagrams one by one instead.
+      ENVOY_LOG_MISC(trace, "UDP GSO failed, sending {} datagrams individually",
+                     first_packet[next_message + 1] - first_packet[next_message]);
+      for (uint64_t j = first_packet[next_message]; j < first_packet[next_message + 1]; ++j) {
+        result = writeToSocket(handle, slices[j].data(), slices[j].size(), packets[j].local_ip_,
+                               packets[j].peer_address_);
+        if (!result.ok()) {
+          return Api::IoCallUint64Result(j, std::move(result.err_));
+        }
+      }
+      ++next_message;
+      continue;
+    }
+    ENVOY_LOG_MISC(trace, "sendmmsg sent {} messages", result.rc_);
+    ASSERT(result.rc_ > 0);
+    next_message += result.rc_;
+  }
+  return Api::IoCallUint64Result(num_packets,
+                                 Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError));
+}
+
+bool Utility::enableUdpGro(IoHandle& handle) {
+  auto& os_syscalls = Api::OsSysCallsSingleton::get();
+  if (!os_syscalls.supportsUdpGro()) {
+    return false;
+  }
+#if ENVOY_UDP_GSO_GRO
+  const int enable = 1;
+  return os_syscalls.setsockopt(handle.fd(), IPPROTO_UDP, UDP_GRO, &enable, sizeof(enable)).rc_ ==
+         0;
+#else
+  UNREFERENCED_PARAMETER(handle);
+  return false;
+#endif
+}
+
+void passPayloadToProcessor(uint64_t bytes_read, uint64_t gso_size, Buffer::RawSlice& slice,
                             Buffer::InstancePtr buffer, Address::InstanceConstSharedPtr peer_addess,
                             Address::InstanceConstSharedPtr local_address,
                             UdpPacketProcessor& udp_packet_processor, MonotonicTime receive_time) {
@@ -548,6 +681,15 @@ void passPayloadToProcessor(uint64_t bytes_read, Buffer::RawSlice& slice,
                  fmt::format("Unsupported remote address: {} local address: {}, receive size: "
                              "{}",
                              peer_addess->asString(), local_address->asString(), bytes_read));
+  if (gso_size != 0) {
+    // Split a message coalesced by UDP GRO into the original datagrams.
+    while (buffer->length() > gso_size) {
+      Buffer::InstancePtr datagram = std::make_unique<Buffer::OwnedImpl>();
+      datagram->move(*buffer, gso_size);
+      udp_packet_processor.processPacket(local_address, peer_addess, std::move(datagram),
+                                         receive_time);
+    }
+  }
   udp_packet_processor.processPacket(std::move(local_address), std::move(peer_addess),
                                      std::move(buffer), receive_time);
 }
@@ -557,7 +699,7 @@ Api::IoCallUint64Result Utility::readFromSocket(IoHandle& handle,
                                                 UdpPacketProcessor& udp_packet_processor,
                                                 MonotonicTime receive_time,
                                                 uint32_t* packets_dropped) {
-  if (handle.supportsMmsg()) {
+  if (handle.supportsMmsg() && udp_packet_processor.maxPacketSize() <= MAX_UDP_PACKET_SIZE) {
     const uint32_t num_packets_per_mmsg_call = 16u;
     const uint32_t num_slices_per_packet = 1u;
     absl::FixedArray<Buffer::InstancePtr> buffers(num_packets_per_mmsg_call);
@@ -584,8 +726,9 @@ Api::IoCallUint64Result Utility::readFromSocket(IoHandle& handle,
       ASSERT(msg_len <= slice->len_);
       ENVOY_LOG_MISC(debug, "Receive a packet with {} bytes from {}", msg_len,
                      output.msg_[i].peer_address_->asString());
-      passPayloadToProcessor(msg_len, *slice, std::move(buffers[i]), output.msg_[i].peer_address_,
-                             output.msg_[i].local_address_, udp_packet_processor, receive_time);
+      passPayloadToProcessor(msg_len, output.msg_[i].gso_size_, *slice, std::move(buffers[i]),
+                             output.msg_[i].peer_address_, output.msg_[i].local_address_,
+                             udp_packet_processor, receive_time);
     }
     return result;
   }
@@ -605,9 +748,10 @@ Api::IoCallUint64Result Utility::readFromSocket(IoHandle& handle,
 
   ENVOY_LOG_MISC(trace, "recvmsg bytes {}", result.rc_);
 
-  passPayloadToProcessor(
-      result.rc_, slice, std::move(buffer), std::move(output.msg_[0].peer_address_),
-      std::move(output.msg_[0].local_address_), udp_packet_processor, receive_time);
+  passPayloadToProcessor(result.rc_, output.msg_[0].gso_size_, slice, std::move(buffer),
+                         std::move(output.msg_[0].peer_address_),
+                         std::move(output.msg_[0].local_address_), udp_packet_processor,
+                         receive_time);
   return result;
 }
 
@@ -61,6 +61,18 @@ public:
 
 static const uint64_t MAX_UDP_PACKET_SIZE = 1500;
 
+// The receive buffer size for sockets with UDP GRO enabled, large enough for the largest message
+// the kernel coalesces.
+static const uint64_t MAX_UDP_GRO_PACKET_SIZE = 64 * 1024;
+
+// The maximum number of datagrams and payload bytes in a message segmented by UDP GSO. The kernel
+// limits a message to UDP_MAX_SEGMENTS datagrams and to the payload of a single IPv4 packet.
+static const uint64_t MAX_UDP_GSO_SEGMENTS = 64;
+static const uint64_t MAX_UDP_GSO_PAYLOAD_SIZE = 65507;
+
+// The maximum number of messages passed to a single sendmmsg() call.
+static const uint64_t MAX_UDP_PACKETS_PER_SENDMMSG = 64;
+
 /**
  * Common network utility routines.
  */
@@ -307,7 +319,34 @@ public:
                                                const Address::Instance& peer_address);
 
   /**
-   * Read a packet from a given UDP socket and pass the packet to given UdpPacketProcessor.
+   * Write a batch of datagrams to a given UDP socket with as few system calls as the platform
+   * allows. The datagrams are sent in order with sendmmsg(), and each run of equally sized
+   * datagrams to the same peer from the same local IP is coalesced into a single message which
+   * the kernel segments with UDP GSO. A single datagram, or a platform without sendmmsg(), falls
+   * back to sendmsg().
+   * @param handle is the UDP socket to write to.
+   * @param packets supplies the datagrams to send. The buffers are not drained.
+   * @param num_packets supplies the number of datagrams in packets.
+   * @return a Api::IoCallUint64Result with rc_ = the number of datagrams sent from the front of
+   * packets. If not all datagrams were sent, err_ is the error which stopped the batch.
+   */
+  static Api::IoCallUint64Result writePacketsToSocket(IoHandle& handle, const UdpSendData* packets,
+                                                      uint64_t num_packets);
+
+  /**
+   * Enable UDP GRO on a given UDP socket if the platform supports it. Once enabled, the kernel may
+   * coalesce received datagrams into messages of up to MAX_UDP_GRO_PACKET_SIZE bytes, which
+   * readFromSocket() splits into the original datagrams.
+   * @param handle is the UDP socket.
+   * @return true if UDP GRO was enabled.
+   */
+  static bool enableUdpGro(IoHandle& handle);
+
+  /**
+   * Read a packet from a given UDP socket and pass the packet to given UdpPacketProcessor. A
+   * message coalesced by UDP GRO is passed to the processor as the datagrams it is made of.
+   * recvmmsg() is only used if the processor's maxPacketSize() is at most MAX_UDP_PACKET_SIZE, as
+   * it needs a receive buffer for each message.
    * @param handle is the UDP socket to read from.
    * @param local_address is the socket's local address used to populate port.
    * @param udp_packet_processor is the callback to receive the packet.
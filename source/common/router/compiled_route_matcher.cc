@@ -0,0 +1,95 @@
+#include "common/router/compiled_route_matcher.h"
+
+#include <algorithm>
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Router {
+
+void CompiledRouteMatcher::addPrefix(absl::string_view prefix, uint32_t index) {
+  nodes_[findOrCreateNode(prefix)].prefix_routes_.push_back(index);
+}
+
+void CompiledRouteMatcher::addExact(absl::string_view path, uint32_t index) {
+  nodes_[findOrCreateNode(path)].exact_routes_.push_back(index);
+}
+
+void CompiledRouteMatcher::addFallback(uint32_t index) { fallback_routes_.push_back(index); }
+
+uint32_t CompiledRouteMatcher::findOrCreateNode(absl::string_view key) {
+  uint32_t current = 0;
+  while (!key.empty()) {
+    const std::vector<Edge>& edges = nodes_[current].edges_;
+    const auto it = std::find_if(edges.begin(), edges.end(),
+                                 [&key](const Edge& edge) { return edge.label_[0] == key[0]; });
+    if (it == edges.end()) {
+      // No edge shares a first character with the remaining key, so it becomes a new leaf.
+      const uint32_t child = nodes_.size();
+      nodes_.emplace_back();
+      nodes_[current].edges_.push_back({std::string(key), child});
+      return child;
+    }
+
+    const std::string& label = it->label_;
+    size_t common = 0;
+    while (common < label.size() && common < key.size() && label[common] == key[common]) {
+      common++;
+    }
+    if (common == label.size()) {
+      current = it->child_;
+      key.remove_prefix(common);
+      continue;
+    }
+
+    // The key diverges from (or ends inside) the edge label. Split the edge so that the common
+    // part ends at a new intermediate node. Note that adding the node may reallocate nodes_, so
+    // the edge is looked up again by position.
+    const size_t edge_index = it - edges.begin();
+    const uint32_t middle = nodes_.size();
+    nodes_.emplace_back();
+    Edge& edge = nodes_[current].edges_[edge_index];
+    nodes_[middle].edges_.push_back({edge.label_.substr(common), edge.child_});
+    edge.label_.resize(common);
+    edge.child_ = middle;
+    current = middle;
+    key.remove_prefix(common);
+  }
+  return current;
+}
+
+const CompiledRouteMatcher::Edge* CompiledRouteMatcher::findEdge(const Node& node, char c) const {
+  for (const Edge& edge : node.edges_) {
+    if (edge.label_[0] == c) {
+      return &edge;
+    }
+  }
+  return nullptr;
+}
+
+void CompiledRouteMatcher::candidates(absl::string_view path, Candidates& candidates) const {
+  candidates.assign(fallback_routes_.begin(), fallback_routes_.end());
+  const Node* node = &nodes_[0];
+  while (true) {
+    candidates.insert(candidates.end(), node->prefix_routes_.begin(), node->prefix_routes_.end());
+    if (path.empty()) {
+      candidates.insert(candidates.end(), node->exact_routes_.begin(), node->exact_routes_.end());
+      break;
+    }
+    const Edge* edge = findEdge(*node, path[0]);
+    if (edge == nullptr || !absl::StartsWith(path, edge->label_)) {
+      break;
+    }
+    path.remove_prefix(edge->label_.size());
+    node = &nodes_[edge->child_];
+  }
+  // Each list is already sorted, and there are typically only a handful of candidates.
+  std::sort(candidates.begin(), candidates.end());
+}
+
+void CompiledRouteMatcher::fallbackCandidates(Candidates& candidates) const {
+  candidates.assign(fallback_routes_.begin(), fallback_routes_.end());
+}
+
+} // namespace Router
+} // namespace Envoy
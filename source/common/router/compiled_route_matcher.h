@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Pre-computed index over the routes of a virtual host. Case sensitive prefix and exact path
+ * routes are stored in a radix trie keyed by their match string; all other routes (regex,
+ * CONNECT, case insensitive paths) are kept in a fallback list that is always considered.
+ *
+ * The matcher only narrows down the set of routes that may match a request path. Candidates are
+ * returned as indices into the virtual host's route list in ascending order, so callers that
+ * evaluate them in order preserve first-match-wins semantics exactly.
+ */
+class CompiledRouteMatcher {
+public:
+  using Candidates = absl::InlinedVector<uint32_t, 16>;
+
+  /**
+   * Add a route which matches any path starting with prefix.
+   * @param prefix supplies the case sensitive path prefix.
+   * @param index supplies the position of the route in the virtual host's route list.
+   */
+  void addPrefix(absl::string_view prefix, uint32_t index);
+
+  /**
+   * Add a route which matches only the given path.
+   * @param path supplies the case sensitive path.
+   * @param index supplies the position of the route in the virtual host's route list.
+   */
+  void addExact(absl::string_view path, uint32_t index);
+
+  /**
+   * Add a route that cannot be indexed and must always be evaluated.
+   * @param index supplies the position of the route in the virtual host's route list.
+   */
+  void addFallback(uint32_t index);
+
+  /**
+   * Collect the routes that may match a path.
+   * @param path supplies the request path with query string and fragment already removed.
+   * @param candidates is filled with route indices in ascending order.
+   */
+  void candidates(absl::string_view path, Candidates& candidates) const;
+
+  /**
+   * Collect only the routes that are not indexed by path. This is used for requests without a
+   * :path header.
+   * @param candidates is filled with route indices in ascending order.
+   */
+  void fallbackCandidates(Candidates& candidates) const;
+
+  /**
+   * @return the number of radix trie nodes. Exposed for tests.
+   */
+  size_t nodeCount() const { return nodes_.size(); }
+
+private:
+  struct Edge {
+    std::string label_;
+    uint32_t child_;
+  };
+
+  struct Node {
+    // Outgoing edges, keyed by the first character of their label. No two edges share a first
+    // character.
+    std::vector<Edge> edges_;
+    std::vector<uint32_t> prefix_routes_;
+    std::vector<uint32_t> exact_routes_;
+  };
+
+  uint32_t findOrCreateNode(absl::string_view key);
+  const Edge* findEdge(const Node& node, char c) const;
+
+  // nodes_[0] is the root and corresponds to the empty string.
+  std::vector<Node> nodes_{1};
+  std::vector<uint32_t> fallback_routes_;
+};
+
+} // namespace Router
+} // namespace Envoy
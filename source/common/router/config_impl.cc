@@ -1078,6 +1078,10 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
     }
   }
 
+  if (global_route_config.compiledRouteMatching()) {
+    buildCompiledRouteMatcher();
+  }
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(
         VirtualClusterEntry(virtual_cluster, stat_name_pool_, *vcluster_scope_));
@@ -1125,28 +1129,6 @@ const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::str
   return per_filter_configs_.get(name);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
-    const std::string& host, const RouteMatcher::WildcardVirtualHosts& wildcard_virtual_hosts,
-    RouteMatcher::SubstringFunction substring_function) const {
-  // We do a longest wildcard match against the host that's passed in
-  // (e.g. "foo-bar.baz.com" should match "*-bar.baz.com" before matching "*.baz.com" for suffix
-  // wildcards). This is done by scanning the length => wildcards map looking for every wildcard
-  // whose size is < length.
-  for (const auto& iter : wildcard_virtual_hosts) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto& match = wildcard_map.find(substring_function(host, wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
-  }
-  return nullptr;
-}
-
 RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& route_config,
                            const ConfigImpl& global_route_config,
                            Server::Configuration::ServerFactoryContext& factory_context,
@@ -1165,13 +1147,11 @@ RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& r
         }
         default_virtual_host_ = virtual_host;
       } else if (!domain.empty() && '*' == domain[0]) {
-        duplicate_found = !wildcard_virtual_host_suffixes_[domain.size() - 1]
-                               .emplace(domain.substr(1), virtual_host)
-                               .second;
+        duplicate_found =
+            !wildcard_virtual_host_suffixes_.add(absl::string_view(domain).substr(1), virtual_host);
       } else if (!domain.empty() && '*' == domain[domain.size() - 1]) {
-        duplicate_found = !wildcard_virtual_host_prefixes_[domain.size() - 1]
-                               .emplace(domain.substr(0, domain.size() - 1), virtual_host)
-                               .second;
+        duplicate_found = !wildcard_virtual_host_prefixes_.add(
+            absl::string_view(domain).substr(0, domain.size() - 1), virtual_host);
       } else {
         duplicate_found = !virtual_hosts_.emplace(domain, virtual_host).second;
       }
@@ -1203,38 +1183,86 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (auto route = routes_.begin(); route != routes_.end(); ++route) {
-    if (!headers.Path() && !(*route)->supportsPathlessHeaders()) {
-      continue;
-    }
-
-    RouteConstSharedPtr route_entry = (*route)->matches(headers, stream_info, random_value);
-    if (nullptr == route_entry) {
-      continue;
+  RouteConstSharedPtr result;
+  if (compiled_route_matcher_ != nullptr) {
+    // Only evaluate the routes which may match the path, in configuration order.
+    CompiledRouteMatcher::Candidates candidates;
+    if (headers.Path()) {
+      compiled_route_matcher_->candidates(
+          Http::PathUtil::removeQueryAndFragment(headers.Path()->value().getStringView()),
+          candidates);
+    } else {
+      compiled_route_matcher_->fallbackCandidates(candidates);
     }
-
-    if (cb) {
-      RouteEvalStatus eval_status = (std::next(route) == routes_.end())
-                                        ? RouteEvalStatus::NoMoreRoutes
-                                        : RouteEvalStatus::HasMoreRoutes;
-      RouteMatchStatus match_status = cb(route_entry, eval_status);
-      if (match_status == RouteMatchStatus::Accept) {
-        return route_entry;
+    for (const uint32_t index : candidates) {
+      if (evaluateRoute(index, cb, headers, stream_info, random_value, result)) {
+        return result;
       }
-      if (match_status == RouteMatchStatus::Continue &&
-          eval_status == RouteEvalStatus::NoMoreRoutes) {
-        return nullptr;
-      }
-      continue;
     }
+    return nullptr;
+  }
 
-    return route_entry;
+  // Check for a route that matches the request.
+  for (size_t index = 0; index < routes_.size(); index++) {
+    if (evaluateRoute(index, cb, headers, stream_info, random_value, result)) {
+      return result;
+    }
   }
 
   return nullptr;
 }
 
+bool VirtualHostImpl::evaluateRoute(size_t index, const RouteCallback& cb,
+                                    const Http::RequestHeaderMap& headers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    uint64_t random_value, RouteConstSharedPtr& result) const {
+  const RouteEntryImplBaseConstSharedPtr& route = routes_[index];
+  if (!headers.Path() && !route->supportsPathlessHeaders()) {
+    return false;
+  }
+
+  RouteConstSharedPtr route_entry = route->matches(headers, stream_info, random_value);
+  if (nullptr == route_entry) {
+    return false;
+  }
+
+  if (cb) {
+    RouteEvalStatus eval_status = (index + 1 == routes_.size()) ? RouteEvalStatus::NoMoreRoutes
+                                                                : RouteEvalStatus::HasMoreRoutes;
+    RouteMatchStatus match_status = cb(route_entry, eval_status);
+    if (match_status == RouteMatchStatus::Accept) {
+      result = std::move(route_entry);
+      return true;
+    }
+    if (match_status == RouteMatchStatus::Continue &&
+        eval_status == RouteEvalStatus::NoMoreRoutes) {
+      result = nullptr;
+      return true;
+    }
+    return false;
+  }
+
+  result = std::move(route_entry);
+  return true;
+}
+
+void VirtualHostImpl::buildCompiledRouteMatcher() {
+  auto matcher = std::make_unique<CompiledRouteMatcher>();
+  for (uint32_t index = 0; index < routes_.size(); index++) {
+    const RouteEntryImplBase& route = *routes_[index];
+    const PathMatchCriterion& criterion = route.pathMatchCriterion();
+    if (route.caseSensitive() && criterion.matchType() == PathMatchType::Prefix) {
+      matcher->addPrefix(criterion.matcher(), index);
+    } else if (route.caseSensitive() && criterion.matchType() == PathMatchType::Exact) {
+      matcher->addExact(criterion.matcher(), index);
+    } else {
+      // Regex, CONNECT and case insensitive routes are always evaluated.
+      matcher->addFallback(index);
+    }
+  }
+  compiled_route_matcher_ = std::move(matcher);
+}
+
 const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
   if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() &&
@@ -1255,20 +1283,18 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMa
   if (iter != virtual_hosts_.end()) {
     return iter->second.get();
   }
+  // We do a longest wildcard match against the host that's passed in (e.g. "foo-bar.baz.com" should
+  // match "*-bar.baz.com" before matching "*.baz.com" for suffix wildcards).
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
-        host, wildcard_virtual_host_suffixes_,
-        [](const std::string& h, int l) -> std::string { return h.substr(h.size() - l); });
+    const VirtualHostSharedPtr* vhost = wildcard_virtual_host_suffixes_.find(host);
     if (vhost != nullptr) {
-      return vhost;
+      return vhost->get();
     }
   }
   if (!wildcard_virtual_host_prefixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
-        host, wildcard_virtual_host_prefixes_,
-        [](const std::string& h, int l) -> std::string { return h.substr(0, l); });
+    const VirtualHostSharedPtr* vhost = wildcard_virtual_host_prefixes_.find(host);
     if (vhost != nullptr) {
-      return vhost;
+      return vhost->get();
     }
   }
   return default_virtual_host_.get();
@@ -1312,7 +1338,8 @@ ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& confi
                        bool validate_clusters_default)
     : name_(config.name()), symbol_table_(factory_context.scope().symbolTable()),
       uses_vhds_(config.has_vhds()),
-      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()) {
+      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()),
+      compiled_route_matching_(config.compiled_route_matching()) {
   route_matcher_ = std::make_unique<RouteMatcher>(
       config, *this, factory_context, validator,
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default));
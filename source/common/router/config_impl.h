@@ -24,12 +24,14 @@
 #include "common/config/metadata.h"
 #include "common/http/hash_policy.h"
 #include "common/http/header_utility.h"
+#include "common/router/compiled_route_matcher.h"
 #include "common/router/config_utility.h"
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
 #include "common/router/router_ratelimit.h"
 #include "common/router/tls_context_match_criteria_impl.h"
+#include "common/router/wildcard_domain_trie.h"
 #include "common/stats/symbol_table_impl.h"
 
 #include "absl/types/optional.h"
@@ -221,10 +223,23 @@ private:
 
   static const std::shared_ptr<const SslRedirectRoute> SSL_REDIRECT_ROUTE;
 
+  /**
+   * Evaluate a single route against the request.
+   * @param index supplies the position of the route in routes_.
+   * @param result is set to the route to return if the search should stop.
+   * @return true if the search is over, false if further routes should be evaluated.
+   */
+  bool evaluateRoute(size_t index, const RouteCallback& cb, const Http::RequestHeaderMap& headers,
+                     const StreamInfo::StreamInfo& stream_info, uint64_t random_value,
+                     RouteConstSharedPtr& result) const;
+  void buildCompiledRouteMatcher();
+
   Stats::StatNamePool stat_name_pool_;
   const Stats::StatName stat_name_;
   Stats::ScopePtr vcluster_scope_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Only set if compiled route matching is enabled for the route configuration.
+  std::unique_ptr<const CompiledRouteMatcher> compiled_route_matcher_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -455,6 +470,7 @@ public:
 
   bool matchRoute(const Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& stream_info,
                   uint64_t random_value) const;
+  bool caseSensitive() const { return case_sensitive_; }
   void validateClusters(Upstream::ClusterManager& cm) const;
 
   // Router::RouteEntry
@@ -916,26 +932,14 @@ public:
   const VirtualHostImpl* findVirtualHost(const Http::RequestHeaderMap& headers) const;
 
 private:
-  using WildcardVirtualHosts =
-      std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<>>;
-  using SubstringFunction = std::function<std::string(const std::string&, int)>;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host,
-                                                 const WildcardVirtualHosts& wildcard_virtual_hosts,
-                                                 SubstringFunction substring_function) const;
+  using WildcardVirtualHosts = WildcardDomainTrie<VirtualHostSharedPtr>;
 
   Stats::ScopePtr vhost_scope_;
   std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  WildcardVirtualHosts wildcard_virtual_host_suffixes_;
-  WildcardVirtualHosts wildcard_virtual_host_prefixes_;
+  // Wildcard domains are matched with a single walk over the host, from the end of the host for
+  // suffix wildcards and from the start for prefix wildcards, returning the longest match.
+  WildcardVirtualHosts wildcard_virtual_host_suffixes_{WildcardVirtualHosts::Direction::Reverse};
+  WildcardVirtualHosts wildcard_virtual_host_prefixes_{WildcardVirtualHosts::Direction::Forward};
 
   VirtualHostSharedPtr default_virtual_host_;
 };
@@ -979,6 +983,8 @@ public:
     return most_specific_header_mutations_wins_;
   }
 
+  bool compiledRouteMatching() const { return compiled_route_matching_; }
+
 private:
   std::unique_ptr<RouteMatcher> route_matcher_;
   std::list<Http::LowerCaseString> internal_only_headers_;
@@ -988,6 +994,7 @@ private:
   Stats::SymbolTable& symbol_table_;
   const bool uses_vhds_;
   const bool most_specific_header_mutations_wins_;
+  const bool compiled_route_matching_;
 };
 
 /**
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Character trie used to find the longest wildcard domain matching a host. Suffix wildcards
+ * (e.g. "*.foo.com") are stored reversed and walked from the end of the host, prefix wildcards
+ * (e.g. "foo.*") are stored forward and walked from the start of the host. A lookup is a single
+ * pass over the host and does not allocate.
+ */
+template <class T> class WildcardDomainTrie {
+public:
+  enum class Direction { Forward, Reverse };
+
+  explicit WildcardDomainTrie(Direction direction) : direction_(direction) {}
+
+  /**
+   * Add a wildcard.
+   * @param key supplies the non-wildcard part of the domain, e.g. ".foo.com" for "*.foo.com".
+   * @param value supplies the value to return for hosts matching the wildcard.
+   * @return false if the key was already present, in which case the trie is not modified.
+   */
+  bool add(absl::string_view key, T value) {
+    uint32_t current = 0;
+    for (size_t i = 0; i < key.size(); i++) {
+      const char c = charAt(key, i);
+      std::vector<std::pair<char, uint32_t>>& children = nodes_[current].children_;
+      auto it = std::lower_bound(
+          children.begin(), children.end(), c,
+          [](const std::pair<char, uint32_t>& child, char value) { return child.first < value; });
+      if (it != children.end() && it->first == c) {
+        current = it->second;
+        continue;
+      }
+      const uint32_t child = nodes_.size();
+      children.insert(it, {c, child});
+      // Appending may reallocate nodes_, invalidating children. It is not used afterwards.
+      nodes_.emplace_back();
+      current = child;
+    }
+    Node& node = nodes_[current];
+    if (node.has_value_) {
+      return false;
+    }
+    node.has_value_ = true;
+    node.value_ = std::move(value);
+    empty_ = false;
+    return true;
+  }
+
+  /**
+   * Find the longest wildcard strictly shorter than host which matches host. The wildcard must
+   * match at least one character, so "*.foo.com" does not match ".foo.com".
+   * @param host supplies the lower cased host.
+   * @return the value for the longest match, or nullptr if there is none.
+   */
+  const T* find(absl::string_view host) const {
+    const T* match = nullptr;
+    const Node* node = &nodes_[0];
+    // Stop one character early so that the wildcard matches a non-empty string.
+    for (size_t i = 0; i + 1 < host.size(); i++) {
+      node = findChild(*node, charAt(host, i));
+      if (node == nullptr) {
+        break;
+      }
+      if (node->has_value_) {
+        match = &node->value_;
+      }
+    }
+    return match;
+  }
+
+  bool empty() const { return empty_; }
+
+private:
+  struct Node {
+    // Sorted by character.
+    std::vector<std::pair<char, uint32_t>> children_;
+    bool has_value_{};
+    T value_{};
+  };
+
+  char charAt(absl::string_view str, size_t i) const {
+    return direction_ == Direction::Forward ? str[i] : str[str.size() - 1 - i];
+  }
+
+  const Node* findChild(const Node& node, char c) const {
+    for (const auto& child : node.children_) {
+      if (child.first == c) {
+        return &nodes_[child.second];
+      }
+      if (child.first > c) {
+        break;
+      }
+    }
+    return nullptr;
+  }
+
+  const Direction direction_;
+  // nodes_[0] is the root and corresponds to the empty key.
+  std::vector<Node> nodes_{1};
+  bool empty_{true};
+};
+
+} // namespace Router
+} // namespace Envoy
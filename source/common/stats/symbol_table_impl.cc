@@ -158,11 +158,8 @@ void SymbolTableImpl::Encoding::decodeTokens(
 std::vector<absl::string_view> SymbolTableImpl::decodeStrings(const SymbolTable::Storage array,
                                                               uint64_t size) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
   Encoding::decodeTokens(
-      array, size,
-      [this, &strings](Symbol symbol)
-          NO_THREAD_SAFETY_ANALYSIS { strings.push_back(fromSymbol(symbol)); },
+      array, size, [this, &strings](Symbol symbol) { strings.push_back(fromSymbol(symbol)); },
       [&strings](absl::string_view str) { strings.push_back(str); });
   return strings;
 }
@@ -183,9 +180,82 @@ void SymbolTableImpl::Encoding::appendToMemBlock(StatName stat_name,
   }
 }
 
+SymbolTableImpl::DecodeTable::DecodeTable() {
+  directories_.push_back(std::make_unique<Directory>(1));
+  directory_.store(directories_.back().get(), std::memory_order_release);
+}
+
+SymbolTableImpl::DecodeTable::~DecodeTable() {
+  for (const std::unique_ptr<Block>& block : blocks_) {
+    for (std::atomic<InlineString*>& str : block->strings_) {
+      delete str.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+const SymbolTableImpl::DecodeTable::Block&
+SymbolTableImpl::DecodeTable::block(Symbol symbol) const {
+  const Directory* directory = directory_.load(std::memory_order_acquire);
+  const uint64_t block_index = symbol >> BlockBits;
+  const Block* block = nullptr;
+  if (block_index < directory->size_) {
+    block = directory->blocks_[block_index].load(std::memory_order_acquire);
+  }
+  RELEASE_ASSERT(block != nullptr, "no such symbol");
+  return *block;
+}
+
+absl::string_view SymbolTableImpl::DecodeTable::get(Symbol symbol) const {
+  const InlineString* str =
+      block(symbol).strings_[symbol & (BlockSize - 1)].load(std::memory_order_acquire);
+  RELEASE_ASSERT(str != nullptr, "no such symbol");
+  return str->toStringView();
+}
+
+std::atomic<uint32_t>& SymbolTableImpl::DecodeTable::refCount(Symbol symbol) const {
+  return block(symbol).ref_counts_[symbol & (BlockSize - 1)];
+}
+
+std::atomic<InlineString*>& SymbolTableImpl::DecodeTable::slot(Symbol symbol) {
+  // Only called by the writer, so relaxed loads see its own stores.
+  const Directory* directory = directory_.load(std::memory_order_relaxed);
+  const uint64_t block_index = symbol >> BlockBits;
+  if (block_index >= directory->size_) {
+    // Readers may still be using the old directory, so it is kept rather than freed.
+    auto larger = std::make_unique<Directory>(std::max(2 * directory->size_, block_index + 1));
+    for (uint64_t i = 0; i < directory->size_; ++i) {
+      larger->blocks_[i].store(directory->blocks_[i].load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+    }
+    directory = larger.get();
+    directories_.push_back(std::move(larger));
+    directory_.store(directory, std::memory_order_release);
+  }
+  Block* block = directory->blocks_[block_index].load(std::memory_order_relaxed);
+  if (block == nullptr) {
+    blocks_.push_back(std::make_unique<Block>());
+    block = blocks_.back().get();
+    directory->blocks_[block_index].store(block, std::memory_order_release);
+  }
+  return block->strings_[symbol & (BlockSize - 1)];
+}
+
+void SymbolTableImpl::DecodeTable::set(Symbol symbol, InlineStringPtr str) {
+  std::atomic<InlineString*>& s = slot(symbol);
+  ASSERT(s.load(std::memory_order_relaxed) == nullptr);
+  refCount(symbol).store(1, std::memory_order_relaxed);
+  s.store(str.release(), std::memory_order_release);
+}
+
+void SymbolTableImpl::DecodeTable::clear(Symbol symbol) {
+  std::atomic<InlineString*>& s = slot(symbol);
+  ASSERT(s.load(std::memory_order_relaxed) != nullptr);
+  delete s.exchange(nullptr, std::memory_order_relaxed);
+}
+
 SymbolTableImpl::SymbolTableImpl()
     // Have to be explicitly initialized, if we want to use the GUARDED_BY macro.
-    : next_symbol_(FirstValidSymbol), monotonic_counter_(FirstValidSymbol) {}
+    : monotonic_counter_(FirstValidSymbol) {}
 
 SymbolTableImpl::~SymbolTableImpl() {
   // To avoid leaks into the symbol table, we expect all StatNames to be freed.
@@ -203,24 +273,29 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
     return;
   }
 
-  // We want to hold the lock for the minimum amount of time, so we do the
+  // We want to hold the locks for the minimum amount of time, so we do the
   // string-splitting and prepare a temp vector of Symbol first.
   const std::vector<absl::string_view> tokens = absl::StrSplit(name, '.');
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
-    Thread::LockGuard lock(lock_);
-    recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
+  recordLookup(name);
+
+  // Now populate the Symbol objects, which involves bumping ref-counts in
+  // this. Existing tokens are found under a reader lock of their shard, and the
+  // writer lock is only taken to insert new ones.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    Shard& shard = shardFor(token);
+    absl::optional<Symbol> symbol = findSymbol(shard, token);
+    if (!symbol.has_value()) {
+      absl::MutexLock lock(&shard.lock_);
+      symbol = toSymbol(shard, token);
     }
+    symbols.push_back(*symbol);
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -228,9 +303,8 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  Thread::LockGuard lock(symbol_lock_);
+  return monotonic_counter_ - FirstValidSymbol - pool_.size();
 }
 
 std::string SymbolTableImpl::toString(const StatName& stat_name) const {
@@ -243,60 +317,72 @@ void SymbolTableImpl::callWithStringView(StatName stat_name,
 }
 
 void SymbolTableImpl::incRefCount(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
+  // The caller holds a reference to each symbol, so none of them can be
+  // released concurrently, and no lock is needed.
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    ++encode_search->second.ref_count_;
+    decode_table_.refCount(symbol).fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void SymbolTableImpl::free(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
+    freeSymbol(symbol);
+  }
+}
+
+void SymbolTableImpl::freeSymbol(Symbol symbol) {
+  // References other than the last one are dropped without a lock. The release
+  // ordering makes the caller's reads of the string happen before it is
+  // destroyed by whichever thread drops the last reference.
+  std::atomic<uint32_t>& ref_count = decode_table_.refCount(symbol);
+  uint32_t count = ref_count.load(std::memory_order_relaxed);
+  while (count > 1) {
+    if (ref_count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel)) {
+      return;
     }
   }
+
+  // This may be the last reference. Under the writer lock of the shard no
+  // reference can be added by encoding, so a count dropping to zero stays
+  // there. The caller's reference keeps the string valid until then.
+  const absl::string_view token = fromSymbol(symbol);
+  Shard& shard = shardFor(token);
+  absl::MutexLock lock(&shard.lock_);
+  if (ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // The key of the encode map entry views the string in the decode table,
+    // so the entry is erased first.
+    const size_t erased = shard.encode_map_.erase(token);
+    ASSERT(erased == 1);
+    Thread::LockGuard symbol_lock(symbol_lock_);
+    decode_table_.clear(symbol);
+    pool_.push(symbol);
+  }
+}
+
+void SymbolTableImpl::recordLookup(absl::string_view name) {
+  num_lookups_.fetch_add(1, std::memory_order_relaxed);
+  if (track_recent_lookups_.load(std::memory_order_relaxed)) {
+    Thread::LockGuard lock(recent_lookups_lock_);
+    recent_lookups_.lookup(name);
+  }
 }
 
 uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
-  uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold recent_lookups_lock_ while calling the iterator, but
+  // we need it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
-    total += recent_lookups_.total();
   }
+  const uint64_t total = num_lookups_.load(std::memory_order_relaxed);
 
   // Now we have the collated name-count map data: we need to vectorize and
   // sort. We define the pair with the count first as std::pair::operator<
@@ -341,17 +427,19 @@ DynamicSpans SymbolTableImpl::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTableImpl::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  track_recent_lookups_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTableImpl::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.clear();
+  num_lookups_.store(0, std::memory_order_relaxed);
 }
 
 uint64_t SymbolTableImpl::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -361,48 +449,61 @@ StatNameSetPtr SymbolTableImpl::makeSet(absl::string_view name) {
   return stat_name_set;
 }
 
-Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
+SymbolTableImpl::Shard& SymbolTableImpl::shardFor(absl::string_view sv) {
+  // The top bits are used, as the encode maps of the shards hash with the same
+  // function and would otherwise only see keys agreeing on their low bits.
+  return shards_[HashUtil::xxHash64(sv) >> (64 - ShardBits)];
+}
+
+absl::optional<Symbol> SymbolTableImpl::findSymbol(Shard& shard, absl::string_view sv) {
+  absl::ReaderMutexLock lock(&shard.lock_);
+  auto encode_find = shard.encode_map_.find(sv);
+  if (encode_find == shard.encode_map_.end()) {
+    return absl::nullopt;
+  }
+  // A symbol in the encode map has at least one reference, and the last one
+  // cannot be dropped while the reader lock is held.
+  decode_table_.refCount(encode_find->second).fetch_add(1, std::memory_order_relaxed);
+  return encode_find->second;
+}
+
+Symbol SymbolTableImpl::toSymbol(Shard& shard, absl::string_view sv) {
   Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
+  auto encode_find = shard.encode_map_.find(sv);
+  // If the string segment doesn't already exist, which may be the case as it
+  // was only looked up under a reader lock,
+  if (encode_find == shard.encode_map_.end()) {
+    // We create the actual string, place it in the decode_table_, and then
+    // insert a string_view pointing to it in the encode map. This allows us to
+    // only store the string once. The string is not moved as flat_hash_map
+    // moves values around.
     InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
+    const absl::string_view token = str->toStringView();
+    {
+      Thread::LockGuard lock(symbol_lock_);
+      result = newSymbol();
+      decode_table_.set(result, std::move(str));
+    }
+    auto encode_insert = shard.encode_map_.insert({token, result});
     ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
   } else {
     // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
+    // refcount of that symbol.
+    result = encode_find->second;
+    decode_table_.refCount(result).fetch_add(1, std::memory_order_relaxed);
   }
   return result;
 }
 
-absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    EXCLUSIVE_LOCKS_REQUIRED(lock_) {
-  auto search = decode_map_.find(symbol);
-  RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
-  return search->second->toStringView();
-}
-
-void SymbolTableImpl::newSymbol() EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+Symbol SymbolTableImpl::newSymbol() EXCLUSIVE_LOCKS_REQUIRED(symbol_lock_) {
   if (pool_.empty()) {
-    next_symbol_ = ++monotonic_counter_;
-  } else {
-    next_symbol_ = pool_.top();
-    pool_.pop();
+    // This should catch integer overflow for the new symbol.
+    ASSERT(monotonic_counter_ != 0);
+    return monotonic_counter_++;
   }
-  // This should catch integer overflow for the new symbol.
-  ASSERT(monotonic_counter_ != 0);
+  const Symbol symbol = pool_.top();
+  pool_.pop();
+  return symbol;
 }
 
 bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
@@ -424,16 +525,24 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  struct SymbolInfo {
+    Symbol symbol_;
+    std::string token_;
+    uint32_t ref_count_;
+  };
+  std::vector<SymbolInfo> symbols;
+  for (const Shard& shard : shards_) {
+    absl::ReaderMutexLock lock(&shard.lock_);
+    for (const auto& p : shard.encode_map_) {
+      symbols.push_back({p.second, std::string(p.first),
+                         decode_table_.refCount(p.second).load(std::memory_order_relaxed)});
+    }
   }
-  std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  std::sort(symbols.begin(), symbols.end(),
+            [](const SymbolInfo& a, const SymbolInfo& b) { return a.symbol_ < b.symbol_; });
+  for (const SymbolInfo& symbol_info : symbols) {
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol_info.symbol_, symbol_info.token_,
+                   symbol_info.ref_count_);
   }
 }
 #endif
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <stack>
@@ -24,6 +26,8 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Stats {
@@ -206,15 +210,82 @@ private:
   friend class StatNameTest;
   friend class StatNameDeathTest;
 
-  struct SharedSymbol {
-    SharedSymbol(Symbol symbol) : symbol_(symbol), ref_count_(1) {}
-
-    Symbol symbol_;
-    uint32_t ref_count_;
+  // The encode map stores the symbol of each string; its ref count is kept in the decode table.
+  // Using absl::string_view lets us only store the complete string once, in the decode table.
+  using EncodeMap = absl::flat_hash_map<absl::string_view, Symbol>;
+
+  // The encode map is split into shards by the hash of the token, each with its own lock, so that
+  // threads inserting or erasing different tokens do not contend. Existing tokens are looked up
+  // under a reader lock. Shards are on separate cache lines.
+  static constexpr uint32_t ShardBits = 4;
+  struct alignas(64) Shard {
+    mutable absl::Mutex lock_;
+    EncodeMap encode_map_ GUARDED_BY(lock_);
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  /**
+   * Maps symbols to their strings and ref counts. As symbols are allocated densely, from the free
+   * pool or else a counter, they index fixed size blocks of string pointers and ref counts. Blocks
+   * are never moved or freed until the table is destroyed, so symbols are decoded without any
+   * lock: the string of a symbol stays valid while the caller holds a StatName referencing it.
+   * Writes of strings must be serialized.
+   *
+   * The ref count of a symbol is only changed:
+   * - by a holder of a reference, to add one or to drop one which isn't the last, without a lock;
+   * - to add a reference found in the encode map, under a reader lock of its shard;
+   * - to drop what may be the last reference, under the writer lock of its shard.
+   * So a ref count only drops to zero under the writer lock, while no reference can be added.
+   */
+  class DecodeTable : NonCopyable {
+  public:
+    DecodeTable();
+    ~DecodeTable();
+
+    /**
+     * @param symbol the symbol to decode, which must have been set. RELEASE_ASSERTs otherwise.
+     * @return absl::string_view the string of the symbol.
+     */
+    absl::string_view get(Symbol symbol) const;
+
+    /**
+     * @param symbol a symbol which has been set.
+     * @return std::atomic<uint32_t>& the ref count of the symbol.
+     */
+    std::atomic<uint32_t>& refCount(Symbol symbol) const;
+
+    /**
+     * Sets the string of a symbol which has none, with a ref count of one.
+     */
+    void set(Symbol symbol, InlineStringPtr str);
+
+    /**
+     * Clears and destroys the string of a symbol.
+     */
+    void clear(Symbol symbol);
+
+  private:
+    static constexpr uint32_t BlockBits = 10;
+    static constexpr uint32_t BlockSize = 1 << BlockBits;
+
+    struct Block {
+      std::atomic<InlineString*> strings_[BlockSize];
+      mutable std::atomic<uint32_t> ref_counts_[BlockSize];
+    };
+    struct Directory {
+      explicit Directory(uint64_t size) : size_(size), blocks_(new std::atomic<Block*>[size]()) {}
+      const uint64_t size_;
+      const std::unique_ptr<std::atomic<Block*>[]> blocks_;
+    };
+
+    std::atomic<InlineString*>& slot(Symbol symbol);
+    const Block& block(Symbol symbol) const;
+
+    std::atomic<const Directory*> directory_;
+    // All the directories, including the ones replaced by larger ones, which readers may still be
+    // using, and all the blocks.
+    std::vector<std::unique_ptr<Directory>> directories_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+  };
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -234,23 +305,51 @@ private:
   /**
    * Convenience function for encode(), symbolizing one string segment at a time.
    *
+   * @param shard the shard of sv, @see shardFor().
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(Shard& shard, absl::string_view sv) EXCLUSIVE_LOCKS_REQUIRED(shard.lock_);
 
   /**
-   * Convenience function for decode(), decoding one symbol at a time.
+   * Adds a reference to the symbol of sv, if sv is in the encode map. Takes a reader lock.
+   *
+   * @param shard the shard of sv, @see shardFor().
+   * @param sv the individual string to look up.
+   * @return absl::optional<Symbol> the symbol of sv, or absl::nullopt if it has none.
+   */
+  absl::optional<Symbol> findSymbol(Shard& shard, absl::string_view sv);
+
+  /**
+   * Drops a reference to a symbol, releasing it if it was the last one.
+   *
+   * @param symbol the symbol, to which the caller holds a reference.
+   */
+  void freeSymbol(Symbol symbol);
+
+  /**
+   * Convenience function for decode(), decoding one symbol at a time. Takes no lock.
    *
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const { return decode_table_.get(symbol); }
+
+  /**
+   * @param sv a string segment.
+   * @return Shard& the shard of the encode map holding sv.
+   */
+  Shard& shardFor(absl::string_view sv);
 
   /**
-   * Stages a new symbol for use. To be called after a successful insertion.
+   * Allocates a symbol, from the free pool if it is not empty.
    */
-  void newSymbol();
+  Symbol newSymbol() EXCLUSIVE_LOCKS_REQUIRED(symbol_lock_);
+
+  /**
+   * Records a lookup of name for the recent lookups.
+   */
+  void recordLookup(absl::string_view name);
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -262,30 +361,34 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(symbol_lock_);
     return monotonic_counter_;
   }
 
-  // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
-  // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ GUARDED_BY(lock_);
+  std::array<Shard, 1 << ShardBits> shards_;
+
+  // Guards the allocation and release of symbols, and writes of strings to decode_table_. Only
+  // taken to create a symbol or to release one whose ref count dropped to zero, while holding the
+  // writer lock of the shard of its string.
+  mutable Thread::MutexBasicLockable symbol_lock_;
 
-  // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
+  // If the free pool is exhausted, we monotonically increase this counter. It holds the next
+  // symbol to allocate from it.
+  Symbol monotonic_counter_ GUARDED_BY(symbol_lock_);
 
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ GUARDED_BY(lock_);
-  DecodeMap decode_map_ GUARDED_BY(lock_);
+  DecodeTable decode_table_;
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ GUARDED_BY(symbol_lock_);
+
+  // Lookups are counted even while recent lookups are not tracked, which is when their capacity
+  // is zero, and then recent_lookups_lock_ is not taken.
+  std::atomic<uint64_t> num_lookups_{0};
+  std::atomic<bool> track_recent_lookups_{false};
+  mutable Thread::MutexBasicLockable recent_lookups_lock_;
+  RecentLookups recent_lookups_ GUARDED_BY(recent_lookups_lock_);
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
@@ -5,12 +5,14 @@
 
 #include "envoy/common/exception.h"
 
+#include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/common/perf_annotation.h"
 #include "common/common/regex.h"
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
 
 namespace Envoy {
 namespace Stats {
@@ -105,5 +107,93 @@ bool TagExtractorImpl::extractTag(absl::string_view stat_name, TagVector& tags,
   return false;
 }
 
+TagExtractorTokensImpl::TagExtractorTokensImpl(const std::string& name, const std::string& tokens)
+    : name_(name) {
+  uint32_t num_values = 0;
+  for (absl::string_view token : absl::StrSplit(tokens, '.')) {
+    if (token == "$") {
+      pattern_.push_back({TokenType::Value, ""});
+      ++num_values;
+    } else if (token == "*") {
+      pattern_.push_back({TokenType::AnyToken, ""});
+    } else if (token == "**") {
+      pattern_.push_back({TokenType::AnyTokens, ""});
+    } else {
+      pattern_.push_back({TokenType::Literal, std::string(token)});
+    }
+  }
+  ASSERT(num_values == 1);
+  if (pattern_.front().type_ == TokenType::Literal) {
+    prefix_ = pattern_.front().literal_;
+  }
+}
+
+bool TagExtractorTokensImpl::extractTag(absl::string_view stat_name, TagVector& tags,
+                                        IntervalSet<size_t>& remove_characters) const {
+  PERF_OPERATION(perf);
+
+  NameTokens name_tokens;
+  for (absl::string_view token : absl::StrSplit(stat_name, '.')) {
+    name_tokens.push_back(token);
+  }
+  size_t value_index = 0;
+  if (!match(name_tokens, 0, 0, value_index)) {
+    PERF_RECORD(perf, "tokens-miss", name_);
+    return false;
+  }
+
+  const absl::string_view value = name_tokens[value_index];
+  tags.emplace_back();
+  Tag& tag = tags.back();
+  tag.name_ = name_;
+  tag.value_ = std::string(value);
+
+  size_t start = value.data() - stat_name.data();
+  size_t end = start + value.size();
+  if (value_index + 1 < name_tokens.size()) {
+    ++end;
+  } else if (start > 0) {
+    --start;
+  }
+  remove_characters.insert(start, end);
+  PERF_RECORD(perf, "tokens-match", name_);
+  return true;
+}
+
+bool TagExtractorTokensImpl::match(const NameTokens& name_tokens, size_t name_index,
+                                   size_t pattern_index, size_t& value_index) const {
+  for (; pattern_index < pattern_.size(); ++pattern_index, ++name_index) {
+    const PatternToken& pattern_token = pattern_[pattern_index];
+    if (pattern_token.type_ == TokenType::AnyTokens) {
+      // Like the lazy ".*?" of a regex, try to match the rest of the pattern after as few tokens as
+      // possible, so that the value is captured at the same place.
+      for (size_t next = name_index; next <= name_tokens.size(); ++next) {
+        if (match(name_tokens, next, pattern_index + 1, value_index)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    if (name_index == name_tokens.size()) {
+      return false;
+    }
+    switch (pattern_token.type_) {
+    case TokenType::Literal:
+      if (name_tokens[name_index] != pattern_token.literal_) {
+        return false;
+      }
+      break;
+    case TokenType::Value:
+      value_index = name_index;
+      break;
+    case TokenType::AnyToken:
+      break;
+    case TokenType::AnyTokens:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+  }
+  return name_index == name_tokens.size();
+}
+
 } // namespace Stats
 } // namespace Envoy
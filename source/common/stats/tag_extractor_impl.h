@@ -3,9 +3,11 @@
 #include <cstdint>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include "envoy/stats/tag_extractor.h"
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -53,5 +55,54 @@ private:
   const std::regex regex_;
 };
 
+/**
+ * Extracts a tag by matching the '.' separated tokens of a stat name, the components StatNames are
+ * symbolized into, against a pattern of tokens, without regexes. Each token of the pattern is one
+ * of:
+ *   - "$", which matches any one token and captures it as the tag value. A pattern has exactly one.
+ *   - "*", which matches any one token.
+ *   - "**", which matches any number of tokens, including none, preferring as few as possible.
+ *   - any other token, which must be equal to the token of the name.
+ * The whole name must match. The captured token is removed from the name along with the '.'
+ * following it, or preceding it if it is the last token of the name. For example, the pattern
+ * "cluster.$.*.**" extracts "foo" from "cluster.foo.upstream_cx_total", which it reduces to
+ * "cluster.upstream_cx_total".
+ */
+class TagExtractorTokensImpl : public TagExtractor {
+public:
+  /**
+   * @param name name for tag extractor.
+   * @param tokens the pattern of '.' separated tokens.
+   */
+  TagExtractorTokensImpl(const std::string& name, const std::string& tokens);
+  std::string name() const override { return name_; }
+  bool extractTag(absl::string_view stat_name, TagVector& tags,
+                  IntervalSet<size_t>& remove_characters) const override;
+  absl::string_view prefixToken() const override { return prefix_; }
+
+private:
+  enum class TokenType { Literal, Value, AnyToken, AnyTokens };
+
+  struct PatternToken {
+    TokenType type_;
+    std::string literal_;
+  };
+
+  // The tokens of a stat name, which are few enough to not need a heap allocation in most cases.
+  using NameTokens = absl::InlinedVector<absl::string_view, 16>;
+
+  /**
+   * Matches the tokens of a name from name_index against the pattern from pattern_index.
+   * @param value_index receives the index of the token matching "$" if the tokens match.
+   * @return bool whether the tokens match.
+   */
+  bool match(const NameTokens& name_tokens, size_t name_index, size_t pattern_index,
+             size_t& value_index) const;
+
+  const std::string name_;
+  std::vector<PatternToken> pattern_;
+  std::string prefix_;
+};
+
 } // namespace Stats
 } // namespace Envoy
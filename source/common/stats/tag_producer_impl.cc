@@ -11,6 +11,17 @@
 namespace Envoy {
 namespace Stats {
 
+namespace {
+
+TagExtractorPtr createDefaultTagExtractor(const Config::TagNameValues::Descriptor& desc) {
+  if (desc.type_ == Config::TagNameValues::PatternType::Tokens) {
+    return std::make_unique<TagExtractorTokensImpl>(desc.name_, desc.regex_);
+  }
+  return TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_);
+}
+
+} // namespace
+
 TagProducerImpl::TagProducerImpl(const envoy::config::metrics::v3::StatsConfig& config) {
   // To check name conflict.
   reserveResources(config);
@@ -47,8 +58,7 @@ int TagProducerImpl::addExtractorsMatching(absl::string_view name) {
   int num_found = 0;
   for (const auto& desc : Config::TagNames::get().descriptorVec()) {
     if (desc.name_ == name) {
-      addExtractor(
-          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+      addExtractor(createDefaultTagExtractor(desc));
       ++num_found;
     }
   }
@@ -103,8 +113,7 @@ TagProducerImpl::addDefaultExtractors(const envoy::config::metrics::v3::StatsCon
   if (!config.has_use_all_default_tags() || config.use_all_default_tags().value()) {
     for (const auto& desc : Config::TagNames::get().descriptorVec()) {
       names.emplace(desc.name_);
-      addExtractor(
-          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+      addExtractor(createDefaultTagExtractor(desc));
     }
   }
   return names;
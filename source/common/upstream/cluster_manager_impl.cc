@@ -766,7 +766,7 @@ void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster&
       cluster_entry_it->second->thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
           cluster_reference.prioritySet(), cluster_reference.info()->stats(),
           cluster_reference.info()->statsScope(), runtime_, random_,
-          cluster_reference.info()->lbConfig());
+          cluster_reference.info()->lbMaglevConfig(), cluster_reference.info()->lbConfig());
     }
   } else if (cluster_reference.info()->lbType() == LoadBalancerType::ClusterProvided) {
     cluster_entry_it->second->thread_aware_lb_ = std::move(new_cluster_pair.second);
@@ -852,13 +852,12 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, ui
                                                       const HostVector& hosts_removed) {
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
 
-  tls_->runOnAllThreads([this, name = cluster.info()->name(), priority,
-                         update_params = HostSetImpl::updateHostsParams(*host_set),
-                         locality_weights = host_set->localityWeights(), hosts_added, hosts_removed,
-                         overprovisioning_factor = host_set->overprovisioningFactor()]() {
-    ThreadLocalClusterManagerImpl::updateClusterMembership(
-        name, priority, update_params, locality_weights, hosts_added, hosts_removed, *tls_,
-        overprovisioning_factor);
+  // The update is built once and shared by all workers. The posted callback is copied for every
+  // worker, so it must not capture anything which is O(hosts) to copy.
+  ThreadLocalClusterUpdateConstSharedPtr update =
+      std::make_shared<const ThreadLocalClusterUpdate>(*host_set, hosts_added, hosts_removed);
+  tls_->runOnAllThreads([this, name = cluster.info()->name(), update]() {
+    ThreadLocalClusterManagerImpl::updateClusterMembership(name, *update, *tls_);
   });
 }
 
@@ -1116,24 +1115,25 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeHosts(const std::s
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
-    const std::string& name, uint32_t priority, PrioritySet::UpdateHostsParams update_hosts_params,
-    LocalityWeightsConstSharedPtr locality_weights, const HostVector& hosts_added,
-    const HostVector& hosts_removed, ThreadLocal::Slot& tls, uint64_t overprovisioning_factor) {
+    const std::string& name, const ThreadLocalClusterUpdate& update, ThreadLocal::Slot& tls) {
   ThreadLocalClusterManagerImpl& config = tls.getTyped<ThreadLocalClusterManagerImpl>();
 
   ASSERT(config.thread_local_clusters_.find(name) != config.thread_local_clusters_.end());
   const auto& cluster_entry = config.thread_local_clusters_[name];
   ENVOY_LOG(debug, "membership update for TLS cluster {} added {} removed {}", name,
-            hosts_added.size(), hosts_removed.size());
-  cluster_entry->priority_set_.updateHosts(priority, std::move(update_hosts_params),
-                                           std::move(locality_weights), hosts_added, hosts_removed,
-                                           overprovisioning_factor);
+            update.hostsAdded().size(), update.hostsRemoved().size());
+  update.applyTo(cluster_entry->priority_set_);
 
   // If an LB is thread aware, create a new worker local LB on membership changes.
   if (cluster_entry->lb_factory_ != nullptr) {
     ENVOY_LOG(debug, "re-creating local LB for TLS cluster {}", name);
     cluster_entry->lb_ = cluster_entry->lb_factory_->create();
   }
+
+  // Hosts which became healthy are not among the added hosts, so all the hosts of the priority are
+  // warmed. This is a no-op unless the cluster keeps warm connections.
+  cluster_entry->warmConnPools(
+      cluster_entry->priority_set_.hostSetsPerPriority()[update.priority()]->hosts());
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
@@ -1216,8 +1216,8 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     lb_ = std::make_unique<SubsetLoadBalancer>(
         cluster->lbType(), priority_set_, parent_.local_priority_set_, cluster->stats(),
         cluster->statsScope(), parent.parent_.runtime_, parent.parent_.random_,
-        cluster->lbSubsetInfo(), cluster->lbRingHashConfig(), cluster->lbLeastRequestConfig(),
-        cluster->lbConfig());
+        cluster->lbSubsetInfo(), cluster->lbRingHashConfig(), cluster->lbMaglevConfig(),
+        cluster->lbLeastRequestConfig(), cluster->lbConfig());
   } else {
     switch (cluster->lbType()) {
     case LoadBalancerType::LeastRequest: {
@@ -1275,6 +1275,13 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     return nullptr;
   }
 
+  return hostConnPool(host, priority, protocol, context);
+}
+
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::hostConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority, Http::Protocol protocol,
+    LoadBalancerContext* context) {
   std::vector<uint8_t> hash_key = {uint8_t(protocol)};
 
   Network::Socket::OptionsSharedPtr upstream_options(std::make_shared<Network::Socket::Options>());
@@ -1318,6 +1325,30 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
   }
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::warmConnPools(
+    const HostVector& hosts) {
+  // Only the pools which use neither the downstream protocol nor socket options from the
+  // downstream connection are known before the first request.
+  if (cluster_info_->minWarmConnections() == 0 ||
+      (cluster_info_->features() & ClusterInfo::Features::USE_DOWNSTREAM_PROTOCOL)) {
+    return;
+  }
+
+  const Http::Protocol protocol = cluster_info_->upstreamHttpProtocol(absl::nullopt);
+  for (const HostSharedPtr& host : hosts) {
+    if (host->health() != Host::Health::Healthy) {
+      continue;
+    }
+    // A new pool establishes its warm connections when it is created, while an existing one may
+    // have lost them while the host was unhealthy.
+    Http::ConnectionPool::Instance* pool =
+        hostConnPool(host, ResourcePriority::Default, protocol, nullptr);
+    if (pool != nullptr) {
+      pool->maybePrefetch();
+    }
+  }
+}
+
 Tcp::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     ResourcePriority priority, LoadBalancerContext* context) {
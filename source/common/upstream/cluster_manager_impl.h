@@ -183,6 +183,47 @@ struct ClusterManagerStats {
   ALL_CLUSTER_MANAGER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
 };
 
+/**
+ * A membership update for one priority of a cluster, posted from the main thread to every worker.
+ * The host vectors are the main thread host set's immutable snapshots and the added and removed
+ * hosts are copied once, so a single update is shared by all workers and posting it costs one
+ * reference count per worker regardless of the size of the cluster.
+ */
+class ThreadLocalClusterUpdate {
+public:
+  ThreadLocalClusterUpdate(const HostSet& host_set, const HostVector& hosts_added,
+                           const HostVector& hosts_removed)
+      : priority_(host_set.priority()),
+        update_hosts_params_(HostSetImpl::updateHostsParams(host_set)),
+        locality_weights_(host_set.localityWeights()), hosts_added_(hosts_added),
+        hosts_removed_(hosts_removed),
+        overprovisioning_factor_(host_set.overprovisioningFactor()) {}
+
+  /**
+   * Apply the update to a priority set, which shares the host vectors of the update.
+   * @param priority_set supplies the priority set to update.
+   */
+  void applyTo(PrioritySetImpl& priority_set) const {
+    priority_set.updateHosts(priority_, PrioritySet::UpdateHostsParams(update_hosts_params_),
+                             locality_weights_, hosts_added_, hosts_removed_,
+                             overprovisioning_factor_);
+  }
+
+  uint32_t priority() const { return priority_; }
+  const HostVector& hostsAdded() const { return hosts_added_; }
+  const HostVector& hostsRemoved() const { return hosts_removed_; }
+
+private:
+  const uint32_t priority_;
+  const PrioritySet::UpdateHostsParams update_hosts_params_;
+  const LocalityWeightsConstSharedPtr locality_weights_;
+  const HostVector hosts_added_;
+  const HostVector hosts_removed_;
+  const uint32_t overprovisioning_factor_;
+};
+
+using ThreadLocalClusterUpdateConstSharedPtr = std::shared_ptr<const ThreadLocalClusterUpdate>;
+
 /**
  * Implementation of ClusterManager that reads from a proto configuration, maintains a central
  * cluster list, as well as thread local caches of each cluster and associated connection pools.
@@ -329,6 +370,16 @@ private:
       Http::ConnectionPool::Instance* connPool(ResourcePriority priority, Http::Protocol protocol,
                                                LoadBalancerContext* context);
 
+      // Returns the pool of the given host for the protocol and the options of the context,
+      // creating it if needed.
+      Http::ConnectionPool::Instance* hostConnPool(const HostConstSharedPtr& host,
+                                                   ResourcePriority priority,
+                                                   Http::Protocol protocol,
+                                                   LoadBalancerContext* context);
+
+      // Establishes the warm connections of the default pools of the given healthy hosts.
+      void warmConnPools(const HostVector& hosts);
+
       Tcp::ConnectionPool::Instance* tcpConnPool(ResourcePriority priority,
                                                  LoadBalancerContext* context);
 
@@ -361,12 +412,9 @@ private:
     void removeTcpConn(const HostConstSharedPtr& host, Network::ClientConnection& connection);
     static void removeHosts(const std::string& name, const HostVector& hosts_removed,
                             ThreadLocal::Slot& tls);
-    static void updateClusterMembership(const std::string& name, uint32_t priority,
-                                        PrioritySet::UpdateHostsParams update_hosts_params,
-                                        LocalityWeightsConstSharedPtr locality_weights,
-                                        const HostVector& hosts_added,
-                                        const HostVector& hosts_removed, ThreadLocal::Slot& tls,
-                                        uint64_t overprovisioning_factor);
+    static void updateClusterMembership(const std::string& name,
+                                        const ThreadLocalClusterUpdate& update,
+                                        ThreadLocal::Slot& tls);
     static void onHostHealthFailure(const HostSharedPtr& host, ThreadLocal::Slot& tls);
 
     ConnPoolsContainer* getHttpConnPoolsContainer(const HostConstSharedPtr& host,
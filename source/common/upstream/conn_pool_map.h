@@ -27,8 +27,9 @@ public:
               ResourcePriority priority);
   ~ConnPoolMap();
   /**
-   * Returns an existing pool for `key`, or creates a new one using `factory`. Note that it is
-   * possible for this to fail if a limit on the number of pools allowed is reached.
+   * Returns an existing pool for `key`, or creates a new one using `factory` and asks it to
+   * establish its warm connections. Note that it is possible for this to fail if a limit on the
+   * number of pools allowed is reached.
    * @return The pool corresponding to `key`, or `absl::nullopt`.
    */
   PoolOptRef getPool(KEY_TYPE key, const PoolFactory& factory);
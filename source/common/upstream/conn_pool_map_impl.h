@@ -55,6 +55,8 @@ ConnPoolMap<KEY_TYPE, POOL_TYPE>::getPool(KEY_TYPE key, const PoolFactory& facto
   for (const auto& cb : cached_callbacks_) {
     new_pool->addDrainedCallback(cb);
   }
+  // Establish the warm connections of the new pool, unless it is being drained.
+  new_pool->maybePrefetch();
 
   auto inserted = active_pools_.emplace(key, std::move(new_pool));
   return std::ref(*inserted.first->second);
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <queue>
+#include <vector>
 
 #include "common/common/assert.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -32,25 +38,31 @@ public:
    */
   std::shared_ptr<C> pick() {
     EDF_TRACE("Queue pick: queue_.size()={}, current_time_={}.", queue_.size(), current_time_);
-    while (true) {
-      if (queue_.empty()) {
-        EDF_TRACE("Queue is empty.");
-        return nullptr;
-      }
-      const EdfEntry& edf_entry = queue_.top();
-      // Entry has been removed, let's see if there's another one.
-      if (edf_entry.entry_.expired()) {
-        EDF_TRACE("Entry has expired, repick.");
-        queue_.pop();
-        continue;
-      }
-      std::shared_ptr<C> ret{edf_entry.entry_};
-      ASSERT(edf_entry.deadline_ >= current_time_);
-      current_time_ = edf_entry.deadline_;
+    std::shared_ptr<C> ret = popExpired();
+    if (ret != nullptr) {
       queue_.pop();
-      EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()), current_time_);
-      return ret;
+      EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()),
+                current_time_);
+    }
+    return ret;
+  }
+
+  /**
+   * Pick queue entry with closest deadline and add it back to the queue with a new weight. This is
+   * equivalent to pick() followed by add().
+   * @param calculate_weight supplies the new weight of the picked entry.
+   * @return std::shared_ptr<C> to the queue entry if a valid entry exists in the queue, nullptr
+   *         otherwise.
+   */
+  std::shared_ptr<C> pickAndAdd(const std::function<double(const C&)>& calculate_weight) {
+    EDF_TRACE("Queue pick and add: queue_.size()={}, current_time_={}.", queue_.size(),
+              current_time_);
+    std::shared_ptr<C> ret = popExpired();
+    if (ret != nullptr) {
+      queue_.pop();
+      add(calculate_weight(*ret), ret);
     }
+    return ret;
   }
 
   /**
@@ -73,6 +85,11 @@ public:
    */
   bool empty() const { return queue_.empty(); }
 
+  /**
+   * @return size_t the number of entries in the internal queue, including expired entries.
+   */
+  size_t size() const { return queue_.size(); }
+
 private:
   struct EdfEntry {
     double deadline_;
@@ -89,6 +106,26 @@ private:
     }
   };
 
+  // Discards expired entries at the top of the queue and returns the first valid one, advancing
+  // current_time_ to its deadline. The entry is left at the top of the queue.
+  std::shared_ptr<C> popExpired() {
+    while (!queue_.empty()) {
+      const EdfEntry& edf_entry = queue_.top();
+      std::shared_ptr<C> ret = edf_entry.entry_.lock();
+      // Entry has been removed, let's see if there's another one.
+      if (ret == nullptr) {
+        EDF_TRACE("Entry has expired, repick.");
+        queue_.pop();
+        continue;
+      }
+      ASSERT(edf_entry.deadline_ >= current_time_);
+      current_time_ = edf_entry.deadline_;
+      return ret;
+    }
+    EDF_TRACE("Queue is empty.");
+    return nullptr;
+  }
+
   // Current time in EDF scheduler.
   // TODO(htuch): Is it worth the small extra complexity to use integer time for performance
   // reasons?
@@ -100,6 +137,153 @@ private:
   std::priority_queue<EdfEntry> queue_;
 };
 
+// EDF scheduler with the same scheduling behavior as EdfScheduler, for a set of entries which only
+// changes through update(). Entries are identified by their position in the vector supplied to
+// the last update() and the scheduler holds no references to them, so a pick performs no atomic
+// reference count operations and no allocations. The queue is a 4-ary min heap of small trivially
+// copyable entries, which keeps it shallow and the children of a node in a single cache line.
+//
+// The caller must call update() whenever the vector of entries changes, and the entries passed to
+// update() must remain alive until the next call to update(). Host sets satisfy this, since load
+// balancers are notified of every host set change before the previous hosts may be released.
+template <class C> class IndexedEdfScheduler {
+public:
+  /**
+   * Bring the schedule in line with entries. Entries which were already in the schedule keep their
+   * deadline. If their weight has changed, the time remaining until the deadline is scaled by the
+   * ratio of the old and new weights, so that the entry keeps its progress. New entries
+   * get a deadline of current_time_ + 1 / weight. Entries which are no longer present are removed.
+   * This is O(n) in the number of entries.
+   * @param entries supplies the entries to schedule. Each entry may appear at most once.
+   * @param calculate_weight supplies a callable taking const C& and returning its weight.
+   */
+  template <class CalculateWeight>
+  void update(const std::vector<std::shared_ptr<C>>& entries, CalculateWeight calculate_weight) {
+    absl::flat_hash_map<const C*, uint32_t> previous_entries;
+    previous_entries.reserve(queue_.size());
+    for (uint32_t i = 0; i < queue_.size(); ++i) {
+      previous_entries.emplace(entries_[queue_[i].index_], i);
+    }
+
+    std::vector<EdfEntry> queue;
+    queue.reserve(entries.size());
+    std::vector<double> weights(entries.size());
+    entries_.resize(entries.size());
+    for (uint32_t index = 0; index < entries.size(); ++index) {
+      const C* entry = entries[index].get();
+      const double weight = calculate_weight(*entry);
+      ASSERT(weight > 0);
+      auto it = previous_entries.find(entry);
+      if (it != previous_entries.end()) {
+        const EdfEntry& previous = queue_[it->second];
+        const double previous_weight = weights_[previous.index_];
+        queue.push_back({current_time_ + (previous.deadline_ - current_time_) * previous_weight /
+                                             weight,
+                         previous.order_offset_, index});
+      } else {
+        queue.push_back({current_time_ + 1.0 / weight, order_offset_++, index});
+      }
+      entries_[index] = entry;
+      weights[index] = weight;
+    }
+    queue_ = std::move(queue);
+    weights_ = std::move(weights);
+
+    if (queue_.size() > 1) {
+      for (size_t i = (queue_.size() - 2) / Arity + 1; i > 0; --i) {
+        siftDown(i - 1);
+      }
+    }
+    EDF_TRACE("Updated queue: queue_.size()={}, current_time_={}.", queue_.size(), current_time_);
+  }
+
+  /**
+   * Pick queue entry with closest deadline and add it back to the queue with a new weight.
+   * @param calculate_weight supplies a callable taking const C& and returning the new weight of
+   *        the picked entry.
+   * @return uint32_t the index of the picked entry in the entries passed to the last update().
+   *         The queue must not be empty.
+   */
+  template <class CalculateWeight> uint32_t pickAndAdd(CalculateWeight calculate_weight) {
+    ASSERT(!queue_.empty());
+    EdfEntry& edf_entry = queue_.front();
+    ASSERT(edf_entry.deadline_ >= current_time_);
+    current_time_ = edf_entry.deadline_;
+    const uint32_t index = edf_entry.index_;
+    const double weight = calculate_weight(*entries_[index]);
+    ASSERT(weight > 0);
+    weights_[index] = weight;
+    edf_entry.deadline_ = current_time_ + 1.0 / weight;
+    edf_entry.order_offset_ = order_offset_++;
+    siftDown(0);
+    EDF_TRACE("Picked {}, current_time_={}, new weight {}.", index, current_time_, weight);
+    return index;
+  }
+
+  /**
+   * @return bool whether or not the queue is empty.
+   */
+  bool empty() const { return queue_.empty(); }
+
+  /**
+   * @return size_t the number of entries in the queue.
+   */
+  size_t size() const { return queue_.size(); }
+
+private:
+  static constexpr size_t Arity = 4;
+
+  struct EdfEntry {
+    double deadline_;
+    // Tie breaker for entries with the same deadline. This is used to provide FIFO behavior.
+    uint64_t order_offset_;
+    // Index into entries_ and weights_.
+    uint32_t index_;
+  };
+
+  static bool before(const EdfEntry& a, const EdfEntry& b) {
+    return a.deadline_ < b.deadline_ ||
+           (a.deadline_ == b.deadline_ && a.order_offset_ < b.order_offset_);
+  }
+
+  void siftDown(size_t index) {
+    const EdfEntry edf_entry = queue_[index];
+    const size_t size = queue_.size();
+    while (true) {
+      const size_t first_child = Arity * index + 1;
+      if (first_child >= size) {
+        break;
+      }
+      size_t child = first_child;
+      const size_t last_child = std::min(first_child + Arity, size);
+      for (size_t i = first_child + 1; i < last_child; ++i) {
+        if (before(queue_[i], queue_[child])) {
+          child = i;
+        }
+      }
+      if (!before(queue_[child], edf_entry)) {
+        break;
+      }
+      queue_[index] = queue_[child];
+      index = child;
+    }
+    queue_[index] = edf_entry;
+  }
+
+  // Current time in EDF scheduler.
+  double current_time_{};
+  // Offset used during addition to break ties when entries have the same weight but should reflect
+  // FIFO insertion order in picks.
+  uint64_t order_offset_{};
+  // 4-ary min heap for EDF, ordered by (deadline_, order_offset_).
+  std::vector<EdfEntry> queue_;
+  // Entries passed to the last update(), used only to identify entries across updates and to
+  // calculate weights.
+  std::vector<const C*> entries_;
+  // Last weight of each entry.
+  std::vector<double> weights_;
+};
+
 #undef EDF_DEBUG
 
 } // namespace Upstream
@@ -35,6 +35,7 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
           PROTOBUF_GET_MS_OR_DEFAULT(config, unhealthy_edge_interval, unhealthy_interval_.count())),
       healthy_edge_interval_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())),
+      timer_wheel_(initTimerWheel(config, dispatcher)),
       transport_socket_options_(initTransportSocketOptions(config)),
       transport_socket_match_metadata_(initTransportSocketMatchMetadata(config)) {
   cluster_.prioritySet().addMemberUpdateCb(
@@ -70,6 +71,22 @@ MetadataConstSharedPtr HealthCheckerImplBase::initTransportSocketMatchMetadata(
   return nullptr;
 }
 
+std::unique_ptr<Event::TimerWheel>
+HealthCheckerImplBase::initTimerWheel(const envoy::config::core::v3::HealthCheck& config,
+                                      Event::Dispatcher& dispatcher) {
+  if (config.has_timer_wheel_granularity()) {
+    return std::make_unique<Event::TimerWheel>(
+        dispatcher, std::chrono::milliseconds(
+                        DurationUtil::durationToMilliseconds(config.timer_wheel_granularity())));
+  }
+
+  return nullptr;
+}
+
+Event::TimerPtr HealthCheckerImplBase::createTimer(const Event::TimerCb& cb) {
+  return timer_wheel_ != nullptr ? timer_wheel_->createTimer(cb) : dispatcher_.createTimer(cb);
+}
+
 HealthCheckerImplBase::~HealthCheckerImplBase() {
   // ASSERTs inside the session destructor check to make sure we have been previously deferred
   // deleted. Unify that logic here before actual destruction happens.
@@ -247,8 +264,8 @@ void HealthCheckerImplBase::start() {
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
     HealthCheckerImplBase& parent, HostSharedPtr host)
     : host_(host), parent_(parent),
-      interval_timer_(parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
-      timeout_timer_(parent.dispatcher_.createTimer([this]() -> void { onTimeoutBase(); })) {
+      interval_timer_(parent.createTimer([this]() -> void { onIntervalBase(); })),
+      timeout_timer_(parent.createTimer([this]() -> void { onTimeoutBase(); })) {
 
   if (!host->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
     parent.incHealthy();
@@ -11,6 +11,7 @@
 
 #include "common/common/logger.h"
 #include "common/common/matchers.h"
+#include "common/event/timer_wheel.h"
 #include "common/network/transport_socket_options_impl.h"
 
 namespace Envoy {
@@ -126,6 +127,7 @@ private:
   };
 
   void addHosts(const HostVector& hosts);
+  Event::TimerPtr createTimer(const Event::TimerCb& cb);
   void decHealthy();
   void decDegraded();
   HealthCheckerStats generateStats(Stats::Scope& scope);
@@ -142,6 +144,8 @@ private:
   initTransportSocketOptions(const envoy::config::core::v3::HealthCheck& config);
   static MetadataConstSharedPtr
   initTransportSocketMatchMetadata(const envoy::config::core::v3::HealthCheck& config);
+  static std::unique_ptr<Event::TimerWheel>
+  initTimerWheel(const envoy::config::core::v3::HealthCheck& config, Event::Dispatcher& dispatcher);
 
   static const std::chrono::milliseconds NO_TRAFFIC_INTERVAL;
 
@@ -154,6 +158,8 @@ private:
   const std::chrono::milliseconds unhealthy_interval_;
   const std::chrono::milliseconds unhealthy_edge_interval_;
   const std::chrono::milliseconds healthy_edge_interval_;
+  // Drives the session timers if configured. Must outlive the sessions.
+  const std::unique_ptr<Event::TimerWheel> timer_wheel_;
   std::unordered_map<HostSharedPtr, ActiveHealthCheckSessionPtr> active_sessions_;
   uint64_t local_process_healthy_{};
   uint64_t local_process_degraded_{};
@@ -0,0 +1,102 @@
+#include "common/upstream/host_bitmap.h"
+
+#include <algorithm>
+#include <bitset>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+HostBitmap::HostBitmap(std::vector<uint32_t>&& indices, uint32_t size)
+    : size_(size), cardinality_(indices.size()) {
+  ASSERT(std::is_sorted(indices.begin(), indices.end()));
+  ASSERT(indices.empty() || indices.back() < size);
+  if (useArray(cardinality_, size_)) {
+    array_ = std::move(indices);
+    array_.shrink_to_fit();
+    return;
+  }
+
+  words_.resize((size_ + 63) / 64);
+  for (const uint32_t index : indices) {
+    words_[index / 64] |= uint64_t(1) << (index % 64);
+  }
+}
+
+bool HostBitmap::contains(uint32_t index) const {
+  if (dense()) {
+    return index < size_ && (words_[index / 64] >> (index % 64)) & 1;
+  }
+  return std::binary_search(array_.begin(), array_.end(), index);
+}
+
+HostBitmap HostBitmap::intersect(const HostBitmap& other) const {
+  ASSERT(size_ == other.size_ || empty() || other.empty());
+  HostBitmap result;
+  result.size_ = size_;
+  if (empty() || other.empty()) {
+    return result;
+  }
+
+  if (dense() && other.dense()) {
+    std::vector<uint64_t> words(words_.size());
+    uint32_t cardinality = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+      words[i] = words_[i] & other.words_[i];
+      cardinality += std::bitset<64>(words[i]).count();
+    }
+    result.setWords(std::move(words), cardinality);
+    return result;
+  }
+
+  // At least one side is an array, so the result is small enough to be an array too.
+  const HostBitmap& array_side = dense() ? other : *this;
+  const HostBitmap& other_side = dense() ? *this : other;
+  if (other_side.dense()) {
+    for (const uint32_t index : array_side.array_) {
+      if (other_side.contains(index)) {
+        result.array_.push_back(index);
+      }
+    }
+  } else {
+    std::set_intersection(array_side.array_.begin(), array_side.array_.end(),
+                          other_side.array_.begin(), other_side.array_.end(),
+                          std::back_inserter(result.array_));
+  }
+  result.cardinality_ = result.array_.size();
+  return result;
+}
+
+std::vector<uint32_t> HostBitmap::indices() const {
+  if (!dense()) {
+    return array_;
+  }
+
+  std::vector<uint32_t> indices;
+  indices.reserve(cardinality_);
+  for (size_t i = 0; i < words_.size(); ++i) {
+    for (uint32_t bit = 0; bit < 64 && words_[i] >> bit != 0; ++bit) {
+      if ((words_[i] >> bit) & 1) {
+        indices.push_back(i * 64 + bit);
+      }
+    }
+  }
+  return indices;
+}
+
+void HostBitmap::setWords(std::vector<uint64_t>&& words, uint32_t cardinality) {
+  cardinality_ = cardinality;
+  if (cardinality_ == 0) {
+    return;
+  }
+  words_ = std::move(words);
+  if (useArray(cardinality_, size_)) {
+    array_ = indices();
+    words_.clear();
+    words_.shrink_to_fit();
+  }
+}
+
+} // namespace Upstream
+} // namespace Envoy
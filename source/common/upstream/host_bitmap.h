@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * A set of host indices in [0, size). Like a roaring bitmap container, small sets are stored as
+ * a sorted array of indices and large ones as one bit per host, whichever takes less memory.
+ */
+class HostBitmap {
+public:
+  HostBitmap() = default;
+
+  /**
+   * @param indices strictly increasing host indices, all less than size.
+   * @param size the number of hosts the indices refer to.
+   */
+  HostBitmap(std::vector<uint32_t>&& indices, uint32_t size);
+
+  /**
+   * @return whether the host at index is in the set.
+   */
+  bool contains(uint32_t index) const;
+
+  /**
+   * @return the number of hosts in the set.
+   */
+  uint32_t cardinality() const { return cardinality_; }
+  bool empty() const { return cardinality_ == 0; }
+
+  /**
+   * @return whether the set uses one bit per host rather than an array of indices.
+   */
+  bool dense() const { return !words_.empty(); }
+
+  /**
+   * @return the hosts in both this set and other, which must refer to the same hosts.
+   */
+  HostBitmap intersect(const HostBitmap& other) const;
+
+  /**
+   * @return the indices of the hosts in the set, in increasing order.
+   */
+  std::vector<uint32_t> indices() const;
+
+private:
+  // An array of 32 bit indices is smaller than a bitmap while fewer than 1/32 of the hosts are
+  // in the set.
+  static bool useArray(uint32_t cardinality, uint32_t size) {
+    return uint64_t(cardinality) * 32 < size;
+  }
+
+  void setWords(std::vector<uint64_t>&& words, uint32_t cardinality);
+
+  uint32_t size_{};
+  uint32_t cardinality_{};
+  // Exactly one of these is non-empty unless the set is empty.
+  std::vector<uint32_t> array_;
+  std::vector<uint64_t> words_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
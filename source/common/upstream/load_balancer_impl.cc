@@ -699,10 +699,9 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
                                 common_config),
       seed_(random_.random()) {
-  // We fully recompute the schedulers for a given host set here on membership change, which is
-  // consistent with what other LB implementations do (e.g. thread aware).
-  // The downside of a full recompute is that time complexity is O(n * log n),
-  // so we will need to do better at delta tracking to scale (see
+  // We update the schedulers for a given host set here on membership change. Existing schedulers
+  // are updated in place, keeping the deadlines of the hosts which remain. An update is still O(n)
+  // in the number of hosts of the host source, but avoids the O(n * log n) rebuild (see
   // https://github.com/envoyproxy/envoy/issues/2874).
   priority_set.addPriorityUpdateCb(
       [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
@@ -716,8 +715,7 @@ void EdfLoadBalancerBase::initialize() {
 
 void EdfLoadBalancerBase::refresh(uint32_t priority) {
   const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
+    auto& scheduler = scheduler_[source];
     refreshHostSource(source);
 
     // Check if the original host weights are equal and skip EDF creation if they are. When all
@@ -725,31 +723,37 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // least-loaded host selection with lower memory and CPU overhead.
     if (hostWeightsAreEqual(hosts)) {
       // Skip edf creation.
+      scheduler.edf_.reset();
       return;
     }
 
-    scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
+    // We use the current weight here. While the weight may change without
+    // notification, this will only be stale until this host is next picked,
+    // at which point it is reinserted into the schedule with its new weight
+    // in chooseHost().
+    const auto calculate_weight = [this](const Host& host) { return hostWeight(host); };
+
+    // If there is an existing schedule, update it in place. This keeps the deadlines of hosts which
+    // remain in the host source, so an update neither resets nor biases the existing schedule.
+    if (scheduler.edf_ != nullptr) {
+      scheduler.edf_->update(hosts, calculate_weight);
+      return;
+    }
 
     // Populate scheduler with host list.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
     // weighted 1. This is because currently we don't refresh host sets if only weights change.
     // We should probably change this to refresh at all times. See the comment in
     // BaseDynamicClusterImpl::updateDynamicHostList about this.
-    for (const auto& host : hosts) {
-      // We use a fixed weight here. While the weight may change without
-      // notification, this will only be stale until this host is next picked,
-      // at which point it is reinserted into the EdfScheduler with its new
-      // weight in chooseHost().
-      scheduler.edf_->add(hostWeight(*host), host);
-    }
+    scheduler.edf_ = std::make_unique<IndexedEdfScheduler<Host>>();
+    scheduler.edf_->update(hosts, calculate_weight);
 
     // Cycle through hosts to achieve the intended offset behavior.
     // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
     // refreshes for the weighted case.
     if (!hosts.empty()) {
       for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
-        auto host = scheduler.edf_->pick();
-        scheduler.edf_->add(hostWeight(*host), host);
+        scheduler.edf_->pickAndAdd(calculate_weight);
       }
     }
   };
@@ -790,14 +794,16 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   // BaseDynamicClusterImpl::updateDynamicHostList, we must do a runtime pivot here to determine
   // whether to use EDF or do unweighted (fast) selection. EDF is non-null iff the original weights
   // of 2 or more hosts differ.
+  const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
   if (scheduler.edf_ != nullptr) {
-    auto host = scheduler.edf_->pick();
-    if (host != nullptr) {
-      scheduler.edf_->add(hostWeight(*host), host);
+    // The schedule is updated on every host set change, so it indexes the current hosts_to_use.
+    ASSERT(scheduler.edf_->size() == hosts_to_use.size());
+    if (scheduler.edf_->empty()) {
+      return nullptr;
     }
-    return host;
+    return hosts_to_use[scheduler.edf_->pickAndAdd(
+        [this](const Host& host) { return hostWeight(host); })];
   } else {
-    const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
     if (hosts_to_use.empty()) {
       return nullptr;
     }
@@ -332,7 +332,7 @@ private:
 
 /**
  * Base implementation of LoadBalancer that performs weighted RR selection across the hosts in the
- * cluster. This scheduler respects host weighting and utilizes an EdfScheduler to achieve O(log
+ * cluster. This scheduler respects host weighting and utilizes an EDF scheduler to achieve O(log
  * n) pick and insertion time complexity, O(n) memory use. The key insight is that if we schedule
  * with 1 / weight deadline, we will achieve the desired pick frequency for weighted RR in a given
  * interval. Naive implementations of weighted RR are either O(n) pick time or O(m * n) memory use,
@@ -359,10 +359,10 @@ public:
 
 protected:
   struct Scheduler {
-    // EdfScheduler for weighted LB. The edf_ is only created when the original
-    // host weights of 2 or more hosts differ. When not present, the
+    // EDF scheduler for weighted LB, indexing the hosts of the host source. The edf_ is only
+    // created when the original host weights of 2 or more hosts differ. When not present, the
     // implementation of chooseHostOnce falls back to unweightedHostPick.
-    std::unique_ptr<EdfScheduler<const Host>> edf_;
+    std::unique_ptr<IndexedEdfScheduler<Host>> edf_;
   };
 
   void initialize();
@@ -526,7 +526,10 @@ public:
         default_subset_(subset_config.default_subset()),
         locality_weight_aware_(subset_config.locality_weight_aware()),
         scale_locality_weight_(subset_config.scale_locality_weight()),
-        panic_mode_any_(subset_config.panic_mode_any()), list_as_any_(subset_config.list_as_any()) {
+        panic_mode_any_(subset_config.panic_mode_any()), list_as_any_(subset_config.list_as_any()),
+        bitmap_index_(subset_config.has_bitmap_index()),
+        bitmap_index_max_cached_subsets_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+            subset_config.bitmap_index(), max_cached_subsets, 64)) {
     for (const auto& subset : subset_config.subset_selectors()) {
       if (!subset.keys().empty()) {
         subset_selectors_.emplace_back(std::make_shared<SubsetSelectorImpl>(
@@ -549,6 +552,8 @@ public:
   bool scaleLocalityWeight() const override { return scale_locality_weight_; }
   bool panicModeAny() const override { return panic_mode_any_; }
   bool listAsAny() const override { return list_as_any_; }
+  bool bitmapIndex() const override { return bitmap_index_; }
+  uint32_t bitmapIndexMaxCachedSubsets() const override { return bitmap_index_max_cached_subsets_; }
 
 private:
   const bool enabled_;
@@ -560,6 +565,8 @@ private:
   const bool scale_locality_weight_;
   const bool panic_mode_any_;
   const bool list_as_any_;
+  const bool bitmap_index_;
+  const uint32_t bitmap_index_max_cached_subsets_;
 };
 
 } // namespace Upstream
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
@@ -28,7 +31,13 @@ struct MaglevLoadBalancerStats {
  * This is an implementation of Maglev consistent hashing as described in:
  * https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/44824.pdf
  * section 3.4. Specifically, the algorithm shown in pseudocode listing 1 is implemented with a
- * fixed table size of 65537. This is the recommended table size in section 5.3.
+ * configurable prime table size which defaults to 65537. This is the recommended table size in
+ * section 5.3.
+ *
+ * The table stores indices into a per-host array rather than host pointers. Tables for fewer than
+ * 65535 hosts use 16-bit indices, larger ones use 32-bit indices. This keeps the table small enough
+ * to stay cache resident at the default size, lets it scale to millions of entries, and means a
+ * rebuild only copies one HostConstSharedPtr per host instead of one per table entry.
  */
 class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
                     Logger::Loggable<Logger::Id::upstream> {
@@ -45,22 +54,30 @@ public:
 
 private:
   struct TableBuildEntry {
-    TableBuildEntry(const HostConstSharedPtr& host, uint64_t offset, uint64_t skip, double weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(uint64_t offset, uint64_t skip, double weight)
+        : skip_(skip), weight_(weight), next_(offset) {}
 
-    HostConstSharedPtr host_;
-    const uint64_t offset_;
     const uint64_t skip_;
     const double weight_;
     double target_weight_{};
-    uint64_t next_{};
+    // Next table slot in this entry's permutation, i.e. (offset + skip * j) % table_size for the
+    // j'th preference. Kept as a slot rather than j so that advancing it needs no division.
+    uint64_t next_;
     uint64_t count_{};
   };
 
-  uint64_t permutation(const TableBuildEntry& entry);
+  template <class IndexType>
+  void buildTable(std::vector<IndexType>& table, std::vector<TableBuildEntry>& table_build_entries,
+                  double max_normalized_weight);
+  uint32_t hostIndex(uint64_t slot) const {
+    return table16_.empty() ? table32_[slot] : table16_[slot];
+  }
 
   const uint64_t table_size_;
-  std::vector<HostConstSharedPtr> table_;
+  std::vector<HostConstSharedPtr> hosts_;
+  // Exactly one of these is populated if there are any hosts, depending on how many there are.
+  std::vector<uint16_t> table16_;
+  std::vector<uint32_t> table32_;
   MaglevLoadBalancerStats& stats_;
 };
 
@@ -69,10 +86,11 @@ private:
  */
 class MaglevLoadBalancer : public ThreadAwareLoadBalancerBase {
 public:
-  MaglevLoadBalancer(const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
-                     Runtime::Loader& runtime, Runtime::RandomGenerator& random,
-                     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
-                     uint64_t table_size = MaglevTable::DefaultTableSize);
+  MaglevLoadBalancer(
+      const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
+      Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+      const absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig>& config,
+      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config);
 
   const MaglevLoadBalancerStats& stats() const { return stats_; }
 
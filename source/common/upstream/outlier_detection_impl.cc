@@ -481,7 +481,8 @@ void DetectorImpl::ejectHost(HostSharedPtr host,
 DetectionStats DetectorImpl::generateStats(Stats::Scope& scope) {
   std::string prefix("outlier_detection.");
   return {ALL_OUTLIER_DETECTION_STATS(POOL_COUNTER_PREFIX(scope, prefix),
-                                      POOL_GAUGE_PREFIX(scope, prefix))};
+                                      POOL_GAUGE_PREFIX(scope, prefix),
+                                      POOL_HISTOGRAM_PREFIX(scope, prefix))};
 }
 
 void DetectorImpl::notifyMainThreadConsecutiveError(
@@ -553,9 +554,10 @@ void DetectorImpl::onConsecutiveErrorWorker(
   }
 }
 
-DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-    double success_rate_stdev_factor) {
+DetectorImpl::EjectionPair
+DetectorImpl::successRateEjectionThreshold(double success_rate_sum,
+                                           const std::vector<double>& success_rates,
+                                           double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
   // number of data points. Then variance is calculated by taking the mean of the
@@ -571,14 +573,27 @@ DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
-  double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  const size_t size = success_rates.size();
+  const double* data = success_rates.data();
+  const double mean = success_rate_sum / size;
+  // The squared differences are summed into independent partial sums, which lets the compiler
+  // vectorize the loop without having to reorder floating point additions itself.
+  constexpr size_t Lanes = 4;
+  double partial_sums[Lanes] = {};
+  size_t i = 0;
+  for (; i + Lanes <= size; i += Lanes) {
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      const double difference = data[i + lane] - mean;
+      partial_sums[lane] += difference * difference;
+    }
+  }
+  for (; i < size; ++i) {
+    const double difference = data[i] - mean;
+    partial_sums[0] += difference * difference;
+  }
+  const double variance =
+      ((partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3])) / size;
+  const double stdev = std::sqrt(variance);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
@@ -596,8 +611,8 @@ void DetectorImpl::processSuccessRateEjections(
       runtime_.snapshot().getInteger("outlier_detection.failure_percentage_request_volume",
                                      config_.failurePercentageRequestVolume());
 
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  std::vector<HostSuccessRatePair> valid_failure_percentage_hosts;
+  valid_success_rate_hosts_.clear();
+  valid_failure_percentage_hosts_.clear();
   double success_rate_sum = 0;
 
   // Reset the Detector's success rate mean and stdev.
@@ -610,8 +625,8 @@ void DetectorImpl::processSuccessRateEjections(
   }
 
   // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-  valid_failure_percentage_hosts.reserve(host_monitors_.size());
+  valid_success_rate_hosts_.reserve(host_monitors_.size());
+  valid_failure_percentage_hosts_.reserve(host_monitors_.size());
 
   for (const auto& host : host_monitors_) {
     // Don't do work if the host is already ejected.
@@ -633,44 +648,45 @@ void DetectorImpl::processSuccessRateEjections(
       }
 
       if (request_volume >= success_rate_request_volume) {
-        valid_success_rate_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
+        valid_success_rate_hosts_.add(host.first, success_rate);
         success_rate_sum += success_rate;
       }
       if (request_volume >= failure_percentage_request_volume) {
-        valid_failure_percentage_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
+        valid_failure_percentage_hosts_.add(host.first, success_rate);
       }
     }
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  if (!valid_success_rate_hosts_.empty() &&
+      valid_success_rate_hosts_.size() >= success_rate_minimum_hosts) {
     const double success_rate_stdev_factor =
         runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
                                        config_.successRateStdevFactor()) /
         1000.0;
-    getSRNums(monitor_type) = successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+    getSRNums(monitor_type) =
+        successRateEjectionThreshold(success_rate_sum, valid_success_rate_hosts_.success_rates_,
+                                     success_rate_stdev_factor);
     const double success_rate_ejection_threshold = getSRNums(monitor_type).ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold) {
+    for (size_t i = 0; i < valid_success_rate_hosts_.size(); ++i) {
+      if (valid_success_rate_hosts_.success_rates_[i] < success_rate_ejection_threshold) {
+        const HostSharedPtr& host = *valid_success_rate_hosts_.hosts_[i];
         stats_.ejections_success_rate_.inc(); // Deprecated.
         const envoy::data::cluster::v2alpha::OutlierEjectionType type =
-            host_monitors_[host_success_rate_pair.host_]
-                ->getSRMonitor(monitor_type)
-                .getEjectionType();
+            host_monitors_[host]->getSRMonitor(monitor_type).getEjectionType();
         updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+        ejectHost(host, type);
       }
     }
   }
 
-  if (!valid_failure_percentage_hosts.empty() &&
-      valid_failure_percentage_hosts.size() >= failure_percentage_minimum_hosts) {
+  if (!valid_failure_percentage_hosts_.empty() &&
+      valid_failure_percentage_hosts_.size() >= failure_percentage_minimum_hosts) {
     const double failure_percentage_threshold = runtime_.snapshot().getInteger(
         "outlier_detection.failure_percentage_threshold", config_.failurePercentageThreshold());
 
-    for (const auto& host_success_rate_pair : valid_failure_percentage_hosts) {
-      if ((100.0 - host_success_rate_pair.success_rate_) >= failure_percentage_threshold) {
+    for (size_t i = 0; i < valid_failure_percentage_hosts_.size(); ++i) {
+      if ((100.0 - valid_failure_percentage_hosts_.success_rates_[i]) >=
+          failure_percentage_threshold) {
         // We should eject.
 
         // The ejection type returned by the SuccessRateMonitor's getEjectionType() will be a
@@ -680,7 +696,7 @@ void DetectorImpl::processSuccessRateEjections(
                 ? envoy::data::cluster::v2alpha::FAILURE_PERCENTAGE
                 : envoy::data::cluster::v2alpha::FAILURE_PERCENTAGE_LOCAL_ORIGIN;
         updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+        ejectHost(*valid_failure_percentage_hosts_.hosts_[i], type);
       }
     }
   }
@@ -689,7 +705,7 @@ void DetectorImpl::processSuccessRateEjections(
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
 
-  for (auto host : host_monitors_) {
+  for (const auto& host : host_monitors_) {
     checkHostForUneject(host.first, host.second, now);
 
     // Need to update the writer bucket to keep the data valid.
@@ -703,6 +719,9 @@ void DetectorImpl::onIntervalTimer() {
   processSuccessRateEjections(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin);
   processSuccessRateEjections(DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin);
 
+  stats_.detection_pass_duration_.recordValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(time_source_.monotonicTime() - now)
+          .count());
   armIntervalTimer();
 }
 
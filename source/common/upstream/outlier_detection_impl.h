@@ -55,13 +55,29 @@ public:
 };
 
 /**
- * Thin struct to facilitate calculations for success rate outlier detection.
+ * The hosts taking part in a success rate or failure percentage ejection pass, along with their
+ * success rates. The two are kept in parallel arrays so that the statistics of a pass are computed
+ * over contiguous doubles.
  */
-struct HostSuccessRatePair {
-  HostSuccessRatePair(HostSharedPtr host, double success_rate)
-      : host_(host), success_rate_(success_rate) {}
-  HostSharedPtr host_;
-  double success_rate_;
+struct HostSuccessRates {
+  void clear() {
+    hosts_.clear();
+    success_rates_.clear();
+  }
+  void reserve(size_t size) {
+    hosts_.reserve(size);
+    success_rates_.reserve(size);
+  }
+  void add(const HostSharedPtr& host, double success_rate) {
+    hosts_.push_back(&host);
+    success_rates_.push_back(success_rate);
+  }
+  size_t size() const { return success_rates_.size(); }
+  bool empty() const { return success_rates_.empty(); }
+
+  // Points at keys of the detector's host monitor map, which is not modified during a pass.
+  std::vector<const HostSharedPtr*> hosts_;
+  std::vector<double> success_rates_;
 };
 
 struct SuccessRateAccumulatorBucket {
@@ -211,7 +227,7 @@ private:
 /**
  * All outlier detection stats. @see stats_macros.h
  */
-#define ALL_OUTLIER_DETECTION_STATS(COUNTER, GAUGE)                                                \
+#define ALL_OUTLIER_DETECTION_STATS(COUNTER, GAUGE, HISTOGRAM)                                     \
   COUNTER(ejections_consecutive_5xx)                                                               \
   COUNTER(ejections_detected_consecutive_5xx)                                                      \
   COUNTER(ejections_detected_consecutive_gateway_failure)                                          \
@@ -231,13 +247,15 @@ private:
   COUNTER(ejections_overflow)                                                                      \
   COUNTER(ejections_success_rate)                                                                  \
   COUNTER(ejections_total)                                                                         \
-  GAUGE(ejections_active, Accumulate)
+  GAUGE(ejections_active, Accumulate)                                                              \
+  HISTOGRAM(detection_pass_duration, Microseconds)
 
 /**
  * Struct definition for all outlier detection stats. @see stats_macros.h
  */
 struct DetectionStats {
-  ALL_OUTLIER_DETECTION_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ALL_OUTLIER_DETECTION_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                              GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -351,9 +369,8 @@ public:
    * This function returns pair of double values for success rate outlier detection. The pair
    * contains the average success rate of all valid hosts in the cluster and the ejection threshold.
    * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * @param success_rate_sum is the sum of the data in the success_rates vector.
+   * @param success_rates is the vector containing the individual success rate data points.
    * @return EjectionPair
    */
   struct EjectionPair {
@@ -361,8 +378,7 @@ public:
     double ejection_threshold_;   // ejection threshold for the cluster
   };
   static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
+  successRateEjectionThreshold(double success_rate_sum, const std::vector<double>& success_rates,
                                double success_rate_stdev_factor);
 
 private:
@@ -405,6 +421,10 @@ private:
   EjectionPair external_origin_sr_num_;
   EjectionPair local_origin_sr_num_;
 
+  // Scratch space for processSuccessRateEjections(), kept across intervals to avoid reallocating.
+  HostSuccessRates valid_success_rate_hosts_;
+  HostSuccessRates valid_failure_percentage_hosts_;
+
   const EjectionPair& getSRNums(DetectorHostMonitor::SuccessRateMonitorType monitor_type) const {
     return (DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin == monitor_type)
                ? external_origin_sr_num_
@@ -1,6 +1,8 @@
 #include "common/upstream/ring_hash_lb.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -43,6 +45,28 @@ RingHashLoadBalancer::RingHashLoadBalancer(
   }
 }
 
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+RingHashLoadBalancer::createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+                                         double min_normalized_weight,
+                                         double /* max_normalized_weight */) {
+  ++generation_;
+  auto ring = std::make_shared<Ring>(normalized_host_weights, min_normalized_weight,
+                                     min_ring_size_, max_ring_size_, hash_function_,
+                                     use_hostname_for_hashing_, host_hashes_, generation_, stats_);
+
+  // A ring is built for every priority on each refresh, so hashes which were not used by any of
+  // the last (number of priorities) builds belong to hosts which have been removed.
+  const uint64_t max_age = priority_set_.hostSetsPerPriority().size();
+  for (auto it = host_hashes_.begin(); it != host_hashes_.end();) {
+    if (generation_ - it->second.last_used_ >= max_age) {
+      host_hashes_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  return ring;
+}
+
 RingHashLoadBalancerStats RingHashLoadBalancer::generateStats(Stats::Scope& scope) {
   return {ALL_RING_HASH_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
 }
@@ -100,7 +124,8 @@ using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::Hash
 RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_host_weights,
                                  double min_normalized_weight, uint64_t min_ring_size,
                                  uint64_t max_ring_size, HashFunction hash_function,
-                                 bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats)
+                                 bool use_hostname_for_hashing, HostHashesMap& host_hashes,
+                                 uint64_t generation, RingHashLoadBalancerStats& stats)
     : stats_(stats) {
   ENVOY_LOG(trace, "ring hash: building ring");
 
@@ -122,25 +147,40 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   const uint64_t ring_size = std::ceil(scale);
   ring_.reserve(ring_size);
 
-  // Populate the hash ring by walking through the (host, weight) pairs in
+  // Determine the number of hashes for each host by walking through the (host, weight) pairs in
   // normalized_host_weights, and generating (scale * weight) hashes for each host. Since these
   // aren't necessarily whole numbers, we maintain running sums -- current_hashes and
   // target_hashes -- which allows us to populate the ring in a mostly stable way.
   //
   // For example, suppose we have 4 hosts, each with a normalized weight of 0.25, and a scale of
   // 6.0 (because the max_ring_size is 6). That means we want to generate 1.5 hashes per host.
-  // We start the outer loop with current_hashes = 0 and target_hashes = 0.
-  //   - For the first host, we set target_hashes = 1.5. After one run of the inner loop,
-  //     current_hashes = 1. After another run, current_hashes = 2, so the inner loop ends.
-  //   - For the second host, target_hashes becomes 3.0, and current_hashes is 2 from before.
-  //     After only one run of the inner loop, current_hashes = 3, so the inner loop ends.
+  // We start with current_hashes = 0 and target_hashes = 0.
+  //   - For the first host, we set target_hashes = 1.5, so it gets two hashes and current_hashes
+  //     becomes 2.
+  //   - For the second host, target_hashes becomes 3.0, and current_hashes is 2 from before. It
+  //     gets only one hash, and current_hashes becomes 3.
   //   - Likewise, the third host gets two hashes, and the fourth host gets one hash.
   //
+  // The hashes of host i are hash_key_i_0 .. hash_key_i_(n-1), so they only depend on the host and
+  // its number of hashes. Each host's hashes are kept sorted in host_hashes across builds, and only
+  // hosts which are new or whose number of hashes changed are hashed again. The ring is then built
+  // by merging the sorted runs of all hosts.
+  //
   // For stats reporting, keep track of the minimum and maximum actual number of hashes per host.
   // Users should hopefully pay attention to these numbers and alert if min_hashes_per_host is too
   // low, since that implies an inaccurate request distribution.
 
-  absl::InlinedVector<char, 196> hash_key_buffer;
+  struct Run {
+    const uint64_t* next_;
+    const uint64_t* end_;
+    const HostConstSharedPtr* host_;
+  };
+  std::vector<Run> runs;
+  runs.reserve(normalized_host_weights.size());
+  // Hashes of hosts which appear more than once with different numbers of hashes. These are not
+  // cached as they would replace the hashes of the first appearance while they are still in use.
+  std::vector<std::vector<uint64_t>> uncached_hashes;
+
   double current_hashes = 0.0;
   double target_hashes = 0.0;
   uint64_t min_hashes_per_host = ring_size;
@@ -151,39 +191,62 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
         use_hostname_for_hashing ? host->hostname() : host->address()->asString();
     ASSERT(!address_string.empty());
 
-    hash_key_buffer.assign(address_string.begin(), address_string.end());
-    hash_key_buffer.emplace_back('_');
-    auto offset_start = hash_key_buffer.end();
-
     // As noted above: maintain current_hashes and target_hashes as running sums across the entire
-    // host set. `i` is needed only to construct the hash key, and tally min/max hashes per host.
+    // host set. current_hashes is always a whole number, so this host gets the hashes needed to
+    // bring it to the first whole number not less than target_hashes.
     target_hashes += scale * entry.second;
-    uint64_t i = 0;
-    while (current_hashes < target_hashes) {
-      const std::string i_str = absl::StrCat("", i);
-      hash_key_buffer.insert(offset_start, i_str.begin(), i_str.end());
-
-      absl::string_view hash_key(static_cast<char*>(hash_key_buffer.data()),
-                                 hash_key_buffer.size());
-
-      const uint64_t hash =
-          (hash_function == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
-              ? MurmurHash::murmurHash2_64(hash_key, MurmurHash::STD_HASH_SEED)
-              : HashUtil::xxHash64(hash_key);
-
-      ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
-      ++i;
-      ++current_hashes;
-      hash_key_buffer.erase(offset_start, hash_key_buffer.end());
+    const uint64_t count =
+        current_hashes < target_hashes ? std::ceil(target_hashes) - current_hashes : 0;
+    current_hashes += count;
+    min_hashes_per_host = std::min(count, min_hashes_per_host);
+    max_hashes_per_host = std::max(count, max_hashes_per_host);
+
+    HostHashes& cached = host_hashes[address_string];
+    const std::vector<uint64_t>* hashes = &cached.sorted_hashes_;
+    if (cached.sorted_hashes_.size() != count) {
+      if (cached.last_used_ == generation) {
+        uncached_hashes.emplace_back();
+        hashHost(address_string, 0, count, hash_function, uncached_hashes.back());
+        hashes = &uncached_hashes.back();
+      } else if (cached.sorted_hashes_.size() < count) {
+        // The hashes already computed are a prefix of the ones needed, so only compute the rest.
+        const auto old_size = cached.sorted_hashes_.size();
+        hashHost(address_string, old_size, count, hash_function, cached.sorted_hashes_);
+        std::inplace_merge(cached.sorted_hashes_.begin(), cached.sorted_hashes_.begin() + old_size,
+                           cached.sorted_hashes_.end());
+      } else {
+        cached.sorted_hashes_.clear();
+        hashHost(address_string, 0, count, hash_function, cached.sorted_hashes_);
+      }
+    }
+    cached.last_used_ = generation;
+    // Moving a vector, either in uncached_hashes or when host_hashes is resized, keeps its buffer,
+    // so the run stays valid for the rest of this build.
+    runs.push_back({hashes->data(), hashes->data() + hashes->size(), &host});
+  }
+
+  // Merge the sorted runs of all hosts into the ring. Equal hashes are ordered by host.
+  using RunHead = std::pair<uint64_t, size_t>;
+  std::vector<RunHead> heap;
+  heap.reserve(runs.size());
+  for (size_t i = 0; i < runs.size(); ++i) {
+    if (runs[i].next_ != runs[i].end_) {
+      heap.emplace_back(*runs[i].next_, i);
+    }
+  }
+  std::make_heap(heap.begin(), heap.end(), std::greater<RunHead>());
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<RunHead>());
+    Run& run = runs[heap.back().second];
+    ring_.push_back({heap.back().first, *run.host_});
+    if (++run.next_ != run.end_) {
+      heap.back().first = *run.next_;
+      std::push_heap(heap.begin(), heap.end(), std::greater<RunHead>());
+    } else {
+      heap.pop_back();
     }
-    min_hashes_per_host = std::min(i, min_hashes_per_host);
-    max_hashes_per_host = std::max(i, max_hashes_per_host);
   }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-    return lhs.hash_ < rhs.hash_;
-  });
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (const auto& entry : ring_) {
       ENVOY_LOG(trace, "ring hash: host={} hash={}",
@@ -198,5 +261,33 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   stats_.max_hashes_per_host_.set(max_hashes_per_host);
 }
 
+void RingHashLoadBalancer::Ring::hashHost(const std::string& address_string, uint64_t begin,
+                                          uint64_t end, HashFunction hash_function,
+                                          std::vector<uint64_t>& hashes) {
+  absl::InlinedVector<char, 196> hash_key_buffer;
+  hash_key_buffer.assign(address_string.begin(), address_string.end());
+  hash_key_buffer.emplace_back('_');
+  auto offset_start = hash_key_buffer.end();
+
+  const auto first_new = hashes.size();
+  for (uint64_t i = begin; i < end; ++i) {
+    const std::string i_str = absl::StrCat("", i);
+    hash_key_buffer.insert(offset_start, i_str.begin(), i_str.end());
+
+    absl::string_view hash_key(static_cast<char*>(hash_key_buffer.data()),
+                               hash_key_buffer.size());
+
+    const uint64_t hash =
+        (hash_function == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
+            ? MurmurHash::murmurHash2_64(hash_key, MurmurHash::STD_HASH_SEED)
+            : HashUtil::xxHash64(hash_key);
+
+    ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
+    hashes.push_back(hash);
+    hash_key_buffer.erase(offset_start, hash_key_buffer.end());
+  }
+  std::sort(hashes.begin() + first_new, hashes.end());
+}
+
 } // namespace Upstream
 } // namespace Envoy
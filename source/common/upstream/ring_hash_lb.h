@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -10,6 +11,8 @@
 #include "common/common/logger.h"
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -56,14 +59,29 @@ private:
     HostConstSharedPtr host_;
   };
 
+  // The sorted ring positions of a single host, keyed by its hash key (address or hostname). These
+  // are kept across ring builds so that hosts whose number of hashes did not change are not hashed
+  // and sorted again, and the ring can be built by merging the per-host runs.
+  struct HostHashes {
+    std::vector<uint64_t> sorted_hashes_;
+    // The build generation in which these hashes were last used.
+    uint64_t last_used_{};
+  };
+  using HostHashesMap = absl::flat_hash_map<std::string, HostHashes>;
+
   struct Ring : public HashingLoadBalancer {
     Ring(const NormalizedHostWeightVector& normalized_host_weights, double min_normalized_weight,
          uint64_t min_ring_size, uint64_t max_ring_size, HashFunction hash_function,
-         bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats);
+         bool use_hostname_for_hashing, HostHashesMap& host_hashes, uint64_t generation,
+         RingHashLoadBalancerStats& stats);
 
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
 
+    // Appends the sorted hashes of address_string for hash indices [begin, end) to hashes.
+    static void hashHost(const std::string& address_string, uint64_t begin, uint64_t end,
+                         HashFunction hash_function, std::vector<uint64_t>& hashes);
+
     std::vector<RingEntry> ring_;
 
     RingHashLoadBalancerStats& stats_;
@@ -73,11 +91,7 @@ private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
   createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double /* max_normalized_weight */) override {
-    return std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
-                                  max_ring_size_, hash_function_, use_hostname_for_hashing_,
-                                  stats_);
-  }
+                     double min_normalized_weight, double max_normalized_weight) override;
 
   static RingHashLoadBalancerStats generateStats(Stats::Scope& scope);
 
@@ -90,6 +104,9 @@ private:
   const uint64_t max_ring_size_;
   const HashFunction hash_function_;
   const bool use_hostname_for_hashing_;
+  // Only accessed from the thread building rings, which is the main thread.
+  HostHashesMap host_hashes_;
+  uint64_t generation_{};
 };
 
 } // namespace Upstream
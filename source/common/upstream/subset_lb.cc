@@ -1,5 +1,6 @@
 #include "common/upstream/subset_lb.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 
@@ -24,10 +25,12 @@ SubsetLoadBalancer::SubsetLoadBalancer(
     Runtime::RandomGenerator& random, const LoadBalancerSubsetInfo& subsets,
     const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>&
         lb_ring_hash_config,
+    const absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig>& lb_maglev_config,
     const absl::optional<envoy::config::cluster::v3::Cluster::LeastRequestLbConfig>&
         least_request_config,
     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
     : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config),
+      lb_maglev_config_(lb_maglev_config),
       least_request_config_(least_request_config), common_config_(common_config), stats_(stats),
       scope_(scope), runtime_(runtime), random_(random), fallback_policy_(subsets.fallbackPolicy()),
       default_subset_metadata_(subsets.defaultSubset().fields().begin(),
@@ -35,9 +38,18 @@ SubsetLoadBalancer::SubsetLoadBalancer(
       subset_selectors_(subsets.subsetSelectors()), original_priority_set_(priority_set),
       original_local_priority_set_(local_priority_set),
       locality_weight_aware_(subsets.localityWeightAware()),
-      scale_locality_weight_(subsets.scaleLocalityWeight()), list_as_any_(subsets.listAsAny()) {
+      scale_locality_weight_(subsets.scaleLocalityWeight()), list_as_any_(subsets.listAsAny()),
+      bitmap_index_(subsets.bitmapIndex()),
+      max_cached_subsets_(subsets.bitmapIndexMaxCachedSubsets()) {
   ASSERT(subsets.isEnabled());
 
+  if (bitmap_index_) {
+    for (const auto& subset_selector : subset_selectors_) {
+      const auto& keys = subset_selector->selectorKeys();
+      indexed_keys_.insert(keys.begin(), keys.end());
+    }
+  }
+
   if (fallback_policy_ != envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK) {
     HostPredicate predicate;
     if (fallback_policy_ == envoy::config::cluster::v3::Cluster::LbSubsetConfig::ANY_ENDPOINT) {
@@ -281,7 +293,9 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   }
 
   // Route has metadata match criteria defined, see if we have a matching subset.
-  LbSubsetEntryPtr entry = findSubset(match_criteria->metadataMatchCriteria());
+  LbSubsetEntryPtr entry = bitmap_index_
+                               ? findOrCreateIndexedSubset(match_criteria->metadataMatchCriteria())
+                               : findSubset(match_criteria->metadataMatchCriteria());
   if (entry == nullptr || !entry->active()) {
     // No matching subset or subset not active: use fallback policy.
     return nullptr;
@@ -422,6 +436,11 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
                                 const HostVector& hosts_removed) {
   updateFallbackSubset(priority, hosts_added, hosts_removed);
 
+  if (bitmap_index_) {
+    updateIndexedSubsets(priority, hosts_added, hosts_removed);
+    return;
+  }
+
   processSubsets(
       hosts_added, hosts_removed,
       [&](LbSubsetEntryPtr entry) {
@@ -445,6 +464,193 @@ bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host
       kvs, host.metadata().get(), Config::MetadataFilters::get().ENVOY_LB, list_as_any_);
 }
 
+// Renumbers the hosts of all priorities and rebuilds the host bitmap of every indexed key and
+// value. Hosts with a list value are added to the bitmap of each element if list_as_any_ is set.
+void SubsetLoadBalancer::rebuildBitmapIndex() {
+  std::unordered_map<std::string, std::unordered_map<HashedValue, std::vector<uint32_t>>> indices;
+  host_indices_.clear();
+
+  uint32_t index = 0;
+  const auto add_host = [&indices, &index](const std::string& key, const ProtobufWkt::Value& v) {
+    std::vector<uint32_t>& hosts = indices[key][HashedValue(v)];
+    // A list may repeat an element.
+    if (hosts.empty() || hosts.back() != index) {
+      hosts.push_back(index);
+    }
+  };
+
+  for (const auto& host_set : original_priority_set_.hostSetsPerPriority()) {
+    for (const auto& host : host_set->hosts()) {
+      host_indices_.emplace(host.get(), index);
+      if (host->metadata() != nullptr) {
+        const auto& filter_metadata = host->metadata()->filter_metadata();
+        const auto filter_it = filter_metadata.find(Config::MetadataFilters::get().ENVOY_LB);
+        if (filter_it != filter_metadata.end()) {
+          const auto& fields = filter_it->second.fields();
+          for (const auto& key : indexed_keys_) {
+            const auto it = fields.find(key);
+            if (it == fields.end()) {
+              continue;
+            }
+            if (list_as_any_ && it->second.kind_case() == ProtobufWkt::Value::kListValue) {
+              for (const auto& v : it->second.list_value().values()) {
+                add_host(key, v);
+              }
+            } else {
+              add_host(key, it->second);
+            }
+          }
+        }
+      }
+      index++;
+    }
+  }
+
+  host_bitmaps_.clear();
+  for (auto& key_it : indices) {
+    auto& value_bitmaps = host_bitmaps_[key_it.first];
+    for (auto& value_it : key_it.second) {
+      value_bitmaps.emplace(value_it.first, HostBitmap(std::move(value_it.second), index));
+    }
+  }
+}
+
+// Rebuilds the bitmap index and updates the cached subsets. Unlike processSubsets, no subset is
+// created here: they are created when first requested by findOrCreateIndexedSubset.
+void SubsetLoadBalancer::updateIndexedSubsets(uint32_t priority, const HostVector& hosts_added,
+                                              const HostVector& hosts_removed) {
+  rebuildBitmapIndex();
+
+  forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
+    if (entry->initialized()) {
+      entry->hosts_ = intersectBitmaps(entry->metadata_);
+      entry->priority_subset_->update(priority, hosts_added, hosts_removed);
+    }
+  });
+}
+
+// Returns true if the keys of the given metadata match criteria (which must be lexically sorted by
+// key) are exactly the keys of a subset selector, i.e. if the criteria could select a subset.
+bool SubsetLoadBalancer::hasSubsetSelector(
+    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) const {
+  return std::any_of(
+      subset_selectors_.begin(), subset_selectors_.end(),
+      [&match_criteria](const SubsetSelectorPtr& subset_selector) {
+        const auto& keys = subset_selector->selectorKeys();
+        return keys.size() == match_criteria.size() &&
+               std::equal(keys.begin(), keys.end(), match_criteria.begin(),
+                          [](const std::string& key,
+                             const Router::MetadataMatchCriterionConstSharedPtr& criterion) {
+                            return key == criterion->name();
+                          });
+      });
+}
+
+// Returns the hosts having every key-value in kvs.
+HostBitmap SubsetLoadBalancer::intersectBitmaps(const SubsetMetadata& kvs) const {
+  std::vector<const HostBitmap*> bitmaps;
+  bitmaps.reserve(kvs.size());
+  for (const auto& kv : kvs) {
+    const auto key_it = host_bitmaps_.find(kv.first);
+    if (key_it == host_bitmaps_.end()) {
+      return {};
+    }
+    const auto value_it = key_it->second.find(HashedValue(kv.second));
+    if (value_it == key_it->second.end()) {
+      return {};
+    }
+    bitmaps.push_back(&value_it->second);
+  }
+  ASSERT(!bitmaps.empty());
+
+  // Intersecting the smallest bitmaps first keeps the intermediate results small.
+  std::sort(bitmaps.begin(), bitmaps.end(), [](const HostBitmap* a, const HostBitmap* b) {
+    return a->cardinality() < b->cardinality();
+  });
+  HostBitmap hosts = *bitmaps[0];
+  for (size_t i = 1; i < bitmaps.size() && !hosts.empty(); i++) {
+    hosts = hosts.intersect(*bitmaps[i]);
+  }
+  return hosts;
+}
+
+bool SubsetLoadBalancer::indexedHostMatches(const LbSubsetEntry& entry, const Host& host) {
+  const auto it = host_indices_.find(&host);
+  if (it == host_indices_.end()) {
+    // Removed hosts are no longer indexed.
+    return hostMatches(entry.metadata_, host);
+  }
+  return entry.hosts_.contains(it->second);
+}
+
+// Finds the cached subset for the given metadata match criteria or, if there is none and some
+// hosts match the criteria, creates it, evicting the least recently used subset if the cache is
+// full. Returns nullptr if no host matches.
+SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findOrCreateIndexedSubset(
+    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
+  LbSubsetEntryPtr entry = findSubset(match_criteria);
+  if (entry == nullptr || !entry->initialized()) {
+    if (!hasSubsetSelector(match_criteria)) {
+      return nullptr;
+    }
+
+    SubsetMetadata kvs;
+    kvs.reserve(match_criteria.size());
+    for (const auto& criterion : match_criteria) {
+      kvs.emplace_back(criterion->name(), criterion->value().value());
+    }
+    HostBitmap hosts = intersectBitmaps(kvs);
+    if (hosts.empty()) {
+      return nullptr;
+    }
+
+    evictIndexedSubset();
+
+    ENVOY_LOG(debug, "subset lb: creating load balancer for {}", describeMetadata(kvs));
+    entry = findOrCreateSubset(subsets_, kvs, 0);
+    entry->metadata_ = std::move(kvs);
+    entry->hosts_ = std::move(hosts);
+    const LbSubsetEntry* indexed_entry = entry.get();
+    HostPredicate predicate = [this, indexed_entry](const Host& host) -> bool {
+      return indexedHostMatches(*indexed_entry, host);
+    };
+    entry->priority_subset_ = std::make_shared<PrioritySubsetImpl>(
+        *this, predicate, locality_weight_aware_, scale_locality_weight_);
+    stats_.lb_subsets_active_.inc();
+    stats_.lb_subsets_created_.inc();
+  }
+
+  entry->last_used_ = ++subset_requests_;
+  return entry;
+}
+
+// Removes the least recently used subset if max_cached_subsets_ subsets are cached.
+void SubsetLoadBalancer::evictIndexedSubset() {
+  uint32_t cached_subsets = 0;
+  LbSubsetEntryPtr least_recently_used;
+  forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
+    if (!entry->initialized()) {
+      return;
+    }
+    cached_subsets++;
+    if (least_recently_used == nullptr || entry->last_used_ < least_recently_used->last_used_) {
+      least_recently_used = entry;
+    }
+  });
+  if (cached_subsets < max_cached_subsets_) {
+    return;
+  }
+
+  ENVOY_LOG(debug, "subset lb: removing load balancer for {}",
+            describeMetadata(least_recently_used->metadata_));
+  least_recently_used->priority_subset_.reset();
+  least_recently_used->metadata_.clear();
+  least_recently_used->hosts_ = {};
+  stats_.lb_subsets_active_.dec();
+  stats_.lb_subsets_removed_.inc();
+  purgeEmptySubsets(subsets_);
+}
+
 // Iterates over subset_keys looking up values from the given host's metadata. Each key-value pair
 // is appended to kvs. Returns a non-empty value if the host has a value for each key.
 std::vector<SubsetLoadBalancer::SubsetMetadata>
@@ -666,7 +872,7 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
     // can also use a thread aware sub-LB properly. The following works fine but is not optimal.
     thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
         *this, subset_lb.stats_, subset_lb.scope_, subset_lb.runtime_, subset_lb.random_,
-        subset_lb.common_config_);
+        subset_lb.lb_maglev_config_, subset_lb.common_config_);
     thread_aware_lb_->initialize();
     lb_ = thread_aware_lb_->factory()->create();
     break;
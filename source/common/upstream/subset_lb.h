@@ -14,8 +14,10 @@
 #include "common/common/macros.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
+#include "common/upstream/host_bitmap.h"
 #include "common/upstream/upstream_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -29,6 +31,7 @@ public:
       Runtime::RandomGenerator& random, const LoadBalancerSubsetInfo& subsets,
       const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>&
           lb_ring_hash_config,
+      const absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig>& lb_maglev_config,
       const absl::optional<envoy::config::cluster::v3::Cluster::LeastRequestLbConfig>&
           least_request_config,
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config);
@@ -188,6 +191,12 @@ private:
 
     // Only initialized if a match exists at this level.
     PrioritySubsetImplPtr priority_subset_;
+
+    // Only used with the bitmap index: the metadata the subset was requested for, the hosts
+    // matching it and the last time it was used.
+    SubsetMetadata metadata_;
+    HostBitmap hosts_;
+    uint64_t last_used_{};
   };
 
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
@@ -211,6 +220,18 @@ private:
 
   bool hostMatches(const SubsetMetadata& kvs, const Host& host);
 
+  // Bitmap index.
+  void rebuildBitmapIndex();
+  void updateIndexedSubsets(uint32_t priority, const HostVector& hosts_added,
+                            const HostVector& hosts_removed);
+  bool hasSubsetSelector(
+      const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) const;
+  HostBitmap intersectBitmaps(const SubsetMetadata& kvs) const;
+  bool indexedHostMatches(const LbSubsetEntry& entry, const Host& host);
+  LbSubsetEntryPtr findOrCreateIndexedSubset(
+      const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria);
+  void evictIndexedSubset();
+
   LbSubsetEntryPtr
   findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
 
@@ -225,6 +246,7 @@ private:
 
   const LoadBalancerType lb_type_;
   const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig> lb_ring_hash_config_;
+  const absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig> lb_maglev_config_;
   const absl::optional<envoy::config::cluster::v3::Cluster::LeastRequestLbConfig>
       least_request_config_;
   const envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
@@ -258,6 +280,17 @@ private:
   const bool scale_locality_weight_;
   const bool list_as_any_;
 
+  // If set, subsets_ only holds the subsets for recently requested metadata, which are computed
+  // on demand by intersecting the host bitmaps of each requested key and value.
+  const bool bitmap_index_;
+  const uint32_t max_cached_subsets_;
+  // The union of the subset selector keys, which are the only keys indexed.
+  std::set<std::string> indexed_keys_;
+  // For each indexed key and value, the hosts having it. Hosts are numbered in priority order.
+  std::unordered_map<std::string, std::unordered_map<HashedValue, HostBitmap>> host_bitmaps_;
+  absl::flat_hash_map<const Host*, uint32_t> host_indices_;
+  uint64_t subset_requests_{};
+
   friend class SubsetLoadBalancerDescribeMetadataTester;
 };
 
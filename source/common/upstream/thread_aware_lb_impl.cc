@@ -1,5 +1,7 @@
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 namespace Envoy {
@@ -123,6 +125,11 @@ void ThreadAwareLoadBalancerBase::refresh() {
                      min_normalized_weight, max_normalized_weight);
     per_priority_state->current_lb_ =
         createLoadBalancer(normalized_host_weights, min_normalized_weight, max_normalized_weight);
+    if (hash_balance_factor_ > 0) {
+      per_priority_state->current_lb_ = std::make_shared<BoundedLoadHashingLoadBalancer>(
+          per_priority_state->current_lb_, std::move(normalized_host_weights),
+          hash_balance_factor_);
+    }
   }
 
   {
@@ -172,6 +179,68 @@ ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHost(LoadBalancerContext* c
   return host;
 }
 
+ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::BoundedLoadHashingLoadBalancer(
+    HashingLoadBalancerSharedPtr hashing_lb, NormalizedHostWeightVector normalized_host_weights,
+    uint32_t hash_balance_factor)
+    : hashing_lb_(std::move(hashing_lb)),
+      normalized_host_weights_(std::move(normalized_host_weights)),
+      hash_balance_factor_(hash_balance_factor) {
+  ASSERT(hash_balance_factor_ >= 100);
+  normalized_host_weights_map_.reserve(normalized_host_weights_.size());
+  for (const auto& host_weight : normalized_host_weights_) {
+    normalized_host_weights_map_[host_weight.first.get()] += host_weight.second;
+  }
+}
+
+HostConstSharedPtr
+ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::chooseHost(uint64_t hash,
+                                                                        uint32_t attempt) const {
+  HostConstSharedPtr host = hashing_lb_->chooseHost(hash, attempt);
+  if (host == nullptr) {
+    return nullptr;
+  }
+  double overload_factor = overloadFactor(*host);
+  if (overload_factor <= 1.0) {
+    return host;
+  }
+
+  // Try the hosts that retries with a host predicate would, so the sequence is stable for a given
+  // hash. For ring hash these are the following positions of the ring, while Maglev rehashes for
+  // each attempt. Neither guarantees distinct hosts, so this makes as many probes as there are
+  // hosts, which may visit some hosts more than once and miss others.
+  HostConstSharedPtr least_loaded_host = host;
+  double least_overload_factor = overload_factor;
+  for (uint32_t probe = 1; probe < normalized_host_weights_.size(); ++probe) {
+    host = hashing_lb_->chooseHost(hash, attempt + probe);
+    overload_factor = overloadFactor(*host);
+    if (overload_factor <= 1.0) {
+      return host;
+    }
+    if (overload_factor < least_overload_factor) {
+      least_loaded_host = host;
+      least_overload_factor = overload_factor;
+    }
+  }
+
+  return least_loaded_host;
+}
+
+double ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::overloadFactor(
+    const Host& host) const {
+  const auto weight = normalized_host_weights_map_.find(&host);
+  ASSERT(weight != normalized_host_weights_map_.end());
+
+  // Both gauges are updated atomically by every worker as requests start and finish, so they give
+  // the current load of the host and the cluster without any additional bookkeeping. The bound is
+  // the host's weighted share of the cluster's active requests, counting the request being
+  // placed, scaled by hash_balance_factor percent. It is at least 1 so an idle host can always
+  // take a request.
+  const uint64_t cluster_active = host.cluster().stats().upstream_rq_active_.value();
+  const double bound = std::max(
+      1.0, std::ceil((cluster_active + 1) * hash_balance_factor_ / 100.0 * weight->second));
+  return (host.stats().rq_active_.value() + 1) / bound;
+}
+
 LoadBalancerPtr ThreadAwareLoadBalancerBase::LoadBalancerFactoryImpl::create() {
   auto lb = std::make_unique<LoadBalancerImpl>(stats_, random_);
 
@@ -4,6 +4,7 @@
 
 #include "common/upstream/load_balancer_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 
 namespace Envoy {
@@ -28,6 +29,35 @@ public:
   };
   using HashingLoadBalancerSharedPtr = std::shared_ptr<HashingLoadBalancer>;
 
+  /**
+   * Consistent hashing with bounded loads, as described in https://arxiv.org/abs/1608.01350.
+   * Wraps the ring or table of another HashingLoadBalancer. If the host it chooses would exceed
+   * hash_balance_factor percent of its weighted share of the cluster's active requests, the hosts
+   * that retries with a host predicate would choose are tried instead, as many as there are hosts.
+   * If all of them are over the bound, the least loaded of them is chosen. Active requests are
+   * only tracked for HTTP, so this does not bound the load of TCP proxy connections.
+   */
+  class BoundedLoadHashingLoadBalancer : public HashingLoadBalancer {
+  public:
+    BoundedLoadHashingLoadBalancer(HashingLoadBalancerSharedPtr hashing_lb,
+                                   NormalizedHostWeightVector normalized_host_weights,
+                                   uint32_t hash_balance_factor);
+
+    // ThreadAwareLoadBalancerBase::HashingLoadBalancer
+    HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
+
+  private:
+    // Returns the ratio of the host's active requests, counting the one being placed, to its
+    // bound. The host is within its bound if this is at most 1.
+    double overloadFactor(const Host& host) const;
+
+    const HashingLoadBalancerSharedPtr hashing_lb_;
+    // Keeps the hosts referenced by normalized_host_weights_map_ alive.
+    const NormalizedHostWeightVector normalized_host_weights_;
+    absl::flat_hash_map<const Host*, double> normalized_host_weights_map_;
+    const uint32_t hash_balance_factor_;
+  };
+
   // Upstream::ThreadAwareLoadBalancer
   LoadBalancerFactorySharedPtr factory() override { return factory_; }
   void initialize() override;
@@ -43,7 +73,9 @@ protected:
       Runtime::RandomGenerator& random,
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
       : LoadBalancerBase(priority_set, stats, runtime, random, common_config),
-        factory_(new LoadBalancerFactoryImpl(stats, random)) {}
+        factory_(new LoadBalancerFactoryImpl(stats, random)),
+        hash_balance_factor_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+            common_config.consistent_hashing_lb_config(), hash_balance_factor, 0)) {}
 
 private:
   struct PerPriorityState {
@@ -88,6 +120,8 @@ private:
   void refresh();
 
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+  // Zero if the load of hosts is not bounded.
+  const uint32_t hash_balance_factor_;
 };
 
 } // namespace Upstream
@@ -470,12 +470,14 @@ HostSetImpl::chooseLocality(EdfScheduler<LocalityEntry>* locality_scheduler) {
   if (locality_scheduler == nullptr) {
     return {};
   }
-  const std::shared_ptr<LocalityEntry> locality = locality_scheduler->pick();
+  const std::shared_ptr<LocalityEntry> locality =
+      locality_scheduler->pickAndAdd([](const LocalityEntry& locality) {
+        // If we picked it before, its weight must have been positive.
+        ASSERT(locality.effective_weight_ > 0);
+        return locality.effective_weight_;
+      });
   // We don't build a schedule if there are no weighted localities, so we should always succeed.
   ASSERT(locality != nullptr);
-  // If we picked it before, its weight must have been positive.
-  ASSERT(locality->effective_weight_ > 0);
-  locality_scheduler->add(locality->effective_weight_, locality);
   return locality->index_;
 }
 
@@ -669,6 +671,9 @@ ClusterInfoImpl::ClusterInfoImpl(
     : runtime_(runtime), name_(config.name()), type_(config.type()),
       max_requests_per_connection_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_requests_per_connection, 0)),
+      per_upstream_prefetch_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.prefetch_policy(), per_upstream_prefetch_ratio, 1.0)),
+      min_warm_connections_(config.prefetch_policy().min_warm_connections()),
       max_response_headers_count_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
           config.common_http_protocol_options(), max_headers_count,
           runtime_.snapshot().getInteger(Http::MaxResponseHeadersCountOverrideKey,
@@ -694,6 +699,7 @@ ClusterInfoImpl::ClusterInfoImpl(
       source_address_(getSourceAddress(config, bind_config)),
       lb_least_request_config_(config.least_request_lb_config()),
       lb_ring_hash_config_(config.ring_hash_lb_config()),
+      lb_maglev_config_(config.maglev_lb_config()),
       lb_original_dst_config_(config.original_dst_lb_config()), added_via_api_(added_via_api),
       lb_subset_(LoadBalancerSubsetInfoImpl(config.lb_subset_config())),
       metadata_(config.metadata()), typed_metadata_(config.metadata()),
@@ -744,6 +750,16 @@ ClusterInfoImpl::ClusterInfoImpl(
     lb_type_ = LoadBalancerType::ClusterProvided;
     break;
   case envoy::config::cluster::v3::Cluster::MAGLEV:
+    // Maglev load balancers are also created on workers by the subset load balancer, where the
+    // table size can't be rejected anymore.
+    if (config.has_maglev_lb_config() && config.maglev_lb_config().has_table_size()) {
+      const uint64_t table_size = config.maglev_lb_config().table_size().value();
+      if (table_size > std::numeric_limits<uint32_t>::max() ||
+          !Primes::isPrime(static_cast<uint32_t>(table_size))) {
+        throw EnvoyException(
+            fmt::format("cluster: maglev table_size ({}) must be a prime number", table_size));
+      }
+    }
     lb_type_ = LoadBalancerType::Maglev;
     break;
   case envoy::config::cluster::v3::Cluster::CLUSTER_PROVIDED:
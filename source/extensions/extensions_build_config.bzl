@@ -181,6 +181,8 @@ EXTENSIONS = {
     #
 
     "envoy.filters.http.cache.simple_http_cache":       "//source/extensions/filters/http/cache/simple_http_cache:simple_http_cache_lib",
+    "envoy.filters.http.cache.sharded_http_cache":      "//source/extensions/filters/http/cache/sharded_http_cache:sharded_http_cache_lib",
+    "envoy.filters.http.cache.file_system_http_cache":  "//source/extensions/filters/http/cache/file_system_http_cache:file_system_http_cache_lib",
 
     #
     # Internal redirect predicates
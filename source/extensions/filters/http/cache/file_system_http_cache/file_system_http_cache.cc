@@ -0,0 +1,609 @@
+#include "extensions/filters/http/cache/file_system_http_cache/file_system_http_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "envoy/registry/registry.h"
+#include "envoy/singleton/manager.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/fmt.h"
+#include "common/filesystem/directory.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+constexpr absl::string_view SegmentFilePrefix = "envoy-http-cache-segment-";
+
+// Records are laid out as a RecordHeader, followed by the serialized key, the encoded response
+// headers and the body.
+constexpr uint32_t RecordMagic = 0x31524345; // "ECR1"
+
+struct RecordHeader {
+  uint32_t magic_;
+  uint32_t key_size_;
+  uint32_t headers_size_;
+  uint32_t reserved_;
+  uint64_t body_size_;
+};
+
+void appendUint32(std::string& output, uint32_t value) {
+  output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Builds everything in a record but the body. Each header is encoded as the sizes of its key and
+// value, followed by the key and the value.
+std::string encodeRecordPrefix(absl::string_view key, const Http::ResponseHeaderMap& headers,
+                               uint64_t body_size) {
+  std::string output(sizeof(RecordHeader), '\0');
+  output.append(key.data(), key.size());
+  headers.iterate(
+      [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+        std::string& output = *static_cast<std::string*>(context);
+        const absl::string_view key = header.key().getStringView();
+        const absl::string_view value = header.value().getStringView();
+        appendUint32(output, key.size());
+        appendUint32(output, value.size());
+        absl::StrAppend(&output, key, value);
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &output);
+  const RecordHeader record_header{RecordMagic, static_cast<uint32_t>(key.size()),
+                                   static_cast<uint32_t>(output.size() - sizeof(RecordHeader) -
+                                                         key.size()),
+                                   0, body_size};
+  memcpy(&output[0], &record_header, sizeof(record_header));
+  return output;
+}
+
+Http::ResponseHeaderMapPtr decodeHeaders(absl::string_view data) {
+  auto headers = std::make_unique<Http::ResponseHeaderMapImpl>();
+  while (!data.empty()) {
+    uint32_t sizes[2];
+    ASSERT(data.size() >= sizeof(sizes));
+    memcpy(sizes, data.data(), sizeof(sizes));
+    data.remove_prefix(sizeof(sizes));
+    headers->addCopy(Http::LowerCaseString(std::string(data.substr(0, sizes[0]))),
+                     data.substr(sizes[0], sizes[1]));
+    data.remove_prefix(sizes[0] + sizes[1]);
+  }
+  return headers;
+}
+
+// References a range of a cached body, keeping the segment mapped until the buffer is drained.
+class SegmentFragment : public Buffer::BufferFragment {
+public:
+  SegmentFragment(FileSystemHttpCache::SegmentSharedPtr segment, absl::string_view data)
+      : segment_(std::move(segment)), data_(data) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return data_.data(); }
+  size_t size() const override { return data_.size(); }
+  void done() override { delete this; }
+
+private:
+  const FileSystemHttpCache::SegmentSharedPtr segment_;
+  const absl::string_view data_;
+};
+
+class FileSystemLookupContext : public LookupContext {
+public:
+  FileSystemLookupContext(FileSystemHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)),
+        serialized_key_(request_.key().SerializeAsString()) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    entry_ = cache_.lookup(request_, serialized_key_);
+    cb(entry_ ? request_.makeLookupResult(decodeHeaders(entry_->headers_), entry_->body_.size())
+              : LookupResult{});
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(entry_.has_value());
+    ASSERT(range.end() <= entry_->body_.length(), "Attempt to read past end of body.");
+    auto body = std::make_unique<Buffer::OwnedImpl>();
+    if (range.length() > 0) {
+      body->addBufferFragment(*new SegmentFragment(
+          entry_->segment_, entry_->body_.substr(range.begin(), range.length())));
+    }
+    cb(std::move(body));
+  }
+
+  void getTrailers(LookupTrailersCallback&&) override {
+    // TODO(toddmgreer): Support trailers.
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+  }
+
+  const LookupRequest& request() const { return request_; }
+  const std::string& serializedKey() const { return serialized_key_; }
+
+private:
+  FileSystemHttpCache& cache_;
+  const LookupRequest request_;
+  // Serialized once, so that neither the lookup nor the insert has to.
+  const std::string serialized_key_;
+  absl::optional<FileSystemHttpCache::Entry> entry_;
+};
+
+class FileSystemInsertContext : public InsertContext {
+public:
+  FileSystemInsertContext(LookupContext& lookup_context, FileSystemHttpCache& cache)
+      : key_(dynamic_cast<FileSystemLookupContext&>(lookup_context).request().key()),
+        serialized_key_(dynamic_cast<FileSystemLookupContext&>(lookup_context).serializedKey()),
+        cache_(cache) {}
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers, bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+
+    body_.add(chunk);
+    if (end_stream) {
+      commit();
+    } else {
+      ready_for_next_chunk(true);
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap&) override {
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE; // TODO(toddmgreer): support trailers
+  }
+
+private:
+  void commit() {
+    committed_ = true;
+    cache_.insert(key_, serialized_key_, *response_headers_, body_);
+  }
+
+  Key key_;
+  std::string serialized_key_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  FileSystemHttpCache& cache_;
+  Buffer::OwnedImpl body_;
+  bool committed_ = false;
+};
+} // namespace
+
+FileSystemHttpCache::Segment::Segment(std::string path, uint64_t size_bytes)
+    : path_(std::move(path)), size_bytes_(size_bytes) {
+  const int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd == -1) {
+    throw EnvoyException(
+        fmt::format("unable to create cache segment '{}': {}", path_, strerror(errno)));
+  }
+  // A sparse file would raise SIGBUS on writes to the mapping once the disk is full, so the blocks
+  // are allocated up front. posix_fallocate() returns the error rather than setting errno. macOS
+  // lacks posix_fallocate(), and there the file is only extended.
+#ifdef __linux__
+  int error = ::posix_fallocate(fd, 0, static_cast<off_t>(size_bytes_));
+#else
+  int error = ::ftruncate(fd, static_cast<off_t>(size_bytes_)) == 0 ? 0 : errno;
+#endif
+  void* data = MAP_FAILED;
+  if (error == 0) {
+    data = ::mmap(nullptr, size_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      error = errno;
+    }
+  }
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    ::unlink(path_.c_str());
+    throw EnvoyException(
+        fmt::format("unable to allocate cache segment '{}': {}", path_, strerror(error)));
+  }
+  data_ = static_cast<char*>(data);
+}
+
+FileSystemHttpCache::Segment::~Segment() { ::munmap(data_, size_bytes_); }
+
+FileSystemHttpCache::FileSystemHttpCache(
+    const envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig& config,
+    Thread::ThreadFactory& thread_factory, Stats::Scope& scope)
+    : cache_path_(config.cache_path()),
+      segment_size_bytes_(config.segment_size_bytes() > 0 ? config.segment_size_bytes()
+                                                          : DefaultSegmentSizeBytes),
+      max_segments_(std::max<uint64_t>(
+          2, (config.max_size_bytes() > 0 ? config.max_size_bytes() : DefaultMaxSizeBytes) /
+                 segment_size_bytes_)),
+      compaction_threshold_percent_(config.compaction_threshold_percent() > 0
+                                        ? config.compaction_threshold_percent()
+                                        : DefaultCompactionThresholdPercent),
+      stats_{
+          ALL_FILE_SYSTEM_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(scope, "http_cache.file_system."),
+                                           POOL_GAUGE_PREFIX(scope, "http_cache.file_system."))} {
+  for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(cache_path_)) {
+    if (entry.type_ == Filesystem::FileType::Regular &&
+        absl::StartsWith(entry.name_, SegmentFilePrefix)) {
+      ::unlink(absl::StrCat(cache_path_, "/", entry.name_).c_str());
+    }
+  }
+  background_thread_ = thread_factory.createThread([this]() { backgroundThreadRoutine(); });
+}
+
+FileSystemHttpCache::~FileSystemHttpCache() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  // Queued inserts are dropped.
+  background_thread_->join();
+  for (const SegmentSharedPtr& segment : segments_) {
+    ::unlink(segment->path().c_str());
+  }
+}
+
+LookupContextPtr FileSystemHttpCache::makeLookupContext(LookupRequest&& request) {
+  return std::make_unique<FileSystemLookupContext>(*this, std::move(request));
+}
+
+InsertContextPtr FileSystemHttpCache::makeInsertContext(LookupContextPtr&& lookup_context) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<FileSystemInsertContext>(*lookup_context, *this);
+}
+
+void FileSystemHttpCache::updateHeaders(LookupContextPtr&& lookup_context,
+                                        Http::ResponseHeaderMapPtr&& response_headers) {
+  ASSERT(lookup_context);
+  ASSERT(response_headers);
+  // TODO(toddmgreer): Support updating headers.
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+
+absl::optional<FileSystemHttpCache::Entry>
+FileSystemHttpCache::lookup(const LookupRequest& request, absl::string_view serialized_key) {
+  const uint64_t hash = stableHashKey(request.key());
+  absl::optional<Location> location;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto iter = index_.find(hash);
+    if (iter != index_.end()) {
+      location = iter->second;
+    }
+  }
+  if (!location.has_value()) {
+    stats_.misses_.inc();
+    return absl::nullopt;
+  }
+
+  // Published records are never modified, so they can be read without holding the lock.
+  const char* record = location->segment_->data() + location->offset_;
+  RecordHeader header;
+  memcpy(&header, record, sizeof(header));
+  ASSERT(header.magic_ == RecordMagic);
+  const absl::string_view stored_key(record + sizeof(header), header.key_size_);
+  if (stored_key != serialized_key) {
+    stats_.misses_.inc();
+    return absl::nullopt;
+  }
+  stats_.hits_.inc();
+  const char* headers = stored_key.data() + stored_key.size();
+  return Entry{std::move(location->segment_), absl::string_view(headers, header.headers_size_),
+               absl::string_view(headers + header.headers_size_, header.body_size_)};
+}
+
+void FileSystemHttpCache::insert(const Key& key, absl::string_view serialized_key,
+                                 const Http::ResponseHeaderMap& response_headers,
+                                 const Buffer::Instance& body) {
+  PendingInsert pending{stableHashKey(key),
+                        encodeRecordPrefix(serialized_key, response_headers, body.length())};
+  const uint64_t prefix_size = pending.record_.size();
+  const uint64_t size_bytes = prefix_size + body.length();
+  if (size_bytes > segment_size_bytes_) {
+    stats_.insert_failures_.inc();
+    return;
+  }
+  pending.record_.resize(size_bytes);
+  body.copyOut(0, body.length(), &pending.record_[prefix_size]);
+
+  absl::MutexLock lock(&mutex_);
+  // Bounds the memory held by the queue if the background thread falls behind.
+  if (pending_bytes_ + size_bytes > segment_size_bytes_) {
+    stats_.insert_failures_.inc();
+    return;
+  }
+  pending_bytes_ += size_bytes;
+  pending_inserts_.push_back(std::move(pending));
+}
+
+void FileSystemHttpCache::write(const PendingInsert& pending) {
+  absl::optional<Location> location = reserve(pending.record_.size());
+  if (!location.has_value()) {
+    stats_.insert_failures_.inc();
+    return;
+  }
+
+  // The reserved space is only ever written by this thread, so the copy doesn't need the lock.
+  memcpy(location->segment_->data() + location->offset_, pending.record_.data(),
+         pending.record_.size());
+
+  absl::MutexLock lock(&mutex_);
+  if (publish(pending.hash_, *location, nullptr)) {
+    stats_.inserts_.inc();
+  }
+}
+
+absl::optional<FileSystemHttpCache::Location>
+FileSystemHttpCache::reserve(uint64_t size_bytes) {
+  if (size_bytes > segment_size_bytes_) {
+    return absl::nullopt;
+  }
+  std::string segment_path;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!segments_.empty() && segments_.back()->used_bytes_ + size_bytes <= segment_size_bytes_) {
+      const SegmentSharedPtr& segment = segments_.back();
+      Location location{segment, segment->used_bytes_, size_bytes};
+      segment->used_bytes_ += size_bytes;
+      return location;
+    }
+    segment_path = absl::StrCat(cache_path_, "/", SegmentFilePrefix, next_segment_id_++);
+  }
+
+  // Only this thread adds segments, so the file is created without holding the lock, which would
+  // block lookups while its blocks are allocated.
+  SegmentSharedPtr segment;
+  try {
+    segment = std::make_shared<Segment>(segment_path, segment_size_bytes_);
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "file system cache: {}", e.what());
+    return absl::nullopt;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  SegmentSharedPtr sealed = segments_.empty() ? nullptr : segments_.back();
+  segments_.push_back(segment);
+  stats_.segments_.inc();
+  if (sealed != nullptr) {
+    maybeQueueCompaction(sealed);
+  }
+  while (segments_.size() > max_segments_) {
+    dropSegment(segments_.front());
+  }
+  Location location{segment, 0, size_bytes};
+  segment->used_bytes_ = size_bytes;
+  return location;
+}
+
+bool FileSystemHttpCache::publish(uint64_t hash, const Location& location,
+                                  const Location* expected) {
+  if (location.segment_->dropped_) {
+    return false;
+  }
+  auto iter = index_.find(hash);
+  if (expected != nullptr &&
+      (iter == index_.end() || iter->second.segment_ != expected->segment_ ||
+       iter->second.offset_ != expected->offset_)) {
+    return false;
+  }
+  if (iter != index_.end()) {
+    const Location replaced = std::move(iter->second);
+    iter->second = location;
+    release(replaced);
+  } else {
+    index_.emplace(hash, location);
+  }
+  location.segment_->records_.emplace_back(hash, location.offset_);
+  location.segment_->live_bytes_ += location.size_bytes_;
+  stats_.live_bytes_.add(location.size_bytes_);
+  return true;
+}
+
+void FileSystemHttpCache::release(const Location& location) {
+  location.segment_->live_bytes_ -= location.size_bytes_;
+  stats_.live_bytes_.sub(location.size_bytes_);
+  maybeQueueCompaction(location.segment_);
+}
+
+void FileSystemHttpCache::maybeQueueCompaction(const SegmentSharedPtr& segment) {
+  // The newest segment is still being appended to, so it is never compacted.
+  if (segment == segments_.back() || segment->dropped_ || segment->compaction_queued_ ||
+      segment->live_bytes_ * 100 >= segment->used_bytes_ * compaction_threshold_percent_) {
+    return;
+  }
+  segment->compaction_queued_ = true;
+  compaction_queue_.push_back(segment);
+}
+
+void FileSystemHttpCache::dropSegment(const SegmentSharedPtr& segment) {
+  ASSERT(!segment->dropped_);
+  for (const auto& record : liveRecords(*segment)) {
+    stats_.evicted_bytes_.add(record.second.size_bytes_);
+    stats_.live_bytes_.sub(record.second.size_bytes_);
+    index_.erase(record.first);
+  }
+  segment->dropped_ = true;
+  // The file goes away once the last hit referencing the mapping is done with it.
+  ::unlink(segment->path().c_str());
+  segments_.remove(segment);
+  stats_.segments_.dec();
+}
+
+std::vector<std::pair<uint64_t, FileSystemHttpCache::Location>>
+FileSystemHttpCache::liveRecords(const Segment& segment) const {
+  std::vector<std::pair<uint64_t, Location>> live;
+  for (const auto& record : segment.records_) {
+    auto iter = index_.find(record.first);
+    if (iter != index_.end() && iter->second.segment_.get() == &segment &&
+        iter->second.offset_ == record.second) {
+      live.emplace_back(record.first, iter->second);
+    }
+  }
+  return live;
+}
+
+void FileSystemHttpCache::compact(const SegmentSharedPtr& segment) {
+  std::vector<std::pair<uint64_t, Location>> live;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (segment->dropped_) {
+      return;
+    }
+    live = liveRecords(*segment);
+  }
+
+  // Records superseded or evicted while they are being copied are simply not published.
+  for (const auto& record : live) {
+    const Location& from = record.second;
+    absl::optional<Location> to = reserve(from.size_bytes_);
+    if (!to.has_value()) {
+      break;
+    }
+    memcpy(to->segment_->data() + to->offset_, from.segment_->data() + from.offset_,
+           from.size_bytes_);
+    absl::MutexLock lock(&mutex_);
+    if (publish(record.first, *to, &from)) {
+      stats_.compacted_bytes_.add(from.size_bytes_);
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (!segment->dropped_) {
+    dropSegment(segment);
+  }
+  stats_.compactions_.inc();
+}
+
+void FileSystemHttpCache::backgroundThreadRoutine() {
+  while (true) {
+    std::list<PendingInsert> inserts;
+    SegmentSharedPtr segment;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &FileSystemHttpCache::backgroundWorkReady));
+      if (shutdown_) {
+        return;
+      }
+      inserts.swap(pending_inserts_);
+      pending_bytes_ = 0;
+      if (!compaction_queue_.empty()) {
+        segment = std::move(compaction_queue_.front());
+        compaction_queue_.pop_front();
+      }
+      busy_ = true;
+    }
+
+    for (const PendingInsert& pending : inserts) {
+      write(pending);
+    }
+    if (segment != nullptr) {
+      compact(segment);
+    }
+
+    absl::MutexLock lock(&mutex_);
+    busy_ = false;
+  }
+}
+
+void FileSystemHttpCache::waitForBackgroundWork() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &FileSystemHttpCache::backgroundIdle));
+}
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache.file_system";
+
+CacheInfo FileSystemHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  return cache_info;
+}
+
+SINGLETON_MANAGER_REGISTRATION(file_system_http_cache_manager);
+
+// Owns the file system caches of a server, so that filters configured with the same directory
+// share a cache. The manager only holds its caches weakly, while each cache holds the manager, so
+// the manager lives until its last cache is released, and the caches end with the listeners using
+// them rather than outliving the server.
+class FileSystemHttpCacheManager : public Singleton::Instance,
+                                   public std::enable_shared_from_this<FileSystemHttpCacheManager> {
+public:
+  FileSystemHttpCacheManager(Thread::ThreadFactory& thread_factory, Stats::Scope& scope)
+      : thread_factory_(thread_factory), scope_(scope) {}
+
+  HttpCacheSharedPtr getCache(
+      const envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig& config) {
+    ActiveCache& active_cache = caches_[config.cache_path()];
+    HttpCacheSharedPtr cache = active_cache.cache_.lock();
+    if (cache == nullptr) {
+      auto handle = std::make_shared<CacheHandle>();
+      handle->manager_ = shared_from_this();
+      handle->cache_ = std::make_unique<FileSystemHttpCache>(config, thread_factory_, scope_);
+      cache = HttpCacheSharedPtr(handle, handle->cache_.get());
+      active_cache.config_ = config;
+      active_cache.cache_ = cache;
+    } else if (!MessageUtil()(active_cache.config_, config)) {
+      throw EnvoyException(fmt::format(
+          "file system cache at '{}' is already configured with different settings",
+          config.cache_path()));
+    }
+    return cache;
+  }
+
+private:
+  // Owns a cache and keeps the manager alive until the cache is destroyed.
+  struct CacheHandle {
+    std::shared_ptr<FileSystemHttpCacheManager> manager_;
+    std::unique_ptr<FileSystemHttpCache> cache_;
+  };
+  struct ActiveCache {
+    envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig config_;
+    std::weak_ptr<HttpCache> cache_;
+  };
+
+  Thread::ThreadFactory& thread_factory_;
+  Stats::Scope& scope_;
+  absl::flat_hash_map<std::string, ActiveCache> caches_;
+};
+
+class FileSystemHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string(Name); }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<
+        envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig>();
+  }
+  // From HttpCacheFactory
+  HttpCacheSharedPtr
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext& context) override {
+    envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig typed_config;
+    MessageUtil::unpackTo(config.typed_config(), typed_config);
+    std::shared_ptr<FileSystemHttpCacheManager> manager =
+        context.singletonManager().getTyped<FileSystemHttpCacheManager>(
+            SINGLETON_MANAGER_REGISTERED_NAME(file_system_http_cache_manager), [&context] {
+              return std::make_shared<FileSystemHttpCacheManager>(
+                  context.api().threadFactory(), context.getServerFactoryContext().scope());
+            });
+    return manager->getCache(typed_config);
+  }
+};
+
+static Registry::RegisterFactory<FileSystemHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+
+#include "source/extensions/filters/http/cache/file_system_http_cache/config.pb.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All file system cache stats. @see stats_macros.h
+ */
+#define ALL_FILE_SYSTEM_HTTP_CACHE_STATS(COUNTER, GAUGE)                                           \
+  COUNTER(compacted_bytes)                                                                         \
+  COUNTER(compactions)                                                                             \
+  COUNTER(evicted_bytes)                                                                           \
+  COUNTER(hits)                                                                                    \
+  COUNTER(insert_failures)                                                                         \
+  COUNTER(inserts)                                                                                 \
+  COUNTER(misses)                                                                                  \
+  GAUGE(live_bytes, Accumulate)                                                                    \
+  GAUGE(segments, Accumulate)
+
+/**
+ * Struct definition for all file system cache stats. @see stats_macros.h
+ */
+struct FileSystemHttpCacheStats {
+  ALL_FILE_SYSTEM_HTTP_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+// Cache backend storing entries in fixed size segment files on disk. Each entry is appended to the
+// newest segment as a single record holding its key, response headers and body, and an in-memory
+// index maps the hash of the key to the record. Segments are memory mapped for their whole life,
+// so hits are served from the page cache: bodies are handed out as buffer fragments referencing
+// the mapping, without reading or copying them.
+//
+// Workers never touch the segment files: inserts are queued, in memory, to a background thread
+// which creates, writes and removes the files. A response is thus only cached some time after it
+// was inserted, and inserts are dropped while the queue holds more than a segment's worth of them.
+// When the segment files would exceed the size limit the oldest segment is evicted. The background
+// thread also compacts full segments in which most records have been superseded, copying the
+// current records to the newest segment so that the old one can be removed.
+//
+// The index only holds key hashes; the full key stored in the record is checked on lookup, and of
+// two keys with the same hash only the last one inserted is cached.
+class FileSystemHttpCache : public HttpCache, Logger::Loggable<Logger::Id::cache_filter> {
+public:
+  // A segment file. The file is mapped for its whole size when created, and unmapped once the
+  // segment is dropped from the cache and no hit references it anymore.
+  class Segment {
+  public:
+    // Creates the file, allocates its blocks so that writes to the mapping cannot fail for lack of
+    // space, and maps it. Throws EnvoyException on failure.
+    Segment(std::string path, uint64_t size_bytes);
+    ~Segment();
+
+    char* data() const { return data_; }
+    uint64_t sizeBytes() const { return size_bytes_; }
+    const std::string& path() const { return path_; }
+
+  private:
+    friend class FileSystemHttpCache;
+
+    const std::string path_;
+    const uint64_t size_bytes_;
+    char* data_;
+
+    // Guarded by the cache's mutex_.
+    // Bytes reserved for records, including ones still being written.
+    uint64_t used_bytes_{};
+    // Bytes of records referenced by the index.
+    uint64_t live_bytes_{};
+    // Hash and offset of each record, in the order they were published.
+    std::vector<std::pair<uint64_t, uint64_t>> records_;
+    bool compaction_queued_{};
+    bool dropped_{};
+  };
+  using SegmentSharedPtr = std::shared_ptr<Segment>;
+
+  // The location of a record.
+  struct Location {
+    SegmentSharedPtr segment_;
+    uint64_t offset_;
+    uint64_t size_bytes_;
+  };
+
+  // A cached response. The views point into the segment's mapping.
+  struct Entry {
+    SegmentSharedPtr segment_;
+    absl::string_view headers_;
+    absl::string_view body_;
+  };
+
+  static constexpr uint64_t DefaultSegmentSizeBytes = 64 * 1024 * 1024;
+  static constexpr uint64_t DefaultMaxSizeBytes = 1024 * 1024 * 1024;
+  static constexpr uint32_t DefaultCompactionThresholdPercent = 50;
+
+  // Removes segment files left in cache_path and starts the background thread. Throws
+  // EnvoyException if cache_path cannot be read.
+  FileSystemHttpCache(
+      const envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig& config,
+      Thread::ThreadFactory& thread_factory, Stats::Scope& scope);
+  ~FileSystemHttpCache() override;
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override;
+  void updateHeaders(LookupContextPtr&& lookup_context,
+                     Http::ResponseHeaderMapPtr&& response_headers) override;
+  CacheInfo cacheInfo() const override;
+
+  // serialized_key is request.key() serialized, which is compared with the key stored in the record.
+  absl::optional<Entry> lookup(const LookupRequest& request, absl::string_view serialized_key);
+  // Queues the response to be written by the background thread. serialized_key is key serialized.
+  void insert(const Key& key, absl::string_view serialized_key,
+              const Http::ResponseHeaderMap& response_headers, const Buffer::Instance& body);
+
+  /**
+   * Blocks until all queued inserts and compactions have completed. Used by tests.
+   */
+  void waitForBackgroundWork();
+
+  const FileSystemHttpCacheStats& stats() const { return stats_; }
+
+private:
+  // A record waiting to be written by the background thread.
+  struct PendingInsert {
+    uint64_t hash_;
+    std::string record_;
+  };
+
+  // Writes a queued record to the newest segment and publishes it. Only called on the background
+  // thread.
+  void write(const PendingInsert& pending) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Copies the live records of a segment to the newest segment and drops it. Only called on the
+  // background thread.
+  void compact(const SegmentSharedPtr& segment) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Reserves space for a record in the newest segment, starting a new segment if needed. Only
+  // called on the background thread.
+  absl::optional<Location> reserve(uint64_t size_bytes) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Points the index at a written record. If expected is set, only does so if the index still
+  // points at expected. Returns whether the record was published.
+  bool publish(uint64_t hash, const Location& location, const Location* expected)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Accounts for a record no longer referenced by the index.
+  void release(const Location& location) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void maybeQueueCompaction(const SegmentSharedPtr& segment) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Removes a segment and the index entries still pointing at it, counting them as evicted. Only
+  // called on the background thread, as it removes the segment file.
+  void dropSegment(const SegmentSharedPtr& segment) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  std::vector<std::pair<uint64_t, Location>> liveRecords(const Segment& segment) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void backgroundThreadRoutine();
+  bool backgroundWorkReady() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return shutdown_ || !pending_inserts_.empty() || !compaction_queue_.empty();
+  }
+  bool backgroundIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_inserts_.empty() && compaction_queue_.empty() && !busy_;
+  }
+
+  const std::string cache_path_;
+  const uint64_t segment_size_bytes_;
+  const uint64_t max_segments_;
+  const uint32_t compaction_threshold_percent_;
+  FileSystemHttpCacheStats stats_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<uint64_t, Location> index_ ABSL_GUARDED_BY(mutex_);
+  // Oldest first. The last segment is the one new records are appended to.
+  std::list<SegmentSharedPtr> segments_ ABSL_GUARDED_BY(mutex_);
+  uint64_t next_segment_id_ ABSL_GUARDED_BY(mutex_){};
+  std::list<PendingInsert> pending_inserts_ ABSL_GUARDED_BY(mutex_);
+  uint64_t pending_bytes_ ABSL_GUARDED_BY(mutex_){};
+  std::list<SegmentSharedPtr> compaction_queue_ ABSL_GUARDED_BY(mutex_);
+  // Whether the background thread is working on items it took off the queues.
+  bool busy_ ABSL_GUARDED_BY(mutex_){};
+  bool shutdown_ ABSL_GUARDED_BY(mutex_){};
+  Thread::ThreadPtr background_thread_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -9,6 +9,7 @@
 #include "envoy/config/typed_config.h"
 #include "envoy/extensions/filters/http/cache/v3alpha/cache.pb.h"
 #include "envoy/http/header_map.h"
+#include "envoy/server/filter_config.h"
 
 #include "common/common/assert.h"
 
@@ -294,6 +295,7 @@ public:
 
   virtual ~HttpCache() = default;
 };
+using HttpCacheSharedPtr = std::shared_ptr<HttpCache>;
 
 // Factory interface for cache implementations to implement and register.
 class HttpCacheFactory : public Config::TypedFactory {
@@ -301,10 +303,14 @@ public:
   // From UntypedFactory
   std::string category() const override { return "http_cache_factory"; }
 
-  // Returns an HttpCache that will remain valid indefinitely (at least as long
-  // as the calling CacheFilter).
-  virtual HttpCache&
-  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config) PURE;
+  // Returns an HttpCache that remains valid as long as the returned pointer is
+  // held. Called on the main thread, once per filter configuration, so it may
+  // do blocking work and throw EnvoyException to reject the configuration. The
+  // context may be used to obtain stats and OS facilities; caches shared by
+  // several listeners should use the server-wide ones.
+  virtual HttpCacheSharedPtr
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext& context) PURE;
   ~HttpCacheFactory() override = default;
 
 private:
@@ -0,0 +1,271 @@
+#include "extensions/filters/http/cache/sharded_http_cache/sharded_http_cache.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+
+#include "source/extensions/filters/http/cache/sharded_http_cache/config.pb.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+// References a range of a cached body, keeping the entry alive until the buffer is drained.
+class BodyFragment : public Buffer::BufferFragment {
+public:
+  BodyFragment(ShardedHttpCache::EntryConstSharedPtr entry, const AdjustedByteRange& range)
+      : entry_(std::move(entry)), range_(range) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return entry_->body_.data() + range_.begin(); }
+  size_t size() const override { return range_.length(); }
+  void done() override { delete this; }
+
+private:
+  const ShardedHttpCache::EntryConstSharedPtr entry_;
+  const AdjustedByteRange range_;
+};
+
+class ShardedLookupContext : public LookupContext {
+public:
+  ShardedLookupContext(ShardedHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    entry_ = cache_.lookup(request_);
+    cb(entry_ ? request_.makeLookupResult(
+                    Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*entry_->response_headers_),
+                    entry_->body_.size())
+              : LookupResult{});
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(entry_ != nullptr);
+    ASSERT(range.end() <= entry_->body_.length(), "Attempt to read past end of body.");
+    auto body = std::make_unique<Buffer::OwnedImpl>();
+    if (range.length() > 0) {
+      body->addBufferFragment(*new BodyFragment(entry_, range));
+    }
+    cb(std::move(body));
+  }
+
+  void getTrailers(LookupTrailersCallback&&) override {
+    // TODO(toddmgreer): Support trailers.
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+  }
+
+  const LookupRequest& request() const { return request_; }
+
+private:
+  ShardedHttpCache& cache_;
+  const LookupRequest request_;
+  ShardedHttpCache::EntryConstSharedPtr entry_;
+};
+
+class ShardedInsertContext : public InsertContext {
+public:
+  ShardedInsertContext(LookupContext& lookup_context, ShardedHttpCache& cache)
+      : key_(dynamic_cast<ShardedLookupContext&>(lookup_context).request().key()), cache_(cache) {
+  }
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers, bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+
+    body_.add(chunk);
+    if (end_stream) {
+      commit();
+    } else {
+      ready_for_next_chunk(true);
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap&) override {
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE; // TODO(toddmgreer): support trailers
+  }
+
+private:
+  void commit() {
+    committed_ = true;
+    cache_.insert(key_, std::move(response_headers_), body_.toString());
+  }
+
+  Key key_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  ShardedHttpCache& cache_;
+  Buffer::OwnedImpl body_;
+  bool committed_ = false;
+};
+} // namespace
+
+ShardedHttpCache::Entry::Entry(Http::ResponseHeaderMapPtr&& response_headers, std::string&& body)
+    : response_headers_(std::move(response_headers)), body_(std::move(body)),
+      size_bytes_(response_headers_->byteSize() + body_.size()) {}
+
+ShardedHttpCache::ShardedHttpCache(uint32_t shards, uint64_t max_size_bytes)
+    : max_shard_size_bytes_(max_size_bytes / shards) {
+  ASSERT(shards > 0);
+  shards_.reserve(shards);
+  for (uint32_t i = 0; i < shards; i++) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+LookupContextPtr ShardedHttpCache::makeLookupContext(LookupRequest&& request) {
+  return std::make_unique<ShardedLookupContext>(*this, std::move(request));
+}
+
+void ShardedHttpCache::updateHeaders(LookupContextPtr&& lookup_context,
+                                     Http::ResponseHeaderMapPtr&& response_headers) {
+  ASSERT(lookup_context);
+  ASSERT(response_headers);
+  // TODO(toddmgreer): Support updating headers.
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+
+ShardedHttpCache::EntryConstSharedPtr ShardedHttpCache::lookup(const LookupRequest& request) {
+  const KeyRef key{request.key(), stableHashKey(request.key())};
+  Shard& shard = shardFor(key.hash_);
+  absl::ReaderMutexLock lock(&shard.mutex_);
+  auto iter = shard.map_.find(key);
+  if (iter == shard.map_.end()) {
+    return nullptr;
+  }
+  // Avoid dirtying the cache line if the entry is already marked.
+  if (!iter->second->referenced_.load(std::memory_order_relaxed)) {
+    iter->second->referenced_.store(true, std::memory_order_relaxed);
+  }
+  return iter->second;
+}
+
+void ShardedHttpCache::insert(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+                              std::string&& body) {
+  auto entry = std::make_shared<const Entry>(std::move(response_headers), std::move(body));
+  if (entry->size_bytes_ > max_shard_size_bytes_) {
+    return;
+  }
+
+  const KeyRef key_ref{key, stableHashKey(key)};
+  Shard& shard = shardFor(key_ref.hash_);
+  absl::WriterMutexLock lock(&shard.mutex_);
+  auto iter = shard.map_.find(key_ref);
+  if (iter != shard.map_.end()) {
+    // Replace the entry in place, keeping its position on the clock.
+    shard.size_bytes_ -= iter->second->size_bytes_;
+    iter->second = std::move(entry);
+  } else {
+    iter = shard.map_.emplace(StoredKey{key, key_ref.hash_}, std::move(entry)).first;
+    shard.clock_.insert(shard.clock_hand_, &iter->first);
+  }
+  shard.size_bytes_ += iter->second->size_bytes_;
+  while (shard.size_bytes_ > max_shard_size_bytes_) {
+    evictOne(shard);
+  }
+}
+
+void ShardedHttpCache::evictOne(Shard& shard) {
+  ASSERT(!shard.clock_.empty());
+  while (true) {
+    if (shard.clock_hand_ == shard.clock_.end()) {
+      shard.clock_hand_ = shard.clock_.begin();
+    }
+    auto iter = shard.map_.find(**shard.clock_hand_);
+    ASSERT(iter != shard.map_.end());
+    if (iter->second->referenced_.exchange(false, std::memory_order_relaxed)) {
+      ++shard.clock_hand_;
+      continue;
+    }
+    shard.size_bytes_ -= iter->second->size_bytes_;
+    shard.clock_hand_ = shard.clock_.erase(shard.clock_hand_);
+    shard.map_.erase(iter);
+    return;
+  }
+}
+
+uint64_t ShardedHttpCache::sizeBytes() const {
+  uint64_t size_bytes = 0;
+  for (const auto& shard : shards_) {
+    absl::ReaderMutexLock lock(&shard->mutex_);
+    size_bytes += shard->size_bytes_;
+  }
+  return size_bytes;
+}
+
+uint64_t ShardedHttpCache::size() const {
+  uint64_t size = 0;
+  for (const auto& shard : shards_) {
+    absl::ReaderMutexLock lock(&shard->mutex_);
+    size += shard->map_.size();
+  }
+  return size;
+}
+
+InsertContextPtr ShardedHttpCache::makeInsertContext(LookupContextPtr&& lookup_context) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<ShardedInsertContext>(*lookup_context, *this);
+}
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache.sharded";
+
+CacheInfo ShardedHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  return cache_info;
+}
+
+class ShardedHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string(Name); }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<
+        envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig>();
+  }
+  // From HttpCacheFactory
+  // Only called on the main thread, once per filter config, so the map needs no lock.
+  HttpCacheSharedPtr
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext&) override {
+    envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig typed_config;
+    MessageUtil::unpackTo(config.typed_config(), typed_config);
+    // Filters configured with the same settings share a cache. Only weak references are kept
+    // here, so a cache is freed once the last filter config using it is removed.
+    std::weak_ptr<ShardedHttpCache>& existing = caches_[typed_config];
+    std::shared_ptr<ShardedHttpCache> cache = existing.lock();
+    if (cache == nullptr) {
+      cache = std::make_shared<ShardedHttpCache>(
+          typed_config.shards() > 0 ? typed_config.shards() : ShardedHttpCache::DefaultShards,
+          typed_config.max_size_bytes() > 0 ? typed_config.max_size_bytes()
+                                            : ShardedHttpCache::DefaultMaxSizeBytes);
+      existing = cache;
+    }
+    return cache;
+  }
+
+private:
+  absl::flat_hash_map<envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig,
+                      std::weak_ptr<ShardedHttpCache>, MessageUtil, MessageUtil>
+      caches_;
+};
+
+static Registry::RegisterFactory<ShardedHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+// In-memory cache backend with a size limit. Entries are spread over independently locked shards.
+// Lookups only take their shard's lock in shared mode, so concurrent hits never serialize. When
+// a shard exceeds its share of the byte budget, entries are evicted with the CLOCK (second chance)
+// approximation of LRU: inserts and lookups mark their entry as referenced, and the eviction hand
+// sweeps around the shard, clearing reference marks and evicting the first unmarked entry.
+// Bodies are stored once and lookups serve them by reference, without copying.
+class ShardedHttpCache : public HttpCache {
+public:
+  struct Entry {
+    Entry(Http::ResponseHeaderMapPtr&& response_headers, std::string&& body);
+
+    const Http::ResponseHeaderMapPtr response_headers_;
+    const std::string body_;
+    // Bytes charged against the byte budget.
+    const uint64_t size_bytes_;
+    // Set on insertion and by lookups, cleared by the eviction hand.
+    mutable std::atomic<bool> referenced_{true};
+  };
+  using EntryConstSharedPtr = std::shared_ptr<const Entry>;
+
+  static constexpr uint32_t DefaultShards = 16;
+  static constexpr uint64_t DefaultMaxSizeBytes = 64 * 1024 * 1024;
+
+  ShardedHttpCache(uint32_t shards, uint64_t max_size_bytes);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override;
+  void updateHeaders(LookupContextPtr&& lookup_context,
+                     Http::ResponseHeaderMapPtr&& response_headers) override;
+  CacheInfo cacheInfo() const override;
+
+  EntryConstSharedPtr lookup(const LookupRequest& request);
+  void insert(const Key& key, Http::ResponseHeaderMapPtr&& response_headers, std::string&& body);
+
+  /**
+   * @return the number of bytes charged against the byte budget by all entries.
+   */
+  uint64_t sizeBytes() const;
+
+  /**
+   * @return the number of entries in the cache.
+   */
+  uint64_t size() const;
+
+private:
+  // A key along with its hash, so that keys are only hashed once per operation.
+  struct StoredKey {
+    Key key_;
+    size_t hash_;
+  };
+  struct KeyRef {
+    const Key& key_;
+    size_t hash_;
+  };
+  struct KeyHash {
+    using is_transparent = void;
+    template <class T> size_t operator()(const T& key) const { return key.hash_; }
+  };
+  struct KeyEq {
+    using is_transparent = void;
+    template <class T, class U> bool operator()(const T& lhs, const U& rhs) const {
+      return lhs.hash_ == rhs.hash_ && MessageUtil()(lhs.key_, rhs.key_);
+    }
+  };
+
+  struct Shard {
+    mutable absl::Mutex mutex_;
+    absl::node_hash_map<StoredKey, EntryConstSharedPtr, KeyHash, KeyEq>
+        map_ ABSL_GUARDED_BY(mutex_);
+    // Keys of all entries, swept circularly by clock_hand_. New entries are inserted just behind
+    // the hand, so that they are the last to be considered for eviction.
+    std::list<const StoredKey*> clock_ ABSL_GUARDED_BY(mutex_);
+    std::list<const StoredKey*>::iterator clock_hand_ ABSL_GUARDED_BY(mutex_){clock_.end()};
+    uint64_t size_bytes_ ABSL_GUARDED_BY(mutex_){};
+  };
+
+  Shard& shardFor(size_t hash) { return *shards_[hash % shards_.size()]; }
+  static void evictOne(Shard& shard) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const uint64_t max_shard_size_bytes_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -140,14 +140,32 @@ void DnsFilter::onData(Network::UdpRecvData& client_request) {
 }
 
 void DnsFilter::sendDnsResponse(DnsQueryContextPtr query_context) {
-  Buffer::OwnedImpl response;
+  auto response = std::make_unique<Buffer::OwnedImpl>();
 
   // Serializes the generated response to the parsed query from the client. If there is a
   // parsing error or the incoming query is invalid, we will still generate a valid DNS response
-  message_parser_.buildResponseBuffer(query_context, response);
-  Network::UdpSendData response_data{query_context->local_->ip(), *(query_context->peer_),
-                                     response};
-  listener_.send(response_data);
+  message_parser_.buildResponseBuffer(query_context, *response);
+  if (pending_responses_.empty()) {
+    // A zero timeout fires at the end of the current event loop iteration, after all of the
+    // queries which are readable now have been answered.
+    flush_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+  pending_responses_.push_back({query_context->local_, query_context->peer_, std::move(response)});
+}
+
+void DnsFilter::flushResponses() {
+  std::vector<Network::UdpSendData> response_data;
+  response_data.reserve(pending_responses_.size());
+  for (const PendingResponse& response : pending_responses_) {
+    response_data.push_back({response.local_->ip(), *response.peer_, *response.buffer_});
+  }
+  const Api::IoCallUint64Result result =
+      listener_.sendBatch(response_data.data(), response_data.size());
+  if (!result.ok()) {
+    ENVOY_LOG(debug, "dropped {} DNS responses: {}", pending_responses_.size() - result.rc_,
+              result.err_->getErrorDetails());
+  }
+  pending_responses_.clear();
 }
 
 DnsLookupResponseCode DnsFilter::getResponseForQuery(DnsQueryContextPtr& context) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/event/file_event.h"
+#include "envoy/event/timer.h"
 #include "envoy/extensions/filters/udp/dns_filter/v3alpha/dns_filter.pb.h"
 #include "envoy/network/filter.h"
 
@@ -105,7 +106,8 @@ public:
   DnsFilter(Network::UdpReadFilterCallbacks& callbacks, const DnsFilterEnvoyConfigSharedPtr& config)
       : UdpListenerReadFilter(callbacks), config_(config), listener_(callbacks.udpListener()),
         cluster_manager_(config_->clusterManager()),
-        message_parser_(config->forwardQueries(), config->retryCount(), config->random()) {}
+        message_parser_(config->forwardQueries(), config->retryCount(), config->random()),
+        flush_timer_(listener_.dispatcher().createTimer([this] { flushResponses(); })) {}
 
   // Network::UdpListenerReadFilter callbacks
   void onData(Network::UdpRecvData& client_request) override;
@@ -124,6 +126,11 @@ private:
    */
   void sendDnsResponse(DnsQueryContextPtr context);
 
+  /**
+   * Send the responses queued by sendDnsResponse() in this event loop iteration in a batch
+   */
+  void flushResponses();
+
   /**
    * @brief Encapsulates all of the logic required to find an answer for a DNS query
    *
@@ -178,6 +185,19 @@ private:
   Network::Address::InstanceConstSharedPtr local_;
   Network::Address::InstanceConstSharedPtr peer_;
   AnswerCallback answer_callback_;
+
+  // A response queued by sendDnsResponse().
+  struct PendingResponse {
+    Network::Address::InstanceConstSharedPtr local_;
+    Network::Address::InstanceConstSharedPtr peer_;
+    Buffer::InstancePtr buffer_;
+  };
+
+  // Responses are queued while the queries read from the socket are answered, and sent with as few
+  // system calls as possible when this zero timeout timer fires at the end of the event loop
+  // iteration.
+  const Event::TimerPtr flush_timer_;
+  std::vector<PendingResponse> pending_responses_;
 };
 
 } // namespace DnsFilter
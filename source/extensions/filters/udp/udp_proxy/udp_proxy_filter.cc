@@ -1,5 +1,7 @@
 #include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
 
+#include <algorithm>
+
 #include "envoy/network/listener.h"
 
 namespace Envoy {
@@ -11,7 +13,8 @@ UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
                                const UdpProxyFilterConfigSharedPtr& config)
     : UdpListenerReadFilter(callbacks), config_(config),
       cluster_update_callbacks_(
-          config->clusterManager().addThreadLocalClusterUpdateCallbacks(*this)) {
+          config->clusterManager().addThreadLocalClusterUpdateCallbacks(*this)),
+      flush_timer_(callbacks.udpListener().dispatcher().createTimer([this] { flushSessions(); })) {
   Upstream::ThreadLocalCluster* cluster = config->clusterManager().get(config->cluster());
   if (cluster != nullptr) {
     onClusterAddOrUpdate(*cluster);
@@ -50,6 +53,14 @@ void UdpProxyFilter::onReceiveError(Api::IoError::IoErrorCode) {
   config_->stats().downstream_sess_rx_errors_.inc();
 }
 
+void UdpProxyFilter::flushSessions() {
+  // Flushing never creates or destroys sessions, so the list is stable while it is walked.
+  for (ActiveSession* session : sessions_to_flush_) {
+    session->flush();
+  }
+  sessions_to_flush_.clear();
+}
+
 UdpProxyFilter::ClusterInfo::ClusterInfo(UdpProxyFilter& filter,
                                          Upstream::ThreadLocalCluster& cluster)
     : filter_(filter), cluster_(cluster),
@@ -122,7 +133,7 @@ void UdpProxyFilter::ClusterInfo::onData(Network::UdpRecvData& data) {
     }
   }
 
-  active_session->write(*data.buffer_);
+  active_session->write(std::move(data.buffer_));
 }
 
 UdpProxyFilter::ActiveSession*
@@ -158,6 +169,7 @@ UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
       // NOTE: The socket call can only fail due to memory/fd exhaustion. No local ephemeral port
       //       is bound until the first packet is sent to the upstream host.
       io_handle_(cluster.filter_.createIoHandle(host)),
+      gro_enabled_(cluster.filter_.enableUdpGro(*io_handle_)),
       socket_event_(cluster.filter_.read_callbacks_->udpListener().dispatcher().createFileEvent(
           io_handle_->fd(), [this](uint32_t) { onReadReady(); }, Event::FileTriggerType::Edge,
           Event::FileReadyType::Read)) {
@@ -179,6 +191,11 @@ UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
 }
 
 UdpProxyFilter::ActiveSession::~ActiveSession() {
+  if (flush_scheduled_) {
+    // Datagrams still queued for this session are dropped.
+    auto& sessions_to_flush = cluster_.filter_.sessions_to_flush_;
+    sessions_to_flush.erase(std::find(sessions_to_flush.begin(), sessions_to_flush.end(), this));
+  }
   cluster_.filter_.config_->stats().downstream_sess_active_.dec();
   cluster_.cluster_.info()
       ->resourceManager(Upstream::ResourcePriority::Default)
@@ -208,28 +225,17 @@ void UdpProxyFilter::ActiveSession::onReadReady() {
   }
 }
 
-void UdpProxyFilter::ActiveSession::write(const Buffer::Instance& buffer) {
+void UdpProxyFilter::ActiveSession::write(Buffer::InstancePtr&& buffer) {
   ENVOY_LOG(trace, "writing {} byte datagram upstream: downstream={} local={} upstream={}",
-            buffer.length(), addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
+            buffer->length(), addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host_->address()->asStringView());
-  const uint64_t buffer_length = buffer.length();
-  cluster_.filter_.config_->stats().downstream_sess_rx_bytes_.add(buffer_length);
+  cluster_.filter_.config_->stats().downstream_sess_rx_bytes_.add(buffer->length());
   cluster_.filter_.config_->stats().downstream_sess_rx_datagrams_.inc();
 
   idle_timer_->enableTimer(cluster_.filter_.config_->sessionTimeout());
 
-  // NOTE: On the first write, a local ephemeral port is bound, and thus this write can fail due to
-  //       port exhaustion.
-  // NOTE: We do not specify the local IP to use for the sendmsg call. We allow the OS to select
-  //       the right IP based on outbound routing rules.
-  Api::IoCallUint64Result rc =
-      Network::Utility::writeToSocket(*io_handle_, buffer, nullptr, *host_->address());
-  if (!rc.ok()) {
-    cluster_.cluster_stats_.sess_tx_errors_.inc();
-  } else {
-    cluster_.cluster_stats_.sess_tx_datagrams_.inc();
-    cluster_.cluster_.info()->stats().upstream_cx_tx_bytes_total_.add(buffer_length);
-  }
+  pending_upstream_.push_back(std::move(buffer));
+  scheduleFlush();
 }
 
 void UdpProxyFilter::ActiveSession::processPacket(Network::Address::InstanceConstSharedPtr,
@@ -238,18 +244,76 @@ void UdpProxyFilter::ActiveSession::processPacket(Network::Address::InstanceCons
   ENVOY_LOG(trace, "writing {} byte datagram downstream: downstream={} local={} upstream={}",
             buffer->length(), addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host_->address()->asStringView());
-  const uint64_t buffer_length = buffer->length();
 
   cluster_.cluster_stats_.sess_rx_datagrams_.inc();
-  cluster_.cluster_.info()->stats().upstream_cx_rx_bytes_total_.add(buffer_length);
+  cluster_.cluster_.info()->stats().upstream_cx_rx_bytes_total_.add(buffer->length());
 
-  Network::UdpSendData data{addresses_.local_->ip(), *addresses_.peer_, *buffer};
-  const Api::IoCallUint64Result rc = cluster_.filter_.read_callbacks_->udpListener().send(data);
-  if (!rc.ok()) {
-    cluster_.filter_.config_->stats().downstream_sess_tx_errors_.inc();
-  } else {
-    cluster_.filter_.config_->stats().downstream_sess_tx_bytes_.add(buffer_length);
-    cluster_.filter_.config_->stats().downstream_sess_tx_datagrams_.inc();
+  pending_downstream_.push_back(std::move(buffer));
+  scheduleFlush();
+}
+
+void UdpProxyFilter::ActiveSession::scheduleFlush() {
+  if (flush_scheduled_) {
+    return;
+  }
+  flush_scheduled_ = true;
+  if (cluster_.filter_.sessions_to_flush_.empty()) {
+    // A zero timeout fires at the end of the current event loop iteration, after all of the
+    // packets which are readable now have been queued.
+    cluster_.filter_.flush_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+  cluster_.filter_.sessions_to_flush_.push_back(this);
+}
+
+void UdpProxyFilter::ActiveSession::flush() {
+  flush_scheduled_ = false;
+
+  if (!pending_upstream_.empty()) {
+    // NOTE: On the first write, a local ephemeral port is bound, and thus this write can fail due
+    //       to port exhaustion.
+    // NOTE: We do not specify the local IP to use for the sendmmsg call. We allow the OS to select
+    //       the right IP based on outbound routing rules.
+    const Network::Address::InstanceConstSharedPtr upstream_address = host_->address();
+    std::vector<Network::UdpSendData> data;
+    data.reserve(pending_upstream_.size());
+    for (const Buffer::InstancePtr& buffer : pending_upstream_) {
+      data.push_back({nullptr, *upstream_address, *buffer});
+    }
+    const Api::IoCallUint64Result rc =
+        Network::Utility::writePacketsToSocket(*io_handle_, data.data(), data.size());
+    for (uint64_t i = 0; i < rc.rc_; ++i) {
+      cluster_.cluster_stats_.sess_tx_datagrams_.inc();
+      cluster_.cluster_.info()->stats().upstream_cx_tx_bytes_total_.add(
+          pending_upstream_[i]->length());
+    }
+    // Datagrams which were not sent due to an error are dropped.
+    if (rc.rc_ < pending_upstream_.size()) {
+      cluster_.cluster_stats_.sess_tx_errors_.add(pending_upstream_.size() - rc.rc_);
+    }
+    pending_upstream_.clear();
+  }
+
+  if (!pending_downstream_.empty()) {
+    std::vector<Network::UdpSendData> data;
+    std::vector<uint64_t> lengths;
+    data.reserve(pending_downstream_.size());
+    lengths.reserve(pending_downstream_.size());
+    for (const Buffer::InstancePtr& buffer : pending_downstream_) {
+      data.push_back({addresses_.local_->ip(), *addresses_.peer_, *buffer});
+      lengths.push_back(buffer->length());
+    }
+    const Api::IoCallUint64Result rc =
+        cluster_.filter_.read_callbacks_->udpListener().sendBatch(data.data(), data.size());
+    for (uint64_t i = 0; i < rc.rc_; ++i) {
+      cluster_.filter_.config_->stats().downstream_sess_tx_bytes_.add(lengths[i]);
+      cluster_.filter_.config_->stats().downstream_sess_tx_datagrams_.inc();
+    }
+    // Datagrams which were not sent due to an error are dropped.
+    if (rc.rc_ < pending_downstream_.size()) {
+      cluster_.filter_.config_->stats().downstream_sess_tx_errors_.add(pending_downstream_.size() -
+                                                                        rc.rc_);
+    }
+    pending_downstream_.clear();
   }
 }
 
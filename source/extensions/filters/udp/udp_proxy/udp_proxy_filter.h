@@ -116,11 +116,13 @@ private:
     ~ActiveSession() override;
     const Network::UdpRecvData::LocalPeerAddresses& addresses() const { return addresses_; }
     const Upstream::Host& host() const { return *host_; }
-    void write(const Buffer::Instance& buffer);
+    void write(Buffer::InstancePtr&& buffer);
+    void flush();
 
   private:
     void onIdleTimer();
     void onReadReady();
+    void scheduleFlush();
 
     // Network::UdpPacketProcessor
     void processPacket(Network::Address::InstanceConstSharedPtr local_address,
@@ -130,7 +132,7 @@ private:
       // TODO(mattklein123): Support configurable/jumbo frames when proxying to upstream.
       // Eventually we will want to support some type of PROXY header when doing L4 QUIC
       // forwarding.
-      return Network::MAX_UDP_PACKET_SIZE;
+      return gro_enabled_ ? Network::MAX_UDP_GRO_PACKET_SIZE : Network::MAX_UDP_PACKET_SIZE;
     }
 
     ClusterInfo& cluster_;
@@ -146,7 +148,13 @@ private:
     // packets from the upstream host. Note that a a local ephemeral port is bound on the first
     // write to the upstream host.
     const Network::IoHandlePtr io_handle_;
+    // Whether the kernel may coalesce datagrams received from the upstream host with UDP GRO.
+    const bool gro_enabled_;
     const Event::FileEventPtr socket_event_;
+    // Datagrams queued in this event loop iteration, which are sent in batches by flush().
+    std::vector<Buffer::InstancePtr> pending_upstream_;
+    std::vector<Buffer::InstancePtr> pending_downstream_;
+    bool flush_scheduled_{false};
   };
 
   using ActiveSessionPtr = std::unique_ptr<ActiveSession>;
@@ -225,12 +233,23 @@ private:
                                             host->address());
   }
 
+  virtual bool enableUdpGro(Network::IoHandle& io_handle) {
+    // Virtual so this can be overridden in unit tests.
+    return Network::Utility::enableUdpGro(io_handle);
+  }
+
+  void flushSessions();
+
   // Upstream::ClusterUpdateCallbacks
   void onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) override;
   void onClusterRemoval(const std::string& cluster_name) override;
 
   const UdpProxyFilterConfigSharedPtr config_;
   const Upstream::ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_;
+  // Datagrams are queued by the sessions while packets are read, and sent with as few system calls
+  // as possible when this zero timeout timer fires at the end of the event loop iteration.
+  const Event::TimerPtr flush_timer_;
+  std::vector<ActiveSession*> sessions_to_flush_;
   // Right now we support a single cluster to route to. It is highly likely in the future that
   // we will support additional routing options either using filter chain matching, weighting,
   // etc.
@@ -62,7 +62,15 @@ public:
     }
     return io_handle_.recvmmsg(slices, self_port, output);
   }
+  Api::IoCallUint64Result sendmmsg(const SendMsgPacket* packets, uint64_t num_packets) override {
+    if (closed_) {
+      return Api::IoCallUint64Result(0, Api::IoErrorPtr(new Network::IoSocketError(EBADF),
+                                                        Network::IoSocketError::deleteIoError));
+    }
+    return io_handle_.sendmmsg(packets, num_packets);
+  }
   bool supportsMmsg() const override { return io_handle_.supportsMmsg(); }
+  bool supportsUdpGso() const override { return io_handle_.supportsUdpGso(); }
 
 private:
   Network::IoHandle& io_handle_;
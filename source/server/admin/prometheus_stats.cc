@@ -3,6 +3,8 @@
 #include "common/common/empty_string.h"
 #include "common/stats/histogram_impl.h"
 
+#include "server/admin/utils.h"
+
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -48,25 +50,43 @@ struct MetricLessThan {
   }
 };
 
+/*
+ * Writes the tags of a metric as a comma-separated list of <tag_name>="<tag_value>" pairs into
+ * `out`, replacing its contents but reusing its capacity.
+ */
+void formatTags(const Stats::Metric& metric, PrometheusStatsFormatter::MetricNameCache& name_cache,
+                std::string& out) {
+  out.clear();
+  const Stats::SymbolTable& symbol_table = metric.constSymbolTable();
+  metric.iterateTagStatNames([&](Stats::StatName name, Stats::StatName value) -> bool {
+    absl::StrAppend(&out, out.empty() ? "" : ",", name_cache.tagName(name), "=\"",
+                    symbol_table.toString(value), "\"");
+    return true;
+  });
+}
+
 /**
- * Processes a stat type (counter, gauge, histogram) by generating all output lines, sorting
- * them by tag-extracted metric name, and then outputting them in the correct sorted order into
- * response.
+ * Processes a stat type (counter, gauge, histogram) by grouping the metrics by tag-extracted
+ * metric name, and then writing their output lines in sorted order into the writer.
  *
- * @param response The buffer to put the output into.
+ * @param writer The writer to put the output into.
  * @param used_only Whether to only output stats that are used.
  * @param regex A filter on which stats to output.
  * @param metrics The metrics to output stats for. This must contain all stats of the given type
  *        to be included in the same output.
- * @param generate_output A function which returns the output text for this metric.
+ * @param name_cache The cache of sanitized names, or nullptr.
+ * @param generate_output A function which writes the output text for this metric.
  * @param type The name of the prometheus metric type for used in TYPE annotations.
  */
 template <class StatType>
 uint64_t outputStatType(
-    Buffer::Instance& response, const bool used_only, const absl::optional<std::regex>& regex,
+    Utility::ChunkedWriter& writer, const bool used_only, const absl::optional<std::regex>& regex,
     const std::vector<Stats::RefcountPtr<StatType>>& metrics,
-    const std::function<std::string(
-        const StatType& metric, const std::string& prefixed_tag_extracted_name)>& generate_output,
+    PrometheusStatsFormatter::MetricNameCache* name_cache,
+    const std::function<void(Utility::ChunkedWriter& writer, const StatType& metric,
+                             absl::string_view prefixed_tag_extracted_name,
+                             PrometheusStatsFormatter::MetricNameCache& name_cache,
+                             std::string& tags)>& generate_output,
     absl::string_view type) {
 
   /*
@@ -95,7 +115,14 @@ uint64_t outputStatType(
   // interface. If this assumption changes, the name comparisons in this function
   // will have to change to compare to convert all StatNames to strings before
   // comparison.
-  const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
+  Stats::SymbolTable& global_symbol_table = metrics.front()->symbolTable();
+
+  // The names of the given cache are only usable for stats of the same symbol table. Otherwise
+  // the names are only cached for the duration of this call.
+  absl::optional<PrometheusStatsFormatter::MetricNameCache> local_name_cache;
+  if (name_cache == nullptr || &name_cache->constSymbolTable() != &global_symbol_table) {
+    name_cache = &local_name_cache.emplace(global_symbol_table);
+  }
 
   // Sorted collection of metrics sorted by their tagExtractedName, to satisfy the requirements
   // of the exposition format.
@@ -112,10 +139,11 @@ uint64_t outputStatType(
     groups[metric->tagExtractedStatName()].push_back(metric.get());
   }
 
+  // Reused across metrics, to format their tags without an allocation per metric.
+  std::string tags;
   for (auto& group : groups) {
-    const std::string prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(global_symbol_table.toString(group.first));
-    response.add(fmt::format("# TYPE {0} {1}\n", prefixed_tag_extracted_name, type));
+    const std::string& prefixed_tag_extracted_name = name_cache->metricName(group.first);
+    writer.add("# TYPE ", prefixed_tag_extracted_name, " ", type, "\n");
 
     // Sort before producing the final output to satisfy the "preferred" ordering from the
     // prometheus spec: metrics will be sorted by their tags' textual representation, which will
@@ -123,37 +151,41 @@ uint64_t outputStatType(
     std::sort(group.second.begin(), group.second.end(), MetricLessThan());
 
     for (const auto& metric : group.second) {
-      response.add(generate_output(*metric, prefixed_tag_extracted_name));
+      generate_output(writer, *metric, prefixed_tag_extracted_name, *name_cache, tags);
     }
-    response.add("\n");
+    writer.add("\n");
   }
   return groups.size();
 }
 
 /*
- * Return the prometheus output for a numeric Stat (Counter or Gauge).
+ * Writes the prometheus output for a numeric Stat (Counter or Gauge).
  */
 template <class StatType>
-std::string generateNumericOutput(const StatType& metric,
-                                  const std::string& prefixed_tag_extracted_name) {
-  const std::string tags = PrometheusStatsFormatter::formattedTags(metric.tags());
-  return fmt::format("{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, tags, metric.value());
+void generateNumericOutput(Utility::ChunkedWriter& writer, const StatType& metric,
+                           absl::string_view prefixed_tag_extracted_name,
+                           PrometheusStatsFormatter::MetricNameCache& name_cache,
+                           std::string& tags) {
+  formatTags(metric, name_cache, tags);
+  writer.add(prefixed_tag_extracted_name, "{", tags, "} ", metric.value(), "\n");
 }
 
 /*
- * Returns the prometheus output for a histogram. The output is a multi-line string (with embedded
- * newlines) that contains all the individual bucket counts and sum/count for a single histogram
- * (metric_name plus all tags).
+ * Writes the prometheus output for a histogram. The output is multiple lines that contain all
+ * the individual bucket counts and sum/count for a single histogram (metric_name plus all tags).
  */
-std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
-                                    const std::string& prefixed_tag_extracted_name) {
-  const std::string tags = PrometheusStatsFormatter::formattedTags(histogram.tags());
-  const std::string hist_tags = histogram.tags().empty() ? EMPTY_STRING : (tags + ",");
+void generateHistogramOutput(Utility::ChunkedWriter& writer,
+                             const Stats::ParentHistogram& histogram,
+                             absl::string_view prefixed_tag_extracted_name,
+                             PrometheusStatsFormatter::MetricNameCache& name_cache,
+                             std::string& tags) {
+  formatTags(histogram, name_cache, tags);
+  const absl::string_view hist_tags_separator = tags.empty() ? "" : ",";
 
   const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
   const std::vector<double>& supported_buckets = stats.supportedBuckets();
   const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
-  std::string output;
+  std::string& output = writer.chunk();
   for (size_t i = 0; i < supported_buckets.size(); ++i) {
     double bucket = supported_buckets[i];
     uint64_t value = computed_buckets[i];
@@ -162,18 +194,17 @@ std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
     // 'g' operator which prints the number in general fixed point format or scientific format
     // with precision 50 to round the number up to 32 significant digits in fixed point format
     // which should cover pretty much all cases
-    output.append(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", prefixed_tag_extracted_name,
-                              hist_tags, bucket, value));
+    fmt::format_to(std::back_inserter(output), "{0}_bucket{{{1}{2}le=\"{3:.32g}\"}} {4}\n",
+                   prefixed_tag_extracted_name, tags, hist_tags_separator, bucket, value);
   }
 
-  output.append(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name,
-                            hist_tags, stats.sampleCount()));
-  output.append(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleSum()));
-  output.append(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleCount()));
-
-  return output;
+  fmt::format_to(std::back_inserter(output), "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n",
+                 prefixed_tag_extracted_name, tags, hist_tags_separator, stats.sampleCount());
+  fmt::format_to(std::back_inserter(output), "{0}_sum{{{1}}} {2:.32g}\n",
+                 prefixed_tag_extracted_name, tags, stats.sampleSum());
+  fmt::format_to(std::back_inserter(output), "{0}_count{{{1}}} {2}\n",
+                 prefixed_tag_extracted_name, tags, stats.sampleCount());
+  writer.maybeFlush();
 };
 
 } // namespace
@@ -194,23 +225,80 @@ std::string PrometheusStatsFormatter::metricName(const std::string& extracted_na
   return sanitizeName(fmt::format("envoy_{0}", extracted_name));
 }
 
+PrometheusStatsFormatter::MetricNameCache::~MetricNameCache() {
+  for (EntryMap* entries : {&metric_names_, &tag_names_}) {
+    for (auto& entry : *entries) {
+      entry.second.storage_.free(symbol_table_);
+    }
+  }
+}
+
+const std::string&
+PrometheusStatsFormatter::MetricNameCache::metricName(Stats::StatName tag_extracted_name) {
+  return lookup(metric_names_, tag_extracted_name, true);
+}
+
+const std::string& PrometheusStatsFormatter::MetricNameCache::tagName(Stats::StatName tag_name) {
+  return lookup(tag_names_, tag_name, false);
+}
+
+const std::string& PrometheusStatsFormatter::MetricNameCache::lookup(EntryMap& entries,
+                                                                     Stats::StatName stat_name,
+                                                                     bool metric) {
+  auto it = entries.find(stat_name);
+  if (it == entries.end()) {
+    const std::string name = symbol_table_.toString(stat_name);
+    Entry entry(stat_name, symbol_table_,
+                metric ? PrometheusStatsFormatter::metricName(name) : sanitizeName(name));
+    // The key refers to the storage of the entry, which is heap allocated and so is not moved.
+    const Stats::StatName key = entry.storage_.statName();
+    it = entries.emplace(key, std::move(entry)).first;
+  }
+  it->second.used_ = true;
+  return it->second.name_;
+}
+
+void PrometheusStatsFormatter::MetricNameCache::evictUnused() {
+  evictUnused(metric_names_);
+  evictUnused(tag_names_);
+}
+
+void PrometheusStatsFormatter::MetricNameCache::evictUnused(EntryMap& entries) {
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second.used_) {
+      it->second.used_ = false;
+      ++it;
+    } else {
+      it->second.storage_.free(symbol_table_);
+      entries.erase(it++);
+    }
+  }
+}
+
 // TODO(efimki): Add support of text readouts stats.
 uint64_t PrometheusStatsFormatter::statsAsPrometheus(
     const std::vector<Stats::CounterSharedPtr>& counters,
     const std::vector<Stats::GaugeSharedPtr>& gauges,
     const std::vector<Stats::ParentHistogramSharedPtr>& histograms, Buffer::Instance& response,
-    const bool used_only, const absl::optional<std::regex>& regex) {
+    const bool used_only, const absl::optional<std::regex>& regex, MetricNameCache* name_cache) {
 
   uint64_t metric_name_count = 0;
-  metric_name_count += outputStatType<Stats::Counter>(
-      response, used_only, regex, counters, generateNumericOutput<Stats::Counter>, "counter");
+  {
+    Utility::ChunkedWriter writer(response);
+    metric_name_count += outputStatType<Stats::Counter>(
+        writer, used_only, regex, counters, name_cache, generateNumericOutput<Stats::Counter>,
+        "counter");
 
-  metric_name_count += outputStatType<Stats::Gauge>(response, used_only, regex, gauges,
-                                                    generateNumericOutput<Stats::Gauge>, "gauge");
+    metric_name_count += outputStatType<Stats::Gauge>(writer, used_only, regex, gauges, name_cache,
+                                                      generateNumericOutput<Stats::Gauge>, "gauge");
 
-  metric_name_count += outputStatType<Stats::ParentHistogram>(
-      response, used_only, regex, histograms, generateHistogramOutput, "histogram");
+    metric_name_count += outputStatType<Stats::ParentHistogram>(
+        writer, used_only, regex, histograms, name_cache, generateHistogramOutput, "histogram");
+  }
 
+  if (name_cache != nullptr) {
+    name_cache->evictUnused();
+  }
   return metric_name_count;
 }
 
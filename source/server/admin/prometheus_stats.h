@@ -7,6 +7,10 @@
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/stats.h"
 
+#include "common/stats/symbol_table_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Server {
 /**
@@ -16,16 +20,76 @@ namespace Server {
  */
 class PrometheusStatsFormatter {
 public:
+  /**
+   * Caches the sanitized prometheus names of tag-extracted stat names and tag names across
+   * scrapes, so that each is elaborated into a string once rather than once per scrape. Names
+   * which are not output by a scrape are evicted at its end, so the cache does not retain the
+   * names of deleted stats. Not thread-safe; it is meant to be owned by the admin handler.
+   */
+  class MetricNameCache {
+  public:
+    explicit MetricNameCache(Stats::SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+    ~MetricNameCache();
+
+    /**
+     * @return the symbol table of the cached names.
+     */
+    const Stats::SymbolTable& constSymbolTable() const { return symbol_table_; }
+
+    /**
+     * @return the sanitized metric name for a tag-extracted stat name, prefixed with "envoy_".
+     */
+    const std::string& metricName(Stats::StatName tag_extracted_name);
+
+    /**
+     * @return the sanitized name of a tag.
+     */
+    const std::string& tagName(Stats::StatName tag_name);
+
+    /**
+     * Evicts the names which were not used since the previous call.
+     */
+    void evictUnused();
+
+    /**
+     * @return the number of cached names.
+     */
+    size_t size() const { return metric_names_.size() + tag_names_.size(); }
+
+  private:
+    struct Entry {
+      Entry(Stats::StatName stat_name, Stats::SymbolTable& symbol_table, std::string name)
+          : storage_(stat_name, symbol_table), name_(std::move(name)) {}
+
+      // Owns the bytes of the key, which do not move with the entry.
+      Stats::StatNameStorage storage_;
+      std::string name_;
+      bool used_{true};
+    };
+    using EntryMap = absl::flat_hash_map<Stats::StatName, Entry>;
+
+    const std::string& lookup(EntryMap& entries, Stats::StatName stat_name, bool metric);
+    void evictUnused(EntryMap& entries);
+
+    Stats::SymbolTable& symbol_table_;
+    EntryMap metric_names_;
+    EntryMap tag_names_;
+  };
+
   /**
    * Extracts counters and gauges and relevant tags, appending them to
    * the response buffer after sanitizing the metric / label names.
+   * The output is written in chunks as the stats are visited, in sorted
+   * stat name order, without building intermediate strings per stat.
+   * @param name_cache optionally supplies the names cached by previous scrapes.
    * @return uint64_t total number of metric types inserted in response.
    */
   static uint64_t statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
                                     const std::vector<Stats::GaugeSharedPtr>& gauges,
                                     const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
                                     Buffer::Instance& response, const bool used_only,
-                                    const absl::optional<std::regex>& regex);
+                                    const absl::optional<std::regex>& regex,
+                                    MetricNameCache* name_cache = nullptr);
   /**
    * Format the given tags, returning a string as a comma-separated list
    * of <tag_name>="<tag_value>" pairs.
@@ -3,6 +3,7 @@
 #include "envoy/admin/v3/mutex_stats.pb.h"
 
 #include "common/common/empty_string.h"
+#include "common/common/json_escape_string.h"
 #include "common/html/utility.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
@@ -80,32 +81,12 @@ Http::Code StatsHandler::handlerStats(absl::string_view url,
     return Http::Code::BadRequest;
   }
 
-  std::map<std::string, uint64_t> all_stats;
-  for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
-    if (shouldShowMetric(*counter, used_only, regex)) {
-      all_stats.emplace(counter->name(), counter->value());
-    }
-  }
-
-  for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
-    if (shouldShowMetric(*gauge, used_only, regex)) {
-      ASSERT(gauge->importMode() != Stats::Gauge::ImportMode::Uninitialized);
-      all_stats.emplace(gauge->name(), gauge->value());
-    }
-  }
-
-  std::map<std::string, std::string> text_readouts;
-  for (const auto& text_readout : server_.stats().textReadouts()) {
-    if (shouldShowMetric(*text_readout, used_only, regex)) {
-      text_readouts.emplace(text_readout->name(), text_readout->value());
-    }
-  }
-
   if (const auto format_value = Utility::formatParam(params)) {
     if (format_value.value() == "json") {
       response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Json);
-      response.add(
-          statsAsJson(all_stats, text_readouts, server_.stats().histograms(), used_only, regex));
+      statsAsJson(server_.stats().counters(), server_.stats().gauges(),
+                  server_.stats().textReadouts(), server_.stats().histograms(), used_only, regex,
+                  response);
     } else if (format_value.value() == "prometheus") {
       return handlerPrometheusStats(url, response_headers, response, admin_stream);
     } else {
@@ -114,6 +95,27 @@ Http::Code StatsHandler::handlerStats(absl::string_view url,
       rc = Http::Code::NotFound;
     }
   } else { // Display plain stats if format query param is not there.
+    std::map<std::string, uint64_t> all_stats;
+    for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
+      if (shouldShowMetric(*counter, used_only, regex)) {
+        all_stats.emplace(counter->name(), counter->value());
+      }
+    }
+
+    for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
+      if (shouldShowMetric(*gauge, used_only, regex)) {
+        ASSERT(gauge->importMode() != Stats::Gauge::ImportMode::Uninitialized);
+        all_stats.emplace(gauge->name(), gauge->value());
+      }
+    }
+
+    std::map<std::string, std::string> text_readouts;
+    for (const auto& text_readout : server_.stats().textReadouts()) {
+      if (shouldShowMetric(*text_readout, used_only, regex)) {
+        text_readouts.emplace(text_readout->name(), text_readout->value());
+      }
+    }
+
     for (const auto& text_readout : text_readouts) {
       response.add(fmt::format("{}: \"{}\"\n", text_readout.first,
                                Html::Utility::sanitize(text_readout.second)));
@@ -146,9 +148,13 @@ Http::Code StatsHandler::handlerPrometheusStats(absl::string_view path_and_query
   if (!Utility::filterParam(params, response, regex)) {
     return Http::Code::BadRequest;
   }
+  if (prometheus_name_cache_ == nullptr) {
+    prometheus_name_cache_ = std::make_unique<PrometheusStatsFormatter::MetricNameCache>(
+        server_.stats().symbolTable());
+  }
   PrometheusStatsFormatter::statsAsPrometheus(server_.stats().counters(), server_.stats().gauges(),
                                               server_.stats().histograms(), response, used_only,
-                                              regex);
+                                              regex, prometheus_name_cache_.get());
   return Http::Code::OK;
 }
 
@@ -172,85 +178,89 @@ Http::Code StatsHandler::handlerContention(absl::string_view,
   return Http::Code::OK;
 }
 
-std::string
-StatsHandler::statsAsJson(const std::map<std::string, uint64_t>& all_stats,
-                          const std::map<std::string, std::string>& text_readouts,
-                          const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                          const bool used_only, const absl::optional<std::regex> regex,
-                          const bool pretty_print) {
-
-  ProtobufWkt::Struct document;
-  std::vector<ProtobufWkt::Value> stats_array;
-  for (const auto& text_readout : text_readouts) {
-    ProtobufWkt::Struct stat_obj;
-    auto* stat_obj_fields = stat_obj.mutable_fields();
-    (*stat_obj_fields)["name"] = ValueUtil::stringValue(text_readout.first);
-    (*stat_obj_fields)["value"] = ValueUtil::stringValue(text_readout.second);
-    stats_array.push_back(ValueUtil::structValue(stat_obj));
-  }
-  for (const auto& stat : all_stats) {
-    ProtobufWkt::Struct stat_obj;
-    auto* stat_obj_fields = stat_obj.mutable_fields();
-    (*stat_obj_fields)["name"] = ValueUtil::stringValue(stat.first);
-    (*stat_obj_fields)["value"] = ValueUtil::numberValue(stat.second);
-    stats_array.push_back(ValueUtil::structValue(stat_obj));
+void StatsHandler::statsAsJson(const std::vector<Stats::CounterSharedPtr>& counters,
+                               const std::vector<Stats::GaugeSharedPtr>& gauges,
+                               const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+                               const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                               const bool used_only, const absl::optional<std::regex>& regex,
+                               Buffer::Instance& response) {
+  Utility::ChunkedWriter writer(response);
+  writer.add("{\"stats\":[");
+  bool first_stat = true;
+  // Writes the start of a stat object, up to its value.
+  const auto add_stat_name = [&writer, &first_stat](absl::string_view name) {
+    writer.add(first_stat ? "" : ",", "{\"name\":\"");
+    JsonEscaper::appendEscaped(name, writer.chunk());
+    writer.add("\",\"value\":");
+    first_stat = false;
+  };
+
+  for (const auto& text_readout : sortedMetrics(text_readouts, used_only, regex)) {
+    add_stat_name(text_readout.first);
+    writer.add("\"");
+    JsonEscaper::appendEscaped(text_readout.second->value(), writer.chunk());
+    writer.add("\"}");
   }
 
-  ProtobufWkt::Struct histograms_obj;
-  auto* histograms_obj_fields = histograms_obj.mutable_fields();
-
-  ProtobufWkt::Struct histograms_obj_container;
-  auto* histograms_obj_container_fields = histograms_obj_container.mutable_fields();
-  std::vector<ProtobufWkt::Value> computed_quantile_array;
-
-  bool found_used_histogram = false;
-  for (const Stats::ParentHistogramSharedPtr& histogram : all_histograms) {
-    if (shouldShowMetric(*histogram, used_only, regex)) {
-      if (!found_used_histogram) {
-        // It is not possible for the supported quantiles to differ across histograms, so it is ok
-        // to send them once.
-        Stats::HistogramStatisticsImpl empty_statistics;
-        std::vector<ProtobufWkt::Value> supported_quantile_array;
-        for (double quantile : empty_statistics.supportedQuantiles()) {
-          supported_quantile_array.push_back(ValueUtil::numberValue(quantile * 100));
-        }
-        (*histograms_obj_fields)["supported_quantiles"] =
-            ValueUtil::listValue(supported_quantile_array);
-        found_used_histogram = true;
+  // Counters and gauges are output as one list sorted by name. A gauge with the name of a counter
+  // is not output.
+  const std::vector<NamedMetric<Stats::Counter>> sorted_counters =
+      sortedMetrics(counters, used_only, regex);
+  const std::vector<NamedMetric<Stats::Gauge>> sorted_gauges =
+      sortedMetrics(gauges, used_only, regex);
+  auto counter = sorted_counters.begin();
+  auto gauge = sorted_gauges.begin();
+  while (counter != sorted_counters.end() || gauge != sorted_gauges.end()) {
+    if (gauge == sorted_gauges.end() ||
+        (counter != sorted_counters.end() && counter->first <= gauge->first)) {
+      if (gauge != sorted_gauges.end() && gauge->first == counter->first) {
+        ++gauge;
       }
-
-      ProtobufWkt::Struct computed_quantile;
-      auto* computed_quantile_fields = computed_quantile.mutable_fields();
-      (*computed_quantile_fields)["name"] = ValueUtil::stringValue(histogram->name());
-
-      std::vector<ProtobufWkt::Value> computed_quantile_value_array;
-      for (size_t i = 0; i < histogram->intervalStatistics().supportedQuantiles().size(); ++i) {
-        ProtobufWkt::Struct computed_quantile_value;
-        auto* computed_quantile_value_fields = computed_quantile_value.mutable_fields();
-        const auto& interval = histogram->intervalStatistics().computedQuantiles()[i];
-        const auto& cumulative = histogram->cumulativeStatistics().computedQuantiles()[i];
-        (*computed_quantile_value_fields)["interval"] =
-            std::isnan(interval) ? ValueUtil::nullValue() : ValueUtil::numberValue(interval);
-        (*computed_quantile_value_fields)["cumulative"] =
-            std::isnan(cumulative) ? ValueUtil::nullValue() : ValueUtil::numberValue(cumulative);
-
-        computed_quantile_value_array.push_back(ValueUtil::structValue(computed_quantile_value));
-      }
-      (*computed_quantile_fields)["values"] = ValueUtil::listValue(computed_quantile_value_array);
-      computed_quantile_array.push_back(ValueUtil::structValue(computed_quantile));
+      add_stat_name(counter->first);
+      writer.add(counter->second->value(), "}");
+      ++counter;
+    } else {
+      ASSERT(gauge->second->importMode() != Stats::Gauge::ImportMode::Uninitialized);
+      add_stat_name(gauge->first);
+      writer.add(gauge->second->value(), "}");
+      ++gauge;
     }
   }
 
-  if (found_used_histogram) {
-    (*histograms_obj_fields)["computed_quantiles"] = ValueUtil::listValue(computed_quantile_array);
-    (*histograms_obj_container_fields)["histograms"] = ValueUtil::structValue(histograms_obj);
-    stats_array.push_back(ValueUtil::structValue(histograms_obj_container));
+  const std::vector<NamedMetric<Stats::ParentHistogram>> sorted_histograms =
+      sortedMetrics(histograms, used_only, regex);
+  if (!sorted_histograms.empty()) {
+    // It is not possible for the supported quantiles to differ across histograms, so it is ok
+    // to send them once.
+    writer.add(first_stat ? "" : ",", "{\"histograms\":{\"supported_quantiles\":[");
+    Stats::HistogramStatisticsImpl empty_statistics;
+    const std::vector<double>& supported_quantiles = empty_statistics.supportedQuantiles();
+    for (size_t i = 0; i < supported_quantiles.size(); ++i) {
+      writer.add(i == 0 ? "" : ",");
+      JsonEscaper::appendNumber(supported_quantiles[i] * 100, writer.chunk());
+    }
+    writer.add("],\"computed_quantiles\":[");
+
+    for (size_t i = 0; i < sorted_histograms.size(); ++i) {
+      const Stats::ParentHistogram& histogram = *sorted_histograms[i].second;
+      writer.add(i == 0 ? "" : ",", "{\"name\":\"");
+      JsonEscaper::appendEscaped(sorted_histograms[i].first, writer.chunk());
+      writer.add("\",\"values\":[");
+      const std::vector<double>& interval = histogram.intervalStatistics().computedQuantiles();
+      const std::vector<double>& cumulative =
+          histogram.cumulativeStatistics().computedQuantiles();
+      for (size_t j = 0; j < histogram.intervalStatistics().supportedQuantiles().size(); ++j) {
+        writer.add(j == 0 ? "" : ",", "{\"interval\":");
+        JsonEscaper::appendNumber(interval[j], writer.chunk());
+        writer.add(",\"cumulative\":");
+        JsonEscaper::appendNumber(cumulative[j], writer.chunk());
+        writer.add("}");
+      }
+      writer.add("]}");
+    }
+    writer.add("]}}");
   }
-
-  auto* document_fields = document.mutable_fields();
-  (*document_fields)["stats"] = ValueUtil::listValue(stats_array);
-
-  return MessageUtil::getJsonStringFromMessage(document, pretty_print, true);
+  writer.add("]}");
 }
 
 } // namespace Server
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <regex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/http/codes.h"
@@ -12,6 +16,7 @@
 #include "common/stats/histogram_impl.h"
 
 #include "server/admin/handler_ctx.h"
+#include "server/admin/prometheus_stats.h"
 
 #include "absl/strings/string_view.h"
 
@@ -56,14 +61,47 @@ private:
             (!regex.has_value() || std::regex_search(metric.name(), regex.value())));
   }
 
+  // A metric to show, together with its name. The metric is owned by the store's vector.
+  template <class StatType> using NamedMetric = std::pair<std::string, const StatType*>;
+
+  // Returns the metrics to show, sorted by name. Each name is decoded once, for both the regex
+  // and the sort, so the sort compares strings rather than decoding two stat names per comparison.
+  template <class StatType>
+  static std::vector<NamedMetric<StatType>>
+  sortedMetrics(const std::vector<Stats::RefcountPtr<StatType>>& metrics, const bool used_only,
+                const absl::optional<std::regex>& regex) {
+    std::vector<NamedMetric<StatType>> sorted;
+    sorted.reserve(metrics.size());
+    for (const auto& metric : metrics) {
+      if (used_only && !metric->used()) {
+        continue;
+      }
+      std::string name = metric->name();
+      if (!regex.has_value() || std::regex_search(name, regex.value())) {
+        sorted.emplace_back(std::move(name), metric.get());
+      }
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const NamedMetric<StatType>& a, const NamedMetric<StatType>& b) {
+                return a.first < b.first;
+              });
+    return sorted;
+  }
+
   friend class AdminStatsTest;
+  friend class StatsHandlerSpeedTest;
+
+  // Writes the stats as JSON into the response in chunks, walking them in sorted name order
+  // rather than copying their values into intermediate containers.
+  static void statsAsJson(const std::vector<Stats::CounterSharedPtr>& counters,
+                          const std::vector<Stats::GaugeSharedPtr>& gauges,
+                          const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+                          const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                          const bool used_only, const absl::optional<std::regex>& regex,
+                          Buffer::Instance& response);
 
-  static std::string statsAsJson(const std::map<std::string, uint64_t>& all_stats,
-                                 const std::map<std::string, std::string>& text_readouts,
-                                 const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                                 bool used_only,
-                                 const absl::optional<std::regex> regex = absl::nullopt,
-                                 bool pretty_print = false);
+  // Created on the first prometheus scrape, and kept so that later scrapes reuse the names.
+  std::unique_ptr<PrometheusStatsFormatter::MetricNameCache> prometheus_name_cache_;
 };
 
 } // namespace Server
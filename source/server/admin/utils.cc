@@ -67,6 +67,18 @@ absl::optional<std::string> queryParam(const Http::Utility::QueryParams& params,
                                             : absl::nullopt;
 }
 
+ChunkedWriter::ChunkedWriter(Buffer::Instance& response, uint64_t chunk_size)
+    : response_(response), chunk_size_(chunk_size) {
+  chunk_.reserve(chunk_size_);
+}
+
+void ChunkedWriter::flush() {
+  if (!chunk_.empty()) {
+    response_.add(chunk_);
+    chunk_.clear();
+  }
+}
+
 } // namespace Utility
 } // namespace Server
 } // namespace Envoy
@@ -3,12 +3,15 @@
 #include <regex>
 
 #include "envoy/admin/v3/server_info.pb.h"
+#include "envoy/buffer/buffer.h"
 #include "envoy/init/manager.h"
 
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/utility.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Server {
 namespace Utility {
@@ -26,6 +29,52 @@ absl::optional<std::string> formatParam(const Http::Utility::QueryParams& params
 absl::optional<std::string> queryParam(const Http::Utility::QueryParams& params,
                                        const std::string& key);
 
+/**
+ * Accumulates the output of a large admin response in a reusable chunk, which is appended to the
+ * response buffer whenever it reaches the chunk size, and when the writer is destroyed. This avoids
+ * both building the whole response as one string and adding it to the buffer in tiny fragments.
+ */
+class ChunkedWriter {
+public:
+  static constexpr uint64_t DefaultChunkSize = 64 * 1024;
+
+  explicit ChunkedWriter(Buffer::Instance& response, uint64_t chunk_size = DefaultChunkSize);
+  ~ChunkedWriter() { flush(); }
+
+  /**
+   * Appends the given pieces, which may be of any type accepted by absl::StrAppend().
+   */
+  template <class... Pieces> void add(const Pieces&... pieces) {
+    absl::StrAppend(&chunk_, pieces...);
+    maybeFlush();
+  }
+
+  /**
+   * @return the current chunk, for formatting output into directly. maybeFlush() must be called
+   *         once the output is formatted.
+   */
+  std::string& chunk() { return chunk_; }
+
+  /**
+   * Appends the chunk to the response if it has reached the chunk size.
+   */
+  void maybeFlush() {
+    if (chunk_.size() >= chunk_size_) {
+      flush();
+    }
+  }
+
+  /**
+   * Appends the chunk to the response, keeping its capacity for the next one.
+   */
+  void flush();
+
+private:
+  Buffer::Instance& response_;
+  const uint64_t chunk_size_;
+  std::string chunk_;
+};
+
 } // namespace Utility
 } // namespace Server
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/access_log/access_log_formatter.h"
 #include "common/network/address_impl.h"
+#include "common/protobuf/utility.h"
 
 #include "test/common/stream_info/test_util.h"
 #include "test/mocks/http/mocks.h"
@@ -10,20 +11,35 @@ namespace Envoy {
 
 namespace {
 
+const char* const LogFormat =
+    "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% %START_TIME(%Y/%m/%dT%H:%M:%S%z %s)% "
+    "%REQ(:METHOD)% "
+    "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)% %PROTOCOL% "
+    "s%RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQ(REFERER)% \"%REQ(USER-AGENT)%\" - - -\n";
+
+// Same as AccessLogFormatUtils::DEFAULT_FORMAT.
+const char* const DefaultLogFormat =
+    "[%START_TIME%] \"%REQ(:METHOD)% %REQ(X-ENVOY-ORIGINAL-PATH?:PATH)% %PROTOCOL%\" "
+    "%RESPONSE_CODE% %RESPONSE_FLAGS% %BYTES_RECEIVED% %BYTES_SENT% %DURATION% "
+    "%RESP(X-ENVOY-UPSTREAM-SERVICE-TIME)% "
+    "\"%REQ(X-FORWARDED-FOR)%\" \"%REQ(USER-AGENT)%\" \"%REQ(X-REQUEST-ID)%\" "
+    "\"%REQ(:AUTHORITY)%\" \"%UPSTREAM_HOST%\"\n";
+
+absl::flat_hash_map<std::string, std::string> jsonLogFormat() {
+  return {{"remote_address", "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%"},
+          {"start_time", "%START_TIME(%Y/%m/%dT%H:%M:%S%z %s)%"},
+          {"method", "%REQ(:METHOD)%"},
+          {"url", "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)%"},
+          {"protocol", "%PROTOCOL%"},
+          {"respoinse_code", "%RESPONSE_CODE%"},
+          {"bytes_sent", "%BYTES_SENT%"},
+          {"duration", "%DURATION%"},
+          {"referer", "%REQ(REFERER)%"},
+          {"user-agent", "%REQ(USER-AGENT)%"}};
+}
+
 std::unique_ptr<Envoy::AccessLog::JsonFormatterImpl> makeJsonFormatter(bool typed) {
-  absl::flat_hash_map<std::string, std::string> JsonLogFormat = {
-      {"remote_address", "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%"},
-      {"start_time", "%START_TIME(%Y/%m/%dT%H:%M:%S%z %s)%"},
-      {"method", "%REQ(:METHOD)%"},
-      {"url", "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)%"},
-      {"protocol", "%PROTOCOL%"},
-      {"respoinse_code", "%RESPONSE_CODE%"},
-      {"bytes_sent", "%BYTES_SENT%"},
-      {"duration", "%DURATION%"},
-      {"referer", "%REQ(REFERER)%"},
-      {"user-agent", "%REQ(USER-AGENT)%"}};
-
-  return std::make_unique<Envoy::AccessLog::JsonFormatterImpl>(JsonLogFormat, typed);
+  return std::make_unique<Envoy::AccessLog::JsonFormatterImpl>(jsonLogFormat(), typed);
 }
 
 std::unique_ptr<Envoy::TestStreamInfo> makeStreamInfo() {
@@ -33,17 +49,102 @@ std::unique_ptr<Envoy::TestStreamInfo> makeStreamInfo() {
   return stream_info;
 }
 
+// Formats by concatenating the strings returned by each parsed provider, as the formatters did
+// before formats were compiled into a FormatProgram. Used as a baseline.
+class ProviderListFormatter {
+public:
+  explicit ProviderListFormatter(const std::string& format)
+      : providers_(AccessLog::AccessLogFormatParser::parse(format)) {}
+
+  std::string format(const Http::RequestHeaderMap& request_headers,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const Http::ResponseTrailerMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info, absl::string_view body) const {
+    std::string log_line;
+    log_line.reserve(256);
+    for (const AccessLog::FormatterProviderPtr& provider : providers_) {
+      log_line +=
+          provider->format(request_headers, response_headers, response_trailers, stream_info, body);
+    }
+    return log_line;
+  }
+
+  ProtobufWkt::Value formatValue(const Http::RequestHeaderMap& request_headers,
+                                 const Http::ResponseHeaderMap& response_headers,
+                                 const Http::ResponseTrailerMap& response_trailers,
+                                 const StreamInfo::StreamInfo& stream_info,
+                                 absl::string_view body) const {
+    if (providers_.size() == 1) {
+      return providers_.front()->formatValue(request_headers, response_headers, response_trailers,
+                                             stream_info, body);
+    }
+    return ValueUtil::stringValue(
+        format(request_headers, response_headers, response_trailers, stream_info, body));
+  }
+
+private:
+  const std::vector<AccessLog::FormatterProviderPtr> providers_;
+};
+
+// Formats JSON by building a ProtobufWkt::Struct and serializing it, as JsonFormatterImpl did
+// before it wrote JSON directly. Used as a baseline.
+class StructJsonFormatter {
+public:
+  explicit StructJsonFormatter(bool typed) : typed_(typed) {
+    for (const auto& pair : jsonLogFormat()) {
+      fields_.emplace(pair.first, std::make_unique<ProviderListFormatter>(pair.second));
+    }
+  }
+
+  std::string format(const Http::RequestHeaderMap& request_headers,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const Http::ResponseTrailerMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info, absl::string_view body) const {
+    ProtobufWkt::Struct output;
+    auto* fields = output.mutable_fields();
+    for (const auto& pair : fields_) {
+      (*fields)[pair.first] =
+          typed_ ? pair.second->formatValue(request_headers, response_headers, response_trailers,
+                                            stream_info, body)
+                 : ValueUtil::stringValue(pair.second->format(
+                       request_headers, response_headers, response_trailers, stream_info, body));
+    }
+    return absl::StrCat(MessageUtil::getJsonStringFromMessage(output, false, true), "\n");
+  }
+
+private:
+  const bool typed_;
+  std::map<std::string, std::unique_ptr<ProviderListFormatter>> fields_;
+};
+
+// Formats a request with typical headers.
+template <class Formatter> void formatRequests(benchmark::State& state, const Formatter& formatter) {
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "GET"},
+      {":authority", "example.com"},
+      {":path", "/index.html"},
+      {"x-forwarded-proto", "https"},
+      {"x-forwarded-for", "203.0.113.1"},
+      {"x-request-id", "b2ae8e8a-7b3e-4e5c-9f3d-0c2c5a1f9a7e"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36"}};
+  Http::TestResponseHeaderMapImpl response_headers{{"x-envoy-upstream-service-time", "12"}};
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) {
+    output_bytes +=
+        formatter.format(request_headers, response_headers, response_trailers, *stream_info, body)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+
 } // namespace
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_AccessLogFormatter(benchmark::State& state) {
   std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
-  static const char* LogFormat =
-      "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% %START_TIME(%Y/%m/%dT%H:%M:%S%z %s)% "
-      "%REQ(:METHOD)% "
-      "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)% %PROTOCOL% "
-      "s%RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQ(REFERER)% \"%REQ(USER-AGENT)%\" - - -\n";
-
   std::unique_ptr<Envoy::AccessLog::FormatterImpl> formatter =
       std::make_unique<Envoy::AccessLog::FormatterImpl>(LogFormat);
 
@@ -102,4 +203,55 @@ static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
 }
 BENCHMARK(BM_TypedJsonAccessLogFormatter);
 
+// The benchmarks below format requests with typical headers, comparing each formatter against the
+// provider list or Struct based baseline.
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_DefaultFormat(benchmark::State& state) {
+  formatRequests(state, *AccessLog::AccessLogFormatUtils::defaultAccessLogFormatter());
+}
+BENCHMARK(BM_DefaultFormat);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_DefaultFormatProviderList(benchmark::State& state) {
+  formatRequests(state, ProviderListFormatter(DefaultLogFormat));
+}
+BENCHMARK(BM_DefaultFormatProviderList);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_CustomFormat(benchmark::State& state) {
+  formatRequests(state, AccessLog::FormatterImpl(LogFormat));
+}
+BENCHMARK(BM_CustomFormat);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_CustomFormatProviderList(benchmark::State& state) {
+  formatRequests(state, ProviderListFormatter(LogFormat));
+}
+BENCHMARK(BM_CustomFormatProviderList);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_JsonFormat(benchmark::State& state) {
+  formatRequests(state, *makeJsonFormatter(false));
+}
+BENCHMARK(BM_JsonFormat);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_JsonFormatStruct(benchmark::State& state) {
+  formatRequests(state, StructJsonFormatter(false));
+}
+BENCHMARK(BM_JsonFormatStruct);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_TypedJsonFormat(benchmark::State& state) {
+  formatRequests(state, *makeJsonFormatter(true));
+}
+BENCHMARK(BM_TypedJsonFormat);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_TypedJsonFormatStruct(benchmark::State& state) {
+  formatRequests(state, StructJsonFormatter(true));
+}
+BENCHMARK(BM_TypedJsonFormatStruct);
+
 } // namespace Envoy
@@ -1,5 +1,7 @@
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -1882,6 +1884,75 @@ TEST(AccessLogFormatterTest, JsonFormatterTypedTest) {
   EXPECT_THAT(output.fields().at("filter_state"), ProtoEq(expected));
 }
 
+TEST(AccessLogFormatterTest, JsonFormatterNonFiniteNumbersTest) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+
+  ProtobufWkt::Value list;
+  list.mutable_list_value()->add_values()->set_number_value(std::nan(""));
+  list.mutable_list_value()->add_values()->set_number_value(
+      std::numeric_limits<double>::infinity());
+  list.mutable_list_value()->add_values()->set_number_value(
+      -std::numeric_limits<double>::infinity());
+  list.mutable_list_value()->add_values()->set_number_value(1.5);
+
+  envoy::config::core::v3::Metadata metadata;
+  (*(*metadata.mutable_filter_metadata())["com.test"].mutable_fields())["numbers"] = list;
+  EXPECT_CALL(Const(stream_info), dynamicMetadata()).WillRepeatedly(ReturnRef(metadata));
+
+  absl::flat_hash_map<std::string, std::string> key_mapping = {
+      {"numbers", "%DYNAMIC_METADATA(com.test:numbers)%"}};
+
+  JsonFormatterImpl formatter(key_mapping, true);
+
+  // JSON can't represent NaN or infinities, so they are written as null.
+  const std::string json =
+      formatter.format(request_headers, response_headers, response_trailers, stream_info, body);
+  EXPECT_THAT(json, testing::HasSubstr(R"("numbers":[null,null,null,1.5])"));
+}
+
+TEST(AccessLogFormatterTest, JsonFormatterEscapingTest) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{"quoted", "say \"hi\"\\\t\x01"}};
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body = "local \"reply\"\n";
+  absl::optional<uint32_t> response_code{200};
+  EXPECT_CALL(stream_info, responseCode()).WillRepeatedly(Return(response_code));
+
+  absl::flat_hash_map<std::string, std::string> key_mapping = {
+      {"quoted", "%REQ(QUOTED)%"},
+      {"quoted_multi", "[%REQ(QUOTED)%]"},
+      {"body", "%LOCAL_REPLY_BODY%"},
+      {"missing", "%REQ(MISSING)%"},
+      {"code", "%RESPONSE_CODE%"},
+      {"literal \"key\"", "\"literal\""}};
+
+  for (const bool preserve_types : {false, true}) {
+    JsonFormatterImpl formatter(key_mapping, preserve_types);
+    const std::string json =
+        formatter.format(request_header, response_header, response_trailer, stream_info, body);
+    ProtobufWkt::Struct output;
+    MessageUtil::loadFromJson(json, output);
+
+    const auto& fields = output.fields();
+    EXPECT_EQ("say \"hi\"\\\t\x01", fields.at("quoted").string_value());
+    EXPECT_EQ("[say \"hi\"\\\t\x01]", fields.at("quoted_multi").string_value());
+    EXPECT_EQ("local \"reply\"\n", fields.at("body").string_value());
+    EXPECT_EQ("\"literal\"", fields.at("literal \"key\"").string_value());
+    if (preserve_types) {
+      EXPECT_THAT(fields.at("missing"), ProtoEq(ValueUtil::nullValue()));
+      EXPECT_THAT(fields.at("code"), ProtoEq(ValueUtil::numberValue(200)));
+    } else {
+      EXPECT_EQ("-", fields.at("missing").string_value());
+      EXPECT_EQ("200", fields.at("code").string_value());
+    }
+  }
+}
+
 TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   StreamInfo::MockStreamInfo stream_info;
   Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
@@ -1,4 +1,6 @@
+#include <atomic>
 #include <memory>
+#include <string>
 
 #include "common/access_log/access_log_manager_impl.h"
 #include "common/filesystem/file_shared_impl.h"
@@ -11,6 +13,9 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -27,6 +32,22 @@ namespace Envoy {
 namespace AccessLog {
 namespace {
 
+// Counts the threads created by a thread factory.
+class CountingThreadFactory : public Thread::ThreadFactory {
+public:
+  explicit CountingThreadFactory(Thread::ThreadFactory& parent) : parent_(parent) {}
+
+  // Thread::ThreadFactory
+  Thread::ThreadPtr createThread(std::function<void()> thread_routine) override {
+    ++threads_created_;
+    return parent_.createThread(std::move(thread_routine));
+  }
+  Thread::ThreadId currentThreadId() override { return parent_.currentThreadId(); }
+
+  Thread::ThreadFactory& parent_;
+  std::atomic<uint32_t> threads_created_{0};
+};
+
 class AccessLogManagerImplTest : public testing::Test {
 protected:
   AccessLogManagerImplTest()
@@ -47,6 +68,17 @@ protected:
     TestUtility::waitForGaugeEq(store_, name, value, time_system_);
   }
 
+  void waitForWrites(Filesystem::MockFile& file, size_t num_writes) {
+    Thread::LockGuard lock(file.write_mutex_);
+    while (file.num_writes_ != num_writes) {
+      file.write_event_.wait(file.write_mutex_);
+    }
+  }
+
+  static Api::IoCallSizeResult writeSuccess(absl::string_view data) {
+    return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+  }
+
   NiceMock<Api::MockApi> api_;
   NiceMock<Filesystem::MockInstance> file_system_;
   NiceMock<Filesystem::MockFile>* file_;
@@ -518,6 +550,154 @@ TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
       .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+// Test that all the files of a manager are flushed by a single thread, started by the first write
+// to any of them.
+TEST_F(AccessLogManagerImplTest, FilesShareFlushThread) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  CountingThreadFactory thread_factory(thread_factory_);
+  EXPECT_CALL(api_, threadFactory()).WillRepeatedly(ReturnRef(thread_factory));
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log = access_log_manager_.createAccessLog("foo");
+  NiceMock<Filesystem::MockFile>* file2 = new NiceMock<Filesystem::MockFile>;
+  EXPECT_CALL(file_system_, createFile("bar"))
+      .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(file2))));
+  EXPECT_CALL(*file2, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log2 = access_log_manager_.createAccessLog("bar");
+  EXPECT_EQ(0U, thread_factory.threads_created_);
+
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  EXPECT_CALL(*file_, write_("foo data")).WillOnce(Invoke(writeSuccess));
+  EXPECT_CALL(*file2, write_("bar data")).WillOnce(Invoke(writeSuccess));
+  log->write("foo data");
+  log2->write("bar data");
+  waitForWrites(*file_, 1);
+  waitForWrites(*file2, 1);
+  EXPECT_EQ(1U, thread_factory.threads_created_);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file2, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that the first write to a file is flushed without waiting for the flush interval, while
+// later small writes wait for it, and that the per file stats track the buffered data and the
+// time spent flushing.
+TEST_F(AccessLogManagerImplTest, FirstWriteFlushedImmediately) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  ON_CALL(*file_, path()).WillByDefault(Return("/var/log/foo.log"));
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  EXPECT_CALL(*file_, write_("first"))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        absl::SleepFor(absl::Milliseconds(1));
+        return writeSuccess(data);
+      }));
+  log_file->write("first");
+  waitForWrites(*file_, 1);
+  waitForGaugeEq("filesystem.file.var_log_foo_log.pending_bytes", 0);
+  TestUtility::waitForCounterGe(store_, "filesystem.file.var_log_foo_log.flush_time_us", 1000,
+                                time_system_);
+  EXPECT_EQ(0UL, store_.counter("filesystem.flushed_by_timer").value());
+
+  // Nothing wakes up the flush thread until the timer fires.
+  EXPECT_CALL(*file_, write_("second")).WillOnce(Invoke(writeSuccess));
+  log_file->write("second");
+  Stats::Gauge& pending_bytes = store_.gauge("filesystem.file.var_log_foo_log.pending_bytes",
+                                             Stats::Gauge::ImportMode::Accumulate);
+  EXPECT_EQ(6UL, pending_bytes.value());
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    EXPECT_EQ(1U, file_->num_writes_);
+  }
+
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  timer->invokeCallback();
+  waitForWrites(*file_, 2);
+  waitForGaugeEq("filesystem.file.var_log_foo_log.pending_bytes", 0);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that the data buffered until the buffer grows past MIN_FLUSH_SIZE is flushed with a single
+// write, without waiting for the timer.
+TEST_F(AccessLogManagerImplTest, FlushRequestBatchesBufferedWrites) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  EXPECT_CALL(*file_, write_("a")).WillOnce(Invoke(writeSuccess));
+  log_file->write("a");
+  waitForWrites(*file_, 1);
+
+  // Writes below the threshold are only buffered.
+  const std::string chunk(16 * 1024, 'b');
+  for (int i = 0; i < 4; i++) {
+    log_file->write(chunk);
+  }
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    EXPECT_EQ(1U, file_->num_writes_);
+  }
+
+  // The write which crosses the threshold requests a flush of everything buffered.
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([&chunk](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(absl::StrCat(chunk, chunk, chunk, chunk, "c"), data);
+        return writeSuccess(data);
+      }));
+  log_file->write("c");
+  waitForWrites(*file_, 2);
+  EXPECT_EQ(0UL, store_.counter("filesystem.flushed_by_timer").value());
+  waitForCounterEq("filesystem.write_completed", 2);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that a file can be destroyed while the flush thread is flushing another file, and that its
+// buffered data is written exactly once, either by the flush thread or by its destructor.
+TEST_F(AccessLogManagerImplTest, RemoveFileDuringFlushPass) {
+  // The flusher's timer, which is never fired.
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  AccessLogFileStats stats{ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(store_, "filesystem."),
+                                                 POOL_GAUGE_PREFIX(store_, "filesystem."))};
+  auto flusher =
+      std::make_shared<AccessLogFlusher>(dispatcher_, thread_factory_, timeout_40ms_, stats);
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  auto log = std::make_unique<AccessLogFileImpl>(file_system_.createFile("foo"), flusher, lock_,
+                                                 stats, store_, time_system_);
+  NiceMock<Filesystem::MockFile>* file2 = new NiceMock<Filesystem::MockFile>;
+  EXPECT_CALL(*file2, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  auto log2 = std::make_unique<AccessLogFileImpl>(Filesystem::FilePtr{file2}, flusher, lock_,
+                                                  stats, store_, time_system_);
+
+  // The flush thread blocks in the middle of a pass, flushing the first file.
+  absl::Notification writing;
+  absl::Notification release;
+  EXPECT_CALL(*file_, write_("foo data"))
+      .WillOnce(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        writing.Notify();
+        release.WaitForNotification();
+        return writeSuccess(data);
+      }));
+  log->write("foo data");
+  writing.WaitForNotification();
+
+  EXPECT_CALL(*file2, write_("bar data")).WillOnce(Invoke(writeSuccess));
+  EXPECT_CALL(*file2, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  log2->write("bar data");
+  Thread::ThreadPtr destroyer = thread_factory_.createThread([&log2]() { log2.reset(); });
+  release.Notify();
+  destroyer->join();
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  log.reset();
+  flusher.reset();
+}
+
 } // namespace
 } // namespace AccessLog
 } // namespace Envoy
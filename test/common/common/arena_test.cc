@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "common/common/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+bool isAligned(const void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST(ArenaTest, AllocatesFromInitialBufferThenSlabs) {
+  InlineArena<256> arena;
+  void* first = arena.allocate(100);
+  void* second = arena.allocate(100);
+  EXPECT_EQ(0, arena.slabs());
+  EXPECT_NE(first, second);
+
+  // The inline buffer is exhausted, so the next allocation comes from a slab.
+  arena.allocate(100);
+  EXPECT_EQ(1, arena.slabs());
+  EXPECT_EQ(300, arena.bytesAllocated());
+
+  // Slabs double in size, and oversized requests get a slab of their own.
+  arena.allocate(4096);
+  EXPECT_EQ(2, arena.slabs());
+}
+
+TEST(ArenaTest, NoInitialBuffer) {
+  Arena arena(nullptr, 0, 128);
+  EXPECT_EQ(0, arena.slabs());
+  for (int i = 0; i < 8; i++) {
+    memset(arena.allocate(16), 0xff, 16);
+  }
+  EXPECT_EQ(1, arena.slabs());
+}
+
+TEST(ArenaTest, Alignment) {
+  InlineArena<1024> arena;
+  arena.allocate(1, 1);
+  EXPECT_TRUE(isAligned(arena.allocate(8, 8), 8));
+  arena.allocate(3, 1);
+  EXPECT_TRUE(isAligned(arena.allocate(4, 4), 4));
+  arena.allocate(1, 1);
+  EXPECT_TRUE(isAligned(arena.allocate(16), alignof(std::max_align_t)));
+}
+
+TEST(ArenaTest, Allocator) {
+  InlineArena<1024> arena;
+  {
+    std::list<std::string, ArenaAllocator<std::string>> list{ArenaAllocator<std::string>(&arena)};
+    for (int i = 0; i < 10; i++) {
+      list.emplace_back("value");
+    }
+    EXPECT_EQ(10, list.size());
+  }
+  EXPECT_GT(arena.bytesAllocated(), 10 * sizeof(std::string));
+
+  // Without an arena the allocator uses the heap.
+  std::list<int, ArenaAllocator<int>> list;
+  list.push_back(1);
+  EXPECT_EQ(nullptr, list.get_allocator().arena());
+}
+
+class TestObject : public ArenaObject {
+public:
+  TestObject(int& destroyed) : destroyed_(destroyed) {}
+  ~TestObject() { destroyed_++; }
+
+  int& destroyed_;
+  std::string value_{"a string long enough to need its own heap allocation"};
+};
+
+TEST(ArenaTest, ArenaObject) {
+  int destroyed = 0;
+  InlineArena<1024> arena;
+  {
+    std::unique_ptr<TestObject> in_arena(new (&arena) TestObject(destroyed));
+    std::unique_ptr<TestObject> on_heap(new (nullptr) TestObject(destroyed));
+    EXPECT_GE(arena.bytesAllocated(), sizeof(TestObject));
+    EXPECT_TRUE(isAligned(in_arena.get(), alignof(TestObject)));
+    EXPECT_TRUE(isAligned(on_heap.get(), alignof(TestObject)));
+  }
+  EXPECT_EQ(2, destroyed);
+}
+
+} // namespace
+} // namespace Envoy
@@ -0,0 +1,62 @@
+#include <limits>
+#include <string>
+
+#include "common/common/json_escape_string.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+std::string escape(absl::string_view value) {
+  std::string output = "prefix";
+  JsonEscaper::appendEscaped(value, output);
+  return output;
+}
+
+std::string number(double value) {
+  std::string output;
+  JsonEscaper::appendNumber(value, output);
+  return output;
+}
+
+TEST(JsonEscaperTest, AppendEscaped) {
+  EXPECT_EQ("prefix", escape(""));
+  EXPECT_EQ("prefixplain text", escape("plain text"));
+  EXPECT_EQ("prefix\\\"quoted\\\" back\\\\slash", escape("\"quoted\" back\\slash"));
+  EXPECT_EQ("prefix\\b\\f\\n\\r\\t", escape("\b\f\n\r\t"));
+  EXPECT_EQ("prefix\\u0000\\u0001\\u001f", escape(absl::string_view("\0\x01\x1f", 3)));
+  // Characters outside of ASCII are left as is.
+  EXPECT_EQ("prefix\xc3\xa9\x7f", escape("\xc3\xa9\x7f"));
+}
+
+TEST(JsonEscaperTest, NeedsEscape) {
+  EXPECT_TRUE(JsonEscaper::needsEscape('"'));
+  EXPECT_TRUE(JsonEscaper::needsEscape('\\'));
+  EXPECT_TRUE(JsonEscaper::needsEscape('\n'));
+  EXPECT_TRUE(JsonEscaper::needsEscape('\x1f'));
+  EXPECT_FALSE(JsonEscaper::needsEscape(' '));
+  EXPECT_FALSE(JsonEscaper::needsEscape('a'));
+  EXPECT_FALSE(JsonEscaper::needsEscape('\x7f'));
+  EXPECT_FALSE(JsonEscaper::needsEscape('\xc3'));
+}
+
+TEST(JsonEscaperTest, AppendNumber) {
+  EXPECT_EQ("0", number(0));
+  EXPECT_EQ("3", number(3.0));
+  EXPECT_EQ("-42", number(-42.0));
+  EXPECT_EQ("9007199254740991", number(9007199254740991.0));
+  EXPECT_EQ("0.5", number(0.5));
+  EXPECT_EQ("109.95", number(109.95));
+  EXPECT_EQ("-2.25", number(-2.25));
+}
+
+// JSON has no representation for non-finite numbers.
+TEST(JsonEscaperTest, AppendNonFiniteNumber) {
+  EXPECT_EQ("null", number(std::numeric_limits<double>::quiet_NaN()));
+  EXPECT_EQ("null", number(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("null", number(-std::numeric_limits<double>::infinity()));
+}
+
+} // namespace
+} // namespace Envoy
@@ -0,0 +1,152 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "common/api/api_impl.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+// Runs a dispatcher on its own thread, for callbacks to be posted to it from other threads.
+class DispatcherThread {
+public:
+  DispatcherThread()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {
+    thread_ = api_->threadFactory().createThread([this]() {
+      // Must create a keepalive timer to keep the dispatcher from exiting.
+      const std::chrono::milliseconds interval(500);
+      keepalive_timer_ = dispatcher_->createTimer(
+          [this, interval]() { keepalive_timer_->enableTimer(interval); });
+      keepalive_timer_->enableTimer(interval);
+      dispatcher_->run(Dispatcher::RunType::Block);
+      keepalive_timer_.reset();
+    });
+  }
+
+  ~DispatcherThread() {
+    dispatcher_->exit();
+    thread_->join();
+  }
+
+  // Posts a callback which signals the calling thread, and waits for it to run. As callbacks are
+  // run in order, all the callbacks posted earlier by the calling thread have run once this
+  // returns.
+  void postAndWait() {
+    bool done = false;
+    dispatcher_->post([this, &done]() {
+      {
+        Thread::LockGuard lock(mutex_);
+        done = true;
+      }
+      cv_.notifyOne();
+    });
+    Thread::LockGuard lock(mutex_);
+    while (!done) {
+      cv_.wait(mutex_);
+    }
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+  Thread::ThreadPtr thread_;
+  TimerPtr keepalive_timer_;
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar cv_;
+};
+
+// Throughput of posts from one thread, in batches of state.range(0) callbacks.
+static void BM_PostThroughput(benchmark::State& state) {
+  DispatcherThread dispatcher_thread;
+  const uint64_t batch = state.range(0);
+  uint64_t run = 0;
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < batch; ++i) {
+      dispatcher_thread.dispatcher_->post([&run]() { ++run; });
+    }
+    dispatcher_thread.postAndWait();
+  }
+  benchmark::DoNotOptimize(run);
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_PostThroughput)->Arg(1)->Arg(64)->Arg(4096)->UseRealTime();
+
+// Throughput of posts from state.range(0) threads posting 1024 callbacks each, which contend on
+// the post queue of the dispatcher.
+static void BM_PostThroughputContended(benchmark::State& state) {
+  DispatcherThread dispatcher_thread;
+  const uint32_t producers = state.range(0);
+  constexpr uint32_t PostsPerProducer = 1024;
+  std::atomic<uint64_t> run{0};
+  for (auto _ : state) {
+    std::vector<Thread::ThreadPtr> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+      threads.push_back(dispatcher_thread.api_->threadFactory().createThread([&]() {
+        for (uint32_t i = 0; i < PostsPerProducer; ++i) {
+          dispatcher_thread.dispatcher_->post([&run]() { run.fetch_add(1); });
+        }
+      }));
+    }
+    for (Thread::ThreadPtr& thread : threads) {
+      thread->join();
+    }
+    dispatcher_thread.postAndWait();
+  }
+  benchmark::DoNotOptimize(run.load());
+  state.SetItemsProcessed(state.iterations() * producers * PostsPerProducer);
+}
+BENCHMARK(BM_PostThroughputContended)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+// Latency of a post to an idle dispatcher, from the post until the callback has run and signaled
+// the posting thread.
+static void BM_PostLatency(benchmark::State& state) {
+  DispatcherThread dispatcher_thread;
+  for (auto _ : state) {
+    dispatcher_thread.postAndWait();
+  }
+}
+BENCHMARK(BM_PostLatency)->UseRealTime();
+
+// Re-arming one of state.range(0) armed timers, as idle timeouts are on activity. Timers are
+// precise if state.range(1) is 0, and coarse timers of a 100ms granularity otherwise.
+static void BM_TimerRearm(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  const uint64_t num_timers = state.range(0);
+  const bool coarse = state.range(1) != 0;
+  std::vector<TimerPtr> timers;
+  for (uint64_t i = 0; i < num_timers; ++i) {
+    timers.push_back(coarse ? dispatcher->createCoarseTimer([]() {}, std::chrono::milliseconds(100))
+                            : dispatcher->createTimer([]() {}));
+    // The deadlines are one to two minutes away, so none is reached during the benchmark.
+    timers.back()->enableTimer(std::chrono::milliseconds(60000 + i % 60000));
+  }
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    timers[i % num_timers]->enableTimer(std::chrono::milliseconds(60000 + i % 60000));
+    ++i;
+  }
+  for (TimerPtr& timer : timers) {
+    timer->disableTimer();
+  }
+}
+BENCHMARK(BM_TimerRearm)
+    ->Args({1000, 0})
+    ->Args({1000, 1})
+    ->Args({100000, 0})
+    ->Args({100000, 1})
+    ->Args({1000000, 0})
+    ->Args({1000000, 1});
+
+} // namespace Event
+} // namespace Envoy
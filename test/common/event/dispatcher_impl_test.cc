@@ -186,7 +186,7 @@ TEST_F(DispatcherImplTest, RunPostCallbacksLocking) {
     // Block dispatcher first to ensure that both posted events below are handled
     // by a single call to runPostCallbacks().
     //
-    // This also ensures that the post_lock_ is not held while callbacks are called,
+    // This also ensures that no post queue lock is held while callbacks are called,
     // or else this would deadlock.
     Thread::LockGuard lock(mu_);
     dispatcher_->post([this]() { Thread::LockGuard lock(mu_); });
@@ -385,6 +385,34 @@ TEST_F(TimerImplTimingTest, TheoreticalTimerTiming) {
   }
 }
 
+// Coarse timers fire on the first tick of their granularity at or after their deadline.
+TEST(CoarseTimerTest, CoarseTimerTiming) {
+  Event::SimulatedTimeSystem time_system;
+  Api::ApiPtr api = Api::createApiForTest(time_system);
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  const std::chrono::milliseconds granularity(10);
+  Event::TimerPtr timer = dispatcher->createCoarseTimer([] {}, granularity);
+  // Coarse timers of the same granularity share a wheel.
+  Event::TimerPtr other_timer = dispatcher->createCoarseTimer([] {}, granularity);
+  other_timer->enableTimer(std::chrono::milliseconds(100000));
+
+  const std::pair<uint64_t, uint64_t> timings[] = {{0, 10}, {10, 10}, {15, 20}, {1234, 1240}};
+  for (const auto& timing : timings) {
+    timer->enableTimer(std::chrono::milliseconds(timing.first));
+    EXPECT_TRUE(timer->enabled());
+    const auto start = time_system.monotonicTime();
+    while (timer->enabled()) {
+      time_system.advanceTimeAsync(std::chrono::milliseconds(1));
+      dispatcher->run(Dispatcher::RunType::NonBlock);
+    }
+    EXPECT_EQ(timing.second, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 time_system.monotonicTime() - start)
+                                 .count());
+  }
+  EXPECT_TRUE(other_timer->enabled());
+  other_timer->disableTimer();
+}
+
 class TimerUtilsTest : public testing::Test {
 public:
   template <typename Duration>
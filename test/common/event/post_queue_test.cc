@@ -0,0 +1,126 @@
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "common/event/post_queue.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Pops and runs all the callbacks of the queue, returning how many ran.
+uint32_t runAll(PostQueue& queue) {
+  uint32_t count = 0;
+  std::function<void()> callback;
+  while (queue.pop(callback)) {
+    callback();
+    ++count;
+  }
+  return count;
+}
+
+// Only the first push after the consumer acknowledged the previous wake up requires a wake up.
+TEST(PostQueueTest, WakeupOnFirstPush) {
+  PostQueue queue(4);
+  std::function<void()> callback;
+  EXPECT_FALSE(queue.pop(callback));
+
+  EXPECT_TRUE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+  EXPECT_EQ(2, runAll(queue));
+
+  // Popping alone does not re-arm the wake up.
+  EXPECT_FALSE(queue.push([]() {}));
+  EXPECT_EQ(1, runAll(queue));
+
+  queue.acknowledgeWakeup();
+  EXPECT_TRUE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+  EXPECT_EQ(2, runAll(queue));
+}
+
+// Callbacks which do not fit in the ring go to the overflow list, and callbacks pushed while it is
+// not empty follow them, so that the order of the pushes is kept.
+TEST(PostQueueTest, OverflowKeepsOrder) {
+  PostQueue queue(4);
+  std::vector<uint32_t> order;
+  for (uint32_t i = 0; i < 10; ++i) {
+    queue.push([&order, i]() { order.push_back(i); });
+  }
+  EXPECT_EQ(6, queue.overflowCount());
+
+  // Pop part of the ring, and push more while the overflow list is not empty.
+  std::function<void()> callback;
+  ASSERT_TRUE(queue.pop(callback));
+  callback();
+  queue.push([&order]() { order.push_back(10); });
+  EXPECT_EQ(7, queue.overflowCount());
+  EXPECT_EQ(10, runAll(queue));
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), order);
+
+  // The ring is used again once the overflow list has been drained.
+  queue.push([&order]() { order.push_back(11); });
+  EXPECT_EQ(7, queue.overflowCount());
+  EXPECT_EQ(1, runAll(queue));
+  EXPECT_EQ(11, order.back());
+}
+
+// Popped callbacks are destroyed by the consumer rather than left in the ring.
+TEST(PostQueueTest, PoppedCallbackReleased) {
+  PostQueue queue(2);
+  auto state = std::make_shared<uint32_t>(0);
+  queue.push([state]() { ++*state; });
+  EXPECT_EQ(2, state.use_count());
+  EXPECT_EQ(1, runAll(queue));
+  EXPECT_EQ(1, *state);
+  EXPECT_EQ(1, state.use_count());
+}
+
+// Concurrent producers with a ring small enough to overflow: every callback runs once, and the
+// callbacks of each producer run in the order in which it pushed them.
+TEST(PostQueueTest, ConcurrentProducers) {
+  constexpr uint32_t Producers = 4;
+  constexpr uint32_t PushesPerProducer = 10000;
+  PostQueue queue(64);
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+
+  std::vector<uint32_t> next(Producers, 0);
+  bool in_order = true;
+  std::atomic<uint32_t> done{0};
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t p = 0; p < Producers; ++p) {
+    threads.push_back(thread_factory.createThread([&, p]() {
+      for (uint32_t i = 0; i < PushesPerProducer; ++i) {
+        queue.push([&, p, i]() {
+          in_order &= next[p] == i;
+          next[p] = i + 1;
+        });
+      }
+      ++done;
+    }));
+  }
+
+  uint32_t popped = 0;
+  while (done.load() < Producers || popped < Producers * PushesPerProducer) {
+    queue.acknowledgeWakeup();
+    popped += runAll(queue);
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+
+  EXPECT_EQ(Producers * PushesPerProducer, popped);
+  EXPECT_TRUE(in_order);
+  for (uint32_t p = 0; p < Producers; ++p) {
+    EXPECT_EQ(PushesPerProducer, next[p]);
+  }
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
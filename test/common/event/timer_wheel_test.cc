@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "common/api/api_impl.h"
+#include "common/event/timer_wheel.h"
+
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+class TimerWheelTest : public testing::Test {
+protected:
+  TimerWheelTest()
+      : api_(Api::createApiForTest(time_system_)),
+        dispatcher_(api_->allocateDispatcher("test_thread")) {}
+
+  void advance(std::chrono::milliseconds duration) {
+    time_system_.advanceTimeAsync(duration);
+    dispatcher_->run(Dispatcher::RunType::NonBlock);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+// Timers fire in the first tick at or after their deadline.
+TEST_F(TimerWheelTest, FiresOnFirstTickAfterDeadline) {
+  TimerWheel wheel(*dispatcher_, std::chrono::milliseconds(10));
+  uint32_t fired = 0;
+  TimerPtr timer = wheel.createTimer([&fired]() { ++fired; });
+  EXPECT_FALSE(timer->enabled());
+
+  timer->enableTimer(std::chrono::milliseconds(25));
+  EXPECT_TRUE(timer->enabled());
+  EXPECT_EQ(1, wheel.size());
+  advance(std::chrono::milliseconds(25));
+  EXPECT_EQ(0, fired);
+  advance(std::chrono::milliseconds(4));
+  EXPECT_EQ(0, fired);
+  advance(std::chrono::milliseconds(1));
+  EXPECT_EQ(1, fired);
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel.size());
+
+  // A zero timeout fires in the next tick.
+  timer->enableTimer(std::chrono::milliseconds(0));
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(2, fired);
+}
+
+TEST_F(TimerWheelTest, DisableAndRearm) {
+  TimerWheel wheel(*dispatcher_, std::chrono::milliseconds(1));
+  uint32_t fired = 0;
+  TimerPtr timer = wheel.createTimer([&fired]() { ++fired; });
+
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel.size());
+  advance(std::chrono::milliseconds(20));
+  EXPECT_EQ(0, fired);
+
+  // Re-arming replaces the previous deadline, whether earlier or later.
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer->enableTimer(std::chrono::milliseconds(1000));
+  EXPECT_EQ(1, wheel.size());
+  advance(std::chrono::milliseconds(999));
+  EXPECT_EQ(0, fired);
+  timer->enableHRTimer(std::chrono::microseconds(1500));
+  advance(std::chrono::milliseconds(1));
+  EXPECT_EQ(0, fired);
+  advance(std::chrono::milliseconds(1));
+  EXPECT_EQ(1, fired);
+
+  // Destroying an armed timer disarms it.
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer.reset();
+  EXPECT_EQ(0, wheel.size());
+  advance(std::chrono::milliseconds(20));
+  EXPECT_EQ(1, fired);
+}
+
+// Timers on every level of the wheel, and beyond its span, cascade down and fire on time.
+TEST_F(TimerWheelTest, CascadesAcrossLevels) {
+  TimerWheel wheel(*dispatcher_, std::chrono::milliseconds(1));
+  const std::vector<uint64_t> timeouts{1,      255,     256,      257,       1000,     16383,
+                                       16384,  70000,   1048577,  5000000,   67108863, 67108864,
+                                       9999999};
+  std::vector<uint64_t> fired;
+  std::vector<TimerPtr> timers;
+  for (const uint64_t timeout : timeouts) {
+    timers.push_back(wheel.createTimer([&fired, timeout]() { fired.push_back(timeout); }));
+    timers.back()->enableTimer(std::chrono::milliseconds(timeout));
+  }
+  EXPECT_EQ(timeouts.size(), wheel.size());
+
+  std::vector<uint64_t> sorted = timeouts;
+  std::sort(sorted.begin(), sorted.end());
+  uint64_t elapsed = 0;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    advance(std::chrono::milliseconds(sorted[i] - 1 - elapsed));
+    EXPECT_EQ(i, fired.size()) << sorted[i];
+    advance(std::chrono::milliseconds(1));
+    elapsed = sorted[i];
+    ASSERT_EQ(i + 1, fired.size()) << sorted[i];
+    EXPECT_EQ(sorted[i], fired.back());
+  }
+  EXPECT_EQ(0, wheel.size());
+}
+
+// Callbacks may re-arm their own timer and disarm or destroy timers expiring in the same tick.
+TEST_F(TimerWheelTest, CallbacksModifyTimers) {
+  TimerWheel wheel(*dispatcher_, std::chrono::milliseconds(1));
+  uint32_t periodic_fired = 0;
+  TimerPtr periodic;
+  TimerPtr victim;
+  periodic = wheel.createTimer([&]() {
+    ++periodic_fired;
+    victim.reset();
+    periodic->enableTimer(std::chrono::milliseconds(100));
+  });
+  victim = wheel.createTimer([]() { FAIL(); });
+  periodic->enableTimer(std::chrono::milliseconds(100));
+  victim->enableTimer(std::chrono::milliseconds(100));
+
+  for (uint32_t i = 1; i <= 5; ++i) {
+    advance(std::chrono::milliseconds(100));
+    EXPECT_EQ(i, periodic_fired);
+    EXPECT_EQ(1, wheel.size());
+  }
+  periodic->disableTimer();
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
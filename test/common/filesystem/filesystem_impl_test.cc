@@ -276,6 +276,23 @@ TEST_F(FileSystemImplTest, ExistingFile) {
   EXPECT_EQ("existing file new data", contents);
 }
 
+TEST_F(FileSystemImplTest, Writev) {
+  const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(new_file_path.c_str());
+
+  {
+    FilePtr file = file_system_.createFile(new_file_path);
+    const Api::IoCallBoolResult open_result = file->open(DefaultFlags);
+    EXPECT_TRUE(open_result.rc_);
+    const absl::string_view buffers[] = {"first", "", " second", " third"};
+    const Api::IoCallSizeResult result = file->writev(buffers, 4);
+    EXPECT_EQ(18, result.rc_);
+  }
+
+  auto contents = TestEnvironment::readFileToStringForTest(new_file_path);
+  EXPECT_EQ("first second third", contents);
+}
+
 TEST_F(FileSystemImplTest, NonExistingFile) {
   const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
   ::unlink(new_file_path.c_str());
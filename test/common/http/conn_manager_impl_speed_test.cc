@@ -0,0 +1,241 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the cost of running a header only request through the connection manager, with and
+// without per_stream_arena. The filter chain is a number of pass through filters followed by a
+// terminal filter which responds in place of the router. In tcmalloc builds the number of heap
+// allocations per request is reported in the "allocs" counter. Mocks are used for the codec and
+// the network connection, so absolute numbers include some mock overhead; the difference between
+// the arena and non-arena runs is the interesting part.
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/empty_string.h"
+#include "common/http/conn_manager_impl.h"
+#include "common/http/context_impl.h"
+#include "common/http/date_provider_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/request_id_extension_impl.h"
+#include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/common/pass_through_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/router/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "benchmark/benchmark.h"
+
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+#ifdef TCMALLOC
+uint64_t allocations;
+
+void countAllocation(const void*, size_t) { allocations++; }
+#endif
+
+// Responds to the request in place of the router.
+class TerminalFilter : public PassThroughDecoderFilter {
+public:
+  // Http::StreamDecoderFilter
+  FilterHeadersStatus decodeHeaders(RequestHeaderMap&, bool) override {
+    auto headers = std::make_unique<ResponseHeaderMapImpl>();
+    headers->setStatus(200);
+    decoder_callbacks_->encodeHeaders(std::move(headers), true);
+    return FilterHeadersStatus::StopIteration;
+  }
+};
+
+class BenchmarkFilterChainFactory : public FilterChainFactory {
+public:
+  explicit BenchmarkFilterChainFactory(uint32_t num_filters) : num_filters_(num_filters) {}
+
+  // Http::FilterChainFactory
+  void createFilterChain(FilterChainFactoryCallbacks& callbacks) override {
+    for (uint32_t i = 0; i < num_filters_; i++) {
+      callbacks.addStreamFilter(std::make_shared<PassThroughFilter>());
+    }
+    callbacks.addStreamDecoderFilter(std::make_shared<TerminalFilter>());
+  }
+  bool createUpgradeFilterChain(absl::string_view, const UpgradeMap*,
+                                FilterChainFactoryCallbacks&) override {
+    return false;
+  }
+
+private:
+  const uint32_t num_filters_;
+};
+
+class BenchmarkConfig : public ConnectionManagerConfig {
+public:
+  BenchmarkConfig(uint32_t num_filters, bool per_stream_arena)
+      : filter_factory_(num_filters), per_stream_arena_(per_stream_arena),
+        stats_({ALL_HTTP_CONN_MAN_STATS(POOL_COUNTER(fake_stats_), POOL_GAUGE(fake_stats_),
+                                        POOL_HISTOGRAM(fake_stats_))},
+               "", fake_stats_),
+        tracing_stats_{CONN_MAN_TRACING_STATS(POOL_COUNTER(fake_stats_))},
+        listener_stats_{CONN_MAN_LISTENER_STATS(POOL_COUNTER(fake_stats_))},
+        local_reply_(LocalReply::Factory::createDefault()) {
+    request_id_extension_ = RequestIDExtensionFactory::defaultInstance(random_);
+  }
+
+  // Http::ConnectionManagerConfig
+  RequestIDExtensionSharedPtr requestIDExtension() override { return request_id_extension_; }
+  const std::list<AccessLog::InstanceSharedPtr>& accessLogs() override { return access_logs_; }
+  ServerConnectionPtr createCodec(Network::Connection&, const Buffer::Instance&,
+                                  ServerConnectionCallbacks&) override {
+    return ServerConnectionPtr{new testing::NiceMock<MockServerConnection>()};
+  }
+  DateProvider& dateProvider() override { return date_provider_; }
+  std::chrono::milliseconds drainTimeout() const override { return std::chrono::milliseconds(100); }
+  FilterChainFactory& filterFactory() override { return filter_factory_; }
+  bool generateRequestId() const override { return false; }
+  bool preserveExternalRequestId() const override { return false; }
+  bool alwaysSetRequestIdInResponse() const override { return false; }
+  uint32_t maxRequestHeadersKb() const override { return Http::DEFAULT_MAX_REQUEST_HEADERS_KB; }
+  uint32_t maxRequestHeadersCount() const override { return Http::DEFAULT_MAX_HEADERS_COUNT; }
+  absl::optional<std::chrono::milliseconds> idleTimeout() const override { return absl::nullopt; }
+  bool isRoutable() const override { return true; }
+  absl::optional<std::chrono::milliseconds> maxConnectionDuration() const override {
+    return absl::nullopt;
+  }
+  absl::optional<std::chrono::milliseconds> maxStreamDuration() const override {
+    return absl::nullopt;
+  }
+  std::chrono::milliseconds streamIdleTimeout() const override { return {}; }
+  std::chrono::milliseconds requestTimeout() const override { return {}; }
+  std::chrono::milliseconds delayedCloseTimeout() const override { return {}; }
+  Router::RouteConfigProvider* routeConfigProvider() override { return &route_config_provider_; }
+  Config::ConfigProvider* scopedRouteConfigProvider() override { return nullptr; }
+  const std::string& serverName() const override { return EMPTY_STRING; }
+  HttpConnectionManagerProto::ServerHeaderTransformation
+  serverHeaderTransformation() const override {
+    return HttpConnectionManagerProto::OVERWRITE;
+  }
+  ConnectionManagerStats& stats() override { return stats_; }
+  ConnectionManagerTracingStats& tracingStats() override { return tracing_stats_; }
+  bool useRemoteAddress() const override { return true; }
+  const Http::InternalAddressConfig& internalAddressConfig() const override {
+    return internal_address_config_;
+  }
+  uint32_t xffNumTrustedHops() const override { return 0; }
+  bool skipXffAppend() const override { return false; }
+  const std::string& via() const override { return EMPTY_STRING; }
+  Http::ForwardClientCertType forwardClientCert() const override {
+    return Http::ForwardClientCertType::Sanitize;
+  }
+  const std::vector<Http::ClientCertDetailsType>& setCurrentClientCertDetails() const override {
+    return set_current_client_cert_details_;
+  }
+  const Network::Address::Instance& localAddress() override { return local_address_; }
+  const absl::optional<std::string>& userAgent() override { return user_agent_; }
+  Tracing::HttpTracerSharedPtr tracer() override { return nullptr; }
+  const TracingConnectionManagerConfig* tracingConfig() override { return nullptr; }
+  ConnectionManagerListenerStats& listenerStats() override { return listener_stats_; }
+  bool proxy100Continue() const override { return false; }
+  const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
+  bool shouldNormalizePath() const override { return false; }
+  bool shouldMergeSlashes() const override { return false; }
+  bool shouldStripMatchingPort() const override { return false; }
+  envoy::config::core::v3::HttpProtocolOptions::HeadersWithUnderscoresAction
+  headersWithUnderscoresAction() const override {
+    return envoy::config::core::v3::HttpProtocolOptions::ALLOW;
+  }
+  const LocalReply::LocalReply& localReply() const override { return *local_reply_; }
+  bool perStreamArena() const override { return per_stream_arena_; }
+
+  BenchmarkFilterChainFactory filter_factory_;
+  const bool per_stream_arena_;
+  testing::NiceMock<Runtime::MockRandomGenerator> random_;
+  RequestIDExtensionSharedPtr request_id_extension_;
+  std::list<AccessLog::InstanceSharedPtr> access_logs_;
+  Event::SimulatedTimeSystem time_system_;
+  SlowDateProviderImpl date_provider_{time_system_};
+  testing::NiceMock<Router::MockRouteConfigProvider> route_config_provider_;
+  Stats::IsolatedStoreImpl fake_stats_;
+  ConnectionManagerStats stats_;
+  ConnectionManagerTracingStats tracing_stats_;
+  ConnectionManagerListenerStats listener_stats_;
+  std::vector<Http::ClientCertDetailsType> set_current_client_cert_details_;
+  Network::Address::Ipv4Instance local_address_{"127.0.0.1"};
+  absl::optional<std::string> user_agent_;
+  Http::Http1Settings http1_settings_;
+  Http::DefaultInternalAddressConfig internal_address_config_;
+  LocalReply::LocalReplyPtr local_reply_;
+};
+
+// Arguments: number of pass through filters, whether per_stream_arena is enabled.
+static void ConnectionManagerHeaderOnlyRequest(benchmark::State& state) {
+  BenchmarkConfig config(state.range(0), state.range(1) != 0);
+  testing::NiceMock<Network::MockDrainDecision> drain_close;
+  testing::NiceMock<Runtime::MockRandomGenerator> random;
+  Stats::IsolatedStoreImpl stats_store;
+  Http::ContextImpl http_context(stats_store.symbolTable());
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  testing::NiceMock<LocalInfo::MockLocalInfo> local_info;
+  testing::NiceMock<Upstream::MockClusterManager> cluster_manager;
+  testing::NiceMock<Network::MockReadFilterCallbacks> filter_callbacks;
+  filter_callbacks.connection_.local_address_ =
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1");
+  filter_callbacks.connection_.remote_address_ =
+      std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1");
+
+  ConnectionManagerImpl conn_manager(config, drain_close, random, http_context, runtime, local_info,
+                                     cluster_manager, nullptr, config.time_system_);
+  conn_manager.initializeReadFilterCallbacks(filter_callbacks);
+  // Create the codec.
+  Buffer::OwnedImpl data;
+  conn_manager.onData(data, false);
+
+  testing::NiceMock<MockResponseEncoder> encoder;
+  std::list<Event::DeferredDeletablePtr>& to_delete =
+      filter_callbacks.connection_.dispatcher_.to_delete_;
+  uint64_t requests = 0;
+#ifdef TCMALLOC
+  allocations = 0;
+  MallocHook::AddNewHook(&countAllocation);
+#endif
+  for (auto _ : state) {
+    RequestDecoder& decoder = conn_manager.newStream(encoder);
+    auto headers = std::make_unique<RequestHeaderMapImpl>();
+    headers->setReferenceMethod(Headers::get().MethodValues.Get);
+    headers->setReferenceHost("host");
+    headers->setReferencePath("/");
+    decoder.decodeHeaders(std::move(headers), true);
+    // Destroy the stream, which would normally happen at the end of the event loop iteration.
+    to_delete.clear();
+    requests++;
+  }
+#ifdef TCMALLOC
+  MallocHook::RemoveNewHook(&countAllocation);
+  state.counters["allocs"] = static_cast<double>(allocations) / requests;
+#endif
+  benchmark::DoNotOptimize(requests);
+}
+BENCHMARK(ConnectionManagerHeaderOnlyRequest)
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({5, 0})
+    ->Args({5, 1})
+    ->Args({10, 0})
+    ->Args({10, 1});
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
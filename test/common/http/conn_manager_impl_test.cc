@@ -357,6 +357,7 @@ public:
     return headers_with_underscores_action_;
   }
   const LocalReply::LocalReply& localReply() const override { return *local_reply_; }
+  bool perStreamArena() const override { return per_stream_arena_; }
 
   Envoy::Event::SimulatedTimeSystem test_time_;
   NiceMock<Router::MockRouteConfigProvider> route_config_provider_;
@@ -414,6 +415,7 @@ public:
   bool normalize_path_ = false;
   bool merge_slashes_ = false;
   bool strip_matching_port_ = false;
+  bool per_stream_arena_ = false;
   envoy::config::core::v3::HttpProtocolOptions::HeadersWithUnderscoresAction
       headers_with_underscores_action_ = envoy::config::core::v3::HttpProtocolOptions::ALLOW;
   NiceMock<Network::MockClientConnection> upstream_conn_; // for websocket tests
@@ -492,6 +494,43 @@ TEST_F(HttpConnectionManagerImplTest, HeaderOnlyRequestAndResponse) {
   EXPECT_EQ(1U, listener_stats_.downstream_rq_completed_.value());
 }
 
+// Run a request through a filter chain long enough that the per stream arena has to grow past its
+// inline buffer.
+TEST_F(HttpConnectionManagerImplTest, PerStreamArena) {
+  per_stream_arena_ = true;
+  setup(false, "");
+
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> Http::Status {
+    RequestDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    RequestHeaderMapPtr headers{
+        new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+    data.drain(4);
+    return Http::okStatus();
+  }));
+
+  const int num_filters = 32;
+  setupFilterChain(num_filters, num_filters);
+
+  for (int i = 0; i < num_filters; i++) {
+    EXPECT_CALL(*decoder_filters_[i], decodeHeaders(_, true))
+        .WillOnce(Return(FilterHeadersStatus::Continue));
+    EXPECT_CALL(*decoder_filters_[i], decodeComplete());
+    EXPECT_CALL(*encoder_filters_[i], encodeHeaders(_, true))
+        .WillOnce(Return(FilterHeadersStatus::Continue));
+    EXPECT_CALL(*encoder_filters_[i], encodeComplete());
+  }
+  EXPECT_CALL(response_encoder_, encodeHeaders(_, true));
+  expectOnDestroy();
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  decoder_filters_[num_filters - 1]->callbacks_->encodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, true);
+  EXPECT_EQ(1U, stats_.named_.downstream_rq_2xx_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, 100ContinueResponse) {
   proxy_100_continue_ = true;
   setup(false, "envoy-custom-server", false);
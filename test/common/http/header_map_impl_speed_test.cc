@@ -113,6 +113,57 @@ static void HeaderMapImplSetInlineInteger(benchmark::State& state) {
 }
 BENCHMARK(HeaderMapImplSetInlineInteger)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
 
+// A custom header registered for O(1) access, as an extension would.
+RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::RequestHeaders>
+    custom_inline_header(LowerCaseString("x-custom-inline"));
+
+/**
+ * Measure the retrieval speed of a custom header by key, which requires a scan of all headers. The
+ * numeric Arg is the number of other headers.
+ */
+static void HeaderMapImplGetCustom(benchmark::State& state) {
+  const LowerCaseString key("x-custom");
+  const std::string value("01234567890123456789");
+  RequestHeaderMapImpl headers;
+  addDummyHeaders(headers, state.range(0));
+  headers.setReference(key, value);
+  size_t size = 0;
+  for (auto _ : state) {
+    size += headers.get(key)->value().size();
+  }
+  benchmark::DoNotOptimize(size);
+}
+BENCHMARK(HeaderMapImplGetCustom)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
+
+/**
+ * Measure the retrieval speed of a custom header registered with CustomInlineHeaderRegistry, which
+ * is expected to be independent of the number of other headers.
+ */
+static void HeaderMapImplGetCustomInline(benchmark::State& state) {
+  const std::string value("01234567890123456789");
+  RequestHeaderMapImpl headers;
+  addDummyHeaders(headers, state.range(0));
+  headers.setReferenceInline(custom_inline_header.handle(), value);
+  size_t size = 0;
+  for (auto _ : state) {
+    size += headers.getInline(custom_inline_header.handle())->value().size();
+  }
+  benchmark::DoNotOptimize(size);
+}
+BENCHMARK(HeaderMapImplGetCustomInline)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
+
+/** Measure the speed of overwriting a registered custom header. */
+static void HeaderMapImplSetCustomInline(benchmark::State& state) {
+  const std::string value("01234567890123456789");
+  RequestHeaderMapImpl headers;
+  addDummyHeaders(headers, state.range(0));
+  for (auto _ : state) {
+    headers.setReferenceInline(custom_inline_header.handle(), value);
+  }
+  benchmark::DoNotOptimize(headers.size());
+}
+BENCHMARK(HeaderMapImplSetCustomInline)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
+
 /** Measure the speed of the byteSize() estimation method. */
 static void HeaderMapImplGetByteSize(benchmark::State& state) {
   HeaderMapImpl headers;
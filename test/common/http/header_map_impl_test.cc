@@ -383,6 +383,100 @@ TEST(HeaderMapImplTest, AllInlineHeaders) {
   }
 }
 
+namespace {
+
+RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::RequestHeaders>
+    custom_request_header(LowerCaseString("x-custom-request"));
+RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::RequestHeaders>
+    custom_request_header_again(LowerCaseString("x-custom-request"));
+RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::RequestHeaders>
+    custom_builtin_request_header(Headers::get().Path);
+RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::RequestTrailers>
+    custom_request_trailer(LowerCaseString("x-custom-trailer"));
+RegisterCustomInlineHeader<CustomInlineHeaderRegistry::Type::ResponseHeaders>
+    custom_response_header(LowerCaseString("x-custom-response"));
+
+} // namespace
+
+// Make sure that registered custom O(1) headers are wired up properly.
+TEST(HeaderMapImplTest, CustomInlineHeaders) {
+  {
+    TestRequestHeaderMapImpl headers{{"x-custom-request", "a"}, {":path", "/"}};
+    EXPECT_EQ(custom_request_header.handle().index(), custom_request_header_again.handle().index());
+    EXPECT_EQ("a", headers.getInlineValue(custom_request_header.handle()));
+    EXPECT_EQ("a", headers.getInlineValue(custom_request_header_again.handle()));
+    headers.addCopy(LowerCaseString("x-custom-request"), "b");
+    EXPECT_EQ("a,b", headers.getInlineValue(custom_request_header.handle()));
+    EXPECT_EQ(2UL, headers.size());
+
+    // Registering a built in header yields the built in slot.
+    EXPECT_EQ(headers.Path(), headers.getInline(custom_builtin_request_header.handle()));
+    headers.setInline(custom_builtin_request_header.handle(), "/foo");
+    EXPECT_EQ("/foo", headers.getPathValue());
+
+    headers.appendInline(custom_request_header.handle(), "c", ";");
+    EXPECT_EQ("a,b;c", headers.get(LowerCaseString("x-custom-request"))->value().getStringView());
+    headers.setInline(custom_request_header.handle(), 5);
+    EXPECT_EQ("5", headers.getInlineValue(custom_request_header.handle()));
+    const std::string value = "referenced";
+    headers.setReferenceInline(custom_request_header.handle(), value);
+    EXPECT_EQ(value.data(),
+              headers.getInline(custom_request_header.handle())->value().getStringView().data());
+
+    const HeaderEntry* entry;
+    EXPECT_EQ(HeaderMap::Lookup::Found,
+              headers.lookup(LowerCaseString("x-custom-request"), &entry));
+    EXPECT_EQ(1UL, headers.removeInline(custom_request_header.handle()));
+    EXPECT_EQ(0UL, headers.removeInline(custom_request_header.handle()));
+    EXPECT_EQ(nullptr, headers.get(LowerCaseString("x-custom-request")));
+    EXPECT_EQ(HeaderMap::Lookup::NotFound,
+              headers.lookup(LowerCaseString("x-custom-request"), &entry));
+
+    headers.setInline(custom_request_header.handle(), "d");
+    EXPECT_EQ(1UL, headers.removePrefix(LowerCaseString("x-custom")));
+    EXPECT_EQ(nullptr, headers.getInline(custom_request_header.handle()));
+    headers.setInline(custom_request_header.handle(), "e");
+    headers.clear();
+    EXPECT_EQ(nullptr, headers.getInline(custom_request_header.handle()));
+    EXPECT_EQ(0UL, headers.byteSize());
+  }
+  {
+    // Custom headers are registered independently for each header map type.
+    TestResponseHeaderMapImpl headers{{"x-custom-request", "a"}, {"x-custom-response", "b"}};
+    const HeaderEntry* entry;
+    EXPECT_EQ(HeaderMap::Lookup::NotSupported,
+              headers.lookup(LowerCaseString("x-custom-request"), &entry));
+    EXPECT_EQ("b", headers.getInlineValue(custom_response_header.handle()));
+  }
+  {
+    TestRequestTrailerMapImpl trailers;
+    trailers.setInline(custom_request_trailer.handle(), "a");
+    EXPECT_EQ("a", trailers.get(LowerCaseString("x-custom-trailer"))->value().getStringView());
+  }
+}
+
+TEST(HeaderMapImplTest, CustomInlineHeaderRegistry) {
+  const auto handle = CustomInlineHeaderRegistry::getInlineHeader<
+      CustomInlineHeaderRegistry::Type::RequestHeaders>(LowerCaseString("x-custom-request"));
+  ASSERT_TRUE(handle.has_value());
+  EXPECT_EQ(custom_request_header.handle().index(), handle->index());
+  EXPECT_EQ("x-custom-request", handle->key().get());
+  EXPECT_FALSE(CustomInlineHeaderRegistry::getInlineHeader<
+                   CustomInlineHeaderRegistry::Type::ResponseHeaders>(
+                   LowerCaseString("x-custom-request"))
+                   .has_value());
+}
+
+TEST(TestHeaderMapImplDeathTest, CustomInlineHeaderRegisteredAfterFinalize) {
+  // Using a header map finalizes the registry.
+  RequestHeaderMapImpl headers;
+  headers.setPath("/");
+  EXPECT_DEATH_LOG_TO_STDERR(
+      CustomInlineHeaderRegistry::registerInlineHeader<
+          CustomInlineHeaderRegistry::Type::RequestHeaders>(LowerCaseString("x-late")),
+      "inline headers must be registered before any header map is used");
+}
+
 TEST(HeaderMapImplTest, InlineInsert) {
   TestRequestHeaderMapImpl headers;
   EXPECT_TRUE(headers.empty());
@@ -930,6 +930,119 @@ TEST_F(Http1ConnPoolImplTest, DrainCallback) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+// Test that spare connections are established ahead of demand with a prefetch ratio, up to the
+// connection circuit breaker.
+TEST_F(Http1ConnPoolImplTest, PrefetchRatio) {
+  cluster_->per_upstream_prefetch_ratio_ = 1.5;
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+
+  // The first request needs a connection, and one more is established for the next request.
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  r1.expectNewStream();
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r1.startRequest();
+
+  // The second request uses the spare connection, and another one is established.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+  conn_pool_.test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The third request uses it, but the circuit breaker stops a fourth connection without counting
+  // an overflow.
+  ActiveTestRequest r3(*this, 2, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+  r3.completeResponse(false);
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(3);
+  conn_pool_.test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Test that the warm connections are established, replaced when closed, and not replaced once the
+// pool is being drained.
+TEST_F(Http1ConnPoolImplTest, MinWarmConnections) {
+  cluster_->min_warm_connections_ = 2;
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  EXPECT_TRUE(conn_pool_.maybePrefetch());
+  EXPECT_FALSE(conn_pool_.maybePrefetch());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_FALSE(conn_pool_.hasActiveConnections());
+
+  // A request uses a warm connection without establishing another one.
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  r1.expectNewStream();
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r1.startRequest();
+  r1.completeResponse(false);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // A closed connection is replaced.
+  conn_pool_.expectClientCreate();
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(3U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // Draining closes the idle and connecting connections, without replacing them.
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  conn_pool_.addDrainedCallback([&]() -> void { drained.ready(); });
+  EXPECT_FALSE(conn_pool_.maybePrefetch());
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(3U, cluster_->stats_.upstream_cx_prefetch_.value());
+}
+
+// Test that a connection which fails to connect is not replaced ahead of demand until a connection
+// is established for a request.
+TEST_F(Http1ConnPoolImplTest, MinWarmConnectionsConnectFailure) {
+  cluster_->min_warm_connections_ = 1;
+
+  conn_pool_.expectClientCreate();
+  EXPECT_TRUE(conn_pool_.maybePrefetch());
+
+  // The warm connection fails to connect and is not replaced.
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_connect_fail_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // A request still gets a connection, without a second one being established ahead of demand.
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  r1.completeResponse(false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // Once a connection has been established, a closed connection is replaced again.
+  conn_pool_.expectClientCreate();
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 // Test draining a connection pool that has a pending connection.
 TEST_F(Http1ConnPoolImplTest, DrainWhileConnecting) {
   InSequence s;
@@ -0,0 +1,59 @@
+#include <random>
+#include <string>
+
+#include "common/http/header_utility.h"
+#include "common/http/http1/header_scanner.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Every byte value, at every position of inputs long enough to exercise both the vectorized loop
+// and the scalar tail.
+TEST(HeaderScannerTest, ValueIsValidAllBytes) {
+  for (int c = 0; c < 256; c++) {
+    const bool valid = c == '\t' || (c >= 0x20 && c != 0x7f);
+    for (size_t size : {1, 15, 16, 17, 40}) {
+      for (size_t pos = 0; pos < size; pos++) {
+        std::string value(size, 'a');
+        value[pos] = static_cast<char>(c);
+        EXPECT_EQ(valid, HeaderScanner::valueIsValid(value)) << c << " " << pos;
+        EXPECT_EQ(valid, HeaderScanner::valueIsValidScalar(value)) << c << " " << pos;
+      }
+    }
+  }
+}
+
+TEST(HeaderScannerTest, ValueIsValid) {
+  EXPECT_TRUE(HeaderScanner::valueIsValid(""));
+  EXPECT_TRUE(HeaderScanner::valueIsValid("text/html; charset=utf-8\tq=0.9 \xc3\xa9"));
+  EXPECT_FALSE(HeaderScanner::valueIsValid("value with a\r\nsmuggled: header"));
+  EXPECT_FALSE(
+      HeaderScanner::valueIsValid(absl::string_view("nul\0byte in a long header value", 31)));
+}
+
+// The codec used to validate values with HeaderUtility::headerValueIsValid(); the scanner must
+// accept exactly the same values, including ones spanning several 16 byte blocks.
+TEST(HeaderScannerTest, MatchesHeaderUtility) {
+  std::mt19937 random(0);
+  const std::string alphabet("\0\t\n\r \x1f\x7f\x80\xff" "aZ;=", 13);
+  for (int i = 0; i < 10000; i++) {
+    std::string value(random() % 80, 'a');
+    for (char& c : value) {
+      // Mostly valid characters, so that invalid ones are found at all positions.
+      if (random() % 8 == 0) {
+        c = alphabet[random() % alphabet.size()];
+      }
+    }
+    EXPECT_EQ(HeaderUtility::headerValueIsValid(value), HeaderScanner::valueIsValid(value))
+        << value;
+  }
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
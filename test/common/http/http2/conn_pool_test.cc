@@ -387,6 +387,38 @@ TEST_F(Http2ConnPoolImplTest, MaxConcurrentRequestsPerStream) {
   EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
 }
 
+// Verifies that spare stream capacity is established ahead of demand with a prefetch ratio.
+TEST_F(Http2ConnPoolImplTest, PrefetchRatio) {
+  cluster_->per_upstream_prefetch_ratio_ = 2.0;
+  cluster_->http2_options_.mutable_max_concurrent_streams()->set_value(2);
+
+  // The first connection can serve both requests, and a second one is established for the
+  // requests expected to follow them.
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 0, false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  expectStreamConnect(0, r1);
+  expectClientConnect(0, r2);
+  EXPECT_CALL(*test_clients_[1].connect_timer_, disableTimer());
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // A third request uses the spare connection, and another one is established.
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 1, true);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(3U, cluster_->stats_.upstream_cx_total_.value());
+
+  completeRequest(r1);
+  completeRequest(r2);
+  completeRequest(r3);
+  closeClient(0);
+  closeClient(1);
+  closeClient(2);
+}
+
 // Verifies that requests are queued up in the conn pool until the connection becomes ready.
 TEST_F(Http2ConnPoolImplTest, PendingRequests) {
   InSequence s;
@@ -372,6 +372,33 @@ TEST_P(UdpListenerImplTest, SendData) {
   EXPECT_EQ(data.buffer_->toString(), payload);
 }
 
+/**
+ * Tests that a batch of datagrams, including equally sized runs which may be coalesced into a
+ * single GSO send, arrives at the client socket intact and in order and that sent buffers are
+ * drained.
+ */
+TEST_P(UdpListenerImplTest, SendBatch) {
+  const std::vector<std::string> payloads{"hello", "world", "end"};
+  std::vector<Buffer::OwnedImpl> buffers(payloads.size());
+  std::vector<UdpSendData> send_data;
+  for (size_t i = 0; i < payloads.size(); ++i) {
+    buffers[i].add(payloads[i]);
+    send_data.push_back(UdpSendData{send_to_addr_->ip(), *client_.localAddress(), buffers[i]});
+  }
+
+  auto send_result = listener_->sendBatch(send_data.data(), send_data.size());
+  EXPECT_TRUE(send_result.ok()) << "sendBatch() failed : "
+                                << send_result.err_->getErrorDetails();
+  EXPECT_EQ(payloads.size(), send_result.rc_);
+
+  for (size_t i = 0; i < payloads.size(); ++i) {
+    EXPECT_EQ(0, buffers[i].length());
+    UdpRecvData data;
+    client_.recv(data);
+    EXPECT_EQ(payloads[i], data.buffer_->toString());
+  }
+}
+
 /**
  * The send fails because the server_socket is created with bind=false.
  */
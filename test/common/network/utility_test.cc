@@ -6,10 +6,13 @@
 #include "envoy/common/exception.h"
 #include "envoy/config/core/v3/address.pb.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/thread.h"
 #include "common/network/address_impl.h"
+#include "common/network/io_socket_error_impl.h"
 #include "common/network/utility.h"
 
+#include "test/mocks/network/io_handle.h"
 #include "test/mocks/network/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
@@ -17,6 +20,13 @@
 
 #include "gtest/gtest.h"
 
+using testing::_;
+using testing::ByMove;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::Sequence;
+
 namespace Envoy {
 namespace Network {
 namespace {
@@ -443,6 +453,167 @@ TEST(PortRangeListTest, Normal) {
   }
 }
 
+class WritePacketsToSocketTest : public testing::Test {
+protected:
+  WritePacketsToSocketTest() {
+    ON_CALL(io_handle_, supportsMmsg()).WillByDefault(Return(true));
+    ON_CALL(io_handle_, supportsUdpGso()).WillByDefault(Return(true));
+  }
+
+  // Queues a datagram of |size| bytes, filled with |fill|, to |peer|.
+  void addPacket(const Address::Instance& peer, uint64_t size, char fill) {
+    buffers_.push_back(std::make_unique<Buffer::OwnedImpl>(std::string(size, fill)));
+    packets_.push_back({nullptr, peer, *buffers_.back()});
+  }
+
+  static uint64_t messageLength(const IoHandle::SendMsgPacket& message) {
+    uint64_t length = 0;
+    for (uint64_t i = 0; i < message.num_slice_; ++i) {
+      length += message.slices_[i].len_;
+    }
+    return length;
+  }
+
+  static Api::IoCallUint64Result sent(uint64_t rc) {
+    return Api::IoCallUint64Result(rc, Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError));
+  }
+
+  static Api::IoCallUint64Result failed(int sys_errno) {
+    return Api::IoCallUint64Result(
+        0, Api::IoErrorPtr(new IoSocketError(sys_errno), IoSocketError::deleteIoError));
+  }
+
+  Address::Ipv4Instance peer1_{"10.0.0.1", 1000};
+  Address::Ipv4Instance peer2_{"10.0.0.2", 2000};
+  std::vector<std::unique_ptr<Buffer::OwnedImpl>> buffers_;
+  std::vector<UdpSendData> packets_;
+  NiceMock<MockIoHandle> io_handle_;
+};
+
+// Runs of datagrams to the same peer are coalesced into one UDP GSO message. When the kernel sends
+// only part of the batch and then refuses to segment a message, the datagrams of that message are
+// sent individually, exactly once, and the rest of the batch is sent with sendmmsg() again.
+TEST_F(WritePacketsToSocketTest, PartialSendThenGsoFallback) {
+  addPacket(peer2_, 50, 'a');
+  addPacket(peer1_, 100, 'b');
+  addPacket(peer1_, 100, 'c');
+  addPacket(peer1_, 100, 'd');
+  // The last datagram of a run may be shorter than the segment size.
+  addPacket(peer1_, 60, 'e');
+  addPacket(peer2_, 50, 'f');
+
+  Sequence seq;
+  EXPECT_CALL(io_handle_, sendmmsg(_, 3))
+      .InSequence(seq)
+      .WillOnce(Invoke([&](const IoHandle::SendMsgPacket* messages, uint64_t) {
+        EXPECT_EQ(0U, messages[0].gso_size_);
+        EXPECT_EQ(50U, messageLength(messages[0]));
+        EXPECT_EQ(peer2_.asString(), messages[0].peer_address_->asString());
+        EXPECT_EQ(100U, messages[1].gso_size_);
+        EXPECT_EQ(360U, messageLength(messages[1]));
+        EXPECT_EQ(peer1_.asString(), messages[1].peer_address_->asString());
+        EXPECT_EQ(0U, messages[2].gso_size_);
+        EXPECT_EQ(50U, messageLength(messages[2]));
+        // Only the first message is sent.
+        return sent(1);
+      }));
+  EXPECT_CALL(io_handle_, sendmmsg(_, 2))
+      .InSequence(seq)
+      .WillOnce(Invoke([&](const IoHandle::SendMsgPacket* messages, uint64_t) {
+        EXPECT_EQ(100U, messages[0].gso_size_);
+        return failed(EINVAL);
+      }));
+  std::vector<std::string> fallback_datagrams;
+  EXPECT_CALL(io_handle_, sendmsg(_, _, 0, nullptr, _))
+      .Times(4)
+      .InSequence(seq)
+      .WillRepeatedly(Invoke([&](const Buffer::RawSlice* slices, uint64_t num_slice, int,
+                                 const Address::Ip*, const Address::Instance& peer_address) {
+        EXPECT_EQ(peer1_.asString(), peer_address.asString());
+        std::string datagram;
+        for (uint64_t i = 0; i < num_slice; ++i) {
+          datagram.append(static_cast<const char*>(slices[i].mem_), slices[i].len_);
+        }
+        fallback_datagrams.push_back(datagram);
+        return sent(datagram.size());
+      }));
+  EXPECT_CALL(io_handle_, sendmmsg(_, 1))
+      .InSequence(seq)
+      .WillOnce(Invoke([&](const IoHandle::SendMsgPacket* messages, uint64_t) {
+        EXPECT_EQ(0U, messages[0].gso_size_);
+        EXPECT_EQ(peer2_.asString(), messages[0].peer_address_->asString());
+        return sent(1);
+      }));
+
+  const Api::IoCallUint64Result result =
+      Utility::writePacketsToSocket(io_handle_, packets_.data(), packets_.size());
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(6U, result.rc_);
+  EXPECT_EQ((std::vector<std::string>{std::string(100, 'b'), std::string(100, 'c'),
+                                      std::string(100, 'd'), std::string(60, 'e')}),
+            fallback_datagrams);
+}
+
+// An error in the individual sends of the fallback reports the datagrams sent before it.
+TEST_F(WritePacketsToSocketTest, GsoFallbackError) {
+  addPacket(peer1_, 100, 'a');
+  addPacket(peer1_, 100, 'b');
+  addPacket(peer1_, 100, 'c');
+
+  EXPECT_CALL(io_handle_, sendmmsg(_, 1)).WillOnce(Return(ByMove(failed(EIO))));
+  EXPECT_CALL(io_handle_, sendmsg(_, _, 0, nullptr, _))
+      .WillOnce(Return(ByMove(sent(100))))
+      .WillOnce(Return(ByMove(failed(ENOBUFS))));
+
+  const Api::IoCallUint64Result result =
+      Utility::writePacketsToSocket(io_handle_, packets_.data(), packets_.size());
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(1U, result.rc_);
+}
+
+// Without UDP GSO every datagram is its own message, and an error other than a GSO failure is
+// returned without falling back to sendmsg().
+TEST_F(WritePacketsToSocketTest, NoGso) {
+  EXPECT_CALL(io_handle_, supportsUdpGso()).WillRepeatedly(Return(false));
+  addPacket(peer1_, 100, 'a');
+  addPacket(peer1_, 100, 'b');
+  addPacket(peer1_, 100, 'c');
+
+  EXPECT_CALL(io_handle_, sendmmsg(_, 3))
+      .WillOnce(Invoke([&](const IoHandle::SendMsgPacket* messages, uint64_t) {
+        for (uint64_t i = 0; i < 3; ++i) {
+          EXPECT_EQ(0U, messages[i].gso_size_);
+          EXPECT_EQ(100U, messageLength(messages[i]));
+        }
+        return sent(2);
+      }));
+  EXPECT_CALL(io_handle_, sendmmsg(_, 1)).WillOnce(Return(ByMove(failed(EINVAL))));
+  EXPECT_CALL(io_handle_, sendmsg(_, _, _, _, _)).Times(0);
+
+  const Api::IoCallUint64Result result =
+      Utility::writePacketsToSocket(io_handle_, packets_.data(), packets_.size());
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(2U, result.rc_);
+}
+
+// Without sendmmsg() each datagram is sent with sendmsg().
+TEST_F(WritePacketsToSocketTest, NoMmsg) {
+  EXPECT_CALL(io_handle_, supportsMmsg()).WillRepeatedly(Return(false));
+  addPacket(peer1_, 100, 'a');
+  addPacket(peer2_, 100, 'b');
+
+  EXPECT_CALL(io_handle_, sendmmsg(_, _)).Times(0);
+  EXPECT_CALL(io_handle_, sendmsg(_, _, 0, nullptr, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([](const Buffer::RawSlice*, uint64_t, int, const Address::Ip*,
+                                const Address::Instance&) { return sent(100); }));
+
+  const Api::IoCallUint64Result result =
+      Utility::writePacketsToSocket(io_handle_, packets_.data(), packets_.size());
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(2U, result.rc_);
+}
+
 // TODO(ccaraman): Support big-endian. These tests operate under the assumption that the machine
 // byte order is little-endian.
 TEST(AbslUint128, TestByteOrder) {
@@ -0,0 +1,92 @@
+#include "common/router/compiled_route_matcher.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+std::vector<uint32_t> candidates(const CompiledRouteMatcher& matcher, absl::string_view path) {
+  CompiledRouteMatcher::Candidates result;
+  matcher.candidates(path, result);
+  return {result.begin(), result.end()};
+}
+
+TEST(CompiledRouteMatcherTest, Empty) {
+  CompiledRouteMatcher matcher;
+  EXPECT_THAT(candidates(matcher, "/foo"), IsEmpty());
+  EXPECT_THAT(candidates(matcher, ""), IsEmpty());
+  EXPECT_EQ(1, matcher.nodeCount());
+}
+
+TEST(CompiledRouteMatcherTest, PrefixAndExact) {
+  CompiledRouteMatcher matcher;
+  matcher.addExact("/foo", 0);
+  matcher.addPrefix("/foo/bar", 1);
+  matcher.addPrefix("/foo", 2);
+  matcher.addExact("/foo/bar", 3);
+  matcher.addPrefix("/", 4);
+  matcher.addPrefix("", 5);
+
+  EXPECT_THAT(candidates(matcher, "/foo"), ElementsAre(0, 2, 4, 5));
+  EXPECT_THAT(candidates(matcher, "/foo/bar"), ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_THAT(candidates(matcher, "/foo/bar/baz"), ElementsAre(1, 2, 4, 5));
+  EXPECT_THAT(candidates(matcher, "/foo/ba"), ElementsAre(2, 4, 5));
+  EXPECT_THAT(candidates(matcher, "/fo"), ElementsAre(4, 5));
+  EXPECT_THAT(candidates(matcher, "/bar"), ElementsAre(4, 5));
+  EXPECT_THAT(candidates(matcher, "bar"), ElementsAre(5));
+  EXPECT_THAT(candidates(matcher, ""), ElementsAre(5));
+}
+
+TEST(CompiledRouteMatcherTest, EdgeSplitting) {
+  CompiledRouteMatcher matcher;
+  matcher.addPrefix("/users/list", 0);
+  matcher.addPrefix("/users/lookup", 1);
+  matcher.addExact("/user", 2);
+  matcher.addPrefix("/users/l", 3);
+
+  // Root, "/user", "/users/l", "ist", "ookup".
+  EXPECT_EQ(5, matcher.nodeCount());
+  EXPECT_THAT(candidates(matcher, "/users/list"), ElementsAre(0, 3));
+  EXPECT_THAT(candidates(matcher, "/users/lookup/1"), ElementsAre(1, 3));
+  EXPECT_THAT(candidates(matcher, "/users/lo"), ElementsAre(3));
+  EXPECT_THAT(candidates(matcher, "/user"), ElementsAre(2));
+  EXPECT_THAT(candidates(matcher, "/users"), IsEmpty());
+  EXPECT_THAT(candidates(matcher, "/use"), IsEmpty());
+}
+
+TEST(CompiledRouteMatcherTest, DuplicateKeys) {
+  CompiledRouteMatcher matcher;
+  matcher.addPrefix("/foo", 0);
+  matcher.addPrefix("/foo", 1);
+  matcher.addExact("/foo", 2);
+  matcher.addExact("/foo", 3);
+
+  EXPECT_EQ(2, matcher.nodeCount());
+  EXPECT_THAT(candidates(matcher, "/foo"), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(candidates(matcher, "/foo/"), ElementsAre(0, 1));
+}
+
+TEST(CompiledRouteMatcherTest, FallbackRoutesAreAlwaysCandidates) {
+  CompiledRouteMatcher matcher;
+  matcher.addFallback(0);
+  matcher.addPrefix("/foo", 1);
+  matcher.addFallback(2);
+  matcher.addExact("/bar", 3);
+
+  EXPECT_THAT(candidates(matcher, "/foo"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(candidates(matcher, "/bar"), ElementsAre(0, 2, 3));
+  EXPECT_THAT(candidates(matcher, "/baz"), ElementsAre(0, 2));
+
+  CompiledRouteMatcher::Candidates result;
+  matcher.fallbackCandidates(result);
+  EXPECT_THAT(result, ElementsAre(0, 2));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
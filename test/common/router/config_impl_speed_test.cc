@@ -0,0 +1,146 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/route/v3/route.pb.h"
+#include "envoy/config/route/v3/route_components.pb.h"
+
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+/**
+ * Builds a virtual host with num_routes routes. Even routes are exact path matches and odd routes
+ * are prefix matches, followed by a catch-all route.
+ */
+envoy::config::route::v3::RouteConfiguration genRouteConfig(int num_routes, bool compiled) {
+  envoy::config::route::v3::RouteConfiguration route_config;
+  route_config.set_compiled_route_matching(compiled);
+  auto* vhost = route_config.add_virtual_hosts();
+  vhost->set_name("default");
+  vhost->add_domains("*");
+  for (int i = 0; i < num_routes; ++i) {
+    auto* route = vhost->add_routes();
+    if (i % 2 == 0) {
+      route->mutable_match()->set_path(absl::StrCat("/shelves/", i));
+    } else {
+      route->mutable_match()->set_prefix(absl::StrCat("/shelves/", i, "/books"));
+    }
+    route->mutable_route()->set_cluster(absl::StrCat("cluster_", i));
+  }
+  auto* catch_all = vhost->add_routes();
+  catch_all->mutable_match()->set_prefix("/");
+  catch_all->mutable_route()->set_cluster("default");
+  return route_config;
+}
+
+Http::TestRequestHeaderMapImpl genHeaders(const std::string& path) {
+  return Http::TestRequestHeaderMapImpl{{":authority", "www.lyft.com"},
+                                        {":path", path},
+                                        {":method", "GET"},
+                                        {"x-forwarded-proto", "http"}};
+}
+
+// Routes a request that matches the last configured non catch-all route, which is the worst case
+// for the linear scan.
+void routeLookup(benchmark::State& state, const std::string& path_format) {
+  const bool compiled = state.range(0);
+  const int num_routes = state.range(1);
+
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+
+  ConfigImpl config(genRouteConfig(num_routes, compiled), factory_context,
+                    ProtobufMessage::getNullValidationVisitor(), false);
+  const int target = num_routes - 1;
+  Http::TestRequestHeaderMapImpl headers =
+      genHeaders(fmt::format(path_format, target, target % 2 == 0 ? "" : "/books/1"));
+
+  for (auto _ : state) {
+    RouteConstSharedPtr route = config.route(headers, stream_info, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+
+// Compares the linear scan (first argument 0) with compiled route matching (first argument 1) at
+// several route table sizes.
+void routeTableSizes(benchmark::internal::Benchmark* b) {
+  for (int compiled : {0, 1}) {
+    for (int num_routes : {10, 100, 10000}) {
+      b->Args({compiled, num_routes});
+    }
+  }
+}
+
+// Request for the last route in the route table.
+void BM_RouteLastMatch(benchmark::State& state) { routeLookup(state, "/shelves/{}{}"); }
+BENCHMARK(BM_RouteLastMatch)->Apply(routeTableSizes);
+
+// Request which only matches the catch-all route.
+void BM_RouteCatchAll(benchmark::State& state) { routeLookup(state, "/authors/{}{}"); }
+BENCHMARK(BM_RouteCatchAll)->Apply(routeTableSizes);
+
+// Builds num_vhosts virtual hosts, each with a suffix and a prefix wildcard domain. Tenant
+// names have different lengths so that there are many distinct wildcard lengths.
+envoy::config::route::v3::RouteConfiguration genWildcardRouteConfig(int num_vhosts) {
+  envoy::config::route::v3::RouteConfiguration route_config;
+  for (int i = 0; i < num_vhosts; ++i) {
+    auto* vhost = route_config.add_virtual_hosts();
+    const std::string tenant = absl::StrCat(std::string(i % 32, 't'), i);
+    vhost->set_name(tenant);
+    vhost->add_domains(absl::StrCat("*.", tenant, ".example.com"));
+    vhost->add_domains(absl::StrCat(tenant, ".internal.*"));
+    auto* route = vhost->add_routes();
+    route->mutable_match()->set_prefix("/");
+    route->mutable_route()->set_cluster(tenant);
+  }
+  return route_config;
+}
+
+// Looks up the virtual host of a request for a suffix wildcard (first argument 0) or a prefix
+// wildcard (first argument 1) domain.
+void BM_WildcardVirtualHostLookup(benchmark::State& state) {
+  const bool prefix = state.range(0);
+  const int num_vhosts = state.range(1);
+
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+
+  ConfigImpl config(genWildcardRouteConfig(num_vhosts), factory_context,
+                    ProtobufMessage::getNullValidationVisitor(), false);
+  const int target = num_vhosts - 1;
+  const std::string tenant = absl::StrCat(std::string(target % 32, 't'), target);
+  Http::TestRequestHeaderMapImpl headers = genHeaders("/");
+  headers.setHost(prefix ? absl::StrCat(tenant, ".internal.example.com")
+                         : absl::StrCat("api.", tenant, ".example.com"));
+
+  for (auto _ : state) {
+    RouteConstSharedPtr route = config.route(headers, stream_info, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+BENCHMARK(BM_WildcardVirtualHostLookup)
+    ->Args({0, 10})
+    ->Args({0, 1000})
+    ->Args({0, 5000})
+    ->Args({1, 10})
+    ->Args({1, 1000})
+    ->Args({1, 5000});
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -7664,6 +7664,144 @@ virtual_hosts:
   EXPECT_NE(nullptr, dynamic_cast<const SslRedirectRoute*>(accepted_route.get()));
 }
 
+class CompiledRouteMatchingTest : public testing::Test, public ConfigImplTestBase {
+public:
+  envoy::config::route::v3::RouteConfiguration routeConfig(bool compiled) {
+    const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: bar
+    domains: ["*"]
+    routes:
+      - match: { path: "/exact" }
+        route:
+          cluster: exact
+      - match: { prefix: "/api/v1/users", headers: [{name: x-user, exact_match: "yes"}] }
+        route:
+          cluster: users_header
+      - match: { safe_regex: { google_re2: {}, regex: "/api/v[0-9]+/regex" } }
+        route:
+          cluster: regex
+      - match: { prefix: "/api/v1/users" }
+        route:
+          cluster: users
+      - match: { prefix: "/API/V1", case_sensitive: false }
+        route:
+          cluster: insensitive
+      - match: { prefix: "/api/v1" }
+        route:
+          cluster: v1
+      - match: { path: "/api/v1/exact" }
+        route:
+          cluster: unreachable_exact
+      - match: { prefix: "/api/v2" }
+        route:
+          cluster: v2
+      - match: { prefix: "/" }
+        route:
+          cluster: default
+)EOF";
+    envoy::config::route::v3::RouteConfiguration config = parseRouteConfigurationFromV2Yaml(yaml);
+    config.set_compiled_route_matching(compiled);
+    return config;
+  }
+};
+
+TEST_F(CompiledRouteMatchingTest, SameResultsAsLinearScan) {
+  TestConfigImpl linear(routeConfig(false), factory_context_, true);
+  TestConfigImpl compiled(routeConfig(true), factory_context_, true);
+
+  const std::vector<std::pair<std::string, std::string>> cases{
+      {"/exact", "exact"},
+      {"/exact?query=1", "exact"},
+      {"/exactly", "default"},
+      {"/api/v1/users/123", "users"},
+      {"/api/v1/users", "users"},
+      {"/api/v1/regex", "regex"},
+      {"/api/v7/regex", "regex"},
+      {"/api/v1/other", "insensitive"},
+      {"/API/v1/other", "insensitive"},
+      {"/api/v1/exact", "insensitive"},
+      {"/api/v2/users", "v2"},
+      {"/api/v", "default"},
+      {"/", "default"},
+      {"/a", "default"},
+  };
+  for (const auto& test_case : cases) {
+    Http::TestRequestHeaderMapImpl headers = genHeaders("bat.com", test_case.first, "GET");
+    EXPECT_EQ(test_case.second, linear.route(headers, 0)->routeEntry()->clusterName())
+        << test_case.first;
+    EXPECT_EQ(test_case.second, compiled.route(headers, 0)->routeEntry()->clusterName())
+        << test_case.first;
+  }
+
+  // Header constraints on indexed routes are still evaluated.
+  Http::TestRequestHeaderMapImpl headers = genHeaders("bat.com", "/api/v1/users/123", "GET");
+  headers.addCopy("x-user", "yes");
+  EXPECT_EQ("users_header", compiled.route(headers, 0)->routeEntry()->clusterName());
+}
+
+TEST_F(CompiledRouteMatchingTest, NoMatch) {
+  envoy::config::route::v3::RouteConfiguration config = routeConfig(true);
+  // Drop the catch-all route.
+  config.mutable_virtual_hosts(0)->mutable_routes()->RemoveLast();
+  TestConfigImpl compiled(config, factory_context_, true);
+
+  EXPECT_EQ(nullptr, compiled.route(genHeaders("bat.com", "/other", "GET"), 0));
+  EXPECT_EQ(nullptr, compiled.route(genPathlessHeaders("bat.com", "GET"), 0));
+}
+
+TEST_F(CompiledRouteMatchingTest, RouteCallbackVisitsCandidatesInOrder) {
+  TestConfigImpl compiled(routeConfig(true), factory_context_, true);
+  std::vector<std::string> visited;
+
+  RouteConstSharedPtr accepted_route = compiled.route(
+      [&visited](RouteConstSharedPtr route, RouteEvalStatus route_eval_status) -> RouteMatchStatus {
+        visited.push_back(route->routeEntry()->clusterName());
+        if (route->routeEntry()->clusterName() == "default") {
+          EXPECT_EQ(route_eval_status, RouteEvalStatus::NoMoreRoutes);
+        } else {
+          EXPECT_EQ(route_eval_status, RouteEvalStatus::HasMoreRoutes);
+        }
+        return RouteMatchStatus::Continue;
+      },
+      genHeaders("bat.com", "/api/v1/users/1", "GET"));
+  EXPECT_EQ(nullptr, accepted_route);
+  EXPECT_EQ((std::vector<std::string>{"users", "insensitive", "v1", "default"}), visited);
+
+  accepted_route = compiled.route(
+      [](RouteConstSharedPtr route, RouteEvalStatus) -> RouteMatchStatus {
+        return route->routeEntry()->clusterName() == "v1" ? RouteMatchStatus::Accept
+                                                          : RouteMatchStatus::Continue;
+      },
+      genHeaders("bat.com", "/api/v1/users/1", "GET"));
+  EXPECT_EQ("v1", accepted_route->routeEntry()->clusterName());
+}
+
+TEST_F(CompiledRouteMatchingTest, ConnectRoutes) {
+  const std::string yaml = R"EOF(
+name: foo
+compiled_route_matching: true
+virtual_hosts:
+  - name: bar
+    domains: ["*"]
+    routes:
+      - match: { connect_matcher: {} }
+        route:
+          cluster: connect
+      - match: { prefix: "/" }
+        route:
+          cluster: default
+)EOF";
+  TestConfigImpl compiled(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+
+  EXPECT_EQ("connect", compiled.route(genPathlessHeaders("bat.com", "CONNECT"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+  EXPECT_EQ("default",
+            compiled.route(genHeaders("bat.com", "/foo", "GET"), 0)->routeEntry()->clusterName());
+}
+
 } // namespace
 } // namespace Router
 } // namespace Envoy
@@ -0,0 +1,74 @@
+#include <string>
+
+#include "common/router/wildcard_domain_trie.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using Trie = WildcardDomainTrie<std::string>;
+
+std::string find(const Trie& trie, absl::string_view host) {
+  const std::string* value = trie.find(host);
+  return value == nullptr ? "<none>" : *value;
+}
+
+TEST(WildcardDomainTrieTest, Empty) {
+  Trie trie(Trie::Direction::Reverse);
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ("<none>", find(trie, "foo.com"));
+  EXPECT_EQ("<none>", find(trie, ""));
+}
+
+TEST(WildcardDomainTrieTest, SuffixLongestMatch) {
+  Trie trie(Trie::Direction::Reverse);
+  EXPECT_TRUE(trie.add(".baz.com", "dot"));
+  EXPECT_TRUE(trie.add("-bar.baz.com", "dash"));
+  EXPECT_TRUE(trie.add(".com", "com"));
+  EXPECT_FALSE(trie.empty());
+
+  EXPECT_EQ("dash", find(trie, "foo-bar.baz.com"));
+  EXPECT_EQ("dot", find(trie, "foo.baz.com"));
+  EXPECT_EQ("dot", find(trie, "a.b.baz.com"));
+  EXPECT_EQ("com", find(trie, "bar.com"));
+  EXPECT_EQ("<none>", find(trie, "bar.net"));
+}
+
+TEST(WildcardDomainTrieTest, WildcardMustMatchAtLeastOneCharacter) {
+  Trie trie(Trie::Direction::Reverse);
+  EXPECT_TRUE(trie.add(".foo.com", "foo"));
+  EXPECT_TRUE(trie.add(".com", "com"));
+
+  // "*.foo.com" does not match ".foo.com", but "*.com" does.
+  EXPECT_EQ("com", find(trie, ".foo.com"));
+  EXPECT_EQ("<none>", find(trie, ".com"));
+  EXPECT_EQ("foo", find(trie, "x.foo.com"));
+}
+
+TEST(WildcardDomainTrieTest, PrefixLongestMatch) {
+  Trie trie(Trie::Direction::Forward);
+  EXPECT_TRUE(trie.add("foo.", "foo"));
+  EXPECT_TRUE(trie.add("foo.bar.", "foo_bar"));
+
+  EXPECT_EQ("foo_bar", find(trie, "foo.bar.com"));
+  EXPECT_EQ("foo", find(trie, "foo.baz.com"));
+  EXPECT_EQ("<none>", find(trie, "foo."));
+  EXPECT_EQ("<none>", find(trie, "bar.foo.com"));
+}
+
+TEST(WildcardDomainTrieTest, Duplicates) {
+  Trie trie(Trie::Direction::Reverse);
+  EXPECT_TRUE(trie.add(".foo.com", "first"));
+  EXPECT_FALSE(trie.add(".foo.com", "second"));
+  EXPECT_EQ("first", find(trie, "a.foo.com"));
+
+  // Keys which are prefixes of each other are distinct.
+  EXPECT_TRUE(trie.add("o.com", "short"));
+  EXPECT_EQ("short", find(trie, "zoo.com"));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
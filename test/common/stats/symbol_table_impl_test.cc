@@ -266,7 +266,6 @@ TEST_P(StatNameTest, TestSuccessfulDecode) {
 class StatNameDeathTest : public StatNameTest {
 public:
   void decodeSymbolVec(const SymbolVec& symbol_vec) {
-    Thread::LockGuard lock(real_symbol_table_->lock_);
     for (Symbol symbol : symbol_vec) {
       real_symbol_table_->fromSymbol(symbol);
     }
@@ -577,21 +576,15 @@ TEST_P(StatNameTest, RacingSymbolCreation) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
+  // SymbolTableImpl finds existing symbols under reader locks, so these
+  // accesses don't contend with each other on the symbol table. The number
+  // of contentions is not checked, as the threads also contend on the
+  // mutexes they wait on.
   //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
+  // It is still better to avoid symbol-table lookups by refactoring all
+  // stat-creation code to symbolize all stat string elements at
   // construction, as composition does not require a lock.
   //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
-  //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
 
@@ -645,21 +638,15 @@ TEST_P(StatNameTest, MutexContentionOnExistingSymbols) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
+  // SymbolTableImpl finds existing symbols under reader locks, so these
+  // accesses don't contend with each other on the symbol table. The number
+  // of contentions is not checked, as the threads also contend on the
+  // mutexes they wait on.
   //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
+  // It is still better to avoid symbol-table lookups by refactoring all
+  // stat-creation code to symbolize all stat string elements at
   // construction, as composition does not require a lock.
   //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
-  //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
 
@@ -669,6 +656,35 @@ TEST_P(StatNameTest, MutexContentionOnExistingSymbols) {
   }
 }
 
+// Validates that symbols whose last reference is dropped while other threads
+// encode the same tokens are released and recreated consistently.
+TEST_P(StatNameTest, RacingSymbolFreeAndEncode) {
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  constexpr int num_threads = 8;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([this, i, &start]() {
+      start.wait();
+      for (int j = 0; j < 1000; ++j) {
+        // The first token is shared by all threads, and the last one by pairs of them.
+        const std::string name = absl::StrCat("cluster.upstream_rq_", j % 10, ".x", i / 2);
+        StatNameStorage storage(name, *table_);
+        StatNameStorage copy(storage.statName(), *table_);
+        EXPECT_EQ(name, table_->toString(copy.statName()));
+        storage.free(*table_);
+        copy.free(*table_);
+      }
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, table_->numSymbols());
+}
+
 TEST_P(StatNameTest, SharedStatNameStorageSetInsertAndFind) {
   StatNameStorageSet set;
   const int iters = 10;
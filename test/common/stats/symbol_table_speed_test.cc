@@ -3,6 +3,10 @@
 //
 // NOLINT(namespace-envoy)
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 #include "common/stats/isolated_store_impl.h"
@@ -12,6 +16,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -58,6 +63,97 @@ static void BM_CreateRace(benchmark::State& state) {
 }
 BENCHMARK(BM_CreateRace);
 
+// Runs fn(thread_index) on each of num_threads threads, and waits for them to finish.
+static void runThreads(uint32_t num_threads, const std::function<void(uint32_t)>& fn) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  std::vector<Envoy::Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    threads.push_back(thread_factory.createThread([&fn, t]() { fn(t); }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+}
+
+// Names of the shape of cluster stats, which share most of their tokens.
+static std::vector<std::string> makeNames(absl::string_view prefix) {
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    names.push_back(absl::StrCat(prefix, ".service_", i % 100, ".upstream_rq_", i / 100));
+  }
+  return names;
+}
+
+// Encoding and freeing names whose symbols all exist, from state.range(0)
+// threads, as when stats are looked up with dynamically built names.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_EncodeExistingContended(benchmark::State& state) {
+  const uint32_t num_threads = state.range(0);
+  Envoy::Stats::SymbolTableImpl table;
+  const std::vector<std::string> names = makeNames("cluster");
+  Envoy::Stats::StatNamePool pool(table);
+  for (const std::string& name : names) {
+    pool.add(name);
+  }
+
+  for (auto _ : state) {
+    runThreads(num_threads, [&names, &table](uint32_t) {
+      for (const std::string& name : names) {
+        Envoy::Stats::StatNameStorage storage(name, table);
+        storage.free(table);
+      }
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * names.size());
+}
+BENCHMARK(BM_EncodeExistingContended)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+// Encoding distinct new names from state.range(0) threads, each creating its
+// own symbols, and then freeing them, as when clusters are added and removed.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_EncodeNewContended(benchmark::State& state) {
+  const uint32_t num_threads = state.range(0);
+  Envoy::Stats::SymbolTableImpl table;
+  std::vector<std::vector<std::string>> names;
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    names.push_back(makeNames(absl::StrCat("cluster_", t)));
+  }
+
+  for (auto _ : state) {
+    runThreads(num_threads, [&names, &table](uint32_t t) {
+      Envoy::Stats::StatNamePool pool(table);
+      for (const std::string& name : names[t]) {
+        pool.add(name);
+      }
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * names[0].size());
+}
+BENCHMARK(BM_EncodeNewContended)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+// Decoding names from state.range(0) threads, as when stats are output.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_DecodeContended(benchmark::State& state) {
+  const uint32_t num_threads = state.range(0);
+  Envoy::Stats::SymbolTableImpl table;
+  Envoy::Stats::StatNamePool pool(table);
+  std::vector<Envoy::Stats::StatName> stat_names;
+  for (const std::string& name : makeNames("cluster")) {
+    stat_names.push_back(pool.add(name));
+  }
+
+  for (auto _ : state) {
+    runThreads(num_threads, [&stat_names, &table](uint32_t) {
+      for (Envoy::Stats::StatName stat_name : stat_names) {
+        benchmark::DoNotOptimize(table.toString(stat_name));
+      }
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * stat_names.size());
+}
+BENCHMARK(BM_DecodeContended)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_JoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
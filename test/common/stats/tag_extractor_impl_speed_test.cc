@@ -0,0 +1,83 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// NOLINT(namespace-envoy)
+
+#include <string>
+#include <vector>
+
+#include "envoy/config/metrics/v3/stats.pb.h"
+
+#include "common/common/utility.h"
+#include "common/stats/tag_extractor_impl.h"
+#include "common/stats/tag_producer_impl.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+// Stat names of the kinds created when a cluster, listener or route is added.
+static std::vector<std::string> makeStatNames() {
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < 100; ++i) {
+    const std::string cluster = absl::StrCat("cluster.service_", i, ".");
+    names.push_back(absl::StrCat(cluster, "upstream_cx_total"));
+    names.push_back(absl::StrCat(cluster, "upstream_rq_200"));
+    names.push_back(absl::StrCat(cluster, "upstream_rq_5xx"));
+    names.push_back(absl::StrCat(cluster, "circuit_breakers.default.rq_open"));
+    names.push_back(absl::StrCat(cluster, "grpc.helloworld.Greeter.SayHello.success"));
+    names.push_back(absl::StrCat("http.ingress_", i, ".downstream_rq_total"));
+    names.push_back(absl::StrCat("listener.127.0.0.1_", 10000 + i, ".http.ingress_", i,
+                                 ".downstream_rq_2xx"));
+    names.push_back(absl::StrCat("vhost.vhost_", i, ".vcluster.other.upstream_rq_retry"));
+  }
+  return names;
+}
+
+// Tag extraction from the stat names with the default tag extractors.
+static void BM_ProduceTagsDefault(benchmark::State& state) {
+  const Envoy::Stats::TagProducerImpl tag_producer{envoy::config::metrics::v3::StatsConfig()};
+  const std::vector<std::string> names = makeStatNames();
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      Envoy::Stats::TagVector tags;
+      benchmark::DoNotOptimize(tag_producer.produceTags(name, tags));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_ProduceTagsDefault);
+
+// Extraction of the cluster name with its former regex and its token pattern.
+template <class Extractor>
+static void extractClusterName(benchmark::State& state, Extractor& extractor) {
+  const std::vector<std::string> names = makeStatNames();
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      Envoy::Stats::TagVector tags;
+      Envoy::IntervalSetImpl<size_t> remove_characters;
+      benchmark::DoNotOptimize(extractor.extractTag(name, tags, remove_characters));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+
+static void BM_ExtractClusterNameRegex(benchmark::State& state) {
+  Envoy::Stats::TagExtractorImpl extractor("envoy.cluster_name", "^cluster\\.((.*?)\\.)");
+  extractClusterName(state, extractor);
+}
+BENCHMARK(BM_ExtractClusterNameRegex);
+
+static void BM_ExtractClusterNameTokens(benchmark::State& state) {
+  Envoy::Stats::TagExtractorTokensImpl extractor("envoy.cluster_name", "cluster.$.*.**");
+  extractClusterName(state, extractor);
+}
+BENCHMARK(BM_ExtractClusterNameTokens);
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
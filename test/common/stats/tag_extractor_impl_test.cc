@@ -41,6 +41,63 @@ TEST(TagExtractorTest, SingleSubexpression) {
   EXPECT_EQ("listner_port", tags.at(0).name_);
 }
 
+// Extracts a tag with a token pattern, returning the tag-extracted name, or "no match".
+std::string extractTokens(const std::string& tokens, const std::string& name, TagVector& tags) {
+  TagExtractorTokensImpl tag_extractor("tag", tokens);
+  IntervalSetImpl<size_t> remove_characters;
+  if (!tag_extractor.extractTag(name, tags, remove_characters)) {
+    return "no match";
+  }
+  return StringUtil::removeCharacters(name, remove_characters);
+}
+
+TEST(TagExtractorTest, Tokens) {
+  TagExtractorTokensImpl tag_extractor("cluster_name", "cluster.$.*.**");
+  EXPECT_EQ("cluster_name", tag_extractor.name());
+  EXPECT_EQ("cluster", tag_extractor.prefixToken());
+  EXPECT_EQ("", TagExtractorTokensImpl("tag", "**.cluster.$").prefixToken());
+
+  TagVector tags;
+  EXPECT_EQ("cluster.upstream_cx_total",
+            extractTokens("cluster.$.*.**", "cluster.test_cluster.upstream_cx_total", tags));
+  EXPECT_EQ("cluster.upstream_rq.total",
+            extractTokens("cluster.$.*.**", "cluster.test_cluster.upstream_rq.total", tags));
+  ASSERT_EQ(2, tags.size());
+  EXPECT_EQ("cluster_name", tags.at(0).name_);
+  EXPECT_EQ("test_cluster", tags.at(0).value_);
+  EXPECT_EQ("tag", tags.at(1).name_);
+  EXPECT_EQ("test_cluster", tags.at(1).value_);
+
+  // Every token of the name must be matched, "*" matching exactly one.
+  tags.clear();
+  EXPECT_EQ("no match", extractTokens("cluster.$.*.**", "cluster.test_cluster", tags));
+  EXPECT_EQ("no match", extractTokens("cluster.$.*", "cluster.test_cluster.a.b", tags));
+  EXPECT_EQ("no match", extractTokens("cluster.$.*.**", "listener.test_cluster.a", tags));
+  EXPECT_TRUE(tags.empty());
+
+  // "**" matches as few tokens as possible.
+  EXPECT_EQ("cluster.foo.grpc.grpc.method.success",
+            extractTokens("cluster.**.grpc.$.*.**", "cluster.foo.grpc.svc.grpc.method.success",
+                          tags));
+  ASSERT_EQ(1, tags.size());
+  EXPECT_EQ("svc", tags.at(0).value_);
+
+  // A value at the end of the name is removed with the preceding '.'.
+  tags.clear();
+  EXPECT_EQ("listener.ssl.cipher",
+            extractTokens("listener.**.cipher.$", "listener.ssl.cipher.AES256-SHA", tags));
+  ASSERT_EQ(1, tags.size());
+  EXPECT_EQ("AES256-SHA", tags.at(0).value_);
+
+  // Empty tokens are matched like any other.
+  tags.clear();
+  EXPECT_EQ("cluster.", extractTokens("cluster.$.*.**", "cluster.foo.", tags));
+  EXPECT_EQ("cluster.bar", extractTokens("cluster.$.*.**", "cluster..bar", tags));
+  ASSERT_EQ(2, tags.size());
+  EXPECT_EQ("foo", tags.at(0).value_);
+  EXPECT_EQ("", tags.at(1).value_);
+}
+
 TEST(TagExtractorTest, substrMismatch) {
   TagExtractorImpl tag_extractor("listner_port", "^listener\\.(\\d+?\\.)\\.foo\\.", ".foo.");
   EXPECT_TRUE(tag_extractor.substrMismatch("listener.80.downstream_cx_total"));
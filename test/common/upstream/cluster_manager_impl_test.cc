@@ -2274,6 +2274,64 @@ TEST_F(ClusterManagerImplTest, ConnPoolDestroyWithDraining) {
   factory_.tls_.shutdownThread();
 }
 
+// Test that the connection pool of a host added to a cluster with warm connections is created, and
+// asked to establish them, without waiting for a request.
+TEST_F(ClusterManagerImplTest, WarmConnPoolsOnMembershipUpdate) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STRICT_DNS
+      dns_resolvers:
+      - socket_address:
+          address: 1.2.3.4
+          port_value: 80
+      lb_policy: ROUND_ROBIN
+      prefetch_policy:
+        min_warm_connections: 2
+      load_assignment:
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: 127.0.0.1
+                    port_value: 11001
+  )EOF";
+
+  std::shared_ptr<Network::MockDnsResolver> dns_resolver(new Network::MockDnsResolver());
+  EXPECT_CALL(factory_.dispatcher_, createDnsResolver(_, _)).WillOnce(Return(dns_resolver));
+
+  Network::DnsResolver::ResolveCb dns_callback;
+  Event::MockTimer* dns_timer_ = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Network::MockActiveDnsQuery active_dns_query;
+  EXPECT_CALL(*dns_resolver, resolve(_, _, _))
+      .WillRepeatedly(DoAll(SaveArg<2>(&dns_callback), Return(&active_dns_query)));
+  create(parseBootstrapFromV2Yaml(yaml));
+  EXPECT_EQ(2, cluster_manager_->get("cluster_1")->info()->minWarmConnections());
+
+  // The new pool is asked to establish its connections by the pool map when it is created, and
+  // by the cluster for the membership update.
+  MockConnPoolWithDestroy* mock_cp = new MockConnPoolWithDestroy();
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _)).WillOnce(Return(mock_cp));
+  EXPECT_CALL(*mock_cp, maybePrefetch()).Times(2).WillRepeatedly(Return(true));
+  dns_callback(Network::DnsResolver::ResolutionStatus::Success,
+               TestUtility::makeDnsResponse({"127.0.0.2"}));
+
+  // Requests which do not depend on the downstream connection use the warm pool.
+  EXPECT_EQ(mock_cp, cluster_manager_->httpConnPoolForCluster(
+                         "cluster_1", ResourcePriority::Default, Http::Protocol::Http11, nullptr));
+
+  Http::ConnectionPool::Instance::DrainedCb drained_cb;
+  EXPECT_CALL(*mock_cp, addDrainedCallback(_)).WillOnce(SaveArg<0>(&drained_cb));
+  dns_timer_->invokeCallback();
+  dns_callback(Network::DnsResolver::ResolutionStatus::Success, TestUtility::makeDnsResponse({}));
+
+  EXPECT_CALL(*mock_cp, onDestroy()).WillOnce(Invoke(drained_cb));
+  factory_.tls_.shutdownThread();
+}
+
 TEST_F(ClusterManagerImplTest, OriginalDstInitialization) {
   const std::string yaml = R"EOF(
   {
@@ -15,6 +15,7 @@
 #include "gtest/gtest.h"
 
 using testing::AtLeast;
+using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
@@ -184,6 +185,31 @@ TEST_F(ConnPoolMapImplTest, CallbacksCachedAndPassedOnCreation) {
   cb2();
 }
 
+// Tests that a new pool is asked to establish its warm connections, after it is given the cached
+// drained callbacks.
+TEST_F(ConnPoolMapImplTest, NewPoolIsPrefetched) {
+  TestMapPtr test_map = makeTestMap();
+
+  test_map->getPool(1, [this]() {
+    auto pool = std::make_unique<NiceMock<Http::ConnectionPool::MockInstance>>();
+    EXPECT_CALL(*pool, maybePrefetch()).WillOnce(Return(true));
+    mock_pools_.push_back(pool.get());
+    return pool;
+  });
+  EXPECT_CALL(*mock_pools_[0], maybePrefetch()).Times(0);
+  test_map->getPool(1, getNeverCalledFactory());
+
+  test_map->addDrainedCallback([]() {});
+  test_map->getPool(2, [this]() {
+    auto pool = std::make_unique<NiceMock<Http::ConnectionPool::MockInstance>>();
+    InSequence s;
+    EXPECT_CALL(*pool, addDrainedCallback(_));
+    EXPECT_CALL(*pool, maybePrefetch()).WillOnce(Return(false));
+    mock_pools_.push_back(pool.get());
+    return pool;
+  });
+}
+
 // Tests that if we drain connections on an empty map, nothing happens.
 TEST_F(ConnPoolMapImplTest, EmptyMapDrainConnectionsNop) {
   TestMapPtr test_map = makeTestMap();
@@ -1,3 +1,6 @@
+#include <memory>
+#include <vector>
+
 #include "common/upstream/edf_scheduler.h"
 
 #include "gtest/gtest.h"
@@ -71,6 +74,93 @@ TEST(EdfSchedulerTest, Expired) {
   EXPECT_EQ(nullptr, sched.pick());
 }
 
+// Validate that pickAndAdd() behaves like pick() followed by add().
+TEST(EdfSchedulerTest, PickAndAdd) {
+  EdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  uint32_t pick_count[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i + 1, entries[i]);
+    pick_count[i] = 0;
+  }
+
+  for (uint32_t i = 0; i < (num_entries * (1 + num_entries)) / 2; ++i) {
+    auto p = sched.pickAndAdd([](const uint32_t& entry) { return entry + 1; });
+    ++pick_count[*p];
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_EQ(i + 1, pick_count[i]);
+  }
+  EXPECT_EQ(num_entries, sched.size());
+}
+
+// Validate that IndexedEdfScheduler picks in the same order as EdfScheduler when weights are
+// distinct.
+TEST(IndexedEdfSchedulerTest, Weighted) {
+  EdfScheduler<uint32_t> sched;
+  IndexedEdfScheduler<uint32_t> indexed_sched;
+  constexpr uint32_t num_entries = 128;
+  std::vector<std::shared_ptr<uint32_t>> entries;
+  uint32_t pick_count[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries.push_back(std::make_shared<uint32_t>(i));
+    sched.add(i + 1, entries[i]);
+    pick_count[i] = 0;
+  }
+  const auto calculate_weight = [](const uint32_t& entry) { return entry + 1; };
+  indexed_sched.update(entries, calculate_weight);
+  EXPECT_EQ(num_entries, indexed_sched.size());
+
+  for (uint32_t i = 0; i < (num_entries * (1 + num_entries)) / 2; ++i) {
+    const uint32_t index = indexed_sched.pickAndAdd(calculate_weight);
+    EXPECT_EQ(*sched.pickAndAdd(calculate_weight), *entries[index]);
+    ++pick_count[index];
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_EQ(i + 1, pick_count[i]);
+  }
+}
+
+// Validate that update() keeps the deadlines of retained entries, schedules new entries and drops
+// removed ones.
+TEST(IndexedEdfSchedulerTest, Update) {
+  IndexedEdfScheduler<uint32_t> sched;
+  EXPECT_TRUE(sched.empty());
+  std::vector<std::shared_ptr<uint32_t>> entries;
+  for (uint32_t i = 0; i < 4; ++i) {
+    entries.push_back(std::make_shared<uint32_t>(i));
+  }
+  const auto calculate_weight = [](const uint32_t& entry) { return entry + 1; };
+  sched.update(entries, calculate_weight);
+
+  // Deadlines 1, 1/2, 1/3, 1/4.
+  EXPECT_EQ(3, sched.pickAndAdd(calculate_weight));
+  EXPECT_EQ(2, sched.pickAndAdd(calculate_weight));
+
+  // Drop entry 3, add entry 4 at the front and reorder the rest. Entry 4 has deadline 1/3 + 1/5
+  // and entry 2 keeps its deadline of 2/3.
+  const std::vector<std::shared_ptr<uint32_t>> updated_entries{
+      std::make_shared<uint32_t>(4), entries[2], entries[1], entries[0]};
+  sched.update(updated_entries, calculate_weight);
+  EXPECT_EQ(4, sched.size());
+
+  EXPECT_EQ(2, sched.pickAndAdd(calculate_weight));  // entry 1, deadline 1/2
+  EXPECT_EQ(0, sched.pickAndAdd(calculate_weight));  // entry 4, deadline 8/15
+  EXPECT_EQ(1, sched.pickAndAdd(calculate_weight));  // entry 2, deadline 2/3
+  EXPECT_EQ(0, sched.pickAndAdd(calculate_weight));  // entry 4, deadline 11/15
+  EXPECT_EQ(0, sched.pickAndAdd(calculate_weight));  // entry 4, deadline 14/15
+  EXPECT_EQ(3, sched.pickAndAdd(calculate_weight));  // entry 0, deadline 1
+
+  sched.update({}, calculate_weight);
+  EXPECT_TRUE(sched.empty());
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
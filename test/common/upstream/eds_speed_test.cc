@@ -10,7 +10,9 @@
 
 #include "common/config/utility.h"
 #include "common/singleton/manager_impl.h"
+#include "common/upstream/cluster_manager_impl.h"
 #include "common/upstream/eds.h"
+#include "common/upstream/load_balancer_impl.h"
 
 #include "server/transport_socket_config_impl.h"
 
@@ -100,7 +102,71 @@ public:
     ASSERT(initialized_);
   }
 
+  // Set up an EDS cluster with num_hosts hosts whose updates are propagated to num_workers worker
+  // priority sets, each with a weighted round robin load balancer, the way the cluster manager
+  // propagates them to its thread local clusters.
+  void workerUpdateHelper(int num_hosts, int num_workers) {
+    resetCluster(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      eds_cluster_config:
+        service_name: fare
+        eds_config:
+          api_config_source:
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+    )EOF",
+                 Envoy::Upstream::Cluster::InitializePhase::Secondary);
+
+    for (int i = 0; i < num_workers; ++i) {
+      worker_priority_sets_.push_back(std::make_unique<PrioritySetImpl>());
+      worker_lbs_.push_back(std::make_unique<RoundRobinLoadBalancer>(
+          *worker_priority_sets_.back(), nullptr, cluster_->info()->stats(), runtime_, random_,
+          common_config_));
+    }
+    cluster_->prioritySet().addPriorityUpdateCb(
+        [this](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
+          const auto update = std::make_shared<const ThreadLocalClusterUpdate>(
+              *cluster_->prioritySet().hostSetsPerPriority()[priority], hosts_added,
+              hosts_removed);
+          for (auto& priority_set : worker_priority_sets_) {
+            update->applyTo(*priority_set);
+          }
+        });
+
+    num_hosts_ = num_hosts;
+    validation_visitor_.setSkipValidation(true);
+    initialize();
+    sendWorkerUpdate(0);
+    ASSERT(initialized_);
+  }
+
+  // Deliver an EDS update in which the first num_replaced hosts have been replaced.
+  void sendWorkerUpdate(int num_replaced) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+    cluster_load_assignment.set_cluster_name("fare");
+    auto* endpoints = cluster_load_assignment.add_endpoints();
+    for (int i = 0; i < num_hosts_; ++i) {
+      auto* lb_endpoint = endpoints->add_lb_endpoints();
+      auto* socket_address =
+          lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
+      socket_address->set_address((i < num_replaced ? "10.0.2." : "10.0.1.") +
+                                  std::to_string(i / 60000));
+      socket_address->set_port_value((1000 + i) % 60000);
+      lb_endpoint->mutable_load_balancing_weight()->set_value(1 + i % 2);
+    }
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+    resources.Add()->PackFrom(cluster_load_assignment);
+    eds_callbacks_->onConfigUpdate(resources, "");
+  }
+
   bool initialized_{};
+  int num_hosts_{};
+  std::vector<std::unique_ptr<PrioritySetImpl>> worker_priority_sets_;
+  std::vector<std::unique_ptr<RoundRobinLoadBalancer>> worker_lbs_;
+  envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
   Stats::IsolatedStoreImpl stats_;
   Ssl::MockContextManager ssl_context_manager_;
   envoy::config::cluster::v3::Cluster eds_cluster_;
@@ -132,3 +198,22 @@ static void priorityAndLocalityWeighted(benchmark::State& state) {
 }
 
 BENCHMARK(priorityAndLocalityWeighted)->Ranges({{false, true}, {2000, 100000}});
+
+// Measures the cost of an EDS update which replaces one percent of the hosts, including
+// propagating it to each worker's priority set and load balancer.
+static void workerUpdate(benchmark::State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  std::unique_ptr<Envoy::Upstream::EdsSpeedTest> speed_test;
+  for (auto _ : state) {
+    // Do not time setting up, or tearing down the previous iteration's, cluster and workers.
+    state.PauseTiming();
+    speed_test = std::make_unique<Envoy::Upstream::EdsSpeedTest>();
+    speed_test->workerUpdateHelper(state.range(0), state.range(1));
+    state.ResumeTiming();
+    speed_test->sendWorkerUpdate(state.range(0) / 100);
+  }
+}
+
+BENCHMARK(workerUpdate)->Ranges({{2000, 100000}, {1, 64}})->Unit(benchmark::kMillisecond);
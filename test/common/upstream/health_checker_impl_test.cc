@@ -3108,6 +3108,25 @@ public:
         HealthCheckEventLoggerPtr(event_logger_));
   }
 
+  void setupDataWithTimerWheel() {
+    std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    timer_wheel_granularity: 0.1s
+    tcp_health_check:
+      send:
+        text: "01"
+      receive:
+      - text: "02"
+    )EOF";
+
+    health_checker_ = std::make_shared<TcpHealthCheckerImpl>(
+        *cluster_, parseHealthCheckFromV2Yaml(yaml), dispatcher_, runtime_, random_,
+        HealthCheckEventLoggerPtr(event_logger_));
+  }
+
   void setupDataDontReuseConnection() {
     std::string yaml = R"EOF(
     timeout: 1s
@@ -3173,6 +3192,44 @@ TEST_F(TcpHealthCheckerImplTest, Success) {
   read_filter_->onData(response, false);
 }
 
+// With a timer wheel the session timers are driven by a single dispatcher timer.
+TEST_F(TcpHealthCheckerImplTest, TimerWheel) {
+  Event::SimulatedTimeSystem time_system;
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
+  Event::MockTimer* tick_timer = new Event::MockTimer(&dispatcher_);
+  setupDataWithTimerWheel();
+  cluster_->info_->stats().upstream_cx_total_.inc();
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  expectClientCreate();
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*tick_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  health_checker_->start();
+
+  // The interval timer expires in the same tick the timeout timer did.
+  connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  Buffer::OwnedImpl response;
+  add_uint8(response, 2);
+  read_filter_->onData(response, false);
+  EXPECT_TRUE(tick_timer->enabled_);
+
+  time_system.advanceTimeAsync(std::chrono::milliseconds(999));
+  EXPECT_CALL(*connection_, write(_, _)).Times(0);
+  EXPECT_CALL(*tick_timer, enableTimer(std::chrono::milliseconds(1), _));
+  tick_timer->invokeCallback();
+
+  time_system.advanceTimeAsync(std::chrono::milliseconds(1));
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*tick_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  tick_timer->invokeCallback();
+
+  time_system.advanceTimeAsync(std::chrono::milliseconds(1000));
+  EXPECT_CALL(*connection_, close(_));
+  EXPECT_CALL(*tick_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  tick_timer->invokeCallback();
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.failure").value());
+}
+
 // Tests that a successful healthcheck will disconnect the client when reuse_connection is false.
 TEST_F(TcpHealthCheckerImplTest, DataWithoutReusingConnection) {
   InSequence s;
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <vector>
+
+#include "common/upstream/host_bitmap.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+std::vector<uint32_t> multiplesOf(uint32_t step, uint32_t size) {
+  std::vector<uint32_t> indices;
+  for (uint32_t i = 0; i < size; i += step) {
+    indices.push_back(i);
+  }
+  return indices;
+}
+
+TEST(HostBitmapTest, Empty) {
+  HostBitmap bitmap;
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_EQ(0, bitmap.cardinality());
+  EXPECT_FALSE(bitmap.contains(0));
+  EXPECT_TRUE(bitmap.indices().empty());
+  EXPECT_TRUE(bitmap.intersect(HostBitmap({1, 2}, 3)).empty());
+  EXPECT_TRUE(HostBitmap({1, 2}, 3).intersect(bitmap).empty());
+}
+
+// Sets holding fewer than 1/32 of the hosts are stored as arrays.
+TEST(HostBitmapTest, Representation) {
+  EXPECT_FALSE(HostBitmap(multiplesOf(64, 1000), 1000).dense());
+  EXPECT_TRUE(HostBitmap(multiplesOf(16, 1000), 1000).dense());
+  EXPECT_TRUE(HostBitmap({0}, 10).dense());
+}
+
+TEST(HostBitmapTest, Contains) {
+  for (const uint32_t step : {1, 3, 16, 64, 100}) {
+    const std::vector<uint32_t> expected = multiplesOf(step, 1000);
+    HostBitmap bitmap(multiplesOf(step, 1000), 1000);
+    EXPECT_EQ(expected.size(), bitmap.cardinality());
+    EXPECT_EQ(expected, bitmap.indices());
+    for (uint32_t i = 0; i < 1000; ++i) {
+      EXPECT_EQ(i % step == 0, bitmap.contains(i));
+    }
+    EXPECT_FALSE(bitmap.contains(1000));
+  }
+}
+
+TEST(HostBitmapTest, Intersect) {
+  const std::vector<uint32_t> steps{1, 2, 3, 16, 64, 100, 999};
+  for (const uint32_t a : steps) {
+    for (const uint32_t b : steps) {
+      const HostBitmap intersection =
+          HostBitmap(multiplesOf(a, 2000), 2000).intersect(HostBitmap(multiplesOf(b, 2000), 2000));
+      std::vector<uint32_t> expected;
+      const std::vector<uint32_t> multiples_of_a = multiplesOf(a, 2000);
+      const std::vector<uint32_t> multiples_of_b = multiplesOf(b, 2000);
+      std::set_intersection(multiples_of_a.begin(), multiples_of_a.end(), multiples_of_b.begin(),
+                            multiples_of_b.end(), std::back_inserter(expected));
+      EXPECT_EQ(expected, intersection.indices()) << a << " " << b;
+      EXPECT_EQ(expected.size(), intersection.cardinality());
+    }
+  }
+}
+
+// A sparse intersection of two dense bitmaps is stored as an array.
+TEST(HostBitmapTest, IntersectShrinksToArray) {
+  const HostBitmap even(multiplesOf(2, 1024), 1024);
+  std::vector<uint32_t> odd_and_zero{0};
+  for (uint32_t i = 1; i < 1024; i += 2) {
+    odd_and_zero.push_back(i);
+  }
+  const HostBitmap intersection = even.intersect(HostBitmap(std::move(odd_and_zero), 1024));
+  EXPECT_FALSE(intersection.dense());
+  EXPECT_EQ(std::vector<uint32_t>{0}, intersection.indices());
+  EXPECT_TRUE(even.intersect(HostBitmap(multiplesOf(1, 1024), 1024)).dense());
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
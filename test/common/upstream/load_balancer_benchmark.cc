@@ -1,5 +1,7 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -124,6 +126,52 @@ BENCHMARK(BM_RoundRobinLoadBalancerBuild)
     ->Args({50000, 100, 50})
     ->Unit(benchmark::kMillisecond);
 
+void BM_RoundRobinLoadBalancerChurn(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t churn_percent = state.range(1);
+  RoundRobinTester tester(num_hosts, 50, 50);
+  tester.initialize();
+
+  // Each update swaps num_churned hosts, spread evenly across the host set, with hosts from a
+  // replacement pool, as an EDS update with a small amount of endpoint churn would.
+  const uint64_t num_churned = std::max<uint64_t>(1, num_hosts * churn_percent / 100);
+  HostVector current_hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  HostVector replacement_hosts;
+  for (uint64_t i = 0; i < num_churned; i++) {
+    replacement_hosts.push_back(makeTestHost(
+        tester.info_, fmt::format("tcp://10.1.{}.{}:6379", i / 256, i % 256), 1 + i % 50));
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    HostVector hosts_added;
+    HostVector hosts_removed;
+    for (uint64_t i = 0; i < num_churned; i++) {
+      const uint64_t index = i * (num_hosts / num_churned);
+      hosts_removed.push_back(current_hosts[index]);
+      hosts_added.push_back(replacement_hosts[i]);
+      std::swap(current_hosts[index], replacement_hosts[i]);
+    }
+    HostVectorConstSharedPtr updated_hosts = std::make_shared<HostVector>(current_hosts);
+    HostsPerLocalityConstSharedPtr hosts_per_locality = makeHostsPerLocality({current_hosts});
+    auto update_hosts_params = HostSetImpl::partitionHosts(updated_hosts, hosts_per_locality);
+
+    // We are only interested in timing the host set update, which includes the load balancer
+    // refresh.
+    state.ResumeTiming();
+    tester.priority_set_.updateHosts(0, std::move(update_hosts_params), {}, hosts_added,
+                                     hosts_removed, absl::nullopt);
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerChurn)
+    ->Args({500, 1})
+    ->Args({500, 10})
+    ->Args({5000, 1})
+    ->Args({5000, 10})
+    ->Args({25000, 1})
+    ->Args({25000, 10})
+    ->Unit(benchmark::kMillisecond);
+
 class RingHashTester : public BaseTester {
 public:
   RingHashTester(uint64_t num_hosts, uint64_t min_ring_size) : BaseTester(num_hosts) {
@@ -139,12 +187,16 @@ public:
 
 class MaglevTester : public BaseTester {
 public:
-  MaglevTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0)
+  MaglevTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0,
+               uint64_t table_size = MaglevTable::DefaultTableSize)
       : BaseTester(num_hosts, weighted_subset_percent, weight) {
+    config_ = envoy::config::cluster::v3::Cluster::MaglevLbConfig();
+    config_.value().mutable_table_size()->set_value(table_size);
     maglev_lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                                      random_, common_config_);
+                                                      random_, config_, common_config_);
   }
 
+  absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig> config_;
   std::unique_ptr<MaglevLoadBalancer> maglev_lb_;
 };
 
@@ -181,11 +233,46 @@ BENCHMARK(BM_RingHashLoadBalancerBuildRing)
     ->Args({500, 256000})
     ->Unit(benchmark::kMillisecond);
 
+void BM_RingHashLoadBalancerRebuildRing(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t min_ring_size = state.range(1);
+  RingHashTester tester(num_hosts, min_ring_size);
+  tester.ring_hash_lb_->initialize();
+
+  // Each update replaces a single host, so all other hosts keep their hashes.
+  HostVector current_hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  HostSharedPtr replacement_host = makeTestHost(tester.info_, "tcp://10.1.0.0:6379");
+  uint64_t index = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    const HostVector hosts_added{replacement_host};
+    const HostVector hosts_removed{current_hosts[index]};
+    std::swap(current_hosts[index], replacement_host);
+    index = (index + 1) % num_hosts;
+    HostVectorConstSharedPtr updated_hosts = std::make_shared<HostVector>(current_hosts);
+    HostsPerLocalityConstSharedPtr hosts_per_locality = makeHostsPerLocality({current_hosts});
+    auto update_hosts_params = HostSetImpl::partitionHosts(updated_hosts, hosts_per_locality);
+
+    // We are only interested in timing the host set update, which includes the ring rebuild.
+    state.ResumeTiming();
+    tester.priority_set_.updateHosts(0, std::move(update_hosts_params), {}, hosts_added,
+                                     hosts_removed, absl::nullopt);
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerRebuildRing)
+    ->Args({100, 65536})
+    ->Args({500, 65536})
+    ->Args({100, 1048576})
+    ->Args({500, 1048576})
+    ->Unit(benchmark::kMillisecond);
+
 void BM_MaglevLoadBalancerBuildTable(benchmark::State& state) {
   for (auto _ : state) {
     state.PauseTiming();
     const uint64_t num_hosts = state.range(0);
-    MaglevTester tester(num_hosts);
+    const uint64_t table_size = state.range(1);
+    MaglevTester tester(num_hosts, 0, 0, table_size);
 
     const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
 
@@ -200,9 +287,12 @@ void BM_MaglevLoadBalancerBuildTable(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_MaglevLoadBalancerBuildTable)
-    ->Arg(100)
-    ->Arg(200)
-    ->Arg(500)
+    ->Args({100, 65537})
+    ->Args({200, 65537})
+    ->Args({500, 65537})
+    ->Args({100, 1000003})
+    ->Args({500, 1000003})
+    ->Args({10000, 1000003})
     ->Unit(benchmark::kMillisecond);
 
 class TestLoadBalancerContext : public LoadBalancerContextBase {
@@ -263,6 +353,23 @@ BENCHMARK(BM_LeastRequestLoadBalancerChooseHost)
     ->Args({100, 100, 1000000})
     ->Unit(benchmark::kMillisecond);
 
+void BM_RoundRobinLoadBalancerChooseHost(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t weighted_subset_percent = state.range(1);
+  const uint64_t weight = state.range(2);
+  RoundRobinTester tester(num_hosts, weighted_subset_percent, weight);
+  tester.initialize();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.lb_->chooseHost(nullptr));
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerChooseHost)
+    ->Args({100, 0, 1})
+    ->Args({100, 50, 50})
+    ->Args({10000, 0, 1})
+    ->Args({10000, 50, 50});
+
 void BM_RingHashLoadBalancerChooseHost(benchmark::State& state) {
   for (auto _ : state) {
     // Do not time the creation of the ring.
@@ -335,6 +442,105 @@ BENCHMARK(BM_MaglevLoadBalancerChooseHost)
     ->Args({500, 100000})
     ->Unit(benchmark::kMillisecond);
 
+envoy::config::cluster::v3::Cluster::CommonLbConfig
+boundedLoadCommonConfig(uint32_t hash_balance_factor) {
+  envoy::config::cluster::v3::Cluster::CommonLbConfig common_config;
+  if (hash_balance_factor > 0) {
+    common_config.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+        hash_balance_factor);
+  }
+  return common_config;
+}
+
+// Chooses hosts for keys_to_simulate requests, hot_key_percent of which use the same hash key as a
+// hot key in a cache would. Each request stays active until num_hosts * 10 later requests have been
+// placed, so that the active request gauges used by bounded loads reflect recent traffic.
+void simulateHotKeyRequests(benchmark::State& state, BaseTester& tester,
+                            ThreadAwareLoadBalancer& thread_aware_lb, uint64_t num_hosts,
+                            uint64_t hot_key_percent, uint64_t keys_to_simulate) {
+  thread_aware_lb.initialize();
+  LoadBalancerPtr lb = thread_aware_lb.factory()->create();
+  std::unordered_map<std::string, uint64_t> hit_counter;
+  std::deque<HostConstSharedPtr> active_requests;
+  TestLoadBalancerContext context;
+  state.ResumeTiming();
+
+  for (uint64_t i = 0; i < keys_to_simulate; i++) {
+    context.hash_key_ = hashInt(i % 100 < hot_key_percent ? 0 : i);
+    HostConstSharedPtr host = lb->chooseHost(&context);
+    host->stats().rq_active_.inc();
+    tester.info_->stats_.upstream_rq_active_.inc();
+    active_requests.push_back(host);
+    if (active_requests.size() > num_hosts * 10) {
+      active_requests.front()->stats().rq_active_.dec();
+      tester.info_->stats_.upstream_rq_active_.dec();
+      active_requests.pop_front();
+    }
+    hit_counter[host->address()->asString()] += 1;
+  }
+
+  // Do not time computation of mean, standard deviation, and relative standard deviation.
+  state.PauseTiming();
+  computeHitStats(state, hit_counter);
+  uint64_t max_hits = 0;
+  for (const auto& pair : hit_counter) {
+    max_hits = std::max(max_hits, pair.second);
+  }
+  state.counters["max_hits"] = max_hits;
+  for (const auto& host : active_requests) {
+    host->stats().rq_active_.dec();
+    tester.info_->stats_.upstream_rq_active_.dec();
+  }
+}
+
+void BM_RingHashLoadBalancerHotKey(benchmark::State& state) {
+  for (auto _ : state) {
+    // Do not time the creation of the ring.
+    state.PauseTiming();
+    const uint64_t num_hosts = state.range(0);
+    const uint64_t hot_key_percent = state.range(1);
+    const uint64_t hash_balance_factor = state.range(2);
+    RingHashTester tester(num_hosts, 65536);
+    RingHashLoadBalancer ring_hash_lb(tester.priority_set_, tester.stats_, tester.stats_store_,
+                                      tester.runtime_, tester.random_, tester.config_,
+                                      boundedLoadCommonConfig(hash_balance_factor));
+    simulateHotKeyRequests(state, tester, ring_hash_lb, num_hosts, hot_key_percent, 100000);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerHotKey)
+    ->Args({100, 0, 0})
+    ->Args({100, 0, 125})
+    ->Args({100, 10, 0})
+    ->Args({100, 10, 125})
+    ->Args({100, 10, 200})
+    ->Args({100, 50, 125})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_MaglevLoadBalancerHotKey(benchmark::State& state) {
+  for (auto _ : state) {
+    // Do not time the creation of the table.
+    state.PauseTiming();
+    const uint64_t num_hosts = state.range(0);
+    const uint64_t hot_key_percent = state.range(1);
+    const uint64_t hash_balance_factor = state.range(2);
+    MaglevTester tester(num_hosts);
+    MaglevLoadBalancer maglev_lb(tester.priority_set_, tester.stats_, tester.stats_store_,
+                                 tester.runtime_, tester.random_, tester.config_,
+                                 boundedLoadCommonConfig(hash_balance_factor));
+    simulateHotKeyRequests(state, tester, maglev_lb, num_hosts, hot_key_percent, 100000);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerHotKey)
+    ->Args({100, 0, 0})
+    ->Args({100, 0, 125})
+    ->Args({100, 10, 0})
+    ->Args({100, 10, 125})
+    ->Args({100, 10, 200})
+    ->Args({100, 50, 125})
+    ->Unit(benchmark::kMillisecond);
+
 void BM_RingHashLoadBalancerHostLoss(benchmark::State& state) {
   for (auto _ : state) {
     const uint64_t num_hosts = state.range(0);
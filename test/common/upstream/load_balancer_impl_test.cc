@@ -1,3 +1,4 @@
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -861,22 +862,23 @@ TEST_P(RoundRobinLoadBalancerTest, Weighted) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
-  // Add a host, it should participate in next round of scheduling.
+  // Add a host, it should participate in next round of scheduling. The existing hosts keep their
+  // place in the schedule.
   hostSet().healthy_hosts_.push_back(makeTestHost(info_, "tcp://127.0.0.1:82", 3));
   hostSet().hosts_.push_back(hostSet().healthy_hosts_.back());
   hostSet().runCallbacks({hostSet().healthy_hosts_.back()}, {});
   EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
   // Remove last two hosts, add a new one with different weights.
   HostVector removed_hosts = {hostSet().hosts_[1], hostSet().hosts_[2]};
   hostSet().healthy_hosts_.pop_back();
@@ -899,6 +901,39 @@ TEST_P(RoundRobinLoadBalancerTest, Weighted) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Validate that hosts leaving and rejoining the healthy host set are removed from and added back to
+// the weighted schedule without disturbing the remaining hosts.
+TEST_P(RoundRobinLoadBalancerTest, WeightedHealthChange) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2),
+                              makeTestHost(info_, "tcp://127.0.0.1:82", 3)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_->chooseHost(nullptr));
+
+  // hosts_[2] becomes unhealthy and is no longer picked, the others are picked 1:2.
+  hostSet().healthy_hosts_.pop_back();
+  hostSet().runCallbacks({}, {});
+  std::map<HostConstSharedPtr, uint32_t> pick_count;
+  for (uint32_t i = 0; i < 30; ++i) {
+    ++pick_count[lb_->chooseHost(nullptr)];
+  }
+  EXPECT_EQ(0, pick_count[hostSet().hosts_[2]]);
+  EXPECT_EQ(10, pick_count[hostSet().hosts_[0]]);
+  EXPECT_EQ(20, pick_count[hostSet().hosts_[1]]);
+
+  // hosts_[2] becomes healthy again and is picked in proportion to its weight.
+  hostSet().healthy_hosts_.push_back(hostSet().hosts_[2]);
+  hostSet().runCallbacks({}, {});
+  pick_count.clear();
+  for (uint32_t i = 0; i < 60; ++i) {
+    ++pick_count[lb_->chooseHost(nullptr)];
+  }
+  EXPECT_EQ(10, pick_count[hostSet().hosts_[0]]);
+  EXPECT_EQ(20, pick_count[hostSet().hosts_[1]]);
+  EXPECT_EQ(30, pick_count[hostSet().hosts_[2]]);
+}
+
 // Validate that the RNG seed influences pick order when weighted RR.
 TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
@@ -1607,6 +1642,20 @@ TEST(LoadBalancerSubsetInfoImplTest, DefaultConfigIsDiabled) {
               envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK);
   EXPECT_EQ(subset_info.defaultSubset().fields_size(), 0);
   EXPECT_EQ(subset_info.subsetSelectors().size(), 0);
+  EXPECT_FALSE(subset_info.bitmapIndex());
+}
+
+TEST(LoadBalancerSubsetInfoImplTest, BitmapIndex) {
+  auto subset_config = envoy::config::cluster::v3::Cluster::LbSubsetConfig::default_instance();
+  subset_config.mutable_subset_selectors()->Add()->add_keys("key");
+  subset_config.mutable_bitmap_index();
+
+  auto subset_info = LoadBalancerSubsetInfoImpl(subset_config);
+  EXPECT_TRUE(subset_info.bitmapIndex());
+  EXPECT_EQ(64, subset_info.bitmapIndexMaxCachedSubsets());
+
+  subset_config.mutable_bitmap_index()->mutable_max_cached_subsets()->set_value(8);
+  EXPECT_EQ(8, LoadBalancerSubsetInfoImpl(subset_config).bitmapIndexMaxCachedSubsets());
 }
 
 TEST(LoadBalancerSubsetInfoImplTest, SubsetConfig) {
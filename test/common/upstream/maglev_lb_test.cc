@@ -1,4 +1,7 @@
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
 
@@ -6,6 +9,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -40,9 +44,11 @@ class MaglevLoadBalancerTest : public testing::Test {
 public:
   MaglevLoadBalancerTest() : stats_(ClusterInfoImpl::generateStats(stats_store_)) {}
 
-  void init(uint32_t table_size) {
+  void init(uint64_t table_size) {
+    config_ = envoy::config::cluster::v3::Cluster::MaglevLbConfig();
+    config_.value().mutable_table_size()->set_value(table_size);
     lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                               random_, common_config_, table_size);
+                                               random_, config_, common_config_);
     lb_->initialize();
   }
 
@@ -51,6 +57,7 @@ public:
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
   Stats::IsolatedStoreImpl stats_store_;
   ClusterStats stats_;
+  absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig> config_;
   envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Runtime::MockRandomGenerator> random_;
@@ -63,6 +70,20 @@ TEST_F(MaglevLoadBalancerTest, NoHost) {
   EXPECT_EQ(nullptr, lb_->factory()->create()->chooseHost(nullptr));
 };
 
+// Without a configured table size, the default table size is used.
+TEST_F(MaglevLoadBalancerTest, DefaultTableSize) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90"),
+                      makeTestHost(info_, "tcp://127.0.0.1:91")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
+                                             random_, absl::nullopt, common_config_);
+  lb_->initialize();
+
+  EXPECT_EQ(MaglevTable::DefaultTableSize / 2, lb_->stats().min_entries_per_host_.value());
+  EXPECT_EQ(MaglevTable::DefaultTableSize / 2 + 1, lb_->stats().max_entries_per_host_.value());
+}
+
 // Basic sanity tests.
 TEST_F(MaglevLoadBalancerTest, Basic) {
   host_set_.hosts_ = {
@@ -178,6 +199,83 @@ TEST_F(MaglevLoadBalancerTest, BasicWithRetryHostPredicate) {
   }
 }
 
+// With bounded loads, a host over its bound is skipped in favor of the host a retry would choose.
+TEST_F(MaglevLoadBalancerTest, BoundedLoad) {
+  host_set_.hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      150);
+  init(7);
+
+  // Same table as the Basic test. For hash 0, the table slots of attempts 0 to 5 are 0, 1, 0, 6,
+  // 5 and 4, i.e. hosts :92, :94, :92, :93, :90 and :95. Host :91 is never tried.
+
+  // With 12 active requests, each host may have ceil(13 * 1.5 / 6) = 4, counting the request being
+  // placed.
+  info_->stats_.upstream_rq_active_.set(12);
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  EXPECT_EQ(host_set_.hosts_[2], lb->chooseHost(&context));
+
+  host_set_.hosts_[2]->stats().rq_active_.set(4);
+  host_set_.hosts_[4]->stats().rq_active_.set(3);
+  EXPECT_EQ(host_set_.hosts_[4], lb->chooseHost(&context));
+
+  // The third attempt rehashes back to :92, which is still over its bound.
+  host_set_.hosts_[4]->stats().rq_active_.set(4);
+  EXPECT_EQ(host_set_.hosts_[3], lb->chooseHost(&context));
+
+  // If every host tried is over its bound, the least loaded one of them is chosen.
+  for (const auto& host : host_set_.hosts_) {
+    host->stats().rq_active_.set(10);
+  }
+  host_set_.hosts_[0]->stats().rq_active_.set(6);
+  host_set_.hosts_[1]->stats().rq_active_.set(5);
+  EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+}
+
+// With bounded loads and weighted hosts, each host is bounded by its weighted share of the active
+// requests, and the fallback when all hosts are over their bounds compares relative loads.
+TEST_F(MaglevLoadBalancerTest, BoundedLoadWeighted) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:91", 2)};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      200);
+  init(17);
+
+  // Same table as the Weighted test. For hash 1, attempt 0 uses slot 1, i.e. host :90, and attempt
+  // 1 uses slot 16, i.e. host :91.
+
+  // With 10 active requests, :90 may have ceil(11 * 2 / 3) = 8 and :91 ceil(11 * 2 * 2 / 3) = 15,
+  // counting the request being placed.
+  info_->stats_.upstream_rq_active_.set(10);
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(1);
+  host_set_.hosts_[0]->stats().rq_active_.set(7);
+  host_set_.hosts_[1]->stats().rq_active_.set(10);
+  EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+
+  // :90 is at its bound, so the request goes to :91, which has more active requests but is still
+  // under its larger bound.
+  host_set_.hosts_[0]->stats().rq_active_.set(8);
+  EXPECT_EQ(host_set_.hosts_[1], lb->chooseHost(&context));
+
+  // Both hosts are over their bounds. :91 is chosen since it is less overloaded relative to its
+  // bound, with 16 / 15 against 9 / 8, even though it has more active requests.
+  host_set_.hosts_[1]->stats().rq_active_.set(15);
+  EXPECT_EQ(host_set_.hosts_[1], lb->chooseHost(&context));
+
+  // With 18 / 15 for :91, :90 is the least overloaded.
+  host_set_.hosts_[1]->stats().rq_active_.set(17);
+  EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+}
+
 // Weighted sanity test.
 TEST_F(MaglevLoadBalancerTest, Weighted) {
   host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
@@ -398,6 +496,60 @@ TEST_F(MaglevLoadBalancerTest, LocalityWeightedLopsided) {
   EXPECT_EQ(MaglevTable::DefaultTableSize - 1023, counts[0]);
 }
 
+// Table sizes well beyond the default are supported.
+TEST_F(MaglevLoadBalancerTest, LargeTable) {
+  host_set_.hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  init(1000003);
+
+  EXPECT_EQ(1000003 / 6, lb_->stats().min_entries_per_host_.value());
+  EXPECT_EQ(1000003 / 6 + 1, lb_->stats().max_entries_per_host_.value());
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  std::vector<uint32_t> counts(host_set_.hosts_.size());
+  for (uint32_t i = 0; i < 1000003; ++i) {
+    TestLoadBalancerContext context(i);
+    ++counts[lb->chooseHost(&context)->address()->ip()->port() - 90];
+  }
+  for (uint32_t count : counts) {
+    EXPECT_LE(1000003 / 6, count);
+    EXPECT_GE(1000003 / 6 + 1, count);
+  }
+}
+
+// With more hosts than fit in a 16-bit index, every host is still reachable through the table.
+TEST_F(MaglevLoadBalancerTest, ManyHosts) {
+  const uint32_t num_hosts = 70000;
+  const uint64_t table_size = 70001;
+  host_set_.hosts_.clear();
+  std::unordered_map<std::string, uint32_t> host_index;
+  for (uint32_t i = 0; i < num_hosts; ++i) {
+    const std::string address = fmt::format("10.{}.{}.{}:90", i >> 16, (i >> 8) & 0xff, i & 0xff);
+    host_set_.hosts_.push_back(makeTestHost(info_, "tcp://" + address));
+    host_index[address] = i;
+  }
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  init(table_size);
+
+  EXPECT_EQ(1, lb_->stats().min_entries_per_host_.value());
+  EXPECT_EQ(2, lb_->stats().max_entries_per_host_.value());
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  std::vector<uint32_t> counts(num_hosts);
+  for (uint32_t i = 0; i < table_size; ++i) {
+    TestLoadBalancerContext context(i);
+    ++counts[host_index.at(lb->chooseHost(&context)->address()->asString())];
+  }
+  for (uint32_t count : counts) {
+    EXPECT_LE(1, count);
+  }
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -1,6 +1,8 @@
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -26,6 +28,7 @@
 
 using testing::_;
 using testing::NiceMock;
+using testing::Property;
 using testing::Return;
 using testing::ReturnRef;
 using testing::SaveArg;
@@ -784,6 +787,21 @@ TEST_F(OutlierDetectorImplTest, BasicFlowNonHttpCodesExternalOrigin) {
   EXPECT_EQ(1UL, outlier_detection_ejections_active_.value());
 }
 
+// Each detection pass records how long it took.
+TEST_F(OutlierDetectorImplTest, DetectionPassDuration) {
+  EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
+  addHosts({"tcp://127.0.0.1:80"});
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000), _));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, empty_outlier_detection_, dispatcher_, runtime_, time_system_, event_logger_));
+
+  EXPECT_CALL(cluster_.info_->stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "outlier_detection.detection_pass_duration"), 0));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000), _));
+  interval_timer_->invokeCallback();
+}
+
 TEST_F(OutlierDetectorImplTest, BasicFlowSuccessRateExternalOrigin) {
   EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
   addHosts({
@@ -1564,11 +1582,7 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
 }
 
 TEST(OutlierUtility, SRThreshold) {
-  std::vector<HostSuccessRatePair> data = {
-      HostSuccessRatePair(nullptr, 50),  HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100), HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100),
-  };
+  std::vector<double> data = {50, 100, 100, 100, 100};
   double sum = 450;
 
   DetectorImpl::EjectionPair success_rate_nums =
@@ -1577,6 +1591,26 @@ TEST(OutlierUtility, SRThreshold) {
   EXPECT_EQ(52.0, success_rate_nums.ejection_threshold_);   // ejection threshold
 }
 
+// The threshold matches a straightforward mean and standard deviation for any number of hosts.
+TEST(OutlierUtility, SRThresholdMatchesNaiveComputation) {
+  std::vector<double> data;
+  for (uint32_t i = 0; i < 37; ++i) {
+    data.push_back(100.0 - (i * 7919 % 101) / 3.0);
+    const double sum = std::accumulate(data.begin(), data.end(), 0.0);
+    const double mean = sum / data.size();
+    double variance = 0;
+    for (const double success_rate : data) {
+      variance += (success_rate - mean) * (success_rate - mean);
+    }
+    const double stdev = std::sqrt(variance / data.size());
+
+    DetectorImpl::EjectionPair success_rate_nums =
+        DetectorImpl::successRateEjectionThreshold(sum, data, 1.9);
+    EXPECT_DOUBLE_EQ(mean, success_rate_nums.success_rate_average_);
+    EXPECT_NEAR(mean - 1.9 * stdev, success_rate_nums.ejection_threshold_, 1e-9) << data.size();
+  }
+}
+
 } // namespace
 } // namespace Outlier
 } // namespace Upstream
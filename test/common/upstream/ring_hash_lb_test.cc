@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/router/router.h"
@@ -165,6 +166,54 @@ TEST_P(RingHashLoadBalancerTest, Basic) {
   EXPECT_EQ(1UL, stats_.lb_healthy_panic_.value());
 }
 
+// With bounded loads, a host over its bound is skipped in favor of the next host on the ring.
+TEST_P(RingHashLoadBalancerTest, BoundedLoad) {
+  hostSet().hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = envoy::config::cluster::v3::Cluster::RingHashLbConfig();
+  config_.value().mutable_minimum_ring_size()->set_value(12);
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      150);
+  init();
+
+  // hash ring (see Basic):
+  // port | position
+  // ---------------------------
+  // :94  | 833437586790550860
+  // :92  | 928266305478181108
+  // :90  | 1033482794131418490
+  // :95  | 3551244743356806947
+  // :93  | 3851675632748031481
+  // :91  | 5583722120771150861
+  // ...
+
+  // With 12 active requests, each host may have ceil(13 * 1.5 / 6) = 4, counting the request being
+  // placed.
+  info_->stats_.upstream_rq_active_.set(12);
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  EXPECT_EQ(hostSet().hosts_[4], lb->chooseHost(&context));
+
+  hostSet().hosts_[4]->stats().rq_active_.set(4);
+  hostSet().hosts_[2]->stats().rq_active_.set(3);
+  EXPECT_EQ(hostSet().hosts_[2], lb->chooseHost(&context));
+
+  hostSet().hosts_[2]->stats().rq_active_.set(4);
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context));
+
+  // If every host is over its bound, the least loaded one is chosen.
+  for (const auto& host : hostSet().hosts_) {
+    host->stats().rq_active_.set(10);
+  }
+  hostSet().hosts_[5]->stats().rq_active_.set(5);
+  EXPECT_EQ(hostSet().hosts_[5], lb->chooseHost(&context));
+}
+
 // Ensure if all the hosts with priority 0 unhealthy, the next priority hosts are used.
 TEST_P(RingHashFailoverTest, BasicFailover) {
   host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80")};
@@ -773,6 +822,59 @@ TEST_P(RingHashLoadBalancerTest, LopsidedWeightSmallScale) {
   }
 }
 
+// Rings built from the hashes cached by earlier builds, as the number of hashes per host shrinks
+// and grows and hosts come and go, match rings built from scratch.
+TEST_P(RingHashLoadBalancerTest, RebuildMatchesFreshRing) {
+  config_ = envoy::config::cluster::v3::Cluster::RingHashLbConfig();
+  config_.value().mutable_minimum_ring_size()->set_value(10);
+  init();
+
+  // Fresh load balancers stay registered with the priority set, so keep them alive until the end.
+  std::vector<std::unique_ptr<RingHashLoadBalancer>> fresh_lbs;
+  auto expect_matches_fresh_ring = [&](uint64_t expected_size) {
+    EXPECT_EQ(expected_size, lb_->stats().size_.value());
+    LoadBalancerPtr lb = lb_->factory()->create();
+    fresh_lbs.push_back(std::make_unique<RingHashLoadBalancer>(
+        priority_set_, stats_, stats_store_, runtime_, random_, config_, common_config_));
+    fresh_lbs.back()->initialize();
+    LoadBalancerPtr fresh_lb = fresh_lbs.back()->factory()->create();
+    for (uint64_t i = 0; i < 1000; ++i) {
+      TestLoadBalancerContext context(i * (std::numeric_limits<uint64_t>::max() / 1000));
+      EXPECT_EQ(fresh_lb->chooseHost(&context), lb->chooseHost(&context));
+    }
+  };
+
+  HostSharedPtr host_90 = makeTestHost(info_, "tcp://127.0.0.1:90");
+  HostSharedPtr host_91 = makeTestHost(info_, "tcp://127.0.0.1:91");
+  HostSharedPtr host_92 = makeTestHost(info_, "tcp://127.0.0.1:92");
+
+  // 5 hashes per host.
+  hostSet().hosts_ = {host_90, host_91};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  expect_matches_fresh_ring(10);
+
+  // 4 hashes per host.
+  hostSet().hosts_ = {host_90, host_91, host_92};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  expect_matches_fresh_ring(12);
+
+  // 5 hashes per host again.
+  hostSet().hosts_ = {host_90, host_92};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  expect_matches_fresh_ring(10);
+
+  // 9 hashes for :90 and 3 for :92.
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 3), host_92};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  expect_matches_fresh_ring(12);
+  EXPECT_EQ(3, lb_->stats().min_hashes_per_host_.value());
+  EXPECT_EQ(9, lb_->stats().max_hashes_per_host_.value());
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
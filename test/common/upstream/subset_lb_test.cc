@@ -189,7 +189,7 @@ public:
 
     lb_ = std::make_shared<SubsetLoadBalancer>(
         lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_, random_, subset_info_,
-        ring_hash_lb_config_, least_request_lb_config_, common_config_);
+        ring_hash_lb_config_, maglev_lb_config_, least_request_lb_config_, common_config_);
   }
 
   void zoneAwareInit(const std::vector<HostURLMetadataMap>& host_metadata_per_locality,
@@ -238,7 +238,8 @@ public:
 
     lb_ = std::make_shared<SubsetLoadBalancer>(
         lb_type_, priority_set_, &local_priority_set_, stats_, stats_store_, runtime_, random_,
-        subset_info_, ring_hash_lb_config_, least_request_lb_config_, common_config_);
+        subset_info_, ring_hash_lb_config_, maglev_lb_config_, least_request_lb_config_,
+        common_config_);
   }
 
   HostSharedPtr makeHost(const std::string& url, const HostMetadata& metadata) {
@@ -460,6 +461,7 @@ public:
   NiceMock<MockLoadBalancerSubsetInfo> subset_info_;
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
   envoy::config::cluster::v3::Cluster::RingHashLbConfig ring_hash_lb_config_;
+  envoy::config::cluster::v3::Cluster::MaglevLbConfig maglev_lb_config_;
   envoy::config::cluster::v3::Cluster::LeastRequestLbConfig least_request_lb_config_;
   envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
@@ -1422,7 +1424,8 @@ TEST_F(SubsetLoadBalancerTest, IgnoresHostsWithoutMetadata) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
 
   TestLoadBalancerContext context_version({{"version", "1.0"}});
 
@@ -1841,7 +1844,8 @@ TEST_F(SubsetLoadBalancerTest, DisabledLocalityWeightAwareness) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
 
   TestLoadBalancerContext context({{"version", "1.1"}});
 
@@ -1864,7 +1868,8 @@ TEST_F(SubsetLoadBalancerTest, DoesNotCheckHostHealth) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
 }
 
 TEST_F(SubsetLoadBalancerTest, EnabledLocalityWeightAwareness) {
@@ -1887,7 +1892,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledLocalityWeightAwareness) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
 
   TestLoadBalancerContext context({{"version", "1.1"}});
 
@@ -1922,7 +1928,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledScaleLocalityWeights) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
   TestLoadBalancerContext context({{"version", "1.1"}});
 
   // Since we scale the locality weights by number of hosts removed, we expect to see the second
@@ -1967,7 +1974,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledScaleLocalityWeightsRounding) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
   TestLoadBalancerContext context({{"version", "1.0"}});
 
   // We expect to see a 33/66 split because 2 * 1 / 2 = 1 and 2 * 3 / 4 = 1.5 -> 2
@@ -1999,7 +2007,8 @@ TEST_F(SubsetLoadBalancerTest, ScaleLocalityWeightsWithNoLocalityWeights) {
 
   lb_ = std::make_shared<SubsetLoadBalancer>(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                              runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                             least_request_lb_config_, common_config_);
+                                             maglev_lb_config_, least_request_lb_config_,
+                                             common_config_);
 }
 
 TEST_P(SubsetLoadBalancerTest, GaugesUpdatedOnDestroy) {
@@ -2325,6 +2334,168 @@ TEST_P(SubsetLoadBalancerTest, KeysSubsetFallbackToNotExistingSelector) {
   EXPECT_EQ(1U, stats_.lb_subsets_fallback_.value());
 }
 
+TEST_P(SubsetLoadBalancerTest, BitmapIndexBalancesSubsetAfterUpdate) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
+  EXPECT_CALL(subset_info_, bitmapIndex()).WillRepeatedly(Return(true));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector({"version"})};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:82", {{"version", "1.1"}}},
+      {"tcp://127.0.0.1:83", {{"version", "1.1"}}},
+  });
+
+  // Subsets are only created when requested.
+  EXPECT_EQ(0U, stats_.lb_subsets_created_.value());
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_11({{"version", "1.1"}});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_11));
+  EXPECT_EQ(host_set_.hosts_[3], lb_->chooseHost(&context_11));
+  EXPECT_EQ(2U, stats_.lb_subsets_created_.value());
+
+  modifyHosts({makeHost("tcp://127.0.0.1:8000", {{"version", "1.2"}}),
+               makeHost("tcp://127.0.0.1:8001", {{"version", "1.0"}})},
+              {host_set_.hosts_[1], host_set_.hosts_[2]});
+
+  TestLoadBalancerContext context_12({{"version", "1.2"}});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[3], lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11));
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_12));
+  EXPECT_EQ(3U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(0U, stats_.lb_subsets_fallback_.value());
+
+  // Removing the last 1.1 host removes its subset.
+  modifyHosts({}, {host_set_.hosts_[1]});
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(1U, stats_.lb_subsets_removed_.value());
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_11));
+
+  lb_ = nullptr;
+  EXPECT_EQ(0U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(3U, stats_.lb_subsets_removed_.value());
+}
+
+TEST_F(SubsetLoadBalancerTest, BitmapIndexBalancesNestedSubsets) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::ANY_ENDPOINT));
+  EXPECT_CALL(subset_info_, bitmapIndex()).WillRepeatedly(Return(true));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector({"stage", "version"}),
+                                                     makeSelector({"stage"})};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}, {"stage", "prod"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.0"}, {"stage", "prod"}}},
+      {"tcp://127.0.0.1:82", {{"version", "1.0"}, {"stage", "off"}}},
+      {"tcp://127.0.0.1:83", {{"version", "1.1"}, {"stage", "prod"}}},
+      {"tcp://127.0.0.1:84", {{"version", "999"}, {"stage", "dev"}}},
+  });
+
+  TestLoadBalancerContext context_prod({{"stage", "prod"}});
+  TestLoadBalancerContext context_prod_10({{"version", "1.0"}, {"stage", "prod"}});
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_unknown_version({{"version", "2.0"}, {"stage", "prod"}});
+  TestLoadBalancerContext context_no_match({{"version", "999"}, {"stage", "prod"}});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_prod_10));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_prod_10));
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_prod_10));
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_prod));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_prod));
+  EXPECT_EQ(host_set_.hosts_[3], lb_->chooseHost(&context_prod));
+  EXPECT_EQ(2U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(6U, stats_.lb_subsets_selected_.value());
+
+  // No selector has only the version key, and no host has both version 999 and stage prod.
+  EXPECT_NE(nullptr, lb_->chooseHost(&context_10));
+  EXPECT_NE(nullptr, lb_->chooseHost(&context_unknown_version));
+  EXPECT_NE(nullptr, lb_->chooseHost(&context_no_match));
+  EXPECT_EQ(3U, stats_.lb_subsets_fallback_.value());
+  EXPECT_EQ(2U, stats_.lb_subsets_created_.value());
+}
+
+TEST_F(SubsetLoadBalancerTest, BitmapIndexEvictsLeastRecentlyUsedSubset) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
+  EXPECT_CALL(subset_info_, bitmapIndex()).WillRepeatedly(Return(true));
+  EXPECT_CALL(subset_info_, bitmapIndexMaxCachedSubsets()).WillRepeatedly(Return(2));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector({"version"})};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.1"}}},
+      {"tcp://127.0.0.1:82", {{"version", "1.2"}}},
+  });
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_11({{"version", "1.1"}});
+  TestLoadBalancerContext context_12({{"version", "1.2"}});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11));
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+
+  // 1.1 is the least recently used subset.
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_12));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(1U, stats_.lb_subsets_removed_.value());
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+
+  // Requesting 1.1 again recreates it, evicting 1.2.
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(4U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(2U, stats_.lb_subsets_removed_.value());
+  EXPECT_EQ(6U, stats_.lb_subsets_selected_.value());
+}
+
+TEST_P(SubsetLoadBalancerTest, BitmapIndexListAsAny) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
+  EXPECT_CALL(subset_info_, bitmapIndex()).WillRepeatedly(Return(true));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector({"version"})};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+  EXPECT_CALL(subset_info_, listAsAny()).WillRepeatedly(Return(true));
+
+  init({});
+  modifyHosts(
+      {makeHost("tcp://127.0.0.1:8000",
+                {{"version", std::vector<std::string>{"1.2.1", "1.2", "1.2"}}}),
+       makeHost("tcp://127.0.0.1:8001", {{"version", "1.0"}})},
+      {}, {}, 0);
+
+  {
+    TestLoadBalancerContext context({{"version", "1.0"}});
+    EXPECT_EQ(host_set_.hosts()[1], lb_->chooseHost(&context));
+  }
+  {
+    TestLoadBalancerContext context({{"version", "1.2"}});
+    EXPECT_EQ(host_set_.hosts()[0], lb_->chooseHost(&context));
+  }
+  TestLoadBalancerContext context({{"version", "1.2.1"}});
+  EXPECT_EQ(host_set_.hosts()[0], lb_->chooseHost(&context));
+}
+
 INSTANTIATE_TEST_SUITE_P(UpdateOrderings, SubsetLoadBalancerTest,
                          testing::ValuesIn({UpdateOrder::RemovesFirst, UpdateOrder::Simultaneous}));
 
@@ -2183,6 +2183,52 @@ TEST_F(ClusterInfoImplTest, BrokenTypedMetadata) {
                             "Cannot create a Baz when metadata is empty.");
 }
 
+// The Maglev table size must be prime. It is validated with the cluster, since Maglev load
+// balancers may be created on workers.
+TEST_F(ClusterInfoImplTest, MaglevTableSizeNotPrime) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: MAGLEV
+    load_assignment:
+      endpoints:
+      - lb_endpoints:
+        - endpoint:
+            address:
+              socket_address:
+                address: foo.bar.com
+                port_value: 443
+    maglev_lb_config:
+      table_size: 8
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(makeCluster(yaml), EnvoyException,
+                            "cluster: maglev table_size (8) must be a prime number");
+}
+
+TEST_F(ClusterInfoImplTest, MaglevTableSizePrime) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: MAGLEV
+    load_assignment:
+      endpoints:
+      - lb_endpoints:
+        - endpoint:
+            address:
+              socket_address:
+                address: foo.bar.com
+                port_value: 443
+    maglev_lb_config:
+      table_size: 7
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(7U, cluster->info()->lbMaglevConfig()->table_size().value());
+}
+
 // Cluster extension protocol options fails validation when configured for an unregistered filter.
 TEST_F(ClusterInfoImplTest, ExtensionProtocolOptionsForUnknownFilter) {
   const std::string yaml = R"EOF(
@@ -2348,6 +2394,33 @@ TEST_F(ClusterInfoImplTest, TestTrackTimeoutBudgets) {
             cluster->info()->timeoutBudgetStats()->upstream_rq_timeout_budget_percent_used_.unit());
 }
 
+TEST_F(ClusterInfoImplTest, PrefetchPolicy) {
+  const std::string yaml_default = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+  )EOF";
+
+  auto cluster = makeCluster(yaml_default);
+  EXPECT_EQ(1.0, cluster->info()->perUpstreamPrefetchRatio());
+  EXPECT_EQ(0, cluster->info()->minWarmConnections());
+
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    prefetch_policy:
+      per_upstream_prefetch_ratio: 1.5
+      min_warm_connections: 4
+  )EOF";
+
+  cluster = makeCluster(yaml);
+  EXPECT_EQ(1.5, cluster->info()->perUpstreamPrefetchRatio());
+  EXPECT_EQ(4, cluster->info()->minWarmConnections());
+}
+
 // Validates HTTP2 SETTINGS config.
 TEST_F(ClusterInfoImplTest, Http2ProtocolOptions) {
   const std::string yaml = R"EOF(
@@ -2,8 +2,10 @@
 
 #include "extensions/filters/http/cache/cache_filter.h"
 #include "extensions/filters/http/cache/config.h"
+#include "extensions/filters/http/cache/simple_http_cache/simple_http_cache.h"
 
 #include "test/mocks/server/mocks.h"
+#include "test/test_common/registry.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -33,6 +35,35 @@ TEST_F(CacheFilterFactoryTest, Basic) {
   ASSERT(dynamic_cast<CacheFilter*>(filter.get()));
 }
 
+// Counts how often the filter factory asks for a cache.
+class CountingHttpCacheFactory : public HttpCacheFactory {
+public:
+  std::string name() const override { return "envoy.extensions.http.cache.counting_test"; }
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ProtobufWkt::StringValue>();
+  }
+  HttpCacheSharedPtr getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig&,
+                              Server::Configuration::FactoryContext&) override {
+    ++get_cache_calls_;
+    return cache_;
+  }
+
+  const HttpCacheSharedPtr cache_ = std::make_shared<SimpleHttpCache>();
+  uint32_t get_cache_calls_{};
+};
+
+TEST_F(CacheFilterFactoryTest, CacheResolvedOncePerFilterConfig) {
+  CountingHttpCacheFactory cache_factory;
+  Registry::InjectFactory<HttpCacheFactory> registration(cache_factory);
+  config_.mutable_typed_config()->PackFrom(ProtobufWkt::StringValue());
+  Http::FilterFactoryCb cb = factory_.createFilterFactoryFromProto(config_, "stats", context_);
+  EXPECT_EQ(cache_factory.get_cache_calls_, 1);
+  EXPECT_CALL(filter_callback_, addStreamFilter(_)).Times(2);
+  cb(filter_callback_);
+  cb(filter_callback_);
+  EXPECT_EQ(cache_factory.get_cache_calls_, 1);
+}
+
 TEST_F(CacheFilterFactoryTest, NoTypedConfig) {
   EXPECT_THROW(factory_.createFilterFactoryFromProto(config_, "stats", context_), EnvoyException);
 }
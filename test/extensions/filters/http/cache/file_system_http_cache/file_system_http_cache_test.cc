@@ -0,0 +1,297 @@
+#include <fstream>
+#include <string>
+
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/filesystem/directory.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/cache/file_system_http_cache/file_system_http_cache.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+class FileSystemHttpCacheTest : public testing::Test {
+protected:
+  FileSystemHttpCacheTest() {
+    TestEnvironment::createPath(cache_path_);
+    config_.set_cache_path(cache_path_);
+    request_headers_.setMethod("GET");
+    request_headers_.setHost("example.com");
+    request_headers_.setForwardedProto("https");
+    request_headers_.setCacheControl("max-age=3600");
+  }
+
+  ~FileSystemHttpCacheTest() override {
+    cache_.reset();
+    TestEnvironment::removePath(cache_path_);
+  }
+
+  void createCache() {
+    cache_ =
+        std::make_unique<FileSystemHttpCache>(config_, Thread::threadFactoryForTest(), stats_store_);
+  }
+
+  // Performs a cache lookup.
+  LookupContextPtr lookup(absl::string_view request_path) {
+    request_headers_.setPath(request_path);
+    LookupContextPtr context =
+        cache_->makeLookupContext(LookupRequest(request_headers_, current_time_));
+    context->getHeaders([this](LookupResult&& result) { lookup_result_ = std::move(result); });
+    return context;
+  }
+
+  // Inserts a response and waits for the background thread to write it.
+  void insert(absl::string_view request_path, absl::string_view response_body) {
+    InsertContextPtr inserter = cache_->makeInsertContext(lookup(request_path));
+    inserter->insertHeaders(response_headers_, false);
+    inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
+    cache_->waitForBackgroundWork();
+  }
+
+  std::string getBody(LookupContext& context, uint64_t start, uint64_t end) {
+    std::string body;
+    context.getBody(AdjustedByteRange(start, end), [&body](Buffer::InstancePtr&& data) {
+      EXPECT_NE(data, nullptr);
+      if (data) {
+        body = data->toString();
+      }
+    });
+    return body;
+  }
+
+  bool isCached(absl::string_view request_path) {
+    lookup(request_path);
+    return lookup_result_.cache_entry_status_ == CacheEntryStatus::Ok;
+  }
+
+  // The size of the record holding a single byte path and a five byte body.
+  uint64_t recordSize() {
+    Stats::IsolatedStoreImpl stats_store;
+    cache_ =
+        std::make_unique<FileSystemHttpCache>(config_, Thread::threadFactoryForTest(), stats_store);
+    insert("x", "Value");
+    const uint64_t size = cache_->stats().live_bytes_.value();
+    cache_.reset();
+    return size;
+  }
+
+  uint32_t segmentFiles() {
+    uint32_t files = 0;
+    for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(cache_path_)) {
+      files += entry.type_ == Filesystem::FileType::Regular;
+    }
+    return files;
+  }
+
+  const std::string cache_path_{TestEnvironment::temporaryPath("file_system_http_cache_test")};
+  envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig config_;
+  Stats::IsolatedStoreImpl stats_store_;
+  std::unique_ptr<FileSystemHttpCache> cache_;
+  LookupResult lookup_result_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+  Event::SimulatedTimeSystem time_source_;
+  SystemTime current_time_ = time_source_.systemTime();
+  DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
+  const Http::TestResponseHeaderMapImpl response_headers_{
+      {"date", formatter_.fromTime(current_time_)},
+      {"cache-control", "public,max-age=3600"},
+      {"x-custom", "first"},
+      {"x-custom", "second"}};
+};
+
+TEST_F(FileSystemHttpCacheTest, PutGet) {
+  createCache();
+  LookupContextPtr name_lookup_context = lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  insert("Name", "Value");
+  name_lookup_context = lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  EXPECT_THAT(lookup_result_.headers_.get(), HeaderMapEqualIgnoreOrder(&response_headers_));
+  ASSERT_EQ(5, lookup_result_.content_length_);
+  EXPECT_EQ("Value", getBody(*name_lookup_context, 0, 5));
+  EXPECT_EQ("alu", getBody(*name_lookup_context, 1, 4));
+  EXPECT_EQ("", getBody(*name_lookup_context, 2, 2));
+
+  EXPECT_FALSE(isCached("Another Name"));
+
+  insert("Name", "NewValue");
+  name_lookup_context = lookup("Name");
+  EXPECT_EQ("NewValue", getBody(*name_lookup_context, 0, 8));
+
+  EXPECT_EQ(2, cache_->stats().inserts_.value());
+  EXPECT_EQ(3, cache_->stats().hits_.value());
+  EXPECT_EQ(3, cache_->stats().misses_.value());
+  EXPECT_EQ(1, cache_->stats().segments_.value());
+}
+
+TEST_F(FileSystemHttpCacheTest, StreamingPut) {
+  createCache();
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("request_path"));
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("Hello, "), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl("World!"), nullptr, true);
+  cache_->waitForBackgroundWork();
+  LookupContextPtr name_lookup_context = lookup("request_path");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_EQ(13, lookup_result_.content_length_);
+  EXPECT_EQ("Hello, World!", getBody(*name_lookup_context, 0, 13));
+}
+
+TEST_F(FileSystemHttpCacheTest, RemovesStaleSegmentFiles) {
+  const std::string stale_file = cache_path_ + "/envoy-http-cache-segment-7";
+  const std::string other_file = cache_path_ + "/other";
+  std::ofstream(stale_file) << "stale";
+  std::ofstream(other_file) << "other";
+  createCache();
+  EXPECT_FALSE(std::ifstream(stale_file).good());
+  EXPECT_TRUE(std::ifstream(other_file).good());
+}
+
+TEST_F(FileSystemHttpCacheTest, TooLargeForSegment) {
+  const uint64_t record_size = recordSize();
+  config_.set_segment_size_bytes(record_size);
+  createCache();
+  insert("a", "Values");
+  EXPECT_FALSE(isCached("a"));
+  EXPECT_EQ(1, cache_->stats().insert_failures_.value());
+  insert("a", "Value");
+  EXPECT_TRUE(isCached("a"));
+}
+
+TEST_F(FileSystemHttpCacheTest, EvictsOldestSegment) {
+  const uint64_t record_size = recordSize();
+  config_.set_segment_size_bytes(2 * record_size);
+  config_.set_max_size_bytes(4 * record_size);
+  createCache();
+  insert("a", "Value");
+  insert("b", "Value");
+  insert("c", "Value");
+  insert("d", "Value");
+  EXPECT_EQ(2, cache_->stats().segments_.value());
+  EXPECT_EQ(0, cache_->stats().evicted_bytes_.value());
+
+  insert("e", "Value");
+  EXPECT_EQ(2, cache_->stats().segments_.value());
+  EXPECT_EQ(2, segmentFiles());
+  EXPECT_EQ(2 * record_size, cache_->stats().evicted_bytes_.value());
+  EXPECT_EQ(3 * record_size, cache_->stats().live_bytes_.value());
+  EXPECT_FALSE(isCached("a"));
+  EXPECT_FALSE(isCached("b"));
+  EXPECT_TRUE(isCached("c"));
+  EXPECT_TRUE(isCached("d"));
+  EXPECT_TRUE(isCached("e"));
+}
+
+// A body handed out by a lookup stays valid after its segment is evicted.
+TEST_F(FileSystemHttpCacheTest, BodyOutlivesSegment) {
+  const uint64_t record_size = recordSize();
+  config_.set_segment_size_bytes(record_size);
+  config_.set_max_size_bytes(2 * record_size);
+  createCache();
+  insert("a", "Value");
+  LookupContextPtr context = lookup("a");
+  Buffer::InstancePtr body;
+  context->getBody(AdjustedByteRange(0, 5),
+                   [&body](Buffer::InstancePtr&& data) { body = std::move(data); });
+
+  insert("b", "Other");
+  insert("c", "Other");
+  EXPECT_FALSE(isCached("a"));
+  EXPECT_EQ(2, segmentFiles());
+  context.reset();
+  EXPECT_EQ("Value", body->toString());
+}
+
+TEST_F(FileSystemHttpCacheTest, CompactsSupersededSegments) {
+  const uint64_t record_size = recordSize();
+  config_.set_segment_size_bytes(4 * record_size);
+  createCache();
+  insert("a", "Value");
+  insert("b", "Value");
+  insert("c", "Value");
+  insert("d", "Value");
+
+  // Superseding three of the four records leaves the first segment below the threshold.
+  insert("a", "Newer");
+  insert("b", "Newer");
+  EXPECT_EQ(0, cache_->stats().compactions_.value());
+  insert("c", "Newer");
+  EXPECT_EQ(1, cache_->stats().compactions_.value());
+  EXPECT_EQ(record_size, cache_->stats().compacted_bytes_.value());
+  EXPECT_EQ(0, cache_->stats().evicted_bytes_.value());
+  EXPECT_EQ(1, cache_->stats().segments_.value());
+  EXPECT_EQ(1, segmentFiles());
+  EXPECT_EQ(4 * record_size, cache_->stats().live_bytes_.value());
+
+  LookupContextPtr context = lookup("a");
+  EXPECT_EQ("Newer", getBody(*context, 0, 5));
+  context = lookup("d");
+  EXPECT_EQ("Value", getBody(*context, 0, 5));
+}
+
+// Inserts are written by the background thread, so a response is not cached right away.
+TEST_F(FileSystemHttpCacheTest, InsertIsAsynchronous) {
+  createCache();
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("a"));
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(Buffer::OwnedImpl("Value"), nullptr, true);
+  cache_->waitForBackgroundWork();
+  EXPECT_TRUE(isCached("a"));
+  EXPECT_EQ(1, cache_->stats().inserts_.value());
+  EXPECT_EQ(1, segmentFiles());
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.source.extensions.filters.http.cache.FileSystemHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ON_CALL(factory_context.api_, threadFactory())
+      .WillByDefault(ReturnRef(Thread::threadFactoryForTest()));
+  envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig typed_config;
+  typed_config.set_cache_path(TestEnvironment::temporaryDirectory());
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  config.mutable_typed_config()->PackFrom(typed_config);
+  HttpCacheSharedPtr cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache->cacheInfo().name_, "envoy.extensions.http.cache.file_system");
+  // The same directory yields the same cache, as long as the settings match.
+  EXPECT_EQ(cache, factory->getCache(config, factory_context));
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig other_config;
+  typed_config.set_segment_size_bytes(1024);
+  other_config.mutable_typed_config()->PackFrom(typed_config);
+  EXPECT_THROW_WITH_MESSAGE(
+      factory->getCache(other_config, factory_context), EnvoyException,
+      fmt::format("file system cache at '{}' is already configured with different settings",
+                  TestEnvironment::temporaryDirectory()));
+
+  // Caches go away with their last user, after which the directory may be configured anew.
+  std::weak_ptr<HttpCache> weak_cache = cache;
+  cache.reset();
+  EXPECT_EQ(nullptr, weak_cache.lock());
+  cache = factory->getCache(other_config, factory_context);
+  EXPECT_NE(nullptr, cache);
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
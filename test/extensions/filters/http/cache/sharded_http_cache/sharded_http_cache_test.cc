@@ -0,0 +1,235 @@
+#include <string>
+#include <vector>
+
+#include "envoy/http/header_map.h"
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/filters/http/cache/sharded_http_cache/sharded_http_cache.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using testing::NiceMock;
+
+class ShardedHttpCacheTest : public testing::Test {
+protected:
+  ShardedHttpCacheTest() {
+    request_headers_.setMethod("GET");
+    request_headers_.setHost("example.com");
+    request_headers_.setForwardedProto("https");
+    request_headers_.setCacheControl("max-age=3600");
+  }
+
+  // Performs a cache lookup.
+  LookupContextPtr lookup(absl::string_view request_path) {
+    LookupRequest request = makeLookupRequest(request_path);
+    LookupContextPtr context = cache_->makeLookupContext(std::move(request));
+    context->getHeaders([this](LookupResult&& result) { lookup_result_ = std::move(result); });
+    return context;
+  }
+
+  // Inserts a value into the cache.
+  void insert(LookupContextPtr lookup, const Http::TestResponseHeaderMapImpl& response_headers,
+              const absl::string_view response_body) {
+    InsertContextPtr inserter = cache_->makeInsertContext(move(lookup));
+    inserter->insertHeaders(response_headers, false);
+    inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
+  }
+
+  void insert(absl::string_view request_path, const absl::string_view response_body) {
+    insert(lookup(request_path), response_headers_, response_body);
+  }
+
+  std::string getBody(LookupContext& context, uint64_t start, uint64_t end) {
+    AdjustedByteRange range(start, end);
+    std::string body;
+    context.getBody(range, [&body](Buffer::InstancePtr&& data) {
+      EXPECT_NE(data, nullptr);
+      if (data) {
+        body = data->toString();
+      }
+    });
+    return body;
+  }
+
+  LookupRequest makeLookupRequest(absl::string_view request_path) {
+    request_headers_.setPath(request_path);
+    return LookupRequest(request_headers_, current_time_);
+  }
+
+  bool isCached(absl::string_view request_path) {
+    lookup(request_path);
+    return lookup_result_.cache_entry_status_ == CacheEntryStatus::Ok;
+  }
+
+  // The number of bytes charged for an entry with the given body.
+  uint64_t entrySize(absl::string_view body) { return response_headers_.byteSize() + body.size(); }
+
+  std::unique_ptr<ShardedHttpCache> cache_{std::make_unique<ShardedHttpCache>(
+      ShardedHttpCache::DefaultShards, ShardedHttpCache::DefaultMaxSizeBytes)};
+  LookupResult lookup_result_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+  Event::SimulatedTimeSystem time_source_;
+  SystemTime current_time_ = time_source_.systemTime();
+  DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
+  const Http::TestResponseHeaderMapImpl response_headers_{
+      {"date", formatter_.fromTime(current_time_)}, {"cache-control", "public,max-age=3600"}};
+};
+
+TEST_F(ShardedHttpCacheTest, PutGet) {
+  LookupContextPtr name_lookup_context = lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  insert(move(name_lookup_context), response_headers_, "Value");
+  name_lookup_context = lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_EQ(5, lookup_result_.content_length_);
+  EXPECT_EQ("Value", getBody(*name_lookup_context, 0, 5));
+  EXPECT_EQ("alu", getBody(*name_lookup_context, 1, 4));
+  EXPECT_EQ("", getBody(*name_lookup_context, 2, 2));
+
+  EXPECT_FALSE(isCached("Another Name"));
+
+  insert(move(name_lookup_context), response_headers_, "NewValue");
+  name_lookup_context = lookup("Name");
+  EXPECT_EQ("NewValue", getBody(*name_lookup_context, 0, 8));
+  EXPECT_EQ(1, cache_->size());
+  EXPECT_EQ(entrySize("NewValue"), cache_->sizeBytes());
+}
+
+TEST_F(ShardedHttpCacheTest, StreamingPut) {
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("request_path"));
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("Hello, "), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl("World!"), nullptr, true);
+  LookupContextPtr name_lookup_context = lookup("request_path");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_EQ(13, lookup_result_.content_length_);
+  EXPECT_EQ("Hello, World!", getBody(*name_lookup_context, 0, 13));
+}
+
+// A body handed out by a lookup stays valid after its entry is replaced or evicted.
+TEST_F(ShardedHttpCacheTest, BodyOutlivesEntry) {
+  cache_ = std::make_unique<ShardedHttpCache>(1, entrySize("Value"));
+  insert("a", "Value");
+  LookupContextPtr context = lookup("a");
+  Buffer::InstancePtr body;
+  context->getBody(AdjustedByteRange(0, 5), [&body](Buffer::InstancePtr&& data) {
+    body = std::move(data);
+  });
+
+  insert("b", "Other");
+  EXPECT_FALSE(isCached("a"));
+  context.reset();
+  EXPECT_EQ("Value", body->toString());
+}
+
+TEST_F(ShardedHttpCacheTest, TooLargeForShard) {
+  cache_ = std::make_unique<ShardedHttpCache>(2, 2 * entrySize("Value"));
+  insert("a", "Values");
+  EXPECT_FALSE(isCached("a"));
+  EXPECT_EQ(0, cache_->sizeBytes());
+  insert("a", "Value");
+  EXPECT_TRUE(isCached("a"));
+}
+
+TEST_F(ShardedHttpCacheTest, EvictsUnreferencedEntries) {
+  cache_ = std::make_unique<ShardedHttpCache>(1, 3 * entrySize("Value"));
+  insert("a", "Value");
+  insert("b", "Value");
+  insert("c", "Value");
+  EXPECT_EQ(3 * entrySize("Value"), cache_->sizeBytes());
+
+  // The hand clears the marks set on insertion, then evicts the oldest entry.
+  insert("d", "Value");
+  EXPECT_EQ(3, cache_->size());
+  EXPECT_EQ(3 * entrySize("Value"), cache_->sizeBytes());
+  EXPECT_FALSE(isCached("a"));
+
+  // "c" is looked up, so it gets a second chance when the hand passes it.
+  EXPECT_TRUE(isCached("c"));
+  insert("e", "Value");
+  EXPECT_FALSE(isCached("b"));
+  insert("f", "Value");
+  EXPECT_FALSE(isCached("d"));
+  EXPECT_TRUE(isCached("c"));
+  EXPECT_TRUE(isCached("e"));
+  EXPECT_TRUE(isCached("f"));
+}
+
+TEST_F(ShardedHttpCacheTest, ReplacingLargerEvicts) {
+  cache_ = std::make_unique<ShardedHttpCache>(1, 2 * entrySize("Value"));
+  insert("a", "Value");
+  insert("b", "Value");
+  insert("a", "Value!");
+  EXPECT_EQ(1, cache_->size());
+  EXPECT_LE(cache_->sizeBytes(), 2 * entrySize("Value"));
+}
+
+TEST_F(ShardedHttpCacheTest, ConcurrentLookupsAndInserts) {
+  cache_ = std::make_unique<ShardedHttpCache>(4, 16 * entrySize("Value"));
+  std::vector<Thread::ThreadPtr> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([this, t]() {
+      Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"},
+                                                     {":authority", "example.com"},
+                                                     {"x-forwarded-proto", "https"}};
+      for (int i = 0; i < 200; i++) {
+        request_headers.setPath(absl::StrCat("/", (i * 7 + t) % 64));
+        LookupContextPtr context =
+            cache_->makeLookupContext(LookupRequest(request_headers, current_time_));
+        bool hit = false;
+        context->getHeaders([&hit](LookupResult&& result) {
+          hit = result.cache_entry_status_ == CacheEntryStatus::Ok;
+        });
+        if (hit) {
+          context->getBody(AdjustedByteRange(0, 5), [](Buffer::InstancePtr&& data) {
+            EXPECT_EQ("Value", data->toString());
+          });
+        } else {
+          InsertContextPtr inserter = cache_->makeInsertContext(std::move(context));
+          inserter->insertHeaders(response_headers_, false);
+          inserter->insertBody(Buffer::OwnedImpl("Value"), nullptr, true);
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_LE(cache_->sizeBytes(), 16 * entrySize("Value"));
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.source.extensions.filters.http.cache.ShardedHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  config.mutable_typed_config()->PackFrom(*factory->createEmptyConfigProto());
+  HttpCacheSharedPtr cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache->cacheInfo().name_, "envoy.extensions.http.cache.sharded");
+  // The same configuration yields the same cache.
+  EXPECT_EQ(cache, factory->getCache(config, factory_context));
+  // The factory doesn't keep caches alive on its own.
+  EXPECT_EQ(cache.use_count(), 2);
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1028,6 +1028,32 @@ TEST_F(HttpConnectionManagerConfigTest, RemovePortFalse) {
   EXPECT_FALSE(config.shouldStripMatchingPort());
 }
 
+TEST_F(HttpConnectionManagerConfigTest, PerStreamArena) {
+  const std::string yaml_string = R"EOF(
+  stat_prefix: ingress_http
+  route_config:
+    name: local_route
+  http_filters:
+  - name: envoy.filters.http.router
+  )EOF";
+
+  {
+    HttpConnectionManagerConfig config(parseHttpConnectionManagerFromV2Yaml(yaml_string), context_,
+                                       date_provider_, route_config_provider_manager_,
+                                       scoped_routes_config_provider_manager_,
+                                       http_tracer_manager_);
+    EXPECT_FALSE(config.perStreamArena());
+  }
+  {
+    // The raw string ends with the indentation of its last line.
+    HttpConnectionManagerConfig config(
+        parseHttpConnectionManagerFromV2Yaml(yaml_string + "per_stream_arena: true"), context_,
+        date_provider_, route_config_provider_manager_, scoped_routes_config_provider_manager_,
+        http_tracer_manager_);
+    EXPECT_TRUE(config.perStreamArena());
+  }
+}
+
 // Validated that by default we allow requests with header names containing underscores.
 TEST_F(HttpConnectionManagerConfigTest, HeadersWithUnderscoresAllowedByDefault) {
   const std::string yaml_string = R"EOF(
@@ -42,12 +42,14 @@ public:
     udp_response_.buffer_ = std::make_unique<Buffer::OwnedImpl>();
 
     EXPECT_CALL(callbacks_, udpListener()).Times(AtLeast(0));
-    EXPECT_CALL(callbacks_.udp_listener_, send(_))
-        .WillRepeatedly(
-            Invoke([this](const Network::UdpSendData& send_data) -> Api::IoCallUint64Result {
-              udp_response_.buffer_->move(send_data.buffer_);
-              return makeNoError(udp_response_.buffer_->length());
-            }));
+    EXPECT_CALL(callbacks_.udp_listener_, sendBatch(_, _))
+        .WillRepeatedly(Invoke([this](const Network::UdpSendData* send_data,
+                                      uint64_t num_data) -> Api::IoCallUint64Result {
+          for (uint64_t i = 0; i < num_data; ++i) {
+            udp_response_.buffer_->move(send_data[i].buffer_);
+          }
+          return makeNoError(num_data);
+        }));
     EXPECT_CALL(callbacks_.udp_listener_, dispatcher()).WillRepeatedly(ReturnRef(dispatcher_));
   }
 
@@ -65,6 +67,7 @@ public:
     EXPECT_CALL(listener_factory_, random()).WillOnce(ReturnRef(random_));
 
     config_ = std::make_shared<DnsFilterEnvoyConfig>(listener_factory_, config);
+    flush_timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
     filter_ = std::make_unique<DnsFilter>(callbacks_, config_);
   }
 
@@ -75,6 +78,8 @@ public:
     data.buffer_ = std::make_unique<Buffer::OwnedImpl>(buffer);
     data.receive_time_ = MonotonicTime(std::chrono::seconds(0));
     filter_->onData(data);
+    // Responses are sent at the end of the event loop iteration.
+    flush_timer_->invokeCallback();
   }
 
   const Network::Address::InstanceConstSharedPtr listener_address_;
@@ -82,6 +87,7 @@ public:
   DnsFilterEnvoyConfigSharedPtr config_;
   DnsQueryContextPtr query_ctx_;
   Event::MockDispatcher dispatcher_;
+  Event::MockTimer* flush_timer_{};
   Network::MockUdpReadFilterCallbacks callbacks_;
   Network::UdpRecvData udp_response_;
   NiceMock<Filesystem::MockInstance> file_system_;
@@ -27,6 +27,7 @@ public:
   using UdpProxyFilter::UdpProxyFilter;
 
   MOCK_METHOD(Network::IoHandlePtr, createIoHandle, (const Upstream::HostConstSharedPtr& host));
+  MOCK_METHOD(bool, enableUdpGro, (Network::IoHandle & io_handle));
 };
 
 Api::IoCallUint64Result makeNoError(uint64_t rc) {
@@ -64,13 +65,21 @@ public:
 
     void recvDataFromUpstream(const std::string& data, int recv_sys_errno = 0,
                               int send_sys_errno = 0) {
+      recvDataFromUpstream(data, 0, {data}, recv_sys_errno, send_sys_errno);
+    }
+
+    // Receives a single message from the upstream, which is split into the expected downstream
+    // datagrams if gso_size is not zero.
+    void recvDataFromUpstream(const std::string& data, uint64_t gso_size,
+                              const std::vector<std::string>& expected_datagrams,
+                              int recv_sys_errno = 0, int send_sys_errno = 0) {
       EXPECT_CALL(*idle_timer_, enableTimer(parent_.config_->sessionTimeout(), nullptr));
 
       EXPECT_CALL(*io_handle_, supportsMmsg());
       // Return the datagram.
       EXPECT_CALL(*io_handle_, recvmsg(_, 1, _, _))
           .WillOnce(
-              Invoke([this, data, recv_sys_errno](
+              Invoke([this, data, gso_size, recv_sys_errno](
                          Buffer::RawSlice* slices, const uint64_t, uint32_t,
                          Network::IoHandle::RecvMsgOutput& output) -> Api::IoCallUint64Result {
                 if (recv_sys_errno != 0) {
@@ -79,33 +88,40 @@ public:
                   ASSERT(data.size() <= slices[0].len_);
                   memcpy(slices[0].mem_, data.data(), data.size());
                   output.msg_[0].peer_address_ = upstream_address_;
+                  output.msg_[0].gso_size_ = gso_size;
                   return makeNoError(data.size());
                 }
               }));
       if (recv_sys_errno == 0) {
-        // Send the datagram downstream.
-        EXPECT_CALL(parent_.callbacks_.udp_listener_, send(_))
-            .WillOnce(Invoke([data, send_sys_errno](
-                                 const Network::UdpSendData& send_data) -> Api::IoCallUint64Result {
-              // TODO(mattklein123): Verify peer/local address.
-              EXPECT_EQ(send_data.buffer_.toString(), data);
-              if (send_sys_errno == 0) {
-                send_data.buffer_.drain(send_data.buffer_.length());
-                return makeNoError(data.size());
-              } else {
-                return makeError(send_sys_errno);
-              }
-            }));
         // Return an EAGAIN result.
         EXPECT_CALL(*io_handle_, supportsMmsg());
         EXPECT_CALL(*io_handle_, recvmsg(_, 1, _, _))
             .WillOnce(Return(ByMove(Api::IoCallUint64Result(
                 0, Api::IoErrorPtr(Network::IoSocketError::getIoSocketEagainInstance(),
                                    Network::IoSocketError::deleteIoError)))));
+        // Send the datagrams downstream at the end of the event loop iteration.
+        EXPECT_CALL(parent_.callbacks_.udp_listener_, sendBatch(_, expected_datagrams.size()))
+            .WillOnce(Invoke([expected_datagrams, send_sys_errno](
+                                 const Network::UdpSendData* send_data,
+                                 uint64_t num_data) -> Api::IoCallUint64Result {
+              for (uint64_t i = 0; i < num_data; ++i) {
+                // TODO(mattklein123): Verify peer/local address.
+                EXPECT_EQ(send_data[i].buffer_.toString(), expected_datagrams[i]);
+              }
+              if (send_sys_errno == 0) {
+                for (uint64_t i = 0; i < num_data; ++i) {
+                  send_data[i].buffer_.drain(send_data[i].buffer_.length());
+                }
+                return makeNoError(num_data);
+              } else {
+                return makeError(send_sys_errno);
+              }
+            }));
       }
 
       // Kick off the receive.
       file_event_cb_(Event::FileReadyType::Read);
+      parent_.flush();
     }
 
     UdpProxyFilterTest& parent_;
@@ -135,6 +151,7 @@ public:
     EXPECT_CALL(cluster_manager_, addThreadLocalClusterUpdateCallbacks_(_))
         .WillOnce(DoAll(SaveArgAddress(&cluster_update_callbacks_),
                         ReturnNew<Upstream::MockClusterUpdateCallbacksHandle>()));
+    flush_timer_ = new NiceMock<Event::MockTimer>(&callbacks_.udp_listener_.dispatcher_);
     if (has_cluster) {
       EXPECT_CALL(cluster_manager_, get(_));
     } else {
@@ -151,14 +168,24 @@ public:
     data.buffer_ = std::make_unique<Buffer::OwnedImpl>(buffer);
     data.receive_time_ = MonotonicTime(std::chrono::seconds(0));
     filter_->onData(data);
+    flush();
+  }
+
+  // Runs the end of event loop iteration flush, if one is scheduled.
+  void flush() {
+    if (flush_timer_->enabled_) {
+      flush_timer_->invokeCallback();
+    }
   }
 
-  void expectSessionCreate(const Network::Address::InstanceConstSharedPtr& address) {
+  void expectSessionCreate(const Network::Address::InstanceConstSharedPtr& address,
+                           bool gro_enabled = false) {
     test_sessions_.emplace_back(*this, address);
     TestSession& new_session = test_sessions_.back();
     new_session.idle_timer_ = new Event::MockTimer(&callbacks_.udp_listener_.dispatcher_);
     EXPECT_CALL(*filter_, createIoHandle(_))
         .WillOnce(Return(ByMove(Network::IoHandlePtr{test_sessions_.back().io_handle_})));
+    EXPECT_CALL(*filter_, enableUdpGro(_)).WillOnce(Return(gro_enabled));
     EXPECT_CALL(*new_session.io_handle_, fd());
     EXPECT_CALL(callbacks_.udp_listener_.dispatcher_,
                 createFileEvent_(_, _, Event::FileTriggerType::Edge, Event::FileReadyType::Read))
@@ -179,6 +206,7 @@ public:
   UdpProxyFilterConfigSharedPtr config_;
   Network::MockUdpReadFilterCallbacks callbacks_;
   Upstream::ClusterUpdateCallbacks* cluster_update_callbacks_{};
+  Event::MockTimer* flush_timer_{};
   std::unique_ptr<TestUdpProxyFilter> filter_;
   std::vector<TestSession> test_sessions_;
   const Network::Address::InstanceConstSharedPtr upstream_address_;
@@ -215,6 +243,71 @@ cluster: fake_cluster
   checkTransferStats(17 /*rx_bytes*/, 3 /*rx_datagrams*/, 17 /*tx_bytes*/, 3 /*tx_datagrams*/);
 }
 
+// Datagrams queued in the same event loop iteration are sent in a single batch.
+TEST_F(UdpProxyFilterTest, BatchedSends) {
+  InSequence s;
+
+  setup(R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+  )EOF");
+
+  expectSessionCreate(upstream_address_);
+  test_sessions_[0].expectUpstreamWrite("hello");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+
+  // Without flushing in between, both datagrams are sent by the same flush.
+  Network::MockIoHandle& io_handle = *test_sessions_[0].io_handle_;
+  EXPECT_CALL(*test_sessions_[0].idle_timer_, enableTimer(_, nullptr)).Times(2);
+  EXPECT_CALL(io_handle, supportsMmsg()).WillOnce(Return(true));
+  EXPECT_CALL(io_handle, supportsUdpGso()).WillOnce(Return(false));
+  EXPECT_CALL(io_handle, sendmmsg(_, 2))
+      .WillOnce(Invoke([](const Network::IoHandle::SendMsgPacket* packets,
+                          uint64_t num_packets) -> Api::IoCallUint64Result {
+        for (uint64_t i = 0; i < num_packets; ++i) {
+          EXPECT_EQ(1U, packets[i].num_slice_);
+          EXPECT_EQ(0U, packets[i].gso_size_);
+          EXPECT_EQ(nullptr, packets[i].self_ip_);
+        }
+        EXPECT_EQ("hello2", absl::string_view(static_cast<const char*>(packets[0].slices_[0].mem_),
+                                              packets[0].slices_[0].len_));
+        EXPECT_EQ("hello3", absl::string_view(static_cast<const char*>(packets[1].slices_[0].mem_),
+                                              packets[1].slices_[0].len_));
+        return makeNoError(num_packets);
+      }));
+  Network::UdpRecvData data;
+  data.addresses_.peer_ = Network::Utility::parseInternetAddressAndPort("10.0.0.1:1000");
+  data.addresses_.local_ = Network::Utility::parseInternetAddressAndPort("10.0.0.2:80");
+  data.buffer_ = std::make_unique<Buffer::OwnedImpl>("hello2");
+  filter_->onData(data);
+  data.buffer_ = std::make_unique<Buffer::OwnedImpl>("hello3");
+  filter_->onData(data);
+  flush();
+  checkTransferStats(17 /*rx_bytes*/, 3 /*rx_datagrams*/, 0 /*tx_bytes*/, 0 /*tx_datagrams*/);
+  EXPECT_EQ(17, cluster_manager_.thread_local_cluster_.cluster_.info_->stats_
+                    .upstream_cx_tx_bytes_total_.value());
+}
+
+// A message coalesced by UDP GRO is split into the original datagrams before being sent downstream.
+TEST_F(UdpProxyFilterTest, UdpGroReceive) {
+  InSequence s;
+
+  setup(R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+  )EOF");
+
+  expectSessionCreate(upstream_address_, true);
+  test_sessions_[0].expectUpstreamWrite("hello");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  test_sessions_[0].recvDataFromUpstream("world1world2end", 6, {"world1", "world2", "end"});
+  checkTransferStats(5 /*rx_bytes*/, 1 /*rx_datagrams*/, 15 /*tx_bytes*/, 3 /*tx_datagrams*/);
+  EXPECT_EQ(3, TestUtility::findCounter(
+                   cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_,
+                   "udp.sess_rx_datagrams")
+                   ->value());
+}
+
 // Idle timeout flow.
 TEST_F(UdpProxyFilterTest, IdleTimeout) {
   InSequence s;
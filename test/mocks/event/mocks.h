@@ -77,6 +77,11 @@ public:
     return Event::TimerPtr{createTimer_(cb)};
   }
 
+  // Coarse timers are mocked like other timers, so that MockTimer expectations cover both.
+  Event::TimerPtr createCoarseTimer(Event::TimerCb cb, std::chrono::milliseconds) override {
+    return Event::TimerPtr{createTimer_(cb)};
+  }
+
   void deferredDelete(DeferredDeletablePtr&& to_delete) override {
     deferredDelete_(to_delete.get());
     if (to_delete) {
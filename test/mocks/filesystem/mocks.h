@@ -21,6 +21,8 @@ public:
   // Filesystem::File
   Api::IoCallBoolResult open(FlagSet flag) override;
   Api::IoCallSizeResult write(absl::string_view buffer) override;
+  // Concatenates the buffers into a single write_() call.
+  Api::IoCallSizeResult writev(const absl::string_view* buffers, uint64_t num_buffers) override;
   Api::IoCallBoolResult close() override;
   bool isOpen() const override { return is_open_; };
   MOCK_METHOD(std::string, path, (), (const));
@@ -435,6 +435,7 @@ public:
   MOCK_METHOD(Event::Dispatcher&, dispatcher, ());
   MOCK_METHOD(Address::InstanceConstSharedPtr&, localAddress, (), (const));
   MOCK_METHOD(Api::IoCallUint64Result, send, (const UdpSendData&));
+  MOCK_METHOD(Api::IoCallUint64Result, sendBatch, (const UdpSendData* data, uint64_t num_data));
 
   Event::MockDispatcher dispatcher_;
 };
@@ -663,5 +663,39 @@ envoy_cluster_test_1_upstream_cx_total{a_tag_name="a.tag-value"} 0
   EXPECT_EQ(expected_output, response.toString());
 }
 
+// Test that the names cached by a scrape are reused by the next one, and evicted once their stats
+// are no longer output.
+TEST_F(PrometheusStatsFormatterTest, MetricNameCache) {
+  PrometheusStatsFormatter::MetricNameCache name_cache(*symbol_table_);
+  addCounter("cluster.test_1.upstream_cx_total",
+             {{makeStat("a.tag-name"), makeStat("a.tag-value")}});
+  addGauge("cluster.test_2.upstream_cx_active", {});
+
+  const std::string expected_output = R"EOF(# TYPE envoy_cluster_test_1_upstream_cx_total counter
+envoy_cluster_test_1_upstream_cx_total{a_tag_name="a.tag-value"} 0
+
+# TYPE envoy_cluster_test_2_upstream_cx_active gauge
+envoy_cluster_test_2_upstream_cx_active{} 0
+
+)EOF";
+
+  for (int i = 0; i < 2; ++i) {
+    Buffer::OwnedImpl response;
+    EXPECT_EQ(2UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_,
+                                                               response, false, absl::nullopt,
+                                                               &name_cache));
+    EXPECT_EQ(expected_output, response.toString());
+    // Two metric names and one tag name.
+    EXPECT_EQ(3UL, name_cache.size());
+  }
+
+  gauges_.clear();
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(1UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_,
+                                                             response, false, absl::nullopt,
+                                                             &name_cache));
+  EXPECT_EQ(2UL, name_cache.size());
+}
+
 } // namespace Server
 } // namespace Envoy
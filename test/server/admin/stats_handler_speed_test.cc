@@ -0,0 +1,67 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/allocator_impl.h"
+#include "common/stats/symbol_table_creator.h"
+#include "common/stats/thread_local_store.h"
+
+#include "server/admin/stats_handler.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Server {
+
+class StatsHandlerSpeedTest {
+public:
+  // Creates a counter and a gauge in each of `num_clusters` clusters for each of a fixed set of
+  // stat suffixes, so the names share their prefixes the way cluster stats do.
+  explicit StatsHandlerSpeedTest(uint64_t num_clusters)
+      : symbol_table_(Stats::SymbolTableCreator::makeSymbolTable()), alloc_(*symbol_table_),
+        store_(alloc_) {
+    for (uint64_t i = 0; i < num_clusters; ++i) {
+      const std::string prefix = absl::StrCat("cluster.service-", i, ".");
+      for (absl::string_view suffix : {"upstream_cx_total", "upstream_rq_total", "upstream_rq_2xx",
+                                       "upstream_rq_5xx", "lb_healthy_panic"}) {
+        store_.counterFromString(absl::StrCat(prefix, suffix)).inc();
+      }
+      for (absl::string_view suffix : {"upstream_cx_active", "upstream_rq_active",
+                                       "membership_healthy", "membership_total"}) {
+        store_.gaugeFromString(absl::StrCat(prefix, suffix), Stats::Gauge::ImportMode::Accumulate)
+            .set(i);
+      }
+    }
+  }
+
+  ~StatsHandlerSpeedTest() { store_.shutdownThreading(); }
+
+  uint64_t statsAsJson() {
+    Buffer::OwnedImpl response;
+    StatsHandler::statsAsJson(store_.counters(), store_.gauges(), store_.textReadouts(),
+                              store_.histograms(), false, absl::nullopt, response);
+    return response.length();
+  }
+
+private:
+  Stats::SymbolTablePtr symbol_table_;
+  Stats::AllocatorImpl alloc_;
+  Stats::ThreadLocalStoreImpl store_;
+};
+
+} // namespace Server
+} // namespace Envoy
+
+// Measures writing every stat of a large store as JSON, which is dominated by sorting the stats
+// by name.
+static void BM_StatsAsJson(benchmark::State& state) {
+  Envoy::Server::StatsHandlerSpeedTest context(state.range(0));
+
+  uint64_t length = 0;
+  for (auto _ : state) {
+    length += context.statsAsJson();
+  }
+  benchmark::DoNotOptimize(length);
+}
+BENCHMARK(BM_StatsAsJson)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
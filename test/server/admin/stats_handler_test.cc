@@ -26,12 +26,21 @@ public:
   }
 
   static std::string
-  statsAsJsonHandler(std::map<std::string, uint64_t>& all_stats,
-                     std::map<std::string, std::string>& all_text_readouts,
+  statsAsJsonHandler(const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
+                     const bool used_only, const absl::optional<std::regex> regex = absl::nullopt) {
+    return statsAsJsonHandler({}, {}, {}, all_histograms, used_only, regex);
+  }
+
+  static std::string
+  statsAsJsonHandler(const std::vector<Stats::CounterSharedPtr>& counters,
+                     const std::vector<Stats::GaugeSharedPtr>& gauges,
+                     const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
                      const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
                      const bool used_only, const absl::optional<std::regex> regex = absl::nullopt) {
-    return StatsHandler::statsAsJson(all_stats, all_text_readouts, all_histograms, used_only, regex,
-                                     true /*pretty_print*/);
+    Buffer::OwnedImpl response;
+    StatsHandler::statsAsJson(counters, gauges, text_readouts, all_histograms, used_only, regex,
+                              response);
+    return response.toString();
   }
 
   Stats::SymbolTablePtr symbol_table_;
@@ -72,9 +81,7 @@ TEST_P(AdminStatsTest, StatsAsJson) {
   std::sort(histograms.begin(), histograms.end(),
             [](const Stats::ParentHistogramSharedPtr& a,
                const Stats::ParentHistogramSharedPtr& b) -> bool { return a->name() < b->name(); });
-  std::map<std::string, uint64_t> all_stats;
-  std::map<std::string, std::string> all_text_readouts;
-  std::string actual_json = statsAsJsonHandler(all_stats, all_text_readouts, histograms, false);
+  std::string actual_json = statsAsJsonHandler(histograms, false);
 
   const std::string expected_json = R"EOF({
     "stats": [
@@ -215,10 +222,7 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJson) {
 
   store_->mergeHistograms([]() -> void {});
 
-  std::map<std::string, uint64_t> all_stats;
-  std::map<std::string, std::string> all_text_readouts;
-  std::string actual_json =
-      statsAsJsonHandler(all_stats, all_text_readouts, store_->histograms(), true);
+  std::string actual_json = statsAsJsonHandler(store_->histograms(), true);
 
   // Expected JSON should not have h2 values as it is not used.
   const std::string expected_json = R"EOF({
@@ -315,11 +319,8 @@ TEST_P(AdminStatsTest, StatsAsJsonFilterString) {
 
   store_->mergeHistograms([]() -> void {});
 
-  std::map<std::string, uint64_t> all_stats;
-  std::map<std::string, std::string> all_text_readouts;
-  std::string actual_json =
-      statsAsJsonHandler(all_stats, all_text_readouts, store_->histograms(), false,
-                         absl::optional<std::regex>{std::regex("[a-z]1")});
+  std::string actual_json = statsAsJsonHandler(store_->histograms(), false,
+                                               absl::optional<std::regex>{std::regex("[a-z]1")});
 
   // Because this is a filter case, we don't expect to see any stats except for those containing
   // "h1" in their name.
@@ -426,11 +427,8 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJsonFilterString) {
 
   store_->mergeHistograms([]() -> void {});
 
-  std::map<std::string, uint64_t> all_stats;
-  std::map<std::string, std::string> all_text_readouts;
-  std::string actual_json =
-      statsAsJsonHandler(all_stats, all_text_readouts, store_->histograms(), true,
-                         absl::optional<std::regex>{std::regex("h[12]")});
+  std::string actual_json = statsAsJsonHandler(store_->histograms(), true,
+                                               absl::optional<std::regex>{std::regex("h[12]")});
 
   // Expected JSON should not have h2 values as it is not used, and should not have h3 values as
   // they are used but do not match.
@@ -506,6 +504,64 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJsonFilterString) {
   store_->shutdownThreading();
 }
 
+TEST_P(AdminStatsTest, CountersGaugesAndTextReadoutsAsJson) {
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  store_->counterFromString("b.counter").add(3);
+  store_->gaugeFromString("a.gauge", Stats::Gauge::ImportMode::Accumulate).set(7);
+  store_->counterFromString("c.unused");
+  store_->textReadoutFromString("t.readout").set("quote\" backslash\\ newline\n");
+
+  std::string actual_json = statsAsJsonHandler(store_->counters(), store_->gauges(),
+                                               store_->textReadouts(), {}, false);
+
+  // Text readouts come first, followed by the counters and gauges sorted by name.
+  const std::string expected_json = R"EOF({
+    "stats": [
+        {
+            "name": "t.readout",
+            "value": "quote\" backslash\\ newline\n"
+        },
+        {
+            "name": "a.gauge",
+            "value": 7
+        },
+        {
+            "name": "b.counter",
+            "value": 3
+        },
+        {
+            "name": "c.unused",
+            "value": 0
+        }
+    ]
+})EOF";
+  EXPECT_THAT(expected_json, JsonStringEq(actual_json));
+
+  // Unused stats are left out, and so is the histograms object when there are no histograms.
+  actual_json = statsAsJsonHandler(store_->counters(), store_->gauges(), {}, {}, true);
+  EXPECT_EQ(R"EOF({"stats":[{"name":"a.gauge","value":7},{"name":"b.counter","value":3}]})EOF",
+            actual_json);
+  store_->shutdownThreading();
+}
+
+// Stats are sorted by their full names as strings, so "a-b" sorts before "a.b" even though the
+// token "a" sorts before the token "a-b".
+TEST_P(AdminStatsTest, StatsAsJsonSortedByString) {
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  store_->counterFromString("a.b").add(1);
+  store_->gaugeFromString("a-b", Stats::Gauge::ImportMode::Accumulate).set(2);
+  store_->counterFromString("a.a").add(3);
+
+  const std::string actual_json =
+      statsAsJsonHandler(store_->counters(), store_->gauges(), {}, {}, true);
+  EXPECT_EQ(R"EOF({"stats":[{"name":"a-b","value":2},{"name":"a.a","value":3},)EOF"
+            R"EOF({"name":"a.b","value":1}]})EOF",
+            actual_json);
+  store_->shutdownThreading();
+}
+
 INSTANTIATE_TEST_SUITE_P(IpVersions, AdminInstanceTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
                          TestUtility::ipTestParamsToString);
@@ -781,26 +781,67 @@ public:
   Impl header_map_;
 };
 
+/**
+ * Base class for the typed test header maps, which adds pass through implementations of the custom
+ * inline header functions.
+ */
+template <class Interface, class Impl>
+class TestTypedHeaderMapImplBase : public TestHeaderMapImplBase<Interface, Impl> {
+public:
+  using TestHeaderMapImplBase<Interface, Impl>::TestHeaderMapImplBase;
+  using Handle = typename Interface::Handle;
+
+  // Http::CustomInlineHeaderBase
+  const HeaderEntry* getInline(Handle handle) const override {
+    return this->header_map_.getInline(handle);
+  }
+  void appendInline(Handle handle, absl::string_view data, absl::string_view delimiter) override {
+    this->header_map_.appendInline(handle, data, delimiter);
+    this->header_map_.verifyByteSizeInternalForTest();
+  }
+  void setReferenceInline(Handle handle, absl::string_view value) override {
+    this->header_map_.setReferenceInline(handle, value);
+    this->header_map_.verifyByteSizeInternalForTest();
+  }
+  void setInline(Handle handle, absl::string_view value) override {
+    this->header_map_.setInline(handle, value);
+    this->header_map_.verifyByteSizeInternalForTest();
+  }
+  void setInline(Handle handle, uint64_t value) override {
+    this->header_map_.setInline(handle, value);
+    this->header_map_.verifyByteSizeInternalForTest();
+  }
+  size_t removeInline(Handle handle) override {
+    const size_t headers_removed = this->header_map_.removeInline(handle);
+    this->header_map_.verifyByteSizeInternalForTest();
+    return headers_removed;
+  }
+};
+
 /**
  * Typed test implementations for all of the concrete header types.
  */
 using TestHeaderMapImpl = TestHeaderMapImplBase<HeaderMap, HeaderMapImpl>;
 
 class TestRequestHeaderMapImpl
-    : public TestHeaderMapImplBase<RequestHeaderMap, RequestHeaderMapImpl> {
+    : public TestTypedHeaderMapImplBase<RequestHeaderMap, RequestHeaderMapImpl> {
 public:
-  using TestHeaderMapImplBase::TestHeaderMapImplBase;
+  using TestTypedHeaderMapImplBase::TestTypedHeaderMapImplBase;
 
   INLINE_REQ_HEADERS(DEFINE_TEST_INLINE_HEADER_FUNCS)
   INLINE_REQ_RESP_HEADERS(DEFINE_TEST_INLINE_HEADER_FUNCS)
 };
 
-using TestRequestTrailerMapImpl = TestHeaderMapImplBase<RequestTrailerMap, RequestTrailerMapImpl>;
+class TestRequestTrailerMapImpl
+    : public TestTypedHeaderMapImplBase<RequestTrailerMap, RequestTrailerMapImpl> {
+public:
+  using TestTypedHeaderMapImplBase::TestTypedHeaderMapImplBase;
+};
 
 class TestResponseHeaderMapImpl
-    : public TestHeaderMapImplBase<ResponseHeaderMap, ResponseHeaderMapImpl> {
+    : public TestTypedHeaderMapImplBase<ResponseHeaderMap, ResponseHeaderMapImpl> {
 public:
-  using TestHeaderMapImplBase::TestHeaderMapImplBase;
+  using TestTypedHeaderMapImplBase::TestTypedHeaderMapImplBase;
 
   INLINE_RESP_HEADERS(DEFINE_TEST_INLINE_HEADER_FUNCS)
   INLINE_REQ_RESP_HEADERS(DEFINE_TEST_INLINE_HEADER_FUNCS)
@@ -808,9 +849,9 @@ public:
 };
 
 class TestResponseTrailerMapImpl
-    : public TestHeaderMapImplBase<ResponseTrailerMap, ResponseTrailerMapImpl> {
+    : public TestTypedHeaderMapImplBase<ResponseTrailerMap, ResponseTrailerMapImpl> {
 public:
-  using TestHeaderMapImplBase::TestHeaderMapImplBase;
+  using TestTypedHeaderMapImplBase::TestTypedHeaderMapImplBase;
 
   INLINE_RESP_HEADERS_TRAILERS(DEFINE_TEST_INLINE_HEADER_FUNCS)
 };